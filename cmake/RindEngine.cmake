@@ -1,10 +1,17 @@
 # Helpers exported by the rind_engine target for downstream consumers
 #
 #   embed_asset_category(TARGET <tgt> CATEGORY <name> DIRECTORY <dir>
-#                        EXTENSIONS <ext...> [RECURSIVE ON|OFF])
-#       Globs assets, runs embed_asset.py + generate_registry.py, and attaches
-#       the generated .cpp files to <tgt>. Adds the generated registry header
-#       directory to <tgt>'s include path
+#                        EXTENSIONS <ext...> [RECURSIVE ON|OFF]
+#                        [COOKER <script> COOKED_EXT <ext>])
+#       Globs assets and adds them to <tgt>'s asset pack, written by
+#       pack_assets.py to ${RIND_ASSET_PACK_DIR}/<tgt>.pak once the calling
+#       directory is done (so every category of a target must be embedded from
+#       the same directory). generate_registry.py emits a per-category
+#       <category>/<category>_registry.h on <tgt>'s include path whose
+#       getEmbedded_<category>() maps the pack at runtime. With COOKER (a
+#       python script or an executable target), each asset is first run
+#       through `<cooker> <input> <output> <asset name>` and the cooked <ext>
+#       file is packed instead of the source
 #
 #   rind_engine_compile_shaders(TARGET <tgt> SOURCE_DIR <dir> OUT_DIR <dir>
 #                               OUTPUT_LIST <var>)
@@ -23,6 +30,9 @@ set(_RIND_ENGINE_CMAKE_INCLUDED TRUE)
 
 set(RIND_ENGINE_CMAKE_DIR "${CMAKE_CURRENT_LIST_DIR}")
 
+# asset packs are looked up next to the running executable
+set(RIND_ASSET_PACK_DIR "${CMAKE_BINARY_DIR}" CACHE PATH "Directory the asset packs are written to, the executable's output directory")
+
 find_package(Python3 REQUIRED COMPONENTS Interpreter)
 
 function(rind_engine_compile_shaders)
@@ -81,7 +91,7 @@ function(rind_engine_compile_shaders)
 endfunction()
 
 function(embed_asset_category)
-    cmake_parse_arguments(EA "" "TARGET;CATEGORY;DIRECTORY;RECURSIVE" "EXTENSIONS" ${ARGN})
+    cmake_parse_arguments(EA "" "TARGET;CATEGORY;DIRECTORY;RECURSIVE;COOKER;COOKED_EXT" "EXTENSIONS" ${ARGN})
 
     if(NOT EA_TARGET)
         message(FATAL_ERROR "embed_asset_category: TARGET argument is required.")
@@ -92,6 +102,9 @@ function(embed_asset_category)
     if(NOT EA_DIRECTORY)
         message(FATAL_ERROR "embed_asset_category: DIRECTORY argument is required.")
     endif()
+    if(EA_COOKER AND NOT EA_COOKED_EXT)
+        message(FATAL_ERROR "embed_asset_category: COOKER requires COOKED_EXT.")
+    endif()
 
     set(GENERATED_ROOT "${CMAKE_BINARY_DIR}/generated/assets/${EA_TARGET}")
     set(CATEGORY_DIR "${GENERATED_ROOT}/${EA_CATEGORY}")
@@ -107,8 +120,11 @@ function(embed_asset_category)
         list(APPEND ASSET_FILES ${FOUND})
     endforeach()
 
-    set(CATEGORY_NAMES "")
-    set(CATEGORY_SOURCES "")
+    if(EA_COOKER AND TARGET ${EA_COOKER})
+        set(COOK_COMMAND $<TARGET_FILE:${EA_COOKER}>)
+    elseif(EA_COOKER)
+        set(COOK_COMMAND ${Python3_EXECUTABLE} ${EA_COOKER})
+    endif()
 
     foreach(ASSET_FILE ${ASSET_FILES})
         file(RELATIVE_PATH REL_PATH "${EA_DIRECTORY}" "${ASSET_FILE}")
@@ -123,54 +139,81 @@ function(embed_asset_category)
             set(ASSET_NAME "${STEM}")
         endif()
 
-        string(REGEX REPLACE "[^a-zA-Z0-9]" "_" SAFE_NAME "${ASSET_NAME}")
-        set(OUT_CPP "${CATEGORY_DIR}/${EA_CATEGORY}_${SAFE_NAME}.cpp")
-        set(OUT_H "${CATEGORY_DIR}/${EA_CATEGORY}_${SAFE_NAME}.h")
-
-        add_custom_command(
-            OUTPUT ${OUT_CPP} ${OUT_H}
-            COMMAND ${Python3_EXECUTABLE}
-                ${RIND_ENGINE_CMAKE_DIR}/embed_asset.py
-                ${ASSET_FILE}
-                ${CATEGORY_DIR}
-                ${ASSET_NAME}
-                ${EA_CATEGORY}
-            DEPENDS ${ASSET_FILE} ${RIND_ENGINE_CMAKE_DIR}/embed_asset.py
-            COMMENT "Embedding ${EA_CATEGORY}: ${ASSET_NAME}"
-            VERBATIM
-        )
+        set(PACK_FILE "${ASSET_FILE}")
+        if(EA_COOKER)
+            string(REGEX REPLACE "[^a-zA-Z0-9]" "_" SAFE_NAME "${ASSET_NAME}")
+            set(PACK_FILE "${GENERATED_ROOT}/${EA_CATEGORY}_cooked/${SAFE_NAME}${EA_COOKED_EXT}")
+            add_custom_command(
+                OUTPUT ${PACK_FILE}
+                COMMAND ${COOK_COMMAND}
+                    ${ASSET_FILE}
+                    ${PACK_FILE}
+                    ${ASSET_NAME}
+                DEPENDS ${ASSET_FILE} ${EA_COOKER}
+                COMMENT "Cooking ${EA_CATEGORY}: ${ASSET_NAME}"
+                VERBATIM
+            )
+        endif()
 
-        list(APPEND CATEGORY_NAMES "${ASSET_NAME}")
-        list(APPEND CATEGORY_SOURCES ${OUT_CPP})
+        set_property(GLOBAL APPEND PROPERTY RIND_ASSET_PACK_ENTRIES_${EA_TARGET} "${EA_CATEGORY}\t${ASSET_NAME}\t${PACK_FILE}")
+        set_property(GLOBAL APPEND PROPERTY RIND_ASSET_PACK_FILES_${EA_TARGET} "${PACK_FILE}")
     endforeach()
 
     set(REGISTRY_H "${CATEGORY_DIR}/${EA_CATEGORY}_registry.h")
-    set(CATEGORY_HEADERS "")
-    foreach(NAME ${CATEGORY_NAMES})
-        string(REGEX REPLACE "[^a-zA-Z0-9]" "_" SAFE "${NAME}")
-        list(APPEND CATEGORY_HEADERS "${CATEGORY_DIR}/${EA_CATEGORY}_${SAFE}.h")
-    endforeach()
-
     add_custom_command(
         OUTPUT ${REGISTRY_H}
         COMMAND ${Python3_EXECUTABLE}
             ${RIND_ENGINE_CMAKE_DIR}/generate_registry.py
             ${EA_CATEGORY}
             ${CATEGORY_DIR}
-            ${CATEGORY_NAMES}
-        DEPENDS ${CATEGORY_HEADERS} ${RIND_ENGINE_CMAKE_DIR}/generate_registry.py
+            ${EA_TARGET}
+        DEPENDS ${RIND_ENGINE_CMAKE_DIR}/generate_registry.py
         COMMENT "Generating ${EA_CATEGORY} registry for ${EA_TARGET}"
         VERBATIM
     )
 
-    target_sources(${EA_TARGET} PRIVATE ${CATEGORY_SOURCES} ${REGISTRY_H})
+    target_sources(${EA_TARGET} PRIVATE ${REGISTRY_H})
     target_include_directories(${EA_TARGET} PRIVATE ${GENERATED_ROOT})
 
     set(_assets_tgt "${EA_TARGET}_${EA_CATEGORY}_Embed")
-    add_custom_target(${_assets_tgt} DEPENDS ${REGISTRY_H} ${CATEGORY_SOURCES})
+    add_custom_target(${_assets_tgt} DEPENDS ${REGISTRY_H})
     add_dependencies(${EA_TARGET} ${_assets_tgt})
-    if(TARGET ${EA_TARGET}_Shaders)
-        add_dependencies(${_assets_tgt} ${EA_TARGET}_Shaders)
+
+    # the pack is written once per target after all of its categories are known
+    get_property(_pack_scheduled GLOBAL PROPERTY RIND_ASSET_PACK_SCHEDULED_${EA_TARGET})
+    if(NOT _pack_scheduled)
+        set_property(GLOBAL PROPERTY RIND_ASSET_PACK_SCHEDULED_${EA_TARGET} TRUE)
+        set_property(GLOBAL APPEND PROPERTY RIND_ASSET_PACKS "${RIND_ASSET_PACK_DIR}/${EA_TARGET}.pak")
+        # deferred arguments are expanded at call time, so bake the target name in now
+        cmake_language(EVAL CODE "cmake_language(DEFER CALL _rind_write_asset_pack [[${EA_TARGET}]])")
+    endif()
+endfunction()
+
+function(_rind_write_asset_pack target)
+    get_property(_entries GLOBAL PROPERTY RIND_ASSET_PACK_ENTRIES_${target})
+    get_property(_files GLOBAL PROPERTY RIND_ASSET_PACK_FILES_${target})
+
+    set(MANIFEST "${CMAKE_BINARY_DIR}/generated/assets/${target}/pack_manifest.txt")
+    set(PACK "${RIND_ASSET_PACK_DIR}/${target}.pak")
+    list(JOIN _entries "\n" _manifest_content)
+    file(GENERATE OUTPUT ${MANIFEST} CONTENT "${_manifest_content}\n")
+    file(MAKE_DIRECTORY "${RIND_ASSET_PACK_DIR}")
+
+    add_custom_command(
+        OUTPUT ${PACK}
+        COMMAND ${Python3_EXECUTABLE}
+            ${RIND_ENGINE_CMAKE_DIR}/pack_assets.py
+            ${PACK}
+            ${MANIFEST}
+        DEPENDS ${_files} ${MANIFEST} ${RIND_ENGINE_CMAKE_DIR}/pack_assets.py
+        COMMENT "Packing assets for ${target}"
+        VERBATIM
+    )
+
+    add_custom_target(${target}_AssetPack DEPENDS ${PACK})
+    add_dependencies(${target} ${target}_AssetPack)
+    if(TARGET ${target}_Shaders)
+        add_dependencies(${target}_AssetPack ${target}_Shaders)
     endif()
 endfunction()
 
@@ -189,6 +232,10 @@ function(rind_engine_bundle_runtimes target_name)
 
     if(WIN32)
         install(TARGETS ${target_name} RUNTIME DESTINATION . CONFIGURATIONS Release)
+        get_property(_asset_packs GLOBAL PROPERTY RIND_ASSET_PACKS)
+        if(_asset_packs)
+            install(FILES ${_asset_packs} DESTINATION . CONFIGURATIONS Release)
+        endif()
 
         # Steam runtime DLL: copy next to the executable and into the install package
         if(_steam_runtime_lib AND EXISTS "${_steam_runtime_lib}")
@@ -0,0 +1,899 @@
+#!/usr/bin/env python3
+# Cooks a .glb into the engine's binary model format (see include/engine/CookedModel.h)
+import sys
+import os
+import json
+import math
+import struct
+
+MAGIC = 0x4C444D52  # "RMDL"
+VERSION = 4
+FLAG_SKINNED = 1
+FLAG_INDEX16 = 2
+VERTEX_FORMAT = '<4H4h2e'  # position unorm16x4, normal + tangent octahedral snorm16x4, uv half2
+VERTEX_CACHE_SIZE = 16
+MAX_LODS = 4  # matches cooked::kMaxModelLods
+LOD_TRIANGLE_RATIO = 0.5  # each level aims for half the triangles of the one before
+LOD_MIN_TRIANGLES = 32
+
+HEADER_FORMAT = '<14I6f14I8x'
+HEADER_SIZE = 144
+
+INTERPOLATIONS = {'LINEAR': 0, 'STEP': 1, 'CUBICSPLINE': 2}
+PATHS = {'translation': 0, 'rotation': 1, 'scale': 2}
+
+COMPONENT_FORMATS = {
+    5120: ('b', 1, 127.0),
+    5121: ('B', 1, 255.0),
+    5122: ('h', 2, 32767.0),
+    5123: ('H', 2, 65535.0),
+    5125: ('I', 4, 4294967295.0),
+    5126: ('f', 4, None),
+}
+TYPE_SIZES = {'SCALAR': 1, 'VEC2': 2, 'VEC3': 3, 'VEC4': 4, 'MAT2': 4, 'MAT3': 9, 'MAT4': 16}
+
+
+def warn(message):
+    print(f"Warning: {message}", file=sys.stderr)
+
+
+class Glb:
+    def __init__(self, path, name):
+        self.name = name
+        with open(path, 'rb') as f:
+            data = f.read()
+        if len(data) < 20:
+            raise RuntimeError(f"{self.name}: file too small to be a glb")
+        magic, version, length = struct.unpack_from('<3I', data, 0)
+        if magic != 0x46546C67 or version != 2:
+            raise RuntimeError(f"{self.name}: not a glTF 2.0 binary")
+        self.json = None
+        self.bin = b''
+        offset = 12
+        while offset + 8 <= min(length, len(data)):
+            chunk_length, chunk_type = struct.unpack_from('<2I', data, offset)
+            chunk = data[offset + 8:offset + 8 + chunk_length]
+            if chunk_type == 0x4E4F534A:
+                self.json = json.loads(chunk)
+            elif chunk_type == 0x004E4942:
+                self.bin = chunk
+            offset += 8 + chunk_length
+        if self.json is None:
+            raise RuntimeError(f"{self.name}: missing JSON chunk")
+
+    def buffer_bytes(self, index):
+        buffer = self.json['buffers'][index]
+        if 'uri' in buffer:
+            raise RuntimeError(f"{self.name}: external buffers are not supported")
+        return self.bin
+
+    def read_view(self, view_index, byte_offset, count, component_type, components):
+        fmt, size, _ = COMPONENT_FORMATS[component_type]
+        view = self.json['bufferViews'][view_index]
+        data = self.buffer_bytes(view['buffer'])
+        base = view.get('byteOffset', 0) + byte_offset
+        element_size = size * components
+        stride = view.get('byteStride', element_size)
+        element = struct.Struct('<' + fmt * components)
+        return [element.unpack_from(data, base + i * stride) for i in range(count)]
+
+    # returns a list of tuples, normalized integers are converted to floats
+    def read_accessor(self, index):
+        accessor = self.json['accessors'][index]
+        component_type = accessor['componentType']
+        components = TYPE_SIZES[accessor['type']]
+        count = accessor['count']
+        if 'bufferView' in accessor:
+            values = self.read_view(accessor['bufferView'], accessor.get('byteOffset', 0),
+                                    count, component_type, components)
+        else:
+            values = [(0,) * components] * count
+        sparse = accessor.get('sparse')
+        if sparse:
+            values = list(values)
+            indices = self.read_view(sparse['indices']['bufferView'], sparse['indices'].get('byteOffset', 0),
+                                     sparse['count'], sparse['indices']['componentType'], 1)
+            replaced = self.read_view(sparse['values']['bufferView'], sparse['values'].get('byteOffset', 0),
+                                      sparse['count'], component_type, components)
+            for (i,), value in zip(indices, replaced):
+                values[i] = value
+        _, _, scale = COMPONENT_FORMATS[component_type]
+        if accessor.get('normalized', False) and scale is not None:
+            values = [tuple(max(c / scale, -1.0) for c in v) for v in values]
+        return values
+
+
+def quat_to_mat3(q):
+    x, y, z, w = q
+    return [
+        [1.0 - 2.0 * (y * y + z * z), 2.0 * (x * y + w * z), 2.0 * (x * z - w * y)],
+        [2.0 * (x * y - w * z), 1.0 - 2.0 * (x * x + z * z), 2.0 * (y * z + w * x)],
+        [2.0 * (x * z + w * y), 2.0 * (y * z - w * x), 1.0 - 2.0 * (x * x + y * y)],
+    ]
+
+
+def mat3_to_quat(m):
+    trace = m[0][0] + m[1][1] + m[2][2]
+    if trace > 0.0:
+        s = math.sqrt(trace + 1.0) * 2.0
+        return ((m[1][2] - m[2][1]) / s, (m[2][0] - m[0][2]) / s, (m[0][1] - m[1][0]) / s, 0.25 * s)
+    if m[0][0] > m[1][1] and m[0][0] > m[2][2]:
+        s = math.sqrt(1.0 + m[0][0] - m[1][1] - m[2][2]) * 2.0
+        return (0.25 * s, (m[1][0] + m[0][1]) / s, (m[2][0] + m[0][2]) / s, (m[1][2] - m[2][1]) / s)
+    if m[1][1] > m[2][2]:
+        s = math.sqrt(1.0 + m[1][1] - m[0][0] - m[2][2]) * 2.0
+        return ((m[1][0] + m[0][1]) / s, 0.25 * s, (m[2][1] + m[1][2]) / s, (m[2][0] - m[0][2]) / s)
+    s = math.sqrt(1.0 + m[2][2] - m[0][0] - m[1][1]) * 2.0
+    return ((m[2][0] + m[0][2]) / s, (m[2][1] + m[1][2]) / s, 0.25 * s, (m[0][1] - m[1][0]) / s)
+
+
+# column-major like glm, columns scaled by the node scale
+def trs_to_mat4(t, r, s):
+    rot = quat_to_mat3(r)
+    return [
+        rot[0][0] * s[0], rot[0][1] * s[0], rot[0][2] * s[0], 0.0,
+        rot[1][0] * s[1], rot[1][1] * s[1], rot[1][2] * s[1], 0.0,
+        rot[2][0] * s[2], rot[2][1] * s[2], rot[2][2] * s[2], 0.0,
+        t[0], t[1], t[2], 1.0,
+    ]
+
+
+def decompose_mat4(m):
+    translation = (m[12], m[13], m[14])
+    columns = [m[0:3], m[4:7], m[8:11]]
+    scale = [math.sqrt(sum(c * c for c in col)) for col in columns]
+    rot = [[c / s if s > 0.0 else 0.0 for c in col] for col, s in zip(columns, scale)]
+    return translation, mat3_to_quat(rot), tuple(scale)
+
+
+def normalize(v):
+    length = math.sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2])
+    if length < 1e-6:
+        return None
+    return (v[0] / length, v[1] / length, v[2] / length)
+
+
+def sub3(a, b):
+    return (a[0] - b[0], a[1] - b[1], a[2] - b[2])
+
+
+def dot3(a, b):
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]
+
+
+def cross3(a, b):
+    return (a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0])
+
+
+def compute_tangents(vertices, first_vertex, vertex_count, indices, first_index):
+    tangents = [[0.0, 0.0, 0.0] for _ in range(vertex_count)]
+    bitangents = [[0.0, 0.0, 0.0] for _ in range(vertex_count)]
+    for i in range(first_index, len(indices) - 2, 3):
+        tri = [indices[i + k] - first_vertex for k in range(3)]
+        if any(v < 0 or v >= vertex_count for v in tri):
+            continue
+        p = [vertices[first_vertex + v] for v in tri]
+        edge1 = [p[1][k] - p[0][k] for k in range(3)]
+        edge2 = [p[2][k] - p[0][k] for k in range(3)]
+        duv1 = (p[1][6] - p[0][6], p[1][7] - p[0][7])
+        duv2 = (p[2][6] - p[0][6], p[2][7] - p[0][7])
+        det = duv1[0] * duv2[1] - duv2[0] * duv1[1]
+        tangent = (1.0, 0.0, 0.0)
+        bitangent = (0.0, 1.0, 0.0)
+        if abs(det) > 1e-6:
+            inv = 1.0 / det
+            tangent = [inv * (edge1[k] * duv2[1] - edge2[k] * duv1[1]) for k in range(3)]
+            bitangent = [inv * (edge2[k] * duv1[0] - edge1[k] * duv2[0]) for k in range(3)]
+        for v in tri:
+            for k in range(3):
+                tangents[v][k] += tangent[k]
+                bitangents[v][k] += bitangent[k]
+    for i in range(vertex_count):
+        vertex = vertices[first_vertex + i]
+        n = vertex[3:6]
+        t = tangents[i]
+        d = n[0] * t[0] + n[1] * t[1] + n[2] * t[2]
+        t = normalize([t[k] - n[k] * d for k in range(3)]) or (1.0, 0.0, 0.0)
+        b = bitangents[i]
+        cross = (n[1] * t[2] - n[2] * t[1], n[2] * t[0] - n[0] * t[2], n[0] * t[1] - n[1] * t[0])
+        handedness = -1.0 if cross[0] * b[0] + cross[1] * b[1] + cross[2] * b[2] < 0.0 else 1.0
+        vertex[8:12] = [t[0], t[1], t[2], handedness]
+
+
+# tipsify (sander et al. 2007): emits triangles fanning around recently used vertices so
+# the post-transform cache stays warm, returns the reordered indices and where a new
+# cluster starts because the walk had to jump to a cold vertex
+def optimize_vertex_cache(indices, vertex_count, cache_size=VERTEX_CACHE_SIZE):
+    tri_count = len(indices) // 3
+    live = [0] * vertex_count
+    for v in indices:
+        live[v] += 1
+    adjacency_offset = [0] * (vertex_count + 1)
+    for v in range(vertex_count):
+        adjacency_offset[v + 1] = adjacency_offset[v] + live[v]
+    adjacency = [0] * len(indices)
+    fill = adjacency_offset[:-1]
+    for i, v in enumerate(indices):
+        adjacency[fill[v]] = i // 3
+        fill[v] += 1
+
+    cache_time = [-cache_size - 1] * vertex_count
+    emitted = [False] * tri_count
+    dead_end = []
+    result = []
+    cluster_starts = [0]
+    timestamp = 0
+    cursor = 0
+    fan = 0
+    while fan >= 0:
+        candidates = []
+        for t in adjacency[adjacency_offset[fan]:adjacency_offset[fan + 1]]:
+            if emitted[t]:
+                continue
+            emitted[t] = True
+            for v in indices[t * 3:t * 3 + 3]:
+                result.append(v)
+                dead_end.append(v)
+                candidates.append(v)
+                live[v] -= 1
+                if timestamp - cache_time[v] > cache_size:
+                    cache_time[v] = timestamp
+                    timestamp += 1
+        fan = -1
+        best = -1
+        for v in candidates:
+            if live[v] <= 0:
+                continue
+            age = timestamp - cache_time[v]
+            priority = age if age + 2 * live[v] <= cache_size else 0
+            if priority > best:
+                best = priority
+                fan = v
+        if fan >= 0:
+            continue
+        while dead_end:
+            v = dead_end.pop()
+            if live[v] > 0:
+                fan = v
+                break
+        while fan < 0 and cursor < vertex_count:
+            if live[cursor] > 0:
+                fan = cursor
+            cursor += 1
+        if fan >= 0 and len(result) > cluster_starts[-1]:
+            cluster_starts.append(len(result))
+    return result, cluster_starts
+
+
+# sorts the clusters so the ones facing away from the mesh centre draw first, they tend to
+# occlude the rest from most directions. clusters keep their own order, so cache hits stay
+def optimize_overdraw(vertices, indices, cluster_starts):
+    clusters = []
+    area_sum = 0.0
+    centre = [0.0, 0.0, 0.0]
+    bounds = cluster_starts + [len(indices)]
+    for start, end in zip(bounds, bounds[1:]):
+        normal = [0.0, 0.0, 0.0]
+        centroid = [0.0, 0.0, 0.0]
+        area = 0.0
+        for i in range(start, end, 3):
+            a, b, c = (vertices[indices[i + k]] for k in range(3))
+            e1 = [b[k] - a[k] for k in range(3)]
+            e2 = [c[k] - a[k] for k in range(3)]
+            n = (e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0])
+            tri_area = math.sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2])
+            for k in range(3):
+                normal[k] += n[k]
+                centroid[k] += (a[k] + b[k] + c[k]) * tri_area / 3.0
+            area += tri_area
+        if area > 0.0:
+            centroid = [c / area for c in centroid]
+            for k in range(3):
+                centre[k] += centroid[k] * area
+            area_sum += area
+        clusters.append((start, end, normal, centroid))
+    if area_sum > 0.0:
+        centre = [c / area_sum for c in centre]
+
+    def facing(cluster):
+        _, _, normal, centroid = cluster
+        n = normalize(normal)
+        if n is None:
+            return 0.0
+        return sum((centroid[k] - centre[k]) * n[k] for k in range(3))
+
+    clusters.sort(key=facing, reverse=True)
+    return [v for start, end, _, _ in clusters for v in indices[start:end]]
+
+
+# renumbers vertices in the order the indices first touch them so fetches walk the
+# vertex buffer forwards, vertices no triangle uses are dropped
+def optimize_vertex_fetch(vertices, indices, skinning):
+    remap = {}
+    for v in indices:
+        if v not in remap:
+            remap[v] = len(remap)
+    order = sorted(remap, key=remap.get)
+    vertices = [vertices[v] for v in order]
+    if skinning:
+        skinning = [c for v in order for c in skinning[v * 8:v * 8 + 8]]
+    return vertices, [remap[v] for v in indices], skinning
+
+
+def optimize_mesh(vertices, indices, skinning):
+    indices = indices[:len(indices) - len(indices) % 3]
+    indices, cluster_starts = optimize_vertex_cache(indices, len(vertices))
+    indices = optimize_overdraw(vertices, indices, cluster_starts)
+    return optimize_vertex_fetch(vertices, indices, skinning)
+
+
+def plane_quadric(a, b, c):
+    e1 = [b[k] - a[k] for k in range(3)]
+    e2 = [c[k] - a[k] for k in range(3)]
+    n = (e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0])
+    area = math.sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2])
+    if area < 1e-12:
+        return None
+    x, y, z = n[0] / area, n[1] / area, n[2] / area
+    w = -(x * a[0] + y * a[1] + z * a[2])
+    # area weighted so big faces hold their shape over slivers
+    return [area * q for q in (x * x, x * y, x * z, x * w, y * y, y * z, y * w, z * z, z * w, w * w)]
+
+
+def quadric_error(q, v):
+    x, y, z = v[0], v[1], v[2]
+    return (q[0] * x * x + 2.0 * q[1] * x * y + 2.0 * q[2] * x * z + 2.0 * q[3] * x
+            + q[4] * y * y + 2.0 * q[5] * y * z + 2.0 * q[6] * y
+            + q[7] * z * z + 2.0 * q[8] * z + q[9])
+
+
+def normal_bucket(n):
+    axis = max(range(3), key=lambda k: abs(n[k]))
+    return axis * 2 + (1 if n[axis] < 0.0 else 0)
+
+
+# vertex clustering (rossignac-borrel) on a grid of cell_size: every vertex snaps to the one
+# in its cell with the smallest quadric error, triangles that collapse are dropped. the
+# normal bucket in the key keeps opposite sides of thin walls and hard edges apart. the
+# level indexes the full-detail vertex buffer, so it costs no vertex memory. returns the
+# indices and the furthest any vertex moved
+def simplify_clustered(vertices, indices, quadrics, aabb_min, cell_size):
+    cells = {}
+    keys = []
+    for v in vertices:
+        key = (int((v[0] - aabb_min[0]) / cell_size), int((v[1] - aabb_min[1]) / cell_size),
+               int((v[2] - aabb_min[2]) / cell_size), normal_bucket(v[3:6]))
+        keys.append(key)
+        cells.setdefault(key, []).append(len(keys) - 1)
+    representative = [0] * len(vertices)
+    error = 0.0
+    for members in cells.values():
+        q = [0.0] * 10
+        for m in members:
+            for k in range(10):
+                q[k] += quadrics[m][k]
+        best = min(members, key=lambda m: quadric_error(q, vertices[m]))
+        for m in members:
+            representative[m] = best
+            d = math.sqrt(sum((vertices[m][k] - vertices[best][k]) ** 2 for k in range(3)))
+            error = max(error, d)
+    result = []
+    seen = set()
+    for i in range(0, len(indices), 3):
+        a, b, c = (representative[indices[i + k]] for k in range(3))
+        if a == b or b == c or a == c:
+            continue
+        tri = (a, b, c)
+        key = min(tri[k:] + tri[:k] for k in range(3))
+        if key in seen:
+            continue
+        seen.add(key)
+        result.extend(tri)
+    return result, error
+
+
+# each level halves the triangle count of the last by searching the grid resolution,
+# levels that barely reduce anything end the chain
+def build_lods(vertices, indices, aabb_min, aabb_max):
+    lods = [(indices, 0.0)]
+    quadrics = [[0.0] * 10 for _ in vertices]
+    for i in range(0, len(indices), 3):
+        corners = [indices[i + k] for k in range(3)]
+        q = plane_quadric(*(vertices[c] for c in corners))
+        if q is None:
+            continue
+        for c in corners:
+            quadric = quadrics[c]
+            for k in range(10):
+                quadric[k] += q[k]
+    extent = max(aabb_max[k] - aabb_min[k] for k in range(3))
+    if extent <= 0.0:
+        return lods
+    while len(lods) < MAX_LODS:
+        previous = len(lods[-1][0]) // 3
+        target = int(previous * LOD_TRIANGLE_RATIO)
+        if target < LOD_MIN_TRIANGLES:
+            break
+        low, high = 1, 1024
+        best = None
+        while low <= high:
+            resolution = (low + high) // 2
+            lod_indices, error = simplify_clustered(vertices, indices, quadrics, aabb_min, extent / resolution)
+            if len(lod_indices) // 3 <= target:
+                best = (lod_indices, error)
+                low = resolution + 1
+            else:
+                high = resolution - 1
+        if best is None or len(best[0]) // 3 > previous * 0.8 or len(best[0]) < 3:
+            break
+        lod_indices, error = best
+        lod_indices, cluster_starts = optimize_vertex_cache(lod_indices, len(vertices))
+        lod_indices = optimize_overdraw(vertices, lod_indices, cluster_starts)
+        lods.append((lod_indices, max(error, lods[-1][1])))
+    return lods
+
+
+def sign_not_zero(value):
+    return 1.0 if value >= 0.0 else -1.0
+
+
+def snorm16(value):
+    return int(round(max(-1.0, min(1.0, value)) * 32767.0))
+
+
+def octahedral_encode(v):
+    length = abs(v[0]) + abs(v[1]) + abs(v[2])
+    if length < 1e-12:
+        return 0, 0
+    x, y = v[0] / length, v[1] / length
+    if v[2] < 0.0:
+        x, y = (1.0 - abs(y)) * sign_not_zero(x), (1.0 - abs(x)) * sign_not_zero(y)
+    return snorm16(x), snorm16(y)
+
+
+def half(value):
+    return max(-65504.0, min(65504.0, value))
+
+
+# positions become unorm16 fractions of the bounding box, the tangent handedness rides in w
+def quantize_vertices(vertices, aabb_min, aabb_max):
+    extent = [aabb_max[k] - aabb_min[k] for k in range(3)]
+    inv_extent = [65535.0 / e if e > 0.0 else 0.0 for e in extent]
+    vertex = struct.Struct(VERTEX_FORMAT)
+    out = bytearray()
+    for v in vertices:
+        position = [min(65535, max(0, int(round((v[k] - aabb_min[k]) * inv_extent[k])))) for k in range(3)]
+        out += vertex.pack(*position, 65535 if v[11] >= 0.0 else 0,
+                           *octahedral_encode(v[3:6]), *octahedral_encode(v[8:11]),
+                           half(v[6]), half(v[7]))
+    return bytes(out)
+
+
+def cook_geometry(glb, mesh):
+    vertices = []  # 12 floats: pos(3), normal(3), uv(2), tangent(4)
+    indices = []
+    skinning = []  # 4 joint indices + 4 weights per vertex
+    skinned = False
+    for primitive in mesh['primitives']:
+        attributes = primitive['attributes']
+        if 'indices' not in primitive:
+            warn(f"Primitive in model {glb.name} has no indices. Skipping.")
+            continue
+        if 'POSITION' not in attributes:
+            warn(f"Primitive in model {glb.name} has no POSITION attribute. Skipping.")
+            continue
+        positions = glb.read_accessor(attributes['POSITION'])
+        first_vertex = len(vertices)
+        first_index = len(indices)
+        vertex_count = len(positions)
+        for p in positions:
+            vertices.append([p[0], p[1], p[2], 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0])
+        indices.extend(first_vertex + i for (i,) in glb.read_accessor(primitive['indices']))
+        if 'NORMAL' in attributes:
+            for vertex, n in zip(vertices[first_vertex:], glb.read_accessor(attributes['NORMAL'])):
+                vertex[3:6] = n[0:3]
+        if 'TEXCOORD_0' in attributes:
+            for vertex, uv in zip(vertices[first_vertex:], glb.read_accessor(attributes['TEXCOORD_0'])):
+                vertex[6:8] = uv[0:2]
+        if 'TANGENT' in attributes:
+            for vertex, t in zip(vertices[first_vertex:], glb.read_accessor(attributes['TANGENT'])):
+                vertex[8:12] = t[0:4]
+        else:
+            compute_tangents(vertices, first_vertex, vertex_count, indices, first_index)
+        skinning.extend([0.0] * (8 * vertex_count))
+        if 'JOINTS_0' in attributes and 'WEIGHTS_0' in attributes:
+            skinned = True
+            joints = glb.read_accessor(attributes['JOINTS_0'])
+            weights = glb.read_accessor(attributes['WEIGHTS_0'])
+            for i, (j, w) in enumerate(zip(joints, weights)):
+                base = (first_vertex + i) * 8
+                skinning[base:base + 8] = [float(c) for c in j[0:4]] + [float(c) for c in w[0:4]]
+    if not vertices or not indices:
+        raise RuntimeError(f"No valid geometry found in model: {glb.name}")
+    vertices, indices, skinning = optimize_mesh(vertices, indices, skinning if skinned else [])
+    if not indices:
+        raise RuntimeError(f"No valid geometry found in model: {glb.name}")
+    aabb_min = [min(v[k] for v in vertices) for k in range(3)]
+    aabb_max = [max(v[k] for v in vertices) for k in range(3)]
+    lods = build_lods(vertices, indices, aabb_min, aabb_max)
+    return vertices, lods, skinning, aabb_min, aabb_max
+
+
+# positions of every primitive, indexed or not, for physics colliders
+def collision_positions(glb, mesh):
+    positions = []
+    for primitive in mesh['primitives']:
+        attributes = primitive['attributes']
+        if 'POSITION' in attributes:
+            positions.extend(tuple(p[0:3]) for p in glb.read_accessor(attributes['POSITION']))
+    return positions
+
+
+# quickhull (barber, dobkin, huhdanpaa), returns outward wound triangles over points or
+# None when the points are flat
+def quickhull(points, eps):
+    def plane(a, b, c):
+        n = cross3(sub3(points[b], points[a]), sub3(points[c], points[a]))
+        length = math.sqrt(dot3(n, n))
+        if length < 1e-12:
+            return None, 0.0
+        n = (n[0] / length, n[1] / length, n[2] / length)
+        return n, dot3(n, points[a])
+
+    # starting tetrahedron from the widest pair and the points furthest from their line and plane
+    extremes = [max(range(len(points)), key=lambda i: points[i][k] * s) for k in range(3) for s in (1, -1)]
+    a, b = max(((i, j) for i in extremes for j in extremes),
+               key=lambda p: dot3(sub3(points[p[0]], points[p[1]]), sub3(points[p[0]], points[p[1]])))
+    ab = sub3(points[b], points[a])
+
+    def line_distance(i):
+        offset = cross3(ab, sub3(points[i], points[a]))
+        return dot3(offset, offset)
+
+    c = max(range(len(points)), key=line_distance)
+    n, d = plane(a, b, c)
+    if n is None:
+        return None
+    e = max(range(len(points)), key=lambda i: abs(dot3(n, points[i]) - d))
+    if abs(dot3(n, points[e]) - d) <= eps:
+        return None
+    if dot3(n, points[e]) - d > 0.0:
+        b, c = c, b
+
+    faces = {}
+    edge_face = {}
+    next_face = 0
+
+    # every outside point belongs to the first face it sees, the rest are inside the hull
+    def add_face(i, j, k, candidates):
+        nonlocal next_face
+        n, d = plane(i, j, k)
+        if n is None:
+            n, d = (0.0, 0.0, 0.0), 0.0
+        outside = []
+        unclaimed = []
+        for p in candidates:
+            distance = dot3(n, points[p]) - d
+            if distance > eps:
+                outside.append((distance, p))
+            else:
+                unclaimed.append(p)
+        faces[next_face] = ((i, j, k), n, d, outside)
+        for edge in ((i, j), (j, k), (k, i)):
+            edge_face[edge] = next_face
+        next_face += 1
+        return unclaimed
+
+    remaining = [i for i in range(len(points)) if i not in (a, b, c, e)]
+    for tri in ((a, b, c), (a, c, e), (a, e, b), (b, e, c)):
+        remaining = add_face(*tri, remaining)
+
+    while True:
+        face_id = next((f for f, face in faces.items() if face[3]), None)
+        if face_id is None:
+            break
+        _, apex = max(faces[face_id][3])
+
+        # grow the visible region across shared edges so its boundary is one closed loop
+        visible = {face_id}
+        stack = [face_id]
+        horizon = []
+        while stack:
+            i, j, k = faces[stack.pop()][0]
+            for u, v in ((i, j), (j, k), (k, i)):
+                neighbour = edge_face[(v, u)]
+                if neighbour in visible:
+                    continue
+                face = faces[neighbour]
+                # anything the apex is in front of goes, leaving near coplanar neighbours
+                # behind is what lets rounding fold the hull inwards
+                if dot3(face[1], points[apex]) - face[2] > 0.0:
+                    visible.add(neighbour)
+                    stack.append(neighbour)
+                else:
+                    horizon.append((u, v))
+        candidates = [p for f in visible for _, p in faces[f][3] if p != apex]
+        for f in visible:
+            del faces[f]
+        for i, j in horizon:
+            candidates = add_face(i, j, apex, candidates)
+    return [(face[0], face[1], face[2]) for face in faces.values()]
+
+
+# index of the axis in axes that is parallel to axis either way round, appending it if
+# there is none. sat only cares about the line, so opposite faces share one axis
+def add_axis(axes, axis):
+    for i, existing in enumerate(axes):
+        if abs(dot3(existing, axis)) > 0.999:
+            return i
+    axes.append(axis)
+    return len(axes) - 1
+
+
+# the convex hull of the collision mesh with its separating axis set: one axis per face
+# after coplanar triangles are merged, one per distinct edge direction between faces, and
+# the hull's own extent along each face axis so the narrowphase never projects it again
+def cook_hull(glb, mesh):
+    unique = {}
+    for p in collision_positions(glb, mesh):
+        unique.setdefault(tuple(round(c, 6) for c in p), p)
+    points = list(unique.values())
+    if not points:
+        raise RuntimeError(f"{glb.name}: mesh has no positions for a collision hull")
+    extent = max(max(p[k] for p in points) - min(p[k] for p in points) for k in range(3))
+    eps = max(extent, 1e-3) * 1e-5
+    triangles = quickhull(points, eps) if len(points) >= 4 else None
+    if triangles is None:
+        warn(f"{glb.name}: collision points are flat, falling back to cardinal axes")
+        triangles = []
+
+    # coplanar triangles collapse into one face, so their shared edges are not real edges
+    planes = []
+    triangle_plane = []
+    for _, n, d in triangles:
+        index = next((i for i, (pn, pd) in enumerate(planes)
+                      if dot3(pn, n) > 1.0 - 1e-5 and abs(pd - d) <= eps * 10.0), None)
+        if index is None:
+            index = len(planes)
+            planes.append((n, d))
+        triangle_plane.append(index)
+
+    edge_planes = {}
+    for (tri, _, _), index in zip(triangles, triangle_plane):
+        for i, j in ((tri[0], tri[1]), (tri[1], tri[2]), (tri[2], tri[0])):
+            edge_planes.setdefault((min(i, j), max(i, j)), set()).add(index)
+
+    used = sorted({i for tri, _, _ in triangles for i in tri}) or range(len(points))
+    hull = [points[i] for i in used]
+
+    face_axes = []
+    for n, _ in planes:
+        add_axis(face_axes, n)
+    # longest edge directions first, the narrowphase only crosses the first few of each shape
+    edge_axes = []
+    edge_lengths = []
+    for (i, j), adjacent in edge_planes.items():
+        edge = sub3(points[j], points[i])
+        direction = normalize(edge)
+        if len(adjacent) > 1 and direction:
+            index = add_axis(edge_axes, direction)
+            if index == len(edge_lengths):
+                edge_lengths.append(0.0)
+            edge_lengths[index] += math.sqrt(dot3(edge, edge))
+    edge_axes = [axis for _, axis in sorted(zip(edge_lengths, edge_axes), key=lambda e: -e[0])]
+    if not face_axes:
+        face_axes = [(1.0, 0.0, 0.0), (0.0, 1.0, 0.0), (0.0, 0.0, 1.0)]
+    if not edge_axes:
+        edge_axes = list(face_axes)
+
+    faces = []
+    for axis in face_axes:
+        projections = [dot3(axis, p) for p in hull]
+        faces.append((axis, min(projections), max(projections)))
+    return hull, faces, edge_axes
+
+
+def cook_skeleton(glb, strings):
+    skins = glb.json.get('skins', [])
+    if not skins:
+        return [], {}
+    nodes = glb.json.get('nodes', [])
+    skin = skins[0]
+    node_to_joint = {node: i for i, node in enumerate(skin['joints'])}
+    parents = {}
+    for parent, node in enumerate(nodes):
+        for child in node.get('children', []):
+            parents.setdefault(child, parent)
+    inverse_binds = []
+    if 'inverseBindMatrices' in skin:
+        inverse_binds = glb.read_accessor(skin['inverseBindMatrices'])
+    identity = (1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0)
+    joints = []
+    for i, node_index in enumerate(skin['joints']):
+        node = nodes[node_index]
+        if 'matrix' in node:
+            local = list(node['matrix'])
+            translation, rotation, scale = decompose_mat4(local)
+        else:
+            translation = tuple(node.get('translation', (0.0, 0.0, 0.0)))
+            rotation = tuple(node.get('rotation', (0.0, 0.0, 0.0, 1.0)))
+            scale = tuple(node.get('scale', (1.0, 1.0, 1.0)))
+            local = trs_to_mat4(translation, rotation, scale)
+        joints.append({
+            'parent': node_to_joint.get(parents.get(node_index, -1), -1),
+            'name': strings.add(node.get('name', '')),
+            'inverseBind': inverse_binds[i] if i < len(inverse_binds) else identity,
+            'local': local,
+            'translation': translation,
+            'rotation': rotation,
+            'scale': scale,
+        })
+    return joints, node_to_joint
+
+
+def cook_animations(glb, node_to_joint, strings, pool):
+    clips = []
+    samplers = []
+    channels = []
+    for anim in glb.json.get('animations', []):
+        first_sampler = len(samplers)
+        first_channel = len(channels)
+        sampler_remap = {}
+        duration = 0.0
+        for index, sampler in enumerate(anim.get('samplers', [])):
+            interpolation = sampler.get('interpolation', 'LINEAR')
+            if interpolation not in INTERPOLATIONS:
+                warn(f"Unsupported animation sampler interpolation in model {glb.name}")
+                continue
+            output_accessor = glb.json['accessors'][sampler['output']]
+            if output_accessor['type'] not in ('VEC3', 'VEC4'):
+                warn(f"Unsupported animation output accessor type in model {glb.name}")
+                continue
+            times = [t for (t,) in glb.read_accessor(sampler['input'])]
+            values = [tuple(v) + (0.0,) * (4 - len(v)) for v in glb.read_accessor(sampler['output'])]
+            if times:
+                duration = max(duration, max(times))
+            sampler_remap[index] = len(samplers) - first_sampler
+            samplers.append({
+                'interpolation': INTERPOLATIONS[interpolation],
+                'timeCount': len(times),
+                'valueCount': len(values),
+                'timesOffset': pool.add(times),
+                'valuesOffset': pool.add([c for v in values for c in v]),
+            })
+        for chan in anim.get('channels', []):
+            target = chan.get('target', {})
+            joint = node_to_joint.get(target.get('node', 0))
+            if joint is None or chan['sampler'] not in sampler_remap:
+                continue
+            path = target.get('path')
+            if path not in PATHS:
+                warn(f"Unsupported animation channel path in model {glb.name}")
+                continue
+            channels.append({'sampler': sampler_remap[chan['sampler']], 'joint': joint, 'path': PATHS[path]})
+        clips.append({
+            'name': strings.add(anim.get('name', '')),
+            'firstSampler': first_sampler,
+            'samplerCount': len(samplers) - first_sampler,
+            'firstChannel': first_channel,
+            'channelCount': len(channels) - first_channel,
+            'duration': duration,
+        })
+    return clips, samplers, channels
+
+
+class StringTable:
+    def __init__(self):
+        self.data = bytearray()
+
+    def add(self, text):
+        encoded = text.encode('utf-8')
+        offset = len(self.data)
+        self.data += encoded
+        return (offset, len(encoded))
+
+
+# times and values live in one float pool, every run starts on a 16 byte boundary
+class FloatPool:
+    def __init__(self):
+        self.values = []
+
+    def add(self, floats):
+        offset = len(self.values)
+        self.values.extend(floats)
+        self.values.extend([0.0] * (-len(self.values) % 4))
+        return offset
+
+
+class Writer:
+    def __init__(self):
+        self.data = bytearray(HEADER_SIZE)
+
+    def section(self, payload):
+        self.data += b'\0' * (-len(self.data) % 16)
+        offset = len(self.data)
+        self.data += payload
+        return offset
+
+
+def pack(fmt, items):
+    return b''.join(struct.pack(fmt, *item) for item in items)
+
+
+def cook(input_file, asset_name):
+    glb = Glb(input_file, asset_name)
+    meshes = glb.json.get('meshes', [])
+    if not meshes:
+        raise RuntimeError(f"Embedded model contains no meshes: {glb.name}")
+    mesh = meshes[0]
+    if not mesh.get('primitives'):
+        raise RuntimeError(f"Mesh contains no primitives: {glb.name}")
+
+    strings = StringTable()
+    pool = FloatPool()
+    vertices, lods, skinning, aabb_min, aabb_max = cook_geometry(glb, mesh)
+    indices = [i for lod_indices, _ in lods for i in lod_indices]
+    lod_table = []
+    for lod_indices, error in lods:
+        first_index = sum(count for _, count, _ in lod_table)
+        lod_table.append((first_index, len(lod_indices), error))
+    hull_vertices, hull_faces, hull_edges = cook_hull(glb, mesh)
+    joints, node_to_joint = cook_skeleton(glb, strings)
+    clips, samplers, channels = cook_animations(glb, node_to_joint, strings, pool)
+
+    writer = Writer()
+    index16 = len(vertices) <= 0x10000
+    vertex_offset = writer.section(quantize_vertices(vertices, aabb_min, aabb_max))
+    index_offset = writer.section(struct.pack(f"<{len(indices)}{'H' if index16 else 'I'}", *indices))
+    skinning_offset = writer.section(struct.pack(f'<{len(skinning)}f', *skinning)) if skinning else 0
+    joint_offset = writer.section(pack('<iII4x16f16f4f4f4f', (
+        (j['parent'], j['name'][0], j['name'][1], *j['inverseBind'], *j['local'],
+         *j['translation'], 0.0, *j['rotation'], *j['scale'], 0.0) for j in joints)))
+    clip_offset = writer.section(pack('<6If4x', (
+        (c['name'][0], c['name'][1], c['firstSampler'], c['samplerCount'], c['firstChannel'],
+         c['channelCount'], c['duration']) for c in clips)))
+    sampler_offset = writer.section(pack('<5I12x', (
+        (s['interpolation'], s['timeCount'], s['valueCount'], s['timesOffset'], s['valuesOffset'])
+        for s in samplers)))
+    channel_offset = writer.section(pack('<3I4x', (
+        (c['sampler'], c['joint'], c['path']) for c in channels)))
+    pool_offset = writer.section(struct.pack(f'<{len(pool.values)}f', *pool.values))
+    string_offset = writer.section(bytes(strings.data))
+    hull_vertex_offset = writer.section(pack('<3f', hull_vertices))
+    hull_face_offset = writer.section(pack('<5f12x', ((*axis, lo, hi) for axis, lo, hi in hull_faces)))
+    hull_edge_offset = writer.section(pack('<3f', hull_edges))
+    lod_offset = writer.section(pack('<2If4x', lod_table))
+    writer.data += b'\0' * (-len(writer.data) % 16)
+
+    header = struct.pack(
+        HEADER_FORMAT,
+        MAGIC, VERSION, (FLAG_SKINNED if skinning else 0) | (FLAG_INDEX16 if index16 else 0),
+        len(vertices), len(indices), len(joints), len(clips), len(samplers), len(channels),
+        len(hull_vertices), len(hull_faces), len(hull_edges), len(strings.data), len(pool.values),
+        *aabb_min, *aabb_max,
+        vertex_offset, index_offset, skinning_offset, joint_offset, clip_offset, sampler_offset,
+        channel_offset, pool_offset, string_offset, hull_vertex_offset, hull_face_offset, hull_edge_offset,
+        len(lod_table), lod_offset)
+    assert len(header) == HEADER_SIZE
+    writer.data[0:HEADER_SIZE] = header
+    return bytes(writer.data)
+
+
+def main():
+    if len(sys.argv) != 4:
+        print(f"Usage: {sys.argv[0]} INPUT_GLB OUTPUT_FILE ASSET_NAME", file=sys.stderr)
+        sys.exit(1)
+
+    input_file, output_file, asset_name = sys.argv[1:4]
+    try:
+        data = cook(input_file, asset_name)
+    except (RuntimeError, KeyError, IndexError, struct.error) as e:
+        print(f"Failed to cook {input_file}: {e}", file=sys.stderr)
+        sys.exit(1)
+
+    os.makedirs(os.path.dirname(os.path.abspath(output_file)), exist_ok=True)
+    with open(output_file, 'wb') as f:
+        f.write(data)
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+# Writes the asset pack read by engine::AssetPack (include/engine/AssetPack.h)
+#
+# usage: pack_assets.py OUTPUT MANIFEST
+# MANIFEST holds one "<category>\t<name>\t<path>" line per asset
+import os
+import struct
+import sys
+
+MAGIC = 0x4B415052  # "RPAK"
+VERSION = 1
+HEADER_FORMAT = '<4I4Q'
+ENTRY_FORMAT = '<3Q4I'
+BLOB_ALIGN = 16
+PAGE_SIZE = 4096
+# anything this large gets its own pages, smaller blobs share them
+PAGE_ALIGN_THRESHOLD = 16 * 1024
+
+
+def pack_hash(category, name):
+    h = 0xcbf29ce484222325
+    for b in f"{category}/{name}".encode('utf-8'):
+        h ^= b
+        h = (h * 0x100000001b3) & 0xFFFFFFFFFFFFFFFF
+    return h
+
+
+def align(value, alignment):
+    return (value + alignment - 1) & ~(alignment - 1)
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(f"Usage: {sys.argv[0]} OUTPUT MANIFEST", file=sys.stderr)
+        sys.exit(1)
+
+    output_file, manifest_file = sys.argv[1:3]
+
+    assets = []
+    with open(manifest_file, 'r', encoding='utf-8') as f:
+        for line in f:
+            line = line.rstrip('\n')
+            if not line:
+                continue
+            category, name, path = line.split('\t')
+            _, ext = os.path.splitext(path)
+            assets.append({
+                'category': category,
+                'name': name,
+                'path': path,
+                'ext': ext,
+                'size': os.path.getsize(path),
+                'hash': pack_hash(category, name),
+            })
+
+    seen = set()
+    for a in assets:
+        key = (a['category'], a['name'])
+        if key in seen:
+            print(f"Duplicate asset {a['category']}/{a['name']}", file=sys.stderr)
+            sys.exit(1)
+        seen.add(key)
+
+    strings = bytearray()
+    string_offsets = {}
+
+    def intern(s):
+        if s not in string_offsets:
+            string_offsets[s] = len(strings)
+            strings.extend(s.encode('utf-8') + b'\0')
+        return string_offsets[s]
+
+    toc = sorted(assets, key=lambda a: (a['hash'], a['category'], a['name']))
+    for a in toc:
+        a['category_offset'] = intern(a['category'])
+        a['name_offset'] = intern(a['name'])
+        a['ext_offset'] = intern(a['ext'])
+
+    header_size = struct.calcsize(HEADER_FORMAT)
+    toc_offset = align(header_size, 16)
+    string_offset = toc_offset + len(toc) * struct.calcsize(ENTRY_FORMAT)
+    cursor = align(string_offset + len(strings), BLOB_ALIGN)
+
+    # small blobs first so a category's worth of them sits in a few pages
+    layout = sorted(assets, key=lambda a: (a['size'] >= PAGE_ALIGN_THRESHOLD, a['category'], a['name']))
+    for a in layout:
+        if a['size'] >= PAGE_ALIGN_THRESHOLD:
+            cursor = align(cursor, PAGE_SIZE)
+        else:
+            cursor = align(cursor, BLOB_ALIGN)
+        a['offset'] = cursor
+        cursor += a['size']
+    file_size = cursor
+
+    tmp_file = output_file + '.tmp'
+    with open(tmp_file, 'wb') as out:
+        out.write(struct.pack(HEADER_FORMAT, MAGIC, VERSION, len(toc), len(strings),
+                              toc_offset, string_offset, file_size, 0))
+        out.write(b'\0' * (toc_offset - header_size))
+        for a in toc:
+            out.write(struct.pack(ENTRY_FORMAT, a['hash'], a['offset'], a['size'],
+                                  a['category_offset'], a['name_offset'], a['ext_offset'], 0))
+        out.write(strings)
+        for a in layout:
+            out.write(b'\0' * (a['offset'] - out.tell()))
+            with open(a['path'], 'rb') as f:
+                out.write(f.read())
+    os.replace(tmp_file, output_file)
+
+
+if __name__ == '__main__':
+    main()
@@ -110,6 +110,12 @@ if(PLATFORM STREQUAL "macos")
        PERMISSIONS OWNER_READ OWNER_WRITE OWNER_EXECUTE
                    GROUP_READ GROUP_EXECUTE WORLD_READ WORLD_EXECUTE)
 
+  # Asset packs are mapped from next to the executable
+  file(GLOB _PAKS "${BIN_DIR}/*.pak")
+  foreach(_pak IN LISTS _PAKS)
+    file(COPY "${_pak}" DESTINATION "${MACOS_DIR}")
+  endforeach()
+
   # Bundled dylibs and Vulkan ICD
   if(EXISTS "${BIN_DIR}/lib")
     file(COPY "${BIN_DIR}/lib" DESTINATION "${MACOS_DIR}")
@@ -182,6 +188,11 @@ elseif(PLATFORM STREQUAL "linux")
        PERMISSIONS OWNER_READ OWNER_WRITE OWNER_EXECUTE
                    GROUP_READ GROUP_EXECUTE WORLD_READ WORLD_EXECUTE)
 
+  file(GLOB _PAKS "${BIN_DIR}/*.pak")
+  foreach(_pak IN LISTS _PAKS)
+    file(COPY "${_pak}" DESTINATION "${APPDIR}/usr/bin")
+  endforeach()
+
   if(EXISTS "${BIN_DIR}/lib")
     file(GLOB _SO_FILES "${BIN_DIR}/lib/*.so*")
     foreach(_f IN LISTS _SO_FILES)
@@ -248,7 +259,7 @@ elseif(PLATFORM STREQUAL "windows")
 
   file(COPY "${BIN_DIR}/${APP_NAME}.exe" DESTINATION "${DIST_DIR}")
 
-  file(GLOB _DLLS "${BIN_DIR}/*.dll")
+  file(GLOB _DLLS "${BIN_DIR}/*.dll" "${BIN_DIR}/*.pak")
   foreach(_dll IN LISTS _DLLS)
     file(COPY "${_dll}" DESTINATION "${DIST_DIR}")
   endforeach()
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <engine/EmbeddedAssets.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// on-disk layout written by cmake/pack_assets.py: header, table of contents sorted by
+// hash, string table, then the blobs. small blobs are packed together up front, large
+// ones start on their own page so touching one asset never faults in its neighbours
+namespace engine::cooked {
+    constexpr uint32_t kPackMagic = 0x4B415052u; // "RPAK"
+    constexpr uint32_t kPackVersion = 1u;
+
+    struct PackHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t stringBytes;
+        uint64_t tocOffset;
+        uint64_t stringOffset;
+        uint64_t fileSize;
+        uint64_t reserved;
+    };
+    static_assert(sizeof(PackHeader) == 48);
+
+    // string offsets index the string table, every string is null terminated
+    struct PackEntry {
+        uint64_t hash; // fnv-1a of "<category>/<name>"
+        uint64_t dataOffset;
+        uint64_t dataSize;
+        uint32_t categoryOffset;
+        uint32_t nameOffset;
+        uint32_t extOffset;
+        uint32_t pad;
+    };
+    static_assert(sizeof(PackEntry) == 40);
+
+    constexpr uint64_t packHash(std::string_view category, std::string_view name) {
+        uint64_t h = 0xcbf29ce484222325ull;
+        auto mix = [&h](char c) {
+            h ^= static_cast<uint8_t>(c);
+            h *= 0x100000001b3ull;
+        };
+        for (char c : category) mix(c);
+        mix('/');
+        for (char c : name) mix(c);
+        return h;
+    }
+}
+
+namespace engine {
+    // read-only mapping of one asset pack, kept alive for the whole process so the
+    // EmbeddedAsset views handed to the managers stay valid
+    class AssetPack {
+    public:
+        // maps <executable dir>/<name>.pak on first use, throws if it is missing or malformed
+        static const AssetPack& open(const std::string& name);
+
+        const EmbeddedAsset* find(std::string_view category, std::string_view name) const;
+        std::unordered_map<std::string, EmbeddedAsset> category(std::string_view category) const;
+
+        ~AssetPack();
+        AssetPack(const AssetPack&) = delete;
+        AssetPack& operator=(const AssetPack&) = delete;
+
+    private:
+        explicit AssetPack(const std::string& path);
+        void readTableOfContents(const std::string& path);
+        void unmap();
+
+        struct Entry {
+            uint64_t hash;
+            std::string_view category;
+            std::string_view name;
+            EmbeddedAsset asset;
+        };
+
+        const unsigned char* mapped = nullptr;
+        size_t mappedSize = 0;
+#if defined(_WIN32)
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#endif
+        std::vector<Entry> entries;
+    };
+}
@@ -148,12 +148,15 @@ namespace engine {
         const std::vector<float>& getWorldVertsZ() const { return worldVertsZ; }
         static constexpr size_t kSoAPad = 8;
         glm::vec3 getWorldCenter() const { return worldCenter; }
-        void setVertsFromModel(std::vector<glm::vec3>&& vertices, std::vector<uint32_t>&& indices, const glm::mat4& transform = glm::mat4(1.0f));
-        void setVertsFromModel(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& indices, const glm::mat4& transform);
+        void setHull(Model::ConvexHull&& hull);
+        void setHull(const Model::ConvexHull& hull);
+        // takes the model's hull once it is resident, collides with nothing until then
+        void setHull(const Model* model);
 
     private:
-        std::vector<glm::vec3> localVerts;
-        std::vector<glm::ivec3> localTris;
+        const Model* hullModel = nullptr;
+        Model::ConvexHull localHull;
+        glm::vec3 localCenter{0.0f};
         std::vector<glm::vec3> worldVerts;
         std::vector<float> worldVertsX;
         std::vector<float> worldVertsY;
@@ -166,6 +169,6 @@ namespace engine {
         uint32_t lastTransformGeneration = 0;
         bool isCached = false;
         void ensureCached();
-        void buildConvexData(const std::vector<glm::vec3>& verts, const std::vector<glm::ivec3>& tris, const glm::mat4& transform, std::vector<glm::vec3>& outVerts, std::vector<glm::vec3>& outEdgeAxes, std::vector<glm::vec3>& outFaceAxes, glm::vec3& outCenter);
+        void transformAxes(const glm::mat4& transform);
     };
 };
\ No newline at end of file
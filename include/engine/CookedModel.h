@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// on-disk layout written by cmake/cook_model.py, every section starts on a 16 byte boundary
+namespace engine::cooked {
+    constexpr uint32_t kModelMagic = 0x4C444D52u; // "RMDL"
+    constexpr uint32_t kModelVersion = 4u;
+    constexpr uint32_t kModelSkinned = 1u << 0;
+    constexpr uint32_t kModelIndex16 = 1u << 1; // indices are uint16_t
+    constexpr size_t kFloatsPerSkinnedVertex = 8; // 4 joint indices + 4 weights
+    constexpr uint32_t kMaxModelLods = 4u;
+
+    // position is a unorm16 fraction of the model's aabb with the tangent handedness in w
+    // (1 = +1, 0 = -1), normal and tangent are octahedral snorm16 pairs, uv is half2
+    struct Vertex {
+        uint16_t position[4];
+        int16_t normalTangent[4];
+        uint16_t texCoord[2];
+    };
+    static_assert(sizeof(Vertex) == 20);
+
+    struct ModelHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t flags;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t jointCount;
+        uint32_t clipCount;
+        uint32_t samplerCount;
+        uint32_t channelCount;
+        uint32_t hullVertexCount;
+        uint32_t hullFaceCount;
+        uint32_t hullEdgeCount;
+        uint32_t stringBytes;
+        uint32_t floatPoolCount;
+        float aabbMin[3];
+        float aabbMax[3];
+        uint32_t vertexOffset;
+        uint32_t indexOffset;
+        uint32_t skinningOffset;
+        uint32_t jointOffset;
+        uint32_t clipOffset;
+        uint32_t samplerOffset;
+        uint32_t channelOffset;
+        uint32_t floatPoolOffset;
+        uint32_t stringOffset;
+        uint32_t hullVertexOffset; // float3 per vertex
+        uint32_t hullFaceOffset;
+        uint32_t hullEdgeOffset; // float3 per distinct edge direction, longest first
+        uint32_t lodCount;
+        uint32_t lodOffset;
+        uint32_t reserved[2];
+    };
+    static_assert(sizeof(ModelHeader) == 144);
+
+    // every level indexes the same vertex buffer, level 0 is the full mesh
+    struct Lod {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        float error; // furthest a vertex moved from its full detail position, in model units
+        uint32_t pad;
+    };
+    static_assert(sizeof(Lod) == 16);
+
+    // one separating axis of the collision hull, coplanar faces are merged and opposite
+    // faces share an axis. projMin/projMax are the hull vertices' extent along it
+    struct HullFace {
+        float normal[3];
+        float projMin;
+        float projMax;
+        uint32_t pad[3];
+    };
+    static_assert(sizeof(HullFace) == 32);
+
+    struct Joint {
+        int32_t parentIndex;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t pad;
+        float inverseBindMatrix[16];
+        float localTransform[16];
+        float translation[4];
+        float rotation[4]; // x, y, z, w
+        float scale[4];
+    };
+    static_assert(sizeof(Joint) == 192);
+
+    struct Clip {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t firstSampler;
+        uint32_t samplerCount;
+        uint32_t firstChannel;
+        uint32_t channelCount;
+        float duration;
+        uint32_t pad;
+    };
+    static_assert(sizeof(Clip) == 32);
+
+    // times and values index the float pool, values are 4 floats per key
+    struct Sampler {
+        uint32_t interpolation;
+        uint32_t timeCount;
+        uint32_t valueCount;
+        uint32_t timesOffset;
+        uint32_t valuesOffset;
+        uint32_t pad[3];
+    };
+    static_assert(sizeof(Sampler) == 32);
+
+    struct Channel {
+        uint32_t samplerIndex; // relative to the clip's first sampler
+        uint32_t targetJoint;
+        uint32_t path;
+        uint32_t pad;
+    };
+    static_assert(sizeof(Channel) == 16);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+// KTX2 subset written by src/tools/texture_cooker.cpp: 2D, one layer, one face,
+// every mip level stored on its own. bc levels are raw and 16 byte aligned so they
+// upload straight from the pack, rgba levels are zlib supercompressed per level
+namespace engine::cooked {
+    constexpr uint8_t kKtx2Identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+    constexpr uint32_t kKtx2SupercompressionNone = 0u;
+    constexpr uint32_t kKtx2SupercompressionZlib = 3u;
+
+    // VkFormat values, the cooker builds without the Vulkan headers
+    enum class TextureFormat : uint32_t {
+        RGBA8_UNORM = 37,
+        RGBA8_SRGB = 43,
+        RGBA16_SFLOAT = 97,
+        BC4_UNORM = 139,
+        BC5_UNORM = 141,
+        BC7_SRGB = 146
+    };
+
+    struct Ktx2Header {
+        uint8_t identifier[12];
+        uint32_t vkFormat;
+        uint32_t typeSize;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;
+        uint32_t layerCount;
+        uint32_t faceCount;
+        uint32_t levelCount;
+        uint32_t supercompressionScheme;
+        uint32_t dfdByteOffset;
+        uint32_t dfdByteLength;
+        uint32_t kvdByteOffset;
+        uint32_t kvdByteLength;
+        uint64_t sgdByteOffset;
+        uint64_t sgdByteLength;
+    };
+    static_assert(sizeof(Ktx2Header) == 80);
+
+    // follows the header, one entry per level starting at the full size image
+    struct Ktx2Level {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+    static_assert(sizeof(Ktx2Level) == 24);
+}
@@ -8,4 +8,10 @@ namespace engine {
         size_t size;
         const char* ext;
     };
+
+    enum class AssetState {
+        Missing,
+        Pending,
+        Resident
+    };
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <engine/ModelManager.h>
+#include <engine/PushConstants.h>
 #include <engine/SpatialGrid.h>
 #include <vulkan/vulkan.h>
 #include <string>
@@ -18,6 +19,15 @@ namespace engine {
     struct GraphicsShader;
     class Camera;
     class Collider;
+    struct Texture;
+
+    inline constexpr uint32_t kInvalidMaterialId = UINT32_MAX;
+
+    // every cull buffer holds the gbuffer's early and late sets first, then the shadow casters of every light.
+    // shadow cull inputs start at kMaxGBufferInstances, their batches, instances and commands at kGBufferDrawSlots
+    inline constexpr uint32_t kGBufferDrawSlots = 2u * kMaxGBufferInstances * cooked::kMaxModelLods;
+    inline constexpr uint32_t kShadowDrawSlots = kMaxShadowCasterInstances * cooked::kMaxModelLods;
+
     class Entity {
     public:
         enum class EntityType {
@@ -60,6 +70,7 @@ namespace engine {
         void removeChild(Entity* child);
 
         void setModel(Model* model);
+        // null until the model is resident, so colliders, casters and probes skip the entity meanwhile
         Model* getModel() const;
 
         const EntityType& getType() const { return type; }
@@ -82,8 +93,12 @@ namespace engine {
         void setTextures(const std::vector<std::string>& textures);
         const std::vector<VkDescriptorSet>& getDescriptorSets() const { return descriptorSets; }
         void setDescriptorSets(const std::vector<VkDescriptorSet>& sets) { descriptorSets = sets; }
-        const std::vector<VkDescriptorSet>& getShadowDescriptorSets() const { return shadowDescriptorSets; }
-        void setShadowDescriptorSets(const std::vector<VkDescriptorSet>& sets) { shadowDescriptorSets = sets; }
+        // index into the bindless material table, assigned by EntityManager::loadTextures
+        uint32_t getMaterialId() const { return materialId; }
+        void setMaterialId(uint32_t id) { materialId = id; }
+        bool hasMaterial() const { return materialId != kInvalidMaterialId; }
+        uint32_t getJointPaletteOffset() const { return jointPaletteOffset; }
+        void setJointPaletteOffset(uint32_t offset) { jointPaletteOffset = offset; }
 
         std::vector<VkBuffer>& getUniformBuffers() { return uniformBuffers; }
         std::vector<VkDeviceMemory>& getUniformBuffersMemory() { return uniformBuffersMemory; }
@@ -109,7 +124,7 @@ namespace engine {
         void playAnimation(const std::string& animationName, bool loop = true, float speed = 1.0f);
         void updateAnimation(float deltaTime);
         const std::vector<glm::mat4>& getJointMatrices() const { return jointMatrices; }
-        bool isAnimated() const { return model && model->hasAnimations() && !animState.currentAnimation.empty(); }
+        bool isAnimated() const { return getModel() && model->hasAnimations() && !animState.currentAnimation.empty(); }
         AnimationState& getAnimationState() { return animState; }
         bool isVisible() const { return visible; }
         void setVisible(bool visible) { this->visible = visible; }
@@ -126,11 +141,12 @@ namespace engine {
         bool isMovable;
 
         std::vector<VkDescriptorSet> descriptorSets;
-        std::vector<VkDescriptorSet> shadowDescriptorSets;
         std::vector<VkBuffer> uniformBuffers;
         std::vector<VkDeviceMemory> uniformBuffersMemory;
         std::vector<void*> uniformBuffersMapped;
         size_t uniformBufferStride = 0;
+        uint32_t materialId = kInvalidMaterialId;
+        uint32_t jointPaletteOffset = UINT32_MAX;
 
         EntityManager* entityManager;
 
@@ -184,6 +200,11 @@ namespace engine {
         void clear();
 
         void loadTextures();
+        // swaps placeholder materials for streamed textures that became resident
+        void refreshStreamedMaterials();
+        // picks up entities whose models finished streaming
+        void refreshStreamedModels();
+        void trackStreamingModel(const std::string& name) { streamingModelEntities.push_back(name); }
 
         std::vector<Entity*>& getRootEntities() { return rootEntities; }
         std::vector<Entity*>& getMovableEntities() { return movableEntities; }
@@ -223,15 +244,52 @@ namespace engine {
         SpatialGrid& getSpatialGrid() { return spatialGrid; }
         void rebuildSpatialGrid();
         void updateDynamicColliders();
-        void markTexturesDirty() { textureLoadDirty = true; }
+        void markTexturesDirty() { textureLoadDirty = true; renderProxiesDirty = true; }
+        void markRenderProxiesDirty() { renderProxiesDirty = true; }
         VkBuffer getDummySkinningBuffer() const { return dummySkinningBuffer; }
+        void ensureInstanceBuffers() {
+            if (instanceBuffers.empty()) {
+                createInstanceBuffers();
+            }
+        }
+        VkBuffer getInstanceBuffer(uint32_t frame) const { return frame < instanceBuffers.size() ? instanceBuffers[frame] : VK_NULL_HANDLE; }
+        VkBuffer getJointPaletteBuffer(uint32_t frame) const { return frame < jointPaletteBuffers.size() ? jointPaletteBuffers[frame] : VK_NULL_HANDLE; }
+        VkBuffer getCullInputBuffer(uint32_t frame) const { return frame < cullInputBuffers.size() ? cullInputBuffers[frame] : VK_NULL_HANDLE; }
+        VkBuffer getDrawBatchBuffer(uint32_t frame) const { return frame < drawBatchBuffers.size() ? drawBatchBuffers[frame] : VK_NULL_HANDLE; }
+        VkBuffer getDrawCommandBuffer(uint32_t frame) const { return frame < drawCommandBuffers.size() ? drawCommandBuffers[frame] : VK_NULL_HANDLE; }
+        VkBuffer getDrawCountBuffer(uint32_t frame) const { return frame < drawCountBuffers.size() ? drawCountBuffers[frame] : VK_NULL_HANDLE; }
+        VkBuffer getOccludedInstanceBuffer(uint32_t frame) const { return frame < occludedInstanceBuffers.size() ? occludedInstanceBuffers[frame] : VK_NULL_HANDLE; }
+        // host view of a frame's cull buffers, LightManager fills the shadow caster region through it
+        struct MappedCullBuffers {
+            GBufferCullInput* cullInputs = nullptr;
+            GBufferInstance* instances = nullptr;
+            GBufferDrawBatch* batches = nullptr;
+            GBufferDrawCommand* commands = nullptr;
+            uint32_t* drawCounts = nullptr;
+        };
+        MappedCullBuffers getMappedCullBuffers(uint32_t frame) const;
+        const std::vector<VkDescriptorSet>& getMaterialDescriptorSets() const { return materialDescriptorSets; }
+        void ensureDepthPyramid();
+        void destroyDepthPyramid();
+        VkImageView getDepthPyramidView() const { return depthPyramidView; }
 
         Renderer* getRenderer() const { return renderer; }
 
         void updateAll(float deltaTime);
+        void uploadJointMatrices(uint32_t currentFrame);
+        void prepareDepthPyramid();
+        void buildDepthPyramid(VkCommandBuffer commandBuffer, uint32_t currentFrame);
+        // fills proxies, batches and cull inputs on the main thread, call before recording
+        void prepareCull(uint32_t currentFrame);
+        void cullEntities(VkCommandBuffer commandBuffer, uint32_t currentFrame);
         void renderEntities(VkCommandBuffer commandBuffer, uint32_t currentFrame, bool DEBUG_RENDER_LOGS = false);
+        // builds the pyramid from the early draws, then re-tests and draws what last frame's pyramid rejected
+        void renderDisoccludedEntities(VkCommandBuffer commandBuffer, uint32_t currentFrame);
 
-        bool hasRenderable3D();
+        // recomputes the cached answer if the entity set changed, call before recording
+        void refreshRenderable3DCache();
+        // read only, safe from the recording workers
+        bool hasRenderable3D() const { return renderable3DCache; }
 
         void markForDeletion(Entity* entity) {
             pendingDeletions.push_back(entity);
@@ -265,5 +323,94 @@ namespace engine {
         VkDeviceMemory dummySkinningBufferMemory = VK_NULL_HANDLE;
         void createDummySkinningBuffer();
         void destroyDummySkinningBuffer();
+
+        // per-frame instance data and joint palette read by the gbuffer vertex shader
+        std::vector<VkBuffer> instanceBuffers;
+        std::vector<VkDeviceMemory> instanceBuffersMemory;
+        std::vector<void*> instanceBuffersMapped;
+        std::vector<VkBuffer> jointPaletteBuffers;
+        std::vector<VkDeviceMemory> jointPaletteBuffersMemory;
+        std::vector<void*> jointPaletteBuffersMapped;
+        // per-frame cull inputs and indirect draw batches filled by prepareCull
+        std::vector<VkBuffer> cullInputBuffers;
+        std::vector<VkDeviceMemory> cullInputBuffersMemory;
+        std::vector<void*> cullInputBuffersMapped;
+        std::vector<VkBuffer> drawBatchBuffers;
+        std::vector<VkDeviceMemory> drawBatchBuffersMemory;
+        std::vector<void*> drawBatchBuffersMapped;
+        // per-frame compacted commands and their per-model counts, written by the cull pass
+        std::vector<VkBuffer> drawCommandBuffers;
+        std::vector<VkDeviceMemory> drawCommandBuffersMemory;
+        std::vector<void*> drawCommandBuffersMapped;
+        std::vector<VkBuffer> drawCountBuffers;
+        std::vector<VkDeviceMemory> drawCountBuffersMemory;
+        std::vector<void*> drawCountBuffersMapped;
+        // per-frame list of instances the early cull rejected by occlusion, [0] holds the count
+        std::vector<VkBuffer> occludedInstanceBuffers;
+        std::vector<VkDeviceMemory> occludedInstanceBuffersMemory;
+        std::vector<void*> occludedInstanceBuffersMapped;
+        // one mesh, its lod batches are firstBatch .. firstBatch + batchCount
+        struct ModelDraw {
+            Model* model;
+            uint32_t firstBatch;
+            uint32_t batchCount;
+        };
+        std::vector<ModelDraw> modelDraws; // written by prepareCull, consumed by renderEntities
+        void recordModelDraws(VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t batchOffset, bool DEBUG_RENDER_LOGS);
+        // one proxy per drawable entity, sorted by mesh then material and rebuilt only when the entity set changes
+        struct RenderProxy {
+            Entity* entity;
+            Model* model;
+            uint32_t materialId;
+            uint32_t transformGeneration; // world bounds are refreshed when the entity's generation moves past this
+            bool skinned;
+        };
+        std::vector<RenderProxy> renderProxies;
+        // world AABBs of renderProxies in SoA, read directly by the frustum kernel
+        std::vector<float> proxyMinX, proxyMinY, proxyMinZ;
+        std::vector<float> proxyMaxX, proxyMaxY, proxyMaxZ;
+        bool renderProxiesDirty = true;
+        void rebuildRenderProxies();
+        void updateRenderProxyBounds(bool all);
+        void createInstanceBuffers();
+        void destroyInstanceBuffers();
+
+        // bindless material table shared by every gbuffer entity, one descriptor set per frame
+        VkBuffer materialBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory materialBufferMemory = VK_NULL_HANDLE;
+        void* materialBufferMapped = nullptr;
+        VkSampler materialSampler = VK_NULL_HANDLE;
+        std::vector<VkDescriptorSet> materialDescriptorSets;
+        std::unordered_map<std::string, uint32_t> materialIds;
+        std::unordered_map<Texture*, uint32_t> bindlessTextureSlots;
+        // gbuffer entities still drawing with default textures while theirs stream in
+        std::vector<std::string> streamingMaterialEntities;
+        // entities whose model handle was still pending when it was set
+        std::vector<std::string> streamingModelEntities;
+        void createMaterialTable();
+        void destroyMaterialTable();
+        uint32_t registerMaterial(const std::vector<Texture*>& textures);
+        uint32_t registerBindlessTexture(Texture* texture);
+
+        // farthest-depth pyramid of the early gbuffer draws, every mip stays in GENERAL
+        VkImage depthPyramidImage = VK_NULL_HANDLE;
+        VkDeviceMemory depthPyramidMemory = VK_NULL_HANDLE;
+        VkImageView depthPyramidView = VK_NULL_HANDLE;
+        std::vector<VkImageView> depthPyramidMipViews;
+        std::vector<VkDescriptorSet> depthPyramidSets; // set i reduces mip i - 1 (or gbuffer depth) into mip i
+        VkExtent2D depthPyramidSourceExtent = { 0, 0 };
+        bool depthPyramidInitialized = false;
+        // occlusion state is handed from the frame that built the pyramid to the next frame's cull
+        bool depthPyramidPending = false;
+        Camera* depthPyramidCamera = nullptr;
+        glm::mat4 depthPyramidViewProj{1.0f};
+        bool occlusionCullEnabled = false;
+        glm::mat4 occlusionViewProj{1.0f};
+        // cull dispatches decided by prepareCull, the late re-test reuses the early state when the GPU path rejected by occlusion
+        bool earlyCullPending = false;
+        GBufferCullPC earlyCullPC{};
+        bool lateCullPending = false;
+        GBufferCullPC lateCullPC{};
+        bool instanceLimitWarned = false; // the overflow warning prints once, not every frame
     };
 };
@@ -2,6 +2,8 @@
 
 #include <engine/ModelManager.h>
 #include <engine/PushConstants.h>
+#include <engine/ShadowCasterGrid.h>
+#include <engine/SIMD.h>
 #include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
 #include <array>
@@ -12,6 +14,8 @@
 namespace engine {
     class Renderer;
     class LightManager;
+    class Camera;
+    class Entity;
 
     // stable handle for lights
     using LightHandle = uint64_t;
@@ -19,6 +23,29 @@ namespace engine {
 
     inline constexpr float kMovableShadowCastRange = 20.0f;
 
+    // shadow atlas tiers hold full, half and quarter resolution cubes, ranked by light importance
+    inline constexpr uint32_t kShadowAtlasTierCount = 3;
+    inline constexpr std::array<uint32_t, kShadowAtlasTierCount> kShadowAtlasTierSlots = { 2u, 4u, 10u };
+    inline constexpr uint32_t kInvalidShadowSlot = 0xFFFFFFFF;
+    inline constexpr uint32_t kShadowFaceUpdateBudget = 24; // cube faces re-rendered per frame over all lights
+    inline constexpr uint32_t kShadowTierRankInterval = 30; // frames between importance re-ranking
+    inline constexpr uint32_t kShadowRebakeBudget = 2; // lights whose static casters are re-baked per frame
+    static_assert(kShadowAtlasTierSlots[0] + kShadowAtlasTierSlots[1] + kShadowAtlasTierSlots[2] == kMaxPointLights);
+
+    // shadow caster region of a frame's cull buffers, filled light by light in prepareShadows
+    struct ShadowCullTarget {
+        GBufferCullInput* cullInputs = nullptr;
+        GBufferInstance* instances = nullptr;
+        GBufferDrawBatch* batches = nullptr;
+        GBufferDrawCommand* commands = nullptr;
+        uint32_t* drawCounts = nullptr;
+        uint32_t inputCount = 0; // caster entries written so far, relative to the region
+        uint32_t batchCount = 0;
+        bool hostCull = false; // no cull pipeline, faces and lods are resolved on the host and commands written directly
+        bool forceAllFaces = false; // debug baseline, casters draw to every face being rendered
+        bool overflowed = false;
+    };
+
     class Light {
     public:
         Light(
@@ -31,12 +58,6 @@ namespace engine {
             float radius
         );
 
-        struct ShadowResources {
-            std::vector<VkImage> images;
-            std::vector<VkDeviceMemory> memories;
-            std::vector<VkImageView> views;
-        };
-
         LightHandle getHandle() const { return handle; }
 
         glm::vec3 getColor() const { return color; }
@@ -55,30 +76,48 @@ namespace engine {
 
         bool shadowMapReady() const { return hasShadowMap; }
         uint32_t getShadowMapSize() const { return shadowMapSize; }
+        uint32_t getShadowSlot() const { return shadowSlot; }
         LightManager* getLightManager() const { return lightManager; }
         glm::vec3 getWorldPosition() const { return glm::vec3(transform[3]); }
 
         PointLight getPointLightData();
-        VkImageView getShadowImageView(size_t frameIndex = 0) const {
-            if (shadowDepthImageViews.empty()) {
-                return VK_NULL_HANDLE;
-            }
-            const size_t idx = frameIndex % shadowDepthImageViews.size();
-            return shadowDepthImageViews[idx];
-        }
+        VkImageView getShadowImageView(size_t frameIndex = 0) const;
         void fillShadowLightEntry(ShadowLightEntry& entry) const;
 
-        void createShadowMaps(engine::Renderer* renderer, bool forceRecreate = false);
-        void bakeShadowMap(engine::Renderer* renderer, VkCommandBuffer commandBuffer);
+        void attachShadowSlot(uint32_t slot, uint32_t size);
+        void detachShadowSlot();
+        float computeShadowImportance(const Camera* camera) const;
+        float getShadowImportance() const { return shadowImportance; }
+        void setShadowImportance(float importance) { shadowImportance = importance; }
+        uint8_t computeFaceMask(const engine::AABB& worldBounds, float rangeLimit = -1.0f) const;
+        void markFacesDirty(uint8_t faceMask);
+        uint8_t getStaleFaces(uint32_t frameIdx) const;
+        bool isShadowFrameValid(uint32_t frameIdx) const;
+        void scheduleShadowUpdate(uint32_t frameIdx, uint8_t faceMask, bool frameWasReady, bool bakedWasReady);
+        uint32_t getShadowStaleFrames() const { return staleFrames; }
+        void skipShadowUpdate() { ++staleFrames; }
+
+        void gatherShadowCasters(const ShadowCasterGrid& staticGrid, const ShadowCasterGrid& movingGrid, ShadowCullTarget& target);
+        void bakeShadowMap(engine::Renderer* renderer, VkCommandBuffer commandBuffer, uint32_t currentFrame);
         void renderShadowMap(engine::Renderer* renderer, VkCommandBuffer commandBuffer, uint32_t currentFrame);
         bool isBaked() const { return shadowBaked; }
-
-        ShadowResources takeShadowResources();
-        static void freeShadowResources(VkDevice device, ShadowResources& resources);
-        void destroyShadowResources(VkDevice device);
+        void invalidateBake();
+        void requestRebake(uint8_t faceMask) { rebakeFaces |= faceMask; }
+        uint8_t getPendingRebake() const { return rebakeFaces; }
+        void beginRebake();
 
     private:
+        // one caster mesh of a shadow pass, its lod batches are firstBatch .. firstBatch + batchCount
+        struct CasterDraw {
+            Model* model;
+            uint32_t firstBatch;
+            uint32_t batchCount;
+        };
+
         void updateShadowMatrices();
+        void appendCasterPass(const ShadowCasterGrid& grid, std::vector<Entity*>& casters, uint8_t allowedFaces, std::vector<CasterDraw>& draws, ShadowCullTarget& target) const;
+        void drawShadowCasters(engine::Renderer* renderer, VkCommandBuffer commandBuffer, const std::vector<CasterDraw>& draws, uint32_t currentFrame);
+        void computeCasterFaces(const ShadowCasterGrid& grid, std::vector<Entity*>& casters, std::vector<uint8_t>& casterFaces, uint8_t allowedFaces) const;
 
         glm::vec3 color;
         float intensity;
@@ -89,48 +128,37 @@ namespace engine {
         glm::mat4 transform;
 
         glm::mat4 viewProjs[6];
-        glm::vec3 getWorldAABBCenter(const engine::AABB& aabb, const glm::mat4& worldTransform) const {
-            const glm::vec3 localCenter = (aabb.min + aabb.max) * 0.5f;
-            return glm::vec3(worldTransform * glm::vec4(localCenter, 1.0f));
-        }
-        float getWorldAABBBoundingRadius(const engine::AABB& aabb, const glm::mat4& worldTransform) const {
-            const glm::vec3 localExtents = (aabb.max - aabb.min) * 0.5f;
-            glm::mat3 basis = glm::mat3(worldTransform);
-            basis[0] = glm::abs(basis[0]);
-            basis[1] = glm::abs(basis[1]);
-            basis[2] = glm::abs(basis[2]);
-            const glm::vec3 worldExtents = basis * localExtents;
-            return glm::length(worldExtents);
-        }
-        bool intersectsShadowRange(const engine::AABB& aabb, const glm::mat4& worldTransform, float rangeLimit = -1.0f) const {
-            const glm::vec3 center = getWorldAABBCenter(aabb, worldTransform);
-            const float boundsRadius = getWorldAABBBoundingRadius(aabb, worldTransform);
-            const float distanceToLight = glm::length(center - getWorldPosition());
-            const float cullRangeScale = 1.02f;
-            const float range = (rangeLimit >= 0.0f && rangeLimit < radius) ? rangeLimit : radius;
-            return (distanceToLight - boundsRadius) <= (range * cullRangeScale);
-        }
+        std::array<simd::Plane, 24> faceSidePlanes{}; // four inward side planes per cube face
         LightHandle handle = kInvalidLightHandle; // stable id
         uint32_t lightIdx = 0xFFFFFFFF; // upload-slot index, reassigned by reorderLights
 
-        // dynamic shadow map, sent to shader
-        std::vector<VkImage> shadowDepthImages;
-        std::vector<VkDeviceMemory> shadowDepthMemories;
-        std::vector<VkImageView> shadowDepthImageViews;
-        std::vector<std::array<VkImageView, 6>> shadowDepthFaceViews;
-        std::vector<VkImageView> shadowDepthArrayViews;
-
-        // baked shadow map, static
-        VkImage bakedShadowImage = VK_NULL_HANDLE;
-        VkDeviceMemory bakedShadowMemory = VK_NULL_HANDLE;
-        VkImageView bakedShadowImageView = VK_NULL_HANDLE;
-        VkImageView bakedShadowFaceViews[6] = { VK_NULL_HANDLE };
-        VkImageView bakedShadowArrayView = VK_NULL_HANDLE;
-        
+        // cube slot in the shared shadow atlas, baked static casters live in the matching baked slot
+        uint32_t shadowSlot = kInvalidShadowSlot;
+        float shadowImportance = 0.0f;
         bool hasShadowMap = false;
-        std::vector<uint8_t> shadowImageReady;
         bool shadowBaked = false;
-        bool bakedImageReady = false;
+        uint8_t rebakeFaces = 0; // faces a new static caster touches, re-baked when the budget allows
+
+        // a face is stale in a frame image when its generation moved past the rendered one
+        std::array<uint32_t, 6> faceGenerations{};
+        std::vector<std::array<uint32_t, 6>> renderedGenerations;
+        std::vector<uint8_t> frameValid; // frame image holds this light's content at all
+        uint32_t staleFrames = 0;
+
+        // decided on the main thread in prepareShadows, recorded by renderShadowMap
+        struct ShadowUpdate {
+            uint8_t faceMask = 0;
+            bool bake = false;
+            bool frameWasReady = false;
+            bool bakedWasReady = false;
+        };
+        ShadowUpdate pendingUpdate;
+        // caster candidates for pendingUpdate, static ones only when baking. the cull pass picks their faces and lods,
+        // the draws are one indirect count call per mesh
+        std::vector<Entity*> staticCasters;
+        std::vector<Entity*> movingCasters;
+        std::vector<CasterDraw> staticDraws;
+        std::vector<CasterDraw> movingDraws;
 
         LightManager* lightManager;
     };
@@ -145,35 +173,73 @@ namespace engine {
         void unregisterLight(LightHandle handle);
         Light* getLight(LightHandle handle);
         std::vector<std::unique_ptr<Light>>& getLights() { return lights; }
-        void processDeferredDestroys();
         void createLightsUBO();
         void updateLightsUBO(uint32_t frameIndex);
         void createShadowLightsBuffers();
         void updateShadowLightsBuffer(uint32_t frameIndex);
+        void createLightClusterBuffers();
+        void updateLightClusters(uint32_t frameIndex);
         void createAllShadowMaps();
+        void prepareShadows(uint32_t currentFrame);
         void renderShadows(VkCommandBuffer commandBuffer, uint32_t currentFrame);
         std::vector<VkBuffer>& getLightsBuffers() { return lightsBuffers; }
         std::vector<VkBuffer>& getShadowLightsBuffers() { return shadowLightsBuffers; }
+        std::vector<VkBuffer>& getLightClusterBuffers() { return lightClusterBuffers; }
+        const std::vector<VkDescriptorSet>& getShadowDescriptorSets() const { return shadowDescriptorSets; }
+        // debug baseline for the shadow statistics, skips the per-caster face test
+        void setForceAllShadowFaces(bool enabled) { forceAllShadowFaces = enabled; }
+        bool getForceAllShadowFaces() const { return forceAllShadowFaces; }
+        // wraps one multiview shadow pass, called inside its rendering scope
+        void beginShadowStatsQuery(VkCommandBuffer commandBuffer, uint32_t lightIdx, uint32_t viewMask);
+        void endShadowStatsQuery(VkCommandBuffer commandBuffer);
 
         void markLightsDirty();
+        void invalidateStaticCaster(Entity* entity);
+        void markStaticCastersDirty() { staticCastersDirty = true; }
+
+        // shared shadow atlas, slots are indexed globally across tiers
+        struct ShadowAtlasSlot {
+            uint32_t tier = 0;
+            uint32_t baseLayer = 0; // first of six cube layers in the tier images
+            std::vector<VkImageView> cubeViews; // per frame in flight, sampled by shadowimage
+            std::vector<VkImageView> arrayViews; // per frame in flight, multiview render target
+            VkImageView bakedArrayView = VK_NULL_HANDLE;
+            std::vector<uint8_t> frameReady; // frame image layers are in SHADER_READ_ONLY_OPTIMAL
+            bool bakedReady = false; // baked layers are in TRANSFER_SRC_OPTIMAL
+            Light* owner = nullptr;
+        };
+        struct ShadowAtlasTier {
+            uint32_t size = 0;
+            std::vector<VkImage> images;
+            std::vector<VkDeviceMemory> memories;
+            VkImage bakedImage = VK_NULL_HANDLE;
+            VkDeviceMemory bakedMemory = VK_NULL_HANDLE;
+        };
+        ShadowAtlasSlot* getShadowSlot(uint32_t slot) { return slot < shadowSlots.size() ? &shadowSlots[slot] : nullptr; }
+        const ShadowAtlasSlot* getShadowSlot(uint32_t slot) const { return slot < shadowSlots.size() ? &shadowSlots[slot] : nullptr; }
+        const ShadowAtlasTier& getShadowTier(uint32_t tier) const { return shadowTiers[tier]; }
 
         Renderer* getRenderer() const { return renderer; }
 
     private:
         void reorderLights();
-        void scheduleShadowResourceDestroy(Light::ShadowResources&& resources);
-        void flushDeferredDestroys();
-
-        struct DeferredShadowDestroy {
-            Light::ShadowResources resources;
-            uint32_t framesRemaining;
-        };
+        void createShadowAtlas();
+        void destroyShadowAtlas();
+        bool assignShadowSlot(Light* light, uint32_t preferredTier);
+        void releaseShadowSlot(Light* light);
+        void rankShadowTiers();
+        void rebuildStaticCasterGrid();
+        void markMovingCasterFaces();
+        void startPendingRebakes();
+        void scheduleShadowUpdates(uint32_t currentFrame);
+        void readShadowStatistics(uint32_t currentFrame);
+        void ensureShadowDescriptorSets();
+        void cullShadowCasters(VkCommandBuffer commandBuffer, uint32_t currentFrame);
 
         Renderer* renderer;
         std::vector<std::unique_ptr<Light>> lights;
         std::unordered_map<LightHandle, Light*> lightLookup;
         LightHandle nextHandle = kInvalidLightHandle + 1;
-        std::vector<DeferredShadowDestroy> deferredDestroys;
         std::vector<VkBuffer> lightsBuffers;
         std::vector<VkDeviceMemory> lightsBuffersMemory;
         std::vector<void*> lightBuffersMapped;
@@ -182,5 +248,49 @@ namespace engine {
         std::vector<VkBuffer> shadowLightsBuffers;
         std::vector<VkDeviceMemory> shadowLightsMemories;
         std::vector<void*> shadowLightsMapped;
+        std::vector<VkBuffer> lightClusterBuffers;
+        std::vector<VkDeviceMemory> lightClusterMemories;
+        std::vector<void*> lightClusterMapped;
+
+        std::array<ShadowAtlasTier, kShadowAtlasTierCount> shadowTiers;
+        std::vector<ShadowAtlasSlot> shadowSlots;
+        uint32_t framesSinceTierRank = kShadowTierRankInterval;
+
+        // last world bounds of every moving caster, so faces it leaves are refreshed too
+        struct CasterBounds {
+            engine::AABB bounds;
+            uint64_t lastSeen = 0;
+        };
+        std::unordered_map<const Entity*, CasterBounds> movingCasterBounds;
+        uint64_t casterFrame = 0;
+
+        // shadow casters bucketed by world bounds, the static grid is rebuilt only when the static set changes
+        ShadowCasterGrid staticCasterGrid;
+        ShadowCasterGrid movingCasterGrid;
+        bool staticCastersDirty = true;
+
+        // joint palette, shadow lights and caster instances, one set per frame shared by every light
+        std::vector<VkDescriptorSet> shadowDescriptorSets;
+        // caster entries and batches prepareShadows wrote this frame, culled on the GPU unless shadowCullOnGPU is off
+        uint32_t shadowCullInputCount = 0;
+        uint32_t shadowCullBatchCount = 0;
+        bool shadowCullOnGPU = false;
+        bool shadowCasterLimitWarned = false; // the overflow warning prints once, not every frame
+
+        bool forceAllShadowFaces = false;
+
+        // primitive counts per light and face, only while a profiler is registered. a multiview pass takes one
+        // query per view, how the driver spreads the counts over them is implementation dependent
+        struct ShadowStatsPass {
+            uint32_t lightIdx = 0;
+            uint32_t viewMask = 0;
+            uint32_t firstQuery = 0; // relative to the frame's range
+        };
+        static constexpr uint32_t kShadowStatsQueriesPerFrame = kMaxLights * 12u; // bake and update pass per light
+        VkQueryPool shadowStatsPool = VK_NULL_HANDLE;
+        std::vector<std::vector<ShadowStatsPass>> shadowStatsPasses; // per frame in flight, written while recording
+        uint32_t shadowStatsFrame = 0; // frame renderShadows is recording
+        uint32_t shadowStatsQueryCount = 0; // queries that frame has used
+        bool shadowStatsQueryOpen = false;
     };
-}
\ No newline at end of file
+}
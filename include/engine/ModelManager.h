@@ -1,15 +1,23 @@
 #pragma once
 #include <engine/EmbeddedAssets.h>
+#include <engine/CookedModel.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <vulkan/vulkan.h>
+#include <algorithm>
+#include <atomic>
 #include <cfloat>
+#include <exception>
+#include <mutex>
 #include <vector>
+#include <span>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 
 namespace engine {
     class Renderer;
+    struct BufferUpload;
     struct AABB {
         glm::vec3 min = glm::vec3(FLT_MAX);
         glm::vec3 max = glm::vec3(-FLT_MAX);
@@ -26,8 +34,9 @@ namespace engine {
             glm::vec3 localScale{1.0f};
         };
         struct AnimationSampler {
-            std::vector<float> inputTimes;
-            std::vector<glm::vec4> outputValues; // vec3 for translation/scale, vec4 for rotation
+            // views into the cooked blob, or into ownedTimes/ownedValues for a raw glb
+            std::span<const float> inputTimes;
+            std::span<const glm::vec4> outputValues; // vec3 for translation/scale, vec4 for rotation
             enum class Interpolation {
                 LINEAR,
                 STEP,
@@ -49,14 +58,45 @@ namespace engine {
             std::vector<AnimationSampler> samplers;
             std::vector<AnimationChannel> channels;
         };
+        // a range of the shared index buffer, level 0 is the full mesh
+        struct Lod {
+            uint32_t firstIndex = 0;
+            uint32_t indexCount = 0;
+            float error = 0.0f; // furthest a vertex moved from its full detail position, in model units
+        };
+        // collision hull in model space with the axes a separating axis test needs, opposite
+        // faces share an axis and faceExtents holds the vertices' min, max along each one
+        struct ConvexHull {
+            std::vector<glm::vec3> vertices;
+            std::vector<glm::vec3> faceAxes;
+            std::vector<glm::vec2> faceExtents;
+            std::vector<glm::vec3> edgeAxes; // longest first
+        };
         Model(const std::string& name, const unsigned char* embeddedData, size_t embeddedSize, Renderer* renderer);
         ~Model();
-        void loadFromMemory();
-        std::pair<std::vector<glm::vec3>, std::vector<uint32_t>> loadVertsForModel();
+        // cpu side only, safe to run on a worker thread
+        void parse();
+        // creates the device buffers and queues their contents for one batched copy
+        void createBuffers(std::vector<BufferUpload>& uploads);
+        void releaseStagingData();
+        // the handle exists from startup, everything below needs the model to be resident first
+        AssetState getState() const { return state; }
+        bool isResident() const { return state == AssetState::Resident; }
+        void setState(AssetState state) { this->state = state; }
+        ConvexHull loadConvexHull() const;
         std::pair<VkBuffer, VkDeviceMemory> getVertexBuffer() const { return {vertexBuffer, vertexBufferMemory}; }
         std::pair<VkBuffer, VkDeviceMemory> getIndexBuffer() const { return {indexBuffer, indexBufferMemory}; }
         std::pair<VkBuffer, VkDeviceMemory> getSkinningBuffer() const { return {skinningBuffer, skinningBufferMemory}; }
         uint32_t getIndexCount() const { return indexCount; }
+        uint32_t getLodCount() const { return static_cast<uint32_t>(lods.size()); }
+        const Lod& getLod(uint32_t level) const { return lods[std::min<size_t>(level, lods.size() - 1)]; }
+        // coarsest level whose error stays under focalPixels' tolerance when seen from viewPos,
+        // focalPixels is the view's focal length in pixels divided by the error it accepts
+        uint32_t selectLod(const glm::mat4& world, const glm::vec3& viewPos, float focalPixels) const;
+        VkIndexType getIndexType() const { return indexType; }
+        // vertex positions are quantized, model space = offset + stored * scale
+        glm::vec4 getPositionOffset() const { return glm::vec4(positionOffset, 0.0f); }
+        glm::vec4 getPositionScale() const { return glm::vec4(positionScale, 0.0f); }
         AABB& getAABB() { return aabb; }
         bool hasSkinning() const { return skinningBuffer != VK_NULL_HANDLE; }
         bool hasAnimations() const { return !animationsMap.empty(); }
@@ -67,18 +107,36 @@ namespace engine {
             return it != animationsMap.end() ? &it->second : nullptr;
         }
     private:
+        void parseCooked(const cooked::ModelHeader& header);
+        void parseGltf();
+
         std::string name;
         const unsigned char* embeddedData = nullptr;
         size_t embeddedSize = 0;
         Renderer* renderer;
+        AssetState state = AssetState::Pending;
         VkBuffer vertexBuffer = VK_NULL_HANDLE;
         VkDeviceMemory vertexBufferMemory = VK_NULL_HANDLE;
         VkBuffer indexBuffer = VK_NULL_HANDLE;
         VkDeviceMemory indexBufferMemory = VK_NULL_HANDLE;
         uint32_t indexCount = 0;
+        std::vector<Lod> lods;
+        VkIndexType indexType = VK_INDEX_TYPE_UINT32;
         AABB aabb; // min, max
+        glm::vec3 positionOffset{0.0f};
+        glm::vec3 positionScale{1.0f};
         std::unordered_map<std::string, AnimationClip> animationsMap;
         std::vector<Joint> skeleton;
+        std::vector<std::vector<float>> ownedTimes;
+        std::vector<std::vector<glm::vec4>> ownedValues;
+        // geometry waiting for upload, points into the blob or the staged vectors
+        std::span<const cooked::Vertex> vertexData;
+        std::span<const std::byte> indexData;
+        std::span<const float> skinningData;
+        std::vector<cooked::Vertex> stagedVertices;
+        std::vector<uint16_t> stagedIndices16;
+        std::vector<uint32_t> stagedIndices;
+        std::vector<float> stagedSkinning;
         VkBuffer skinningBuffer = VK_NULL_HANDLE;
         VkDeviceMemory skinningBufferMemory = VK_NULL_HANDLE;
     };
@@ -89,16 +147,44 @@ namespace engine {
 
         void registerEmbeddedModels(const std::unordered_map<std::string, EmbeddedAsset>& assets);
 
+        // creates a pending handle per model, nothing is parsed until it is requested
         void init();
 
+        // returns the handle right away and starts streaming it, null only for unknown names
         Model* getModel(const std::string& name) {
             auto it = models.find(name);
-            if (it != models.end()) return it->second;
-            return nullptr;
+            if (it == models.end()) return nullptr;
+            requestModel(it->second);
+            return it->second;
         }
+
+        // queues a background parse the first time a model is asked for
+        AssetState requestModel(const std::string& name);
+        void preloadModels(const std::vector<std::string>& names);
+        // blocks until every named model is resident or known to be missing
+        void waitForModels(const std::vector<std::string>& names);
+        // submits up to maxUploads finished parses without waiting, true if any model
+        // became resident since the last call
+        bool processStreamedModels(size_t maxUploads);
+
     private:
+        AssetState requestModel(Model* model);
+        bool submitStreamedModels(size_t maxUploads);
+
+        struct ParsedModel {
+            Model* model;
+            std::exception_ptr error;
+        };
+
         Renderer* renderer;
         std::unordered_map<std::string, Model*> models;
         std::unordered_map<std::string, EmbeddedAsset> embeddedAssets;
+
+        std::unordered_set<const Model*> requestedModels;
+        std::mutex streamedMutex;
+        std::vector<ParsedModel> streamedModels;
+        std::atomic<size_t> streamingInFlight{0};
+        std::atomic<bool> cancelStreaming{false};
+        bool streamedModelsResident = false;
     };
 };
\ No newline at end of file
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <engine/Collider.h>
+#include <engine/PushConstants.h>
 #include <engine/SpatialGrid.h>
 #include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
+#include <array>
 #include <cstdint>
 #include <random>
 #include <vector>
@@ -31,6 +33,12 @@ namespace engine {
         const std::vector<VkDescriptorSet>& getDescriptorSets() const { return descriptorSets; }
         const std::vector<VkBuffer>& getParticleBuffers() const { return particleBuffers; }
         uint32_t getParticleCount() const { return static_cast<uint32_t>(particles.count()); }
+        bool hasParticles() const;
+
+        // GPU mode spawns, integrates, collides and compacts particles in compute, the CPU only queues emits
+        void setGPUSimulation(bool enabled);
+        bool isGPUSimulation() const { return gpuSimulation; }
+        void simulateGPU(VkCommandBuffer commandBuffer, uint32_t currentFrame);
 
         void updateAll(float deltaTime);
         void renderParticles(VkCommandBuffer commandBuffer, uint32_t currentFrame);
@@ -38,6 +46,14 @@ namespace engine {
     private:
         static constexpr float kGravity = 9.81f;
 
+        // budgets keep the per-frame cost bounded no matter how many bursts land at once
+        static constexpr uint32_t kSpawnBudgetPerFrame = 4000;
+        static constexpr size_t kCollisionBudgetPerFrame = 4096;
+        static constexpr float kFullDetailDistance = 15.0f; // bursts closer than this spawn every particle
+        static constexpr float kMinSpawnScale = 0.2f;
+        static constexpr float kOffscreenSpawnScale = 0.25f;
+        static constexpr float kFarTierDistance = 40.0f; // beyond this particles skip collision and step every other frame
+
         struct ParticleSoA {
             std::vector<float> posX, posY, posZ;
             std::vector<float> velX, velY, velZ;
@@ -57,13 +73,27 @@ namespace engine {
             size_t push(const glm::vec3& pos, const glm::vec3& col, const glm::vec3& vel,
                         float life, float typ, float sz);
             void truncateFront(size_t n);
-            void compactDead();
+            // stable mode keeps spawn order, otherwise few dead particles are filled from the back
+            void compactDead(bool preserveOrder = true);
+
+            std::array<std::vector<float>*, 19> floatArrays() {
+                return { &posX, &posY, &posZ, &velX, &velY, &velZ,
+                         &prevPosX, &prevPosY, &prevPosZ,
+                         &prevPrevPosX, &prevPrevPosY, &prevPrevPosZ,
+                         &age, &lifetime, &type, &size, &colorR, &colorG, &colorB };
+            }
         };
 
-        void collideOne(size_t i, float deltaTime);
+        float spawnScale(const glm::vec3& position, float reach) const;
+        void assignSimulationTiers();
+        void collideParticles(float deltaTime);
+        void resolveCollision(size_t i, const engine::SpatialGrid::Candidates& candidates, float deltaTime);
         Collider::Collision checkCollision(const glm::vec3& position);
         Collider::Collision narrowPhaseCollision(const glm::vec3& position, const engine::SpatialGrid::Candidates& candidates);
         ParticleGPU makeGPU(size_t i) const;
+        void createGPUResources();
+        void writeGPUDescriptorSets();
+        void bindDrawSource(uint32_t currentFrame, int32_t source);
         glm::vec3 positionAt(size_t i) const {
             return glm::vec3(particles.posX[i], particles.posY[i], particles.posZ[i]);
         }
@@ -79,6 +109,41 @@ namespace engine {
         std::vector<void*> particleBuffersMapped;
         std::vector<VkDescriptorSet> descriptorSets;
 
+        // two pools of kMaxGPUParticles records followed by their velocities, simulated back and forth
+        bool gpuSimulation = false;
+        std::array<VkBuffer, 2> gpuPools{};
+        std::array<VkDeviceMemory, 2> gpuPoolMemory{};
+        VkBuffer gpuCounters = VK_NULL_HANDLE;
+        VkDeviceMemory gpuCountersMemory = VK_NULL_HANDLE;
+        std::vector<VkBuffer> gpuEmitBuffers;
+        std::vector<VkDeviceMemory> gpuEmitMemory;
+        std::vector<void*> gpuEmitMapped;
+        std::vector<VkDescriptorSet> gpuSimSets; // frame * 2 + source pool
+        std::vector<int32_t> drawSources; // what each frame's draw set reads, -1 = host buffer, else GPU pool
+
+        // latched per frame in updateParticleBuffer so recording never touches the main thread's state
+        struct GPUFrame {
+            uint32_t srcPool = 0;
+            uint32_t emitCount = 0;
+            float deltaTime = 0.0f;
+            bool resetCounters = false;
+            bool live = false;
+        };
+        std::vector<GPUFrame> gpuFrames;
+        std::vector<GPUParticleEmit> pendingEmits;
+        uint32_t gpuSrcPool = 0;
+        float gpuDeltaTime = 0.0f;
+        bool gpuCountersDirty = true;
+        // the CPU never reads the live count back, so emptiness is bounded by the longest lifetime emitted
+        double gpuTime = 0.0;
+        double gpuLiveUntil = 0.0;
+
+        // per-particle dt multiplier and camera distance, rebuilt every update
+        std::vector<float> stepScale;
+        std::vector<float> cameraDistanceSq;
+        uint32_t spawnedThisFrame = 0;
+        uint32_t simFrame = 0;
+
         uint32_t visibleCount = 0;
         uint32_t maxParticles = 5000;
         uint32_t hardCap = 100000;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <filesystem>
 #include <functional>
 #include <vector>
 
@@ -10,6 +11,9 @@ namespace Platform {
 
      void initialize();
 
+     // directory holding the running executable, empty if it cannot be resolved
+     std::filesystem::path executableDir();
+
      int runWithCrashReport(const std::function<void()>& body, const char* logName = "Rind.log");
 
      bool hasHdrDisplay(const std::vector<VkSurfaceFormatKHR>& surfaceFormats);
@@ -10,7 +10,7 @@ enum class Zone : uint8_t {
     // root
     Cleanup, Throttle, WaitFences, Acquire, BuildGraph, Update, Record, Submit, Present,
     // children
-    Cleanup_Deletions, Cleanup_Additions, Cleanup_ShadowMaps, Cleanup_Irradiance,
+    Cleanup_Deletions, Cleanup_Additions, Cleanup_Streaming, Cleanup_ShadowMaps, Cleanup_Irradiance,
     Update_Entities, Update_Audio, Update_Particles, Update_Volumetrics,
     Update_ParticlesBuffer, Update_VolumetricsBuffer, Update_Audio_Listener,
     Update_Entities_SpatialGrid, Update_Entities_DynamicColliders, Update_Entities_Update, Update_Entities_Animations, Update_Entities_LoadTextures,
@@ -18,6 +18,17 @@ enum class Zone : uint8_t {
     Count
 };
 
+// also update kCounterNames
+enum class Counter : uint8_t {
+    ShadowInputPrimitives, ShadowClippingInvocations, ShadowClippingPrimitives,
+    ShadowFace0Primitives, ShadowFace1Primitives, ShadowFace2Primitives,
+    ShadowFace3Primitives, ShadowFace4Primitives, ShadowFace5Primitives,
+    Count
+};
+
+// one counter track per light index, matches kMaxLights
+inline constexpr uint32_t kMaxLightCounters = 64u;
+
 };
 };
 
@@ -44,13 +55,20 @@ namespace profiler {
     // parent-child relationship defined by underscore prefixes
     inline constexpr std::array<std::string_view, static_cast<size_t>(Zone::Count)> kZoneNames = {
         "Cleanup", "Throttle", "WaitFences", "Acquire", "BuildGraph", "Update", "Record", "Submit", "Present",
-        "Cleanup_Deletions", "Cleanup_Additions", "Cleanup_ShadowMaps", "Cleanup_Irradiance",
+        "Cleanup_Deletions", "Cleanup_Additions", "Cleanup_Streaming", "Cleanup_ShadowMaps", "Cleanup_Irradiance",
         "Update_Entities", "Update_Audio", "Update_Particles", "Update_Volumetrics",
         "Update_ParticlesBuffer", "Update_VolumetricsBuffer", "Update_Audio_Listener",
         "Update_Entities_SpatialGrid", "Update_Entities_DynamicColliders", "Update_Entities_Update", "Update_Entities_Animations", "Update_Entities_LoadTextures",
         "Update_Particles_Integrate", "Update_Particles_Collision", "Update_Particles_Compact"
     };
 
+    // gpu values reported once per frame, shown as counter tracks
+    inline constexpr std::array<std::string_view, static_cast<size_t>(Counter::Count)> kCounterNames = {
+        "Shadow Input Primitives", "Shadow Clipping Invocations", "Shadow Clipping Primitives",
+        "Shadow Face +X Primitives", "Shadow Face -X Primitives", "Shadow Face +Y Primitives",
+        "Shadow Face -Y Primitives", "Shadow Face +Z Primitives", "Shadow Face -Z Primitives"
+    };
+
     struct Span {
         uint32_t startNs = 0;
         uint32_t endNs = 0;
@@ -60,6 +78,10 @@ namespace profiler {
         uint64_t startNs = 0;
         uint32_t endNs = 0;
         std::array<Span, size_t(Zone::Count)> zones{};
+        std::array<uint64_t, size_t(Counter::Count)> counters{};
+        uint32_t counterMask = 0;
+        std::array<uint64_t, kMaxLightCounters> lightCounters{};
+        uint64_t lightCounterMask = 0;
     };
 
     namespace Clock {
@@ -120,6 +142,13 @@ namespace profiler {
                     pid, tid, cat, ts, dur, static_cast<int>(name.size()), name.data()
                 ));
             };
+            auto counter = [&](std::string_view name, int pid, double ts, uint64_t value) {
+                char buf[256];
+                out.append(buf, std::snprintf(buf, sizeof(buf),
+                    "{\"ph\":\"C\",\"pid\":%d,\"ts\":%.3f,\"name\":\"%.*s\",\"args\":{\"value\":%llu}},\n",
+                    pid, ts, static_cast<int>(name.size()), name.data(), static_cast<unsigned long long>(value)
+                ));
+            };
             meta("process_name", processId, 1, "Rind");
             meta("thread_name", processId, threadId, "CPU Main");
 
@@ -137,6 +166,16 @@ namespace profiler {
                     if (span.endNs == 0) continue;
                     slice(kZoneNames[z], processId, threadId, "cpu", us(frameStartNs + span.startNs), us(span.endNs));
                 }
+                for (size_t c = 0; c < static_cast<size_t>(Counter::Count); ++c) {
+                    if ((frame.counterMask & (1u << c)) == 0) continue;
+                    counter(kCounterNames[c], processId, us(frameStartNs), frame.counters[c]);
+                }
+                for (uint32_t light = 0; light < kMaxLightCounters; ++light) {
+                    if ((frame.lightCounterMask & (1ull << light)) == 0) continue;
+                    char cname[48];
+                    std::snprintf(cname, sizeof(cname), "Shadow Light %u Primitives", light);
+                    counter(cname, processId, us(frameStartNs), frame.lightCounters[light]);
+                }
             }
             if (out.ends_with(",\n")) { // trim comma
                 out.resize(out.size() - 2);
@@ -163,6 +202,8 @@ namespace profiler {
             ring[currentFrameIndex].startNs = Clock::Now();
             ring[currentFrameIndex].endNs = 0;
             ring[currentFrameIndex].zones.fill(Span{0, 0});
+            ring[currentFrameIndex].counterMask = 0;
+            ring[currentFrameIndex].lightCounterMask = 0;
         }
 
         void endFrame() {
@@ -185,6 +226,20 @@ namespace profiler {
             frame.zones[size_t(Z)].endNs = static_cast<uint32_t>(now - startNs - frame.startNs);
         }
 
+        // main thread only, gpu counters arrive frames late so they land on the frame that read them back
+        void setCounter(Counter c, uint64_t value) {
+            auto& frame = ring[currentFrameIndex];
+            frame.counters[size_t(c)] = value;
+            frame.counterMask |= 1u << size_t(c);
+        }
+
+        void setLightCounter(uint32_t light, uint64_t value) {
+            if (light >= kMaxLightCounters) return;
+            auto& frame = ring[currentFrameIndex];
+            frame.lightCounters[light] = value;
+            frame.lightCounterMask |= 1ull << light;
+        }
+
     private:
         std::array<FrameZones, kMaxFrames> ring{};
         size_t currentFrameIndex = 0;
@@ -264,6 +319,8 @@ namespace profiler {
     public:
         Profiler(Renderer* renderer) {}
         ~Profiler() {}
+        void setCounter(Counter c, uint64_t value) {}
+        void setLightCounter(uint32_t light, uint64_t value) {}
     };
 };
 };
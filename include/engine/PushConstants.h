@@ -1,16 +1,89 @@
 #pragma once
 #include <glm/glm.hpp>
+#include <cstddef>
 #include <cstdint>
 
 namespace engine {
     inline constexpr uint32_t kMaxIrradianceProbes = 64u;
-    inline constexpr uint32_t kMaxPointLights = 16u;
+    inline constexpr uint32_t kMaxPointLights = 16u; // shadow casting lights
+    inline constexpr uint32_t kMaxLights = 64u;
+    inline constexpr uint32_t kMaxGBufferInstances = 4096u;
+    inline constexpr uint32_t kMaxShadowCasterInstances = 8192u; // caster entries over every light's passes in a frame
+    inline constexpr uint32_t kMaxJointPaletteMatrices = 16384u;
+    inline constexpr uint32_t kMaxBindlessTextures = 1024u;
+    inline constexpr uint32_t kMaxGBufferMaterials = 1024u;
+    inline constexpr uint32_t kMaxDepthPyramidMips = 16u;
+    inline constexpr uint32_t kMaxGPUParticles = 262144u;
+    inline constexpr uint32_t kMaxGPUParticleEmits = 1024u;
 
     struct GBufferPC {
-        alignas(16) glm::mat4 model;
         alignas(16) glm::mat4 view;
         alignas(16) glm::mat4 projection;
-        alignas(16) glm::vec4 camPos; // w = bit 0, has skinning
+        alignas(16) glm::vec4 camPos;
+        alignas(16) glm::vec4 positionOffset; // dequantizes the bound model's positions
+        alignas(16) glm::vec4 positionScale;
+    };
+
+    // bindless texture slots of one material
+    struct GBufferMaterial {
+        alignas(4) uint32_t albedo;
+        alignas(4) uint32_t metallic;
+        alignas(4) uint32_t roughness;
+        alignas(4) uint32_t normal;
+    };
+
+    // shadow casters use the same layout with z = cube faces the caster overlaps, w = light index
+    struct GBufferInstance {
+        alignas(16) glm::mat4 model;
+        alignas(16) glm::uvec4 params; // x = joint palette offset, y = bit 0 has skinning, z = material index
+    };
+
+    // shadow casters keep bit 0 of y, set bit 2 to skip the face test, and put the faces being rendered in bits 8-13 and the light index in bits 16+
+    struct GBufferCullInput {
+        alignas(16) glm::mat4 model;
+        alignas(16) glm::uvec4 params; // x = joint palette offset, y = bit 0 has skinning, bit 1 skip culling, bits 16+ material index, z = first batch of the model, w = lod count
+        alignas(16) glm::vec4 boundsMin; // world space AABB
+        alignas(16) glm::vec4 boundsMax;
+    };
+
+    // first five fields match VkDrawIndexedIndirectCommand
+    struct GBufferDrawBatch {
+        alignas(4) uint32_t indexCount;
+        alignas(4) uint32_t instanceCount;
+        alignas(4) uint32_t firstIndex;
+        alignas(4) int32_t vertexOffset;
+        alignas(4) uint32_t firstInstance; // start of this batch's instance range
+        alignas(4) uint32_t drawFirst; // first batch of the model, indexes its compacted commands and draw count
+        alignas(4) float lodError; // of the level this batch draws, in model units
+        alignas(4) uint32_t pad{0};
+    };
+
+    // non-empty batches compacted to the front of their model, drawn with vkCmdDrawIndexedIndirectCount
+    struct GBufferDrawCommand {
+        alignas(4) uint32_t indexCount;
+        alignas(4) uint32_t instanceCount;
+        alignas(4) uint32_t firstIndex;
+        alignas(4) int32_t vertexOffset;
+        alignas(4) uint32_t firstInstance;
+    };
+
+    struct GBufferCullPC {
+        alignas(16) glm::vec4 frustumPlanes[6];
+        alignas(16) glm::mat4 occlusionViewProj; // view projection the depth pyramid was rendered with
+        alignas(4) uint32_t instanceCount;
+        alignas(4) uint32_t occlusionEnabled;
+        alignas(4) uint32_t depthWidth; // depth buffer size the pyramid was reduced from
+        alignas(4) uint32_t depthHeight;
+        alignas(4) uint32_t depthPyramidMips;
+        alignas(4) uint32_t phase; // 0 = cull instances, 1 = compact non-empty batches, 2 = re-test occluded instances, 3 = cull shadow casters
+        alignas(4) uint32_t batchCount; // batches per set, the late set follows the early one
+        alignas(4) uint32_t batchOffset; // 0 for the early set, batchCount for the late set, first shadow input in phase 3
+        alignas(16) glm::vec4 lodParams; // xyz = camera position, w = focal length in pixels over the tolerated error
+    };
+
+    struct DepthPyramidPC {
+        alignas(8) glm::uvec2 srcSize;
+        alignas(8) glm::uvec2 dstSize;
     };
 
     struct LightingPC {
@@ -34,15 +107,15 @@ namespace engine {
     };
 
     struct ShadowPC {
-        alignas(16) glm::mat4 model;
-        alignas(4) uint32_t lightIndex;
-        alignas(4) uint32_t flags; // bit 0 = has skinning
-        alignas(4) uint32_t pad[2]{0, 0};
+        alignas(16) glm::vec4 positionOffset; // dequantizes the bound model's positions
+        alignas(16) glm::vec4 positionScale;
     };
 
     struct ShadowLightEntry {
         alignas(16) glm::mat4 viewProjs[6];
         alignas(16) glm::vec4 lightPosRadius; // xyz = pos, w = radius
+        alignas(16) glm::vec4 faceSidePlanes[24]; // four inward side planes per cube face, casters are culled against them
+        alignas(16) glm::vec4 lodParams; // xyz = light position, w = focal length in texels over the tolerated error
     };
 
     struct ShadowLightsSSBO {
@@ -74,10 +147,24 @@ namespace engine {
     };
 
     struct LightsUBO {
-        PointLight pointLights[64];
+        PointLight pointLights[kMaxLights];
         alignas(16) glm::uvec4 numPointLights;
     };
 
+    // froxel grid for clustered lighting, depth slices are exponential between the camera planes
+    inline constexpr uint32_t kLightClusterDimX = 16u;
+    inline constexpr uint32_t kLightClusterDimY = 9u;
+    inline constexpr uint32_t kLightClusterDimZ = 24u;
+    inline constexpr uint32_t kLightClusterCount = kLightClusterDimX * kLightClusterDimY * kLightClusterDimZ;
+
+    // the cluster buffer is this header, a uvec2 (offset, count) per cluster, then the light index list
+    struct LightClusterHeader {
+        alignas(16) glm::uvec4 dims; // w = 0 until the grid is built, the shader then loops over all lights
+        alignas(16) glm::vec4 zParams; // x = slice scale, y = slice bias, slice = log(depth) * x + y
+    };
+    inline constexpr size_t kLightClusterBufferSize =
+        sizeof(LightClusterHeader) + sizeof(uint32_t) * (2u * kLightClusterCount + kLightClusterCount * kMaxLights);
+
     struct IrradianceProbeData {
         alignas(16) glm::vec4 position; // w = influence radius
         alignas(16) glm::vec4 shCoeffs[9]; // spherical harmonics coefficients
@@ -95,6 +182,9 @@ namespace engine {
     struct IrradianceBakePC {
         alignas(16) glm::mat4 model;
         alignas(16) glm::mat4 viewProj;
+        alignas(16) glm::uvec4 materialParams; // x = material index
+        alignas(16) glm::vec4 positionOffset;
+        alignas(16) glm::vec4 positionScale;
     };
 
     struct ParticlePC {
@@ -106,6 +196,30 @@ namespace engine {
         alignas(4) uint32_t pad[3]{0, 0, 0};
     };
 
+    // one burstParticles or spawnTrail call, expanded into particles by particlesim
+    struct GPUParticleEmit {
+        alignas(16) glm::vec4 positionLifetime; // xyz = origin or trail start, w = lifetime
+        alignas(16) glm::vec4 velocitySpread; // xyz = velocity or trail direction, w = spread already scaled by speed
+        alignas(16) glm::vec4 colorSize; // w = size
+        alignas(16) glm::uvec4 params; // x = count, y = type (0 = burst, 1 = trail), z = seed, w = starting age bits
+    };
+
+    // uint offsets into the GPU particle counter buffer
+    inline constexpr uint32_t kGPUParticleDrawArgsOffset = 4u; // VkDrawIndirectCommand
+    inline constexpr uint32_t kGPUParticleDispatchArgsOffset = 8u; // VkDispatchIndirectCommand
+    inline constexpr uint32_t kGPUParticleCounterCount = 12u; // [0] and [1] are the live counts of each pool
+
+    struct ParticleSimPC {
+        alignas(16) glm::mat4 viewProj;
+        alignas(16) glm::vec4 simParams; // x = gravity, y = dt, z = collision min age, w = bounce damping
+        alignas(8) glm::uvec2 depthSize;
+        alignas(4) uint32_t mode; // 0 = simulate, 1 = emit, 2 = finalize
+        alignas(4) uint32_t srcPool;
+        alignas(4) uint32_t emitCount;
+        alignas(4) uint32_t capacity;
+        alignas(4) uint32_t pad[2]{0, 0};
+    };
+
     struct SimpleParticlePC {
         alignas(16) glm::vec4 probePosition; // xyz = world position
         alignas(4) float particleSize;
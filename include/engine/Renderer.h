@@ -26,6 +26,12 @@ namespace engine {
         class Profiler;
     };
 
+    struct BufferUpload {
+        const void* data;
+        VkDeviceSize size;
+        VkBuffer buffer;
+    };
+
     class Renderer {
     public:
         Renderer(const std::string& windowTitle);
@@ -120,7 +126,8 @@ namespace engine {
             VkImageLayout oldLayout,
             VkImageLayout newLayout,
             uint32_t mipLevels,
-            uint32_t layerCount = 1
+            uint32_t layerCount = 1,
+            uint32_t baseArrayLayer = 0
         );
         void copyBufferToImage(
             VkBuffer buffer,
@@ -135,6 +142,24 @@ namespace engine {
             VkBuffer buffer,
             VkDeviceMemory bufferMemory
         );
+        // one staging buffer and one submission for every upload
+        void copyDataToBuffers(std::span<const BufferUpload> uploads);
+        void copyDataToBuffersInline(
+            VkCommandBuffer commandBuffer,
+            std::span<const BufferUpload> uploads,
+            std::vector<std::pair<VkBuffer, VkDeviceMemory>>& stagingBuffers
+        );
+        // streaming uploads submit with a fence instead of waiting on the queue,
+        // onComplete runs on the main thread from processCompletedUploads once it signals
+        VkCommandBuffer beginUploadCommands();
+        void submitUploadCommands(
+            VkCommandBuffer commandBuffer,
+            std::vector<std::pair<VkBuffer, VkDeviceMemory>> stagingBuffers,
+            std::function<void()> onComplete
+        );
+        // frees finished uploads and runs their callbacks, true if any finished
+        bool processCompletedUploads();
+        void waitForUploads();
         VkSampler createTextureSampler(
             VkFilter magFilter,
             VkFilter minFilter,
@@ -166,6 +191,37 @@ namespace engine {
             uint32_t arrayLayers,
             VkImageCreateFlags flags
         );
+        // leaves the image in transfer dst layout, the staging buffer is appended to stagingBuffers
+        std::pair<VkImage, VkDeviceMemory> createImageFromPixelsInline(
+            VkCommandBuffer commandBuffer,
+            const void* pixels,
+            VkDeviceSize pixelSize,
+            uint32_t width,
+            uint32_t height,
+            uint32_t mipLevels,
+            VkFormat format,
+            VkImageUsageFlags usage,
+            std::vector<std::pair<VkBuffer, VkDeviceMemory>>& stagingBuffers
+        );
+        // uploads precomputed levels in one submission, leaves the image shader readable
+        std::pair<VkImage, VkDeviceMemory> createImageFromMipChain(
+            const void* data,
+            VkDeviceSize size,
+            uint32_t width,
+            uint32_t height,
+            std::span<const VkDeviceSize> mipOffsets,
+            VkFormat format
+        );
+        std::pair<VkImage, VkDeviceMemory> createImageFromMipChainInline(
+            VkCommandBuffer commandBuffer,
+            const void* data,
+            VkDeviceSize size,
+            uint32_t width,
+            uint32_t height,
+            std::span<const VkDeviceSize> mipOffsets,
+            VkFormat format,
+            std::vector<std::pair<VkBuffer, VkDeviceMemory>>& stagingBuffers
+        );
         void generateMipmaps(
             VkImage image,
             VkFormat format,
@@ -174,6 +230,15 @@ namespace engine {
             uint32_t mipLevels,
             uint32_t layerCount = 1
         );
+        void generateMipmapsInline(
+            VkCommandBuffer commandBuffer,
+            VkImage image,
+            VkFormat format,
+            uint32_t width,
+            uint32_t height,
+            uint32_t mipLevels,
+            uint32_t layerCount = 1
+        );
         bool formatSupportsLinearBlit(VkFormat format);
 
         void ensureFallbackShadowCubeTexture();
@@ -223,10 +288,16 @@ namespace engine {
         };
         HdrState hdrState{};
         bool hdrSupported = false;
+        bool pipelineStatisticsSupported = false; // enabled when the device has it, used by the profiler
+        bool blockCompressionSupported = false; // without it cooked BC textures are expanded to rgba8 on load
+        bool drawIndirectCountSupported = false; // without it every lod batch is drawn, empty ones included
 
         const HdrState& getHdrState() const { return hdrState; }
         void setHdrPaperWhiteNits(float nits) { hdrState.paperWhiteNits = nits; }
         bool isHdrSupported() const { return hdrSupported; }
+        bool isPipelineStatisticsSupported() const { return pipelineStatisticsSupported; }
+        bool isBlockCompressionSupported() const { return blockCompressionSupported; }
+        bool isDrawIndirectCountSupported() const { return drawIndirectCountSupported; }
 
     private:
         enum class FadeState { Idle, FadingOut, FadingIn };
@@ -303,11 +374,29 @@ namespace engine {
         std::vector<VkSemaphore> frameWaitSemaphores;
         std::vector<VkPipelineStageFlags> frameWaitStages;
         std::vector<VkSemaphore> frameSignalSemaphores;
-        std::vector<VkImageMemoryBarrier2> recordPreBarriers;
-        std::vector<VkImageMemoryBarrier2> recordPostBarriers;
-        std::vector<VkImageMemoryBarrier> recordLegacyBarriers;
         VkCommandPool commandPool = VK_NULL_HANDLE;
         VkCommandPool computeCommandPool = VK_NULL_HANDLE;
+
+        // one pool pair per worker thread per frame, pools are externally synchronized
+        struct RecordWorkerPools {
+            VkCommandPool graphicsPool = VK_NULL_HANDLE;
+            VkCommandPool computePool = VK_NULL_HANDLE;
+            std::vector<VkCommandBuffer> graphicsBuffers;
+            std::vector<VkCommandBuffer> computeBuffers;
+            uint32_t usedGraphics = 0;
+            uint32_t usedCompute = 0;
+        };
+        std::vector<std::vector<RecordWorkerPools>> recordWorkerPools;
+        std::vector<size_t> recordWorkerSubmissions;
+
+        // streaming uploads in submission order, retired by processCompletedUploads
+        struct PendingUpload {
+            VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+            VkFence fence = VK_NULL_HANDLE;
+            std::vector<std::pair<VkBuffer, VkDeviceMemory>> stagingBuffers;
+            std::function<void()> onComplete;
+        };
+        std::vector<PendingUpload> pendingUploads;
         VkSampler mainTextureSampler;
         VkSampler nearestSampler;
         VkSampler linearClampSampler;
@@ -393,6 +482,8 @@ namespace engine {
         void createNearestSampler();
         void createLinearClampSampler();
         void createCommandBuffers();
+        void createRecordWorkerPools();
+        void destroyRecordWorkerPools();
         void createSyncObjects();
         void createQuadResources();
         void buildRenderSubmitGraph();
@@ -402,12 +493,14 @@ namespace engine {
 
         VkCommandBuffer beginSingleTimeCommands();
         void endSingleTimeCommands(VkCommandBuffer commandBuffer);
+        void destroyStagingBuffers(std::vector<std::pair<VkBuffer, VkDeviceMemory>>& stagingBuffers);
         void recordCommandBuffer(
             VkCommandBuffer commandBuffer,
             uint32_t imageIndex,
             std::span<const size_t> nodeOrder = {},
             NodeQueueClass queueClass = NodeQueueClass::Graphics
         );
+        VkCommandBuffer acquireWorkerCommandBuffer(RecordWorkerPools& pools, NodeQueueClass queueClass);
 
         void draw2DPass(VkCommandBuffer commandBuffer, RenderNode& node);
 
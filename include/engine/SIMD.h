@@ -34,6 +34,23 @@ namespace engine::simd {
         const Plane planes[6],
         uint8_t* outVisible);
 
+    void cullSpheresAgainstFrustum(
+        const float* centerX, const float* centerY, const float* centerZ,
+        size_t count,
+        float radius,
+        const Plane planes[6],
+        uint8_t* outVisible);
+
+    // local to world AABB transform (batched), matrices are 16 floats column major each
+
+    void transformAABBs(
+        const float* localMinX, const float* localMinY, const float* localMinZ,
+        const float* localMaxX, const float* localMaxY, const float* localMaxZ,
+        const float* matrices,
+        size_t count,
+        float* outMinX, float* outMinY, float* outMinZ,
+        float* outMaxX, float* outMaxY, float* outMaxZ);
+
     // AABB-vs-AABB intersection (batched)
 
     void aabbVsManyAABBs(
@@ -45,6 +62,18 @@ namespace engine::simd {
         uint8_t* outIntersect
     );
 
+    // many points vs one box, ors hits into inOutHit (axes are three unit rows, used when oriented)
+
+    void pointsVsBox(
+        const float* px, const float* py, const float* pz,
+        size_t count,
+        const float boundsMin[3], const float boundsMax[3],
+        float margin,
+        bool oriented,
+        const float center[3], const float axes[9], const float halfSize[3],
+        uint8_t* inOutHit
+    );
+
     // ray vs AABB (batched slab test)
 
     void rayVsManyAABBs(
@@ -58,6 +87,14 @@ namespace engine::simd {
     );
 
 
+    // stream compaction, copies src[i] with dead[i] == 0 to the front of dst
+
+    size_t compactFloats(
+        const float* src,
+        const uint8_t* dead,
+        size_t count,
+        float* dst);
+
     // particle kinematics step
 
     void integrateParticleKinematics(
@@ -69,8 +106,57 @@ namespace engine::simd {
         const float* lifetime,
         const float* type,
         uint8_t* dead,
+        const float* stepScale, // per-particle multiplier on dt, 0 skips the particle this frame
         size_t count,
         float dt,
         float gravity
     );
+
+    // volumetric transforms (batched), every stream holds count floats, rotations are xyzw quaternions
+
+    struct VolumetricStreams {
+        const float* scaleA[3];
+        const float* scaleB[3];
+        const float* transA[3];
+        const float* transB[3];
+        const float* rotA[4];
+        const float* rotB[4];
+        const float* color[4];
+        const float* age;
+        const float* lifetime;
+        const float* acceleration;
+        const uint8_t* dead;
+    };
+
+    static constexpr size_t kVolumetricGPUFloats = 40;
+
+    // packs live volumetrics inside the frustum into out as kVolumetricGPUFloats-float records, returns the count
+    size_t buildVolumetricGPUData(
+        const VolumetricStreams& streams,
+        size_t count,
+        const Plane planes[6],
+        float* out,
+        size_t capacity
+    );
+
+    // clustered lighting, bit l of outMasks[c] is set when light l touches cluster c (at most 64 lights)
+    void assignLightsToClusters(
+        const float* lightX, const float* lightY, const float* lightDepth,
+        const float* lightRadius,
+        size_t lightCount,
+        uint32_t dimX, uint32_t dimY, uint32_t dimZ,
+        float slopeX, float slopeY,
+        float nearPlane, float farPlane,
+        uint64_t* outMasks
+    );
+
+    // point light cube faces overlapped by each AABB, sidePlanes are 4 per face in face order
+
+    void cubeFaceMasks(
+        const float* minX, const float* minY, const float* minZ,
+        const float* maxX, const float* maxY, const float* maxZ,
+        size_t count,
+        const Plane sidePlanes[24],
+        uint8_t* outMasks
+    );
 }
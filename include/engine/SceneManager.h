@@ -9,12 +9,19 @@ namespace engine {
     class Renderer;
     class Scene {
     public:
-        Scene(std::function<void(Renderer* renderer)> onLoad) : onLoad(onLoad) {};
+        // preloadTextures are made resident before onLoad runs, so the scene never shows their placeholders,
+        // preloadModels likewise, so colliders built in onLoad have their hulls right away
+        Scene(std::function<void(Renderer* renderer)> onLoad, std::vector<std::string> preloadTextures = {}, std::vector<std::string> preloadModels = {})
+            : onLoad(onLoad), preloadTextures(std::move(preloadTextures)), preloadModels(std::move(preloadModels)) {};
         ~Scene() = default;
         void run(Renderer* renderer) { onLoad(renderer); }
+        const std::vector<std::string>& getPreloadTextures() const { return preloadTextures; }
+        const std::vector<std::string>& getPreloadModels() const { return preloadModels; }
 
     private:
         std::function<void(Renderer* renderer)> onLoad;
+        std::vector<std::string> preloadTextures;
+        std::vector<std::string> preloadModels;
     };
 
     class SceneManager {
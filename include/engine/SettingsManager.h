@@ -14,6 +14,7 @@
 #include <engine/TextureManager.h>
 #include <engine/UIManager.h>
 #include <engine/InputManager.h>
+#include <engine/ParticleManager.h>
 #include <engine/IO.h>
 
 namespace engine {
@@ -34,6 +35,7 @@ namespace engine {
             float hdrPaperWhiteNits = 203.0f; // user-facing "HDR Brightness"
             float uiScale = 1.0f; // user UI scale modifier, 0.5 to 2.0
             float resolutionScale = 0.8f; // internal render resolution scale, 0.5 to 1.0
+            bool gpuParticles = false; // simulate particles in compute instead of on the cpu
         };
 
         struct SettingsDefinition {
@@ -554,6 +556,17 @@ namespace engine {
 
         std::vector<SettingsDefinition> defs = {
             { SettingsDefinition::Bool, "Show FPS Counter", "showFPS", &Settings::showFPS },
+            {
+                .type = SettingsDefinition::Bool,
+                .label = "GPU Particles",
+                .key = "gpuParticles",
+                .boolPtr = &Settings::gpuParticles,
+                .onChange = [](Settings* prev, Settings* curr, Renderer* renderer) {
+                    if (prev->gpuParticles != curr->gpuParticles) {
+                        renderer->getParticleManager()->setGPUSimulation(curr->gpuParticles);
+                    }
+                }
+            },
             { SettingsDefinition::Enum, "Ambient Occlusion Mode", "aoMode", nullptr, &Settings::aoMode, {"Disabled", "SSAO", "GTAO"}, nullptr, 0.0f, 0.0f, "", false, 0.0f, false, 0.0f, 0.0f, 0.0f, "",
                 [](Settings* prev, Settings* curr, Renderer* renderer) {
                     if ((prev->aoMode == 0) != (curr->aoMode == 0)) {
@@ -111,6 +111,7 @@ namespace engine {
             std::vector<VkDescriptorType> vertexDescriptorTypes = {};
             std::vector<uint32_t> fragmentDescriptorCounts = {};
             std::vector<VkDescriptorType> fragmentDescriptorTypes = {};
+            bool partiallyBoundTextures = false; // sampled image arrays are left unwritten and filled per slot later
             VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
             VkFrontFace frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
             bool depthWrite = true;
@@ -262,8 +263,11 @@ namespace engine {
         bool usesRendering = true;
         bool canRunCustomOnComputeQueue = false;
         bool usePassManagedTransitions = true;
+        bool canRecordOnWorkerThread = false; // customRenderFunc only records, safe to run off the main thread
         VkPipelineStageFlags2 storageWriteStage = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+        std::function<void(Renderer*, VkCommandBuffer, uint32_t)> preRenderFunc = nullptr; // recorded outside dynamic rendering
         std::function<void(Renderer*, VkCommandBuffer, uint32_t)> customRenderFunc = nullptr;
+        std::function<void(Renderer*, VkCommandBuffer, uint32_t)> postRenderFunc = nullptr; // recorded after dynamic rendering ends, before the pass's layout transitions
         std::function<bool(Renderer*)> skipCondition = nullptr;
     };
     struct RenderGraph {
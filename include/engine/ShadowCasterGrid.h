@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+#include <unordered_map>
+#include <engine/ModelManager.h>
+
+namespace engine {
+    class Entity;
+
+    // sparse uniform grid over shadow casting entities, lights query it with their range sphere
+    class ShadowCasterGrid {
+    public:
+        explicit ShadowCasterGrid(float cellSize = 8.0f) : invCellSize(1.0f / cellSize) {}
+
+        void clear();
+        void insert(Entity* entity, const AABB& bounds);
+        void remove(const Entity* entity);
+
+        // moves the entity to its new bounds, cells are only touched when the covered range changes
+        void update(Entity* entity, const AABB& bounds);
+
+        // appends the casters whose bounds touch the sphere, sorted and without duplicates
+        void querySphere(const glm::vec3& center, float radius, std::vector<Entity*>& out) const;
+
+        const AABB& getBounds(Entity* entity) const { return entries.at(entity).bounds; }
+        size_t size() const { return entries.size(); }
+        bool empty() const { return entries.empty(); }
+
+    private:
+        struct Entry {
+            AABB bounds;
+            glm::ivec3 minCell;
+            glm::ivec3 maxCell;
+            bool oversized; // lives in the oversized list instead of the cells
+        };
+
+        // casters spanning more cells than this on any axis skip the grid
+        static constexpr int32_t kMaxCellSpan = 16;
+        static constexpr float kCellLimit = static_cast<float>((1 << 20) - 1);
+
+        // clamped to the key range so huge or non-finite coordinates cannot wrap
+        glm::ivec3 getCellPos(const glm::vec3& coord) const {
+            return glm::ivec3(glm::clamp(glm::floor(coord * invCellSize), glm::vec3(-kCellLimit), glm::vec3(kCellLimit)));
+        }
+        static bool isOversized(const glm::ivec3& minCell, const glm::ivec3& maxCell) {
+            const glm::ivec3 span = maxCell - minCell;
+            return span.x >= kMaxCellSpan || span.y >= kMaxCellSpan || span.z >= kMaxCellSpan;
+        }
+
+        // 21 bits per axis, enough for +-1M cells
+        static uint64_t getCellKey(const glm::ivec3& cell) {
+            constexpr int32_t bias = 1 << 20;
+            constexpr uint64_t mask = (1ull << 21) - 1ull;
+            return (static_cast<uint64_t>(cell.x + bias) & mask)
+                 | ((static_cast<uint64_t>(cell.y + bias) & mask) << 21)
+                 | ((static_cast<uint64_t>(cell.z + bias) & mask) << 42);
+        }
+
+        void addToCells(Entity* entity, const Entry& entry);
+        void removeFromCells(Entity* entity, const Entry& entry);
+
+        float invCellSize;
+        std::unordered_map<uint64_t, std::vector<Entity*>> cells;
+        std::unordered_map<Entity*, Entry> entries;
+        std::vector<Entity*> oversized;
+    };
+}
@@ -46,6 +46,8 @@ namespace engine {
         void query(const AABB& aabb, Candidates& out, float margin = 0.0f) const;
 
         void rebuild(const std::vector<Collider*>& colliders);
+
+        size_t cellIndexAt(const glm::vec3& pos) const { return getCellIndex(pos); }
         
     private:
         glm::uvec3 getCellPos(glm::vec3 coord) const {
@@ -2,9 +2,15 @@
 
 #include <engine/EmbeddedAssets.h>
 #include <vulkan/vulkan.h>
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace engine {
     class Renderer;
@@ -30,17 +36,48 @@ namespace engine {
 
         void registerEmbeddedTextures(const std::unordered_map<std::string, EmbeddedAsset>& assets);
 
+        // uploads everything except material sets, which stream in on first request
         void init();
 
+        // returns nullptr until the texture is resident, see requestTexture
         Texture* getTexture(const std::string& name);
+
+        // queues a background decode the first time a streamed texture is asked for
+        AssetState requestTexture(const std::string& name);
+        void preloadTextures(const std::vector<std::string>& names);
+        // blocks until every named texture is resident or known to be missing
+        void waitForTextures(const std::vector<std::string>& names);
+        // submits up to maxUploads finished decodes without waiting, true if any texture
+        // became resident since the last call
+        bool processStreamedTextures(size_t maxUploads);
+
         void registerTexture(const std::string& name, const Texture& texture);
         void registerTextureFromRGBA(const std::string& name, const uint8_t* rgba, int width, int height);
 
         bool createTextureFromRGBA(const std::string& name, const unsigned char* rgba, int width, int height);
 
     private:
+        struct DecodedTexture;
+        static void decodeTexture(const EmbeddedAsset& asset, DecodedTexture& out, bool expandBlockFormats);
+        static void decodeCookedTexture(const EmbeddedAsset& asset, DecodedTexture& out, bool expandBlockFormats);
+        static bool expandBlockCompressed(DecodedTexture& out);
+        Texture recordTextureUpload(
+            DecodedTexture& dec,
+            VkCommandBuffer commandBuffer,
+            std::vector<std::pair<VkBuffer, VkDeviceMemory>>& stagingBuffers
+        );
+        bool submitStreamedTextures(size_t maxUploads);
+
         std::unordered_map<std::string, Texture> textures;
         std::unordered_map<std::string, EmbeddedAsset> embeddedAssets;
         engine::Renderer* renderer;
+
+        std::unordered_set<std::string> requestedTextures;
+        std::unordered_set<std::string> failedTextures;
+        std::mutex streamedMutex;
+        std::vector<std::unique_ptr<DecodedTexture>> streamedTextures;
+        std::atomic<size_t> streamingInFlight{0};
+        std::atomic<bool> cancelStreaming{false};
+        bool streamedTexturesResident = false;
     };
 };
\ No newline at end of file
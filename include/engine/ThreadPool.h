@@ -22,6 +22,9 @@ namespace engine {
 
         void parallel_for_chunks(size_t begin, size_t end, size_t minChunk, const ChunkFn& fn);
 
+        // fire-and-forget background work, workers only pick it up when no chunks are queued
+        void submit(std::function<void()> job);
+
         ~ThreadPool();
         ThreadPool(const ThreadPool&) = delete;
         ThreadPool& operator=(const ThreadPool&) = delete;
@@ -40,6 +43,7 @@ namespace engine {
 
         std::vector<std::thread> workers;
         std::deque<ChunkTask> tasks;
+        std::deque<std::function<void()>> jobs;
         std::mutex m;
         std::condition_variable cv;
         bool running = true;
@@ -7,11 +7,12 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/matrix_decompose.hpp>
 #include <glm/gtx/quaternion.hpp>
+#include <array>
+#include <cstdint>
 #include <vector>
 
 namespace engine {
     class Renderer;
-    class VolumetricManager;
     struct VolumetricGPU {
         alignas(16) glm::mat4 model;
         alignas(16) glm::mat4 invModel;
@@ -20,64 +21,6 @@ namespace engine {
         alignas(4) float lifetime;
         alignas(4) uint32_t pad[2]{0, 0};
     };
-    class Volumetric {
-    public:
-        Volumetric(
-            const glm::mat4& initialTransform,
-            const glm::mat4& finalTransform,
-            const glm::vec4& color,
-            float lifetime,
-            float acceleration = 2.0f
-        );
-        const glm::vec4& getColor() const { return color; }
-        void setColor(const glm::vec4& color) { this->color = color; }
-        float getLifetime() const { return lifetime; }
-        void setLifetime(float lifetime) { this->lifetime = lifetime; }
-        float getAge() const { return age; }
-        void setAge(float age) { this->age = age; }
-        VolumetricGPU getGPUData() const {
-            float t = age / std::max(lifetime, 0.0001f);
-            float eased = 1.0f - std::pow(1.0f - t, std::max(acceleration, 0.0001f));
-
-            glm::vec3 scale = glm::mix(scaleA, scaleB, eased);
-            glm::quat rot = glm::slerp(rotA, rotB, eased);
-            glm::vec3 trans = glm::mix(transA, transB, eased);
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), trans)
-                * glm::toMat4(rot)
-                * glm::scale(glm::mat4(1.0f), scale);
-
-            glm::vec3 invScale(
-                1.0f / (std::abs(scale.x) < 1e-6f ? std::copysign(1e-6f, scale.x == 0.0f ? 1.0f : scale.x) : scale.x),
-                1.0f / (std::abs(scale.y) < 1e-6f ? std::copysign(1e-6f, scale.y == 0.0f ? 1.0f : scale.y) : scale.y),
-                1.0f / (std::abs(scale.z) < 1e-6f ? std::copysign(1e-6f, scale.z == 0.0f ? 1.0f : scale.z) : scale.z)
-            );
-            glm::mat4 invModel = glm::scale(glm::mat4(1.0f), invScale)
-                * glm::transpose(glm::toMat4(rot))
-                * glm::translate(glm::mat4(1.0f), -trans);
-            return {
-                .model = model,
-                .invModel = invModel,
-                .color = color,
-                .age = age,
-                .lifetime = lifetime
-            };
-        }
-
-        const glm::mat4& getFinalTransform() const { return finalTransform; }
-
-        void markForDeletion() { markedForDeletion = true; }
-        bool isMarkedForDeletion() const { return markedForDeletion; }
-    private:
-        glm::mat4 initialTransform;
-        glm::mat4 finalTransform;
-        glm::vec4 color;
-        float lifetime;
-        float acceleration = 2.0f;
-        float age = 0.0f;
-        bool markedForDeletion = false;
-        glm::vec3 scaleA, scaleB, transA, transB;
-        glm::quat rotA, rotB;
-    };
     class VolumetricManager {
     public:
         VolumetricManager(engine::Renderer* renderer);
@@ -85,15 +28,12 @@ namespace engine {
         void init();
         void clear();
 
-        void createVolumetric(const glm::mat4& initialTransform, const glm::mat4& finalTransform, const glm::vec4& color, float lifetime, float acceleration = 2.0f) {
-            if (volumetrics.size() >= hardCap) return;
-            volumetrics.emplace_back(initialTransform, finalTransform, color, lifetime, acceleration);
-        }
+        void createVolumetric(const glm::mat4& initialTransform, const glm::mat4& finalTransform, const glm::vec4& color, float lifetime, float acceleration = 2.0f);
 
         void updateVolumetricBuffer(uint32_t currentFrame);
         void createVolumetricDescriptorSets();
         const std::vector<VkDescriptorSet>& getDescriptorSets() const { return descriptorSets; }
-        const std::vector<Volumetric>& getVolumetrics() const { return volumetrics; }
+        uint32_t getVolumetricCount() const { return static_cast<uint32_t>(volumetrics.count()); }
 
         void updateAll(float deltaTime);
         void renderVolumetrics(VkCommandBuffer commandBuffer, uint32_t currentFrame);
@@ -101,9 +41,37 @@ namespace engine {
         uint32_t getVisibleVolumetrics() const { return visibleVolumetrics; }
 
     private:
+        // start and end transforms are decomposed once, the eased matrices are rebuilt in bulk every frame
+        struct VolumetricSoA {
+            std::vector<float> scaleAX, scaleAY, scaleAZ, scaleBX, scaleBY, scaleBZ;
+            std::vector<float> transAX, transAY, transAZ, transBX, transBY, transBZ;
+            std::vector<float> rotAX, rotAY, rotAZ, rotAW, rotBX, rotBY, rotBZ, rotBW;
+            std::vector<float> colorR, colorG, colorB, colorA;
+            std::vector<float> age, lifetime, acceleration;
+            std::vector<uint8_t> dead;
+
+            size_t count() const { return age.size(); }
+            bool empty() const { return age.empty(); }
+            void clearAll();
+            void reserveAll(size_t n);
+            void push(const glm::vec3& scaleA, const glm::quat& rotA, const glm::vec3& transA,
+                      const glm::vec3& scaleB, const glm::quat& rotB, const glm::vec3& transB,
+                      const glm::vec4& color, float lifetime, float acceleration);
+            void truncateFront(size_t n);
+            void compactDead();
+
+            std::array<std::vector<float>*, 27> floatArrays() {
+                return { &scaleAX, &scaleAY, &scaleAZ, &scaleBX, &scaleBY, &scaleBZ,
+                         &transAX, &transAY, &transAZ, &transBX, &transBY, &transBZ,
+                         &rotAX, &rotAY, &rotAZ, &rotAW, &rotBX, &rotBY, &rotBZ, &rotBW,
+                         &colorR, &colorG, &colorB, &colorA,
+                         &age, &lifetime, &acceleration };
+            }
+        };
+
         engine::Renderer* renderer;
 
-        std::vector<Volumetric> volumetrics;
+        VolumetricSoA volumetrics;
         std::vector<VkBuffer> volumetricBuffers;
         std::vector<VkDeviceMemory> volumetricBufferMemory;
         std::vector<void*> volumetricBuffersMapped;
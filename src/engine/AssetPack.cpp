@@ -0,0 +1,170 @@
+#include <engine/AssetPack.h>
+#include <engine/Platform.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+const engine::AssetPack& engine::AssetPack::open(const std::string& name) {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::unique_ptr<AssetPack>> packs;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = packs.find(name);
+    if (it == packs.end()) {
+        const std::string path = (Platform::executableDir() / (name + ".pak")).string();
+        it = packs.emplace(name, std::unique_ptr<AssetPack>(new AssetPack(path))).first;
+    }
+    return *it->second;
+}
+
+engine::AssetPack::AssetPack(const std::string& path) {
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Failed to open asset pack: " + path);
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        throw std::runtime_error("Failed to read asset pack size: " + path);
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        throw std::runtime_error("Failed to map asset pack: " + path);
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    mapped = static_cast<const unsigned char*>(view);
+    mappedSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open asset pack: " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to read asset pack size: " + path);
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps the file referenced on its own
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        throw std::runtime_error("Failed to map asset pack: " + path);
+    }
+    mapped = static_cast<const unsigned char*>(view);
+    mappedSize = static_cast<size_t>(st.st_size);
+#endif
+
+    // the destructor does not run for a constructor that throws, so the mapping is released here
+    try {
+        readTableOfContents(path);
+    } catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+void engine::AssetPack::readTableOfContents(const std::string& path) {
+    // offset + size can wrap in uint64, so compare against what is left instead
+    auto inBounds = [this](uint64_t offset, uint64_t size) {
+        return offset <= mappedSize && size <= mappedSize - offset;
+    };
+
+    // only the header, toc and string table are touched here, blobs fault in on first use
+    cooked::PackHeader header;
+    if (mappedSize < sizeof(header)) {
+        throw std::runtime_error("Asset pack is truncated: " + path);
+    }
+    std::memcpy(&header, mapped, sizeof(header));
+    if (header.magic != cooked::kPackMagic || header.version != cooked::kPackVersion) {
+        throw std::runtime_error("Asset pack has an unsupported format: " + path);
+    }
+    if (header.fileSize != mappedSize
+        || !inBounds(header.tocOffset, static_cast<uint64_t>(header.entryCount) * sizeof(cooked::PackEntry))
+        || !inBounds(header.stringOffset, header.stringBytes)) {
+        throw std::runtime_error("Asset pack is truncated: " + path);
+    }
+
+    const char* strings = reinterpret_cast<const char*>(mapped + header.stringOffset);
+    auto stringAt = [&](uint32_t offset) -> std::string_view {
+        if (offset >= header.stringBytes) {
+            throw std::runtime_error("Asset pack has a bad string offset: " + path);
+        }
+        return std::string_view(strings + offset, strnlen(strings + offset, header.stringBytes - offset));
+    };
+
+    entries.reserve(header.entryCount);
+    for (uint32_t i = 0; i < header.entryCount; ++i) {
+        cooked::PackEntry entry;
+        std::memcpy(&entry, mapped + header.tocOffset + i * sizeof(cooked::PackEntry), sizeof(entry));
+        if (!inBounds(entry.dataOffset, entry.dataSize)) {
+            throw std::runtime_error("Asset pack entry is out of bounds: " + path);
+        }
+        std::string_view ext = stringAt(entry.extOffset);
+        entries.push_back({
+            .hash = entry.hash,
+            .category = stringAt(entry.categoryOffset),
+            .name = stringAt(entry.nameOffset),
+            .asset = {
+                .data = mapped + entry.dataOffset,
+                .size = static_cast<size_t>(entry.dataSize),
+                .ext = ext.data()
+            }
+        });
+    }
+}
+
+engine::AssetPack::~AssetPack() {
+    unmap();
+}
+
+void engine::AssetPack::unmap() {
+#if defined(_WIN32)
+    if (mapped) UnmapViewOfFile(mapped);
+    if (mappingHandle) CloseHandle(static_cast<HANDLE>(mappingHandle));
+    if (fileHandle) CloseHandle(static_cast<HANDLE>(fileHandle));
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    if (mapped) munmap(const_cast<unsigned char*>(mapped), mappedSize);
+#endif
+    mapped = nullptr;
+    mappedSize = 0;
+}
+
+const engine::EmbeddedAsset* engine::AssetPack::find(std::string_view category, std::string_view name) const {
+    const uint64_t hash = cooked::packHash(category, name);
+    auto it = std::lower_bound(entries.begin(), entries.end(), hash,
+        [](const Entry& e, uint64_t h) { return e.hash < h; });
+    for (; it != entries.end() && it->hash == hash; ++it) {
+        if (it->category == category && it->name == name) {
+            return &it->asset;
+        }
+    }
+    return nullptr;
+}
+
+std::unordered_map<std::string, engine::EmbeddedAsset> engine::AssetPack::category(std::string_view category) const {
+    std::unordered_map<std::string, EmbeddedAsset> assets;
+    for (const Entry& e : entries) {
+        if (e.category == category) {
+            assets.emplace(std::string(e.name), e.asset);
+        }
+    }
+    return assets;
+}
@@ -104,6 +104,7 @@ engine::Collider::Collision engine::Collider::testRayCollision(Collider* collide
             ConvexHullCollider* hullCollider = static_cast<ConvexHullCollider*>(collider);
             const std::vector<glm::vec3>& faceAxes = hullCollider->getFaceAxesCached();
             const std::vector<glm::vec3>& worldVerts = hullCollider->getWorldVerts();
+            if (worldVerts.empty()) break; // hull model still streaming
             glm::vec3 center = hullCollider->getWorldCenter();
             float tMin = 0.0f;
             float tMax = maxDistance;
@@ -471,62 +472,53 @@ bool engine::Collider::satMTV(std::span<const glm::vec3> vertsA, std::span<const
     return true;
 }
 
-void engine::ConvexHullCollider::buildConvexData(const std::vector<glm::vec3>& verts, const std::vector<glm::ivec3>& tris, const glm::mat4& transform, std::vector<glm::vec3>& outVerts, std::vector<glm::vec3>& outEdgeAxes, std::vector<glm::vec3>& outFaceAxes, glm::vec3& outCenter) {
-    outVerts.clear();
-    outEdgeAxes.clear();
-    outFaceAxes.clear();
-    outCenter = glm::vec3(0.0f);
-    outVerts.resize(verts.size());
-    const size_t vcount = verts.size();
-    if (vcount > 128) {
-        ThreadPool::global().parallel_for_chunks(0, vcount, 64, [&](size_t b, size_t e, size_t) {
-            for (size_t i = b; i < e; ++i) {
-                outVerts[i] = glm::vec3(transform * glm::vec4(verts[i], 1.0f));
-            }
-        });
-    } else {
-        for (size_t i = 0; i < vcount; ++i) {
-            outVerts[i] = glm::vec3(transform * glm::vec4(verts[i], 1.0f));
-        }
-    }
-    if (outVerts.empty()) {
-        return;
-    }
-    for (const auto& tri : tris) {
-        if (static_cast<size_t>(tri.x) >= outVerts.size() ||
-            static_cast<size_t>(tri.y) >= outVerts.size() ||
-            static_cast<size_t>(tri.z) >= outVerts.size()) {
-            continue;
-        }
-        glm::vec3 a = outVerts[static_cast<size_t>(tri.x)];
-        glm::vec3 b = outVerts[static_cast<size_t>(tri.y)];
-        glm::vec3 c = outVerts[static_cast<size_t>(tri.z)];
-        glm::vec3 normal = glm::cross(b - a, c - a);
-        float len = glm::length(normal);
-        if (len > 1e-6f) {
-            addAxisUnique(outFaceAxes, normal / len);
-        }
-        if (outEdgeAxes.size() < 12) {
-            addAxisUnique(outEdgeAxes, normalizeOrZero(b - a));
-            addAxisUnique(outEdgeAxes, normalizeOrZero(c - b));
-            addAxisUnique(outEdgeAxes, normalizeOrZero(a - c));
+// normals go through the cofactor matrix, the inverse transpose scaled by the determinant,
+// which stays defined when a scale flattens the hull. dot(M p, cof n) = det * dot(p, n), so
+// the cooked extents carry over with a scale and a shift instead of reprojecting every vertex
+void engine::ConvexHullCollider::transformAxes(const glm::mat4& transform) {
+    const glm::mat3 linear(transform);
+    const glm::mat3 cofactor(
+        glm::cross(linear[1], linear[2]),
+        glm::cross(linear[2], linear[0]),
+        glm::cross(linear[0], linear[1])
+    );
+    const float det = glm::dot(linear[0], cofactor[0]);
+    const glm::vec3 translation(transform[3]);
+    faceAxesCached.clear();
+    faceAxisSelfProjCached.clear();
+    for (size_t i = 0; i < localHull.faceAxes.size() && i < localHull.faceExtents.size(); ++i) {
+        glm::vec3 axis = cofactor * localHull.faceAxes[i];
+        float length = glm::length(axis);
+        if (length < 1e-12f) continue;
+        axis /= length;
+        const float scale = det / length;
+        const float shift = glm::dot(translation, axis);
+        const float a = localHull.faceExtents[i].x * scale + shift;
+        const float b = localHull.faceExtents[i].y * scale + shift;
+        faceAxesCached.push_back(axis);
+        faceAxisSelfProjCached.push_back(glm::vec2(glm::min(a, b), glm::max(a, b)));
+    }
+    edgeAxesCached.clear();
+    for (const auto& edge : localHull.edgeAxes) {
+        glm::vec3 axis = normalizeOrZero(linear * edge);
+        if (glm::dot(axis, axis) > 0.0f) {
+            edgeAxesCached.push_back(axis);
         }
     }
-    if (outFaceAxes.empty()) {
-        outFaceAxes = {
+    if (faceAxesCached.empty()) {
+        faceAxesCached = {
             glm::vec3(1.0f, 0.0f, 0.0f),
             glm::vec3(0.0f, 1.0f, 0.0f),
             glm::vec3(0.0f, 0.0f, 1.0f)
         };
+        for (const auto& axis : faceAxesCached) {
+            auto [pMin, pMax] = projectVertsOntoAxis(worldVerts, axis);
+            faceAxisSelfProjCached.push_back(glm::vec2(pMin, pMax));
+        }
     }
-    if (outEdgeAxes.empty()) {
-        outEdgeAxes = outFaceAxes;
-    }
-    float centerX = 0.0f, centerY = 0.0f, centerZ = 0.0f;
-    for (const auto& vert : outVerts) {
-        centerX += vert.x; centerY += vert.y; centerZ += vert.z;
+    if (edgeAxesCached.empty()) {
+        edgeAxesCached = faceAxesCached;
     }
-    outCenter = glm::vec3(centerX, centerY, centerZ) / static_cast<float>(outVerts.size());
 }
 
 engine::AABB engine::AABBCollider::getWorldAABB() {
@@ -570,54 +562,30 @@ engine::AABB engine::ConvexHullCollider::getWorldAABB() {
     return cachedAABB;
 }
 
-void engine::ConvexHullCollider::setVertsFromModel(std::vector<glm::vec3>&& vertices, std::vector<uint32_t>&& indices, const glm::mat4& transform) {
-    localVerts.clear();
-    localTris.clear();
-    localVerts.reserve(vertices.size());
-    for (const auto& v : vertices) {
-        localVerts.emplace_back(glm::vec3(transform * glm::vec4(v, 1.0f)));
-    }
-    const size_t expectedTriCount = indices.size() / 3;
-    localTris.reserve(expectedTriCount);
-    for (size_t i = 0; i < expectedTriCount; ++i) {
-        glm::ivec3 tri(
-            static_cast<int>(indices[i * 3 + 0]),
-            static_cast<int>(indices[i * 3 + 1]),
-            static_cast<int>(indices[i * 3 + 2])
-        );
-        if (static_cast<size_t>(tri.x) >= localVerts.size() ||
-            static_cast<size_t>(tri.y) >= localVerts.size() ||
-            static_cast<size_t>(tri.z) >= localVerts.size()) {
-            continue;
-        }
-        localTris.emplace_back(tri);
+void engine::ConvexHullCollider::setHull(Model::ConvexHull&& hull) {
+    localHull = std::move(hull);
+    localCenter = glm::vec3(0.0f);
+    for (const auto& v : localHull.vertices) {
+        localCenter += v;
+    }
+    if (!localHull.vertices.empty()) {
+        localCenter /= static_cast<float>(localHull.vertices.size());
     }
     isCached = false;
 }
 
-void engine::ConvexHullCollider::setVertsFromModel(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& indices, const glm::mat4& transform) {
-    localVerts.clear();
-    localTris.clear();
-    localVerts.reserve(vertices.size());
-    for (const auto& v : vertices) {
-        localVerts.emplace_back(glm::vec3(transform * glm::vec4(v, 1.0f)));
-    }
-    const size_t expectedTriCount = indices.size() / 3;
-    localTris.reserve(expectedTriCount);
-    for (size_t i = 0; i < expectedTriCount; ++i) {
-        glm::ivec3 tri(
-            static_cast<int>(indices[i * 3 + 0]),
-            static_cast<int>(indices[i * 3 + 1]),
-            static_cast<int>(indices[i * 3 + 2])
-        );
-        if (static_cast<size_t>(tri.x) >= localVerts.size() ||
-            static_cast<size_t>(tri.y) >= localVerts.size() ||
-            static_cast<size_t>(tri.z) >= localVerts.size()) {
-            continue;
-        }
-        localTris.emplace_back(tri);
+void engine::ConvexHullCollider::setHull(const Model::ConvexHull& hull) {
+    setHull(Model::ConvexHull(hull));
+}
+
+void engine::ConvexHullCollider::setHull(const Model* model) {
+    hullModel = nullptr;
+    if (model && model->isResident()) {
+        setHull(model->loadConvexHull());
+        return;
     }
-    isCached = false;
+    setHull(Model::ConvexHull{});
+    hullModel = model;
 }
 
 bool engine::AABBCollider::intersectsMTV(Collider& other, CollisionMTV& out, const glm::mat4& deltaTransform) {
@@ -792,8 +760,11 @@ bool engine::OBBCollider::intersectsMTV(Collider& other, CollisionMTV& out, cons
 }
 
 bool engine::ConvexHullCollider::intersectsMTV(Collider& other, CollisionMTV& out, const glm::mat4& deltaTransform) {
-    AABB otherAABB = other.getWorldAABB();
     AABB thisAABB = getWorldAABB();
+    if (localHull.vertices.empty()) {
+        return false;
+    }
+    AABB otherAABB = other.getWorldAABB();
     if (!Collider::aabbIntersects(thisAABB, otherAABB, 0.001f)) {
         return false;
     }
@@ -857,16 +828,37 @@ bool engine::ConvexHullCollider::intersectsMTV(Collider& other, CollisionMTV& ou
 }
 
 void engine::ConvexHullCollider::ensureCached() {
+    if (hullModel && hullModel->isResident()) {
+        const Model* model = hullModel;
+        hullModel = nullptr;
+        setHull(model->loadConvexHull());
+    }
     uint32_t currentGen = getTransformGeneration();
     if (isCached && currentGen == lastTransformGeneration) {
         return;
     }
     const glm::mat4& worldTransform = getWorldTransform();
-    buildConvexData(localVerts, localTris, worldTransform, worldVerts, edgeAxesCached, faceAxesCached, worldCenter);
+    const std::vector<glm::vec3>& localVerts = localHull.vertices;
+    const size_t vcount = localVerts.size();
+    worldVerts.resize(vcount);
+    if (vcount > 128) {
+        ThreadPool::global().parallel_for_chunks(0, vcount, 64, [&](size_t b, size_t e, size_t) {
+            for (size_t i = b; i < e; ++i) {
+                worldVerts[i] = glm::vec3(worldTransform * glm::vec4(localVerts[i], 1.0f));
+            }
+        });
+    } else {
+        for (size_t i = 0; i < vcount; ++i) {
+            worldVerts[i] = glm::vec3(worldTransform * glm::vec4(localVerts[i], 1.0f));
+        }
+    }
+    worldCenter = glm::vec3(worldTransform * glm::vec4(localCenter, 1.0f));
 
     if (worldVerts.empty()) {
         glm::vec3 p = glm::vec3(worldTransform[3]);
         cachedAABB = AABB{p - glm::vec3(0.001f), p + glm::vec3(0.001f)};
+        edgeAxesCached.clear();
+        faceAxesCached.clear();
         faceAxisSelfProjCached.clear();
         worldVertsX.clear();
         worldVertsY.clear();
@@ -899,29 +891,7 @@ void engine::ConvexHullCollider::ensureCached() {
             worldVertsZ[i] = padZ;
         }
 
-        faceAxisSelfProjCached.resize(faceAxesCached.size());
-        if (nPad >= engine::simd::kPad) {
-            for (size_t a = 0; a < faceAxesCached.size(); ++a) {
-                const glm::vec3& axis = faceAxesCached[a];
-                auto r = engine::simd::projectVertsSoA(
-                    worldVertsX.data(), worldVertsY.data(), worldVertsZ.data(), nPad,
-                    axis.x, axis.y, axis.z, 0.0f
-                );
-                faceAxisSelfProjCached[a] = glm::vec2(r.min, r.max);
-            }
-        } else {
-            for (size_t a = 0; a < faceAxesCached.size(); ++a) {
-                const glm::vec3& axis = faceAxesCached[a];
-                float pMin = glm::dot(worldVerts[0], axis);
-                float pMax = pMin;
-                for (size_t v = 1; v < worldVerts.size(); ++v) {
-                    float p = glm::dot(worldVerts[v], axis);
-                    if (p < pMin) pMin = p;
-                    if (p > pMax) pMax = p;
-                }
-                faceAxisSelfProjCached[a] = glm::vec2(pMin, pMax);
-            }
-        }
+        transformAxes(worldTransform);
     }
 
     lastTransformGeneration = currentGen;
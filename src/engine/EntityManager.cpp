@@ -7,14 +7,25 @@
 #include <engine/Collider.h>
 #include <engine/SettingsManager.h>
 #include <engine/LightManager.h>
+#include <engine/PushConstants.h>
 #include <engine/SIMD.h>
 #include <engine/ThreadPool.h>
 #include <engine/Profiler.h>
+#include <algorithm>
+#include <array>
 #include <cstring>
 #include <glm/gtc/quaternion.hpp>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/quaternion.hpp>
 
+// screen space error in pixels a gbuffer lod may introduce before a finer one is drawn
+static constexpr float kLodPixelError = 1.0f;
+
+// albedo, metallic, roughness, normal, also the placeholders while a material streams in
+static constexpr std::array<const char*, 4> kDefaultMaterialTextures = {
+    "materials_default_albedo", "materials_default_metallic", "materials_default_roughness", "materials_default_normal"
+};
+
 void engine::EntityManager::addCollider(Collider* collider) {
     colliders.push_back(collider);
     spatialGridDirty = true;
@@ -75,17 +86,9 @@ engine::Entity::~Entity() {
                         static_cast<uint32_t>(descriptorSets.size()), descriptorSets.data());
                 }
             }
-            if (!shadowDescriptorSets.empty()) {
-                GraphicsShader* shadowShader = shaderManager->getGraphicsShader("shadow");
-                if (shadowShader && shadowShader->descriptorPool != VK_NULL_HANDLE) {
-                    vkFreeDescriptorSets(device, shadowShader->descriptorPool,
-                        static_cast<uint32_t>(shadowDescriptorSets.size()), shadowDescriptorSets.data());
-                }
-            }
         }
     }
     descriptorSets.clear();
-    shadowDescriptorSets.clear();
     destroyUniformBuffers(renderer);
     for (auto& child : children) {
         delete child;
@@ -96,10 +99,14 @@ engine::Entity::~Entity() {
 
 void engine::Entity::setModel(engine::Model* model) {
     this->model = model;
+    if (model && !model->isResident()) {
+        entityManager->trackStreamingModel(name);
+    }
+    entityManager->markRenderProxiesDirty();
 }
 
 engine::Model* engine::Entity::getModel() const {
-    return model;
+    return model && model->isResident() ? model : nullptr;
 }
 
 void engine::Entity::updateWorldTransform(const glm::mat4& parentWorld) {
@@ -121,12 +128,14 @@ void engine::Entity::addChild(Entity* child) {
     entityManager->removeRootEntry(child);
     children.push_back(child);
     child->setParent(this);
+    entityManager->markRenderProxiesDirty();
 }
 
 void engine::Entity::removeChild(Entity* child) {
     std::erase(children, child);
     child->setParent(nullptr);
     entityManager->addRootEntry(child);
+    entityManager->markRenderProxiesDirty();
 }
 
 void engine::Entity::setIsMovable(bool isMovable) { 
@@ -144,8 +153,9 @@ void engine::Entity::ensureUniformBuffers(Renderer* renderer, GraphicsShader* sh
         return;
     }
     const size_t frames = static_cast<size_t>(renderer->getFramesInFlight());
-    const size_t requiredStride = static_cast<size_t>(shader->config.vertexBitBindings);
-    if (requiredStride == 0 || frames == 0) {
+    // one joint matrix UBO per frame for shaders that bind per-entity sets
+    const size_t requiredStride = 1;
+    if (frames == 0) {
         destroyUniformBuffers(renderer);
         return;
     }
@@ -209,6 +219,14 @@ void engine::Entity::destroyUniformBuffers(Renderer* renderer) {
 }
 
 void engine::Entity::playAnimation(const std::string& animationName, bool loop, float speed) {
+    if (model && !model->isResident()) {
+        // clips aren't known yet, keep the request and let updateAnimation resolve it once the model streams in
+        animState.currentAnimation = animationName;
+        animState.currentTime = 0.0f;
+        animState.looping = loop;
+        animState.playbackSpeed = speed;
+        return;
+    }
     if (!model || !model->hasAnimations()) return;
     const engine::Model::AnimationClip* clip = model->getAnimation(animationName);
     if (!clip) {
@@ -229,7 +247,7 @@ void engine::Entity::playAnimation(const std::string& animationName, bool loop,
     }
 }
 
-static inline size_t findKeyIndex(const std::vector<float>& times, float t, size_t cachedIdx) {
+static inline size_t findKeyIndex(std::span<const float> times, float t, size_t cachedIdx) {
     const size_t n = times.size();
     if (n == 0) return 0;
     if (cachedIdx < n) {
@@ -248,7 +266,7 @@ static inline size_t findKeyIndex(const std::vector<float>& times, float t, size
 }
 
 void engine::Entity::updateAnimation(float deltaTime) {
-    if (!model || !model->hasAnimations() || animState.currentAnimation.empty()) return;
+    if (!isAnimated()) return;
     const engine::Model::AnimationClip* clip = model->getAnimation(animState.currentAnimation);
     if (!clip) return;
     const std::vector<engine::Model::Joint>& skeleton = model->getSkeleton();
@@ -429,6 +447,7 @@ void engine::Entity::updateAnimation(float deltaTime) {
 
 void engine::Entity::setTextures(const std::vector<std::string>& textures) {
     this->textures = textures;
+    materialId = kInvalidMaterialId;
     getEntityManager()->markTexturesDirty();
 }
 
@@ -442,6 +461,9 @@ engine::EntityManager::EntityManager(
 engine::EntityManager::~EntityManager() {
     clear();
     destroyDummySkinningBuffer();
+    destroyMaterialTable();
+    destroyDepthPyramid();
+    destroyInstanceBuffers();
 }
 
 void engine::EntityManager::createDummySkinningBuffer() {
@@ -478,6 +500,416 @@ void engine::EntityManager::destroyDummySkinningBuffer() {
     }
 }
 
+void engine::EntityManager::createInstanceBuffers() {
+    const size_t frames = static_cast<size_t>(renderer->getFramesInFlight());
+    // every lod of a mesh gets its own instance range and batch, once for the early and once for the late draws,
+    // then once per shadow caster entry
+    constexpr VkDeviceSize DRAW_SLOTS = kGBufferDrawSlots + kShadowDrawSlots;
+    constexpr VkDeviceSize INSTANCE_BUFFER_SIZE = DRAW_SLOTS * sizeof(GBufferInstance);
+    constexpr VkDeviceSize JOINT_PALETTE_SIZE = kMaxJointPaletteMatrices * sizeof(glm::mat4);
+    constexpr VkDeviceSize CULL_INPUT_BUFFER_SIZE = (kMaxGBufferInstances + kMaxShadowCasterInstances) * sizeof(GBufferCullInput);
+    constexpr VkDeviceSize DRAW_BATCH_BUFFER_SIZE = DRAW_SLOTS * sizeof(GBufferDrawBatch);
+    constexpr VkDeviceSize DRAW_COMMAND_BUFFER_SIZE = DRAW_SLOTS * sizeof(GBufferDrawCommand);
+    constexpr VkDeviceSize DRAW_COUNT_BUFFER_SIZE = DRAW_SLOTS * sizeof(uint32_t);
+    constexpr VkDeviceSize OCCLUDED_INSTANCE_BUFFER_SIZE = (1 + kMaxGBufferInstances) * sizeof(uint32_t);
+    VkDevice device = renderer->getDevice();
+    instanceBuffers.resize(frames, VK_NULL_HANDLE);
+    instanceBuffersMemory.resize(frames, VK_NULL_HANDLE);
+    instanceBuffersMapped.resize(frames, nullptr);
+    jointPaletteBuffers.resize(frames, VK_NULL_HANDLE);
+    jointPaletteBuffersMemory.resize(frames, VK_NULL_HANDLE);
+    jointPaletteBuffersMapped.resize(frames, nullptr);
+    cullInputBuffers.resize(frames, VK_NULL_HANDLE);
+    cullInputBuffersMemory.resize(frames, VK_NULL_HANDLE);
+    cullInputBuffersMapped.resize(frames, nullptr);
+    drawBatchBuffers.resize(frames, VK_NULL_HANDLE);
+    drawBatchBuffersMemory.resize(frames, VK_NULL_HANDLE);
+    drawBatchBuffersMapped.resize(frames, nullptr);
+    drawCommandBuffers.resize(frames, VK_NULL_HANDLE);
+    drawCommandBuffersMemory.resize(frames, VK_NULL_HANDLE);
+    drawCommandBuffersMapped.resize(frames, nullptr);
+    drawCountBuffers.resize(frames, VK_NULL_HANDLE);
+    drawCountBuffersMemory.resize(frames, VK_NULL_HANDLE);
+    drawCountBuffersMapped.resize(frames, nullptr);
+    occludedInstanceBuffers.resize(frames, VK_NULL_HANDLE);
+    occludedInstanceBuffersMemory.resize(frames, VK_NULL_HANDLE);
+    occludedInstanceBuffersMapped.resize(frames, nullptr);
+    for (size_t frame = 0; frame < frames; ++frame) {
+        std::tie(instanceBuffers[frame], instanceBuffersMemory[frame]) = renderer->createBuffer(
+            INSTANCE_BUFFER_SIZE,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        );
+        if (vkMapMemory(device, instanceBuffersMemory[frame], 0, INSTANCE_BUFFER_SIZE, 0, &instanceBuffersMapped[frame]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to map gbuffer instance buffer!");
+        }
+        std::tie(jointPaletteBuffers[frame], jointPaletteBuffersMemory[frame]) = renderer->createBuffer(
+            JOINT_PALETTE_SIZE,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        );
+        if (vkMapMemory(device, jointPaletteBuffersMemory[frame], 0, JOINT_PALETTE_SIZE, 0, &jointPaletteBuffersMapped[frame]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to map joint palette buffer!");
+        }
+        std::tie(cullInputBuffers[frame], cullInputBuffersMemory[frame]) = renderer->createBuffer(
+            CULL_INPUT_BUFFER_SIZE,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        );
+        if (vkMapMemory(device, cullInputBuffersMemory[frame], 0, CULL_INPUT_BUFFER_SIZE, 0, &cullInputBuffersMapped[frame]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to map gbuffer cull input buffer!");
+        }
+        std::tie(drawBatchBuffers[frame], drawBatchBuffersMemory[frame]) = renderer->createBuffer(
+            DRAW_BATCH_BUFFER_SIZE,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        );
+        if (vkMapMemory(device, drawBatchBuffersMemory[frame], 0, DRAW_BATCH_BUFFER_SIZE, 0, &drawBatchBuffersMapped[frame]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to map gbuffer draw batch buffer!");
+        }
+        std::tie(drawCommandBuffers[frame], drawCommandBuffersMemory[frame]) = renderer->createBuffer(
+            DRAW_COMMAND_BUFFER_SIZE,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        );
+        if (vkMapMemory(device, drawCommandBuffersMemory[frame], 0, DRAW_COMMAND_BUFFER_SIZE, 0, &drawCommandBuffersMapped[frame]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to map gbuffer draw command buffer!");
+        }
+        std::tie(drawCountBuffers[frame], drawCountBuffersMemory[frame]) = renderer->createBuffer(
+            DRAW_COUNT_BUFFER_SIZE,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        );
+        if (vkMapMemory(device, drawCountBuffersMemory[frame], 0, DRAW_COUNT_BUFFER_SIZE, 0, &drawCountBuffersMapped[frame]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to map gbuffer draw count buffer!");
+        }
+        std::tie(occludedInstanceBuffers[frame], occludedInstanceBuffersMemory[frame]) = renderer->createBuffer(
+            OCCLUDED_INSTANCE_BUFFER_SIZE,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        );
+        if (vkMapMemory(device, occludedInstanceBuffersMemory[frame], 0, OCCLUDED_INSTANCE_BUFFER_SIZE, 0, &occludedInstanceBuffersMapped[frame]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to map gbuffer occluded instance buffer!");
+        }
+    }
+}
+
+engine::EntityManager::MappedCullBuffers engine::EntityManager::getMappedCullBuffers(uint32_t frame) const {
+    if (frame >= instanceBuffersMapped.size()) {
+        return {};
+    }
+    return {
+        .cullInputs = static_cast<GBufferCullInput*>(cullInputBuffersMapped[frame]),
+        .instances = static_cast<GBufferInstance*>(instanceBuffersMapped[frame]),
+        .batches = static_cast<GBufferDrawBatch*>(drawBatchBuffersMapped[frame]),
+        .commands = static_cast<GBufferDrawCommand*>(drawCommandBuffersMapped[frame]),
+        .drawCounts = static_cast<uint32_t*>(drawCountBuffersMapped[frame])
+    };
+}
+
+void engine::EntityManager::destroyInstanceBuffers() {
+    VkDevice device = renderer->getDevice();
+    auto destroy = [&](std::vector<VkBuffer>& buffers, std::vector<VkDeviceMemory>& memories, std::vector<void*>& mapped) {
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            if (mapped[i] != nullptr) {
+                vkUnmapMemory(device, memories[i]);
+            }
+            if (buffers[i] != VK_NULL_HANDLE) {
+                vkDestroyBuffer(device, buffers[i], nullptr);
+            }
+            if (memories[i] != VK_NULL_HANDLE) {
+                vkFreeMemory(device, memories[i], nullptr);
+            }
+        }
+        buffers.clear();
+        memories.clear();
+        mapped.clear();
+    };
+    destroy(instanceBuffers, instanceBuffersMemory, instanceBuffersMapped);
+    destroy(jointPaletteBuffers, jointPaletteBuffersMemory, jointPaletteBuffersMapped);
+    destroy(cullInputBuffers, cullInputBuffersMemory, cullInputBuffersMapped);
+    destroy(drawBatchBuffers, drawBatchBuffersMemory, drawBatchBuffersMapped);
+    destroy(drawCommandBuffers, drawCommandBuffersMemory, drawCommandBuffersMapped);
+    destroy(drawCountBuffers, drawCountBuffersMemory, drawCountBuffersMapped);
+    destroy(occludedInstanceBuffers, occludedInstanceBuffersMemory, occludedInstanceBuffersMapped);
+}
+
+void engine::EntityManager::createMaterialTable() {
+    GraphicsShader* shader = renderer->getShaderManager()->getGraphicsShader("gbuffer");
+    if (!shader) return;
+    constexpr VkDeviceSize MATERIAL_BUFFER_SIZE = kMaxGBufferMaterials * sizeof(GBufferMaterial);
+    VkDevice device = renderer->getDevice();
+    std::tie(materialBuffer, materialBufferMemory) = renderer->createBuffer(
+        MATERIAL_BUFFER_SIZE,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    );
+    if (vkMapMemory(device, materialBufferMemory, 0, MATERIAL_BUFFER_SIZE, 0, &materialBufferMapped) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to map material buffer!");
+    }
+    // texture samplers only differ in maxLod, so one unclamped sampler covers every material
+    materialSampler = renderer->createTextureSampler(
+        VK_FILTER_LINEAR,
+        VK_FILTER_LINEAR,
+        VK_SAMPLER_MIPMAP_MODE_LINEAR,
+        VK_SAMPLER_ADDRESS_MODE_REPEAT,
+        VK_SAMPLER_ADDRESS_MODE_REPEAT,
+        VK_SAMPLER_ADDRESS_MODE_REPEAT,
+        0.0f,
+        VK_TRUE,
+        16.0f,
+        VK_FALSE,
+        VK_COMPARE_OP_ALWAYS,
+        0.0f,
+        VK_LOD_CLAMP_NONE,
+        VK_BORDER_COLOR_INT_OPAQUE_BLACK,
+        VK_FALSE
+    );
+    std::vector<VkBuffer> frameBuffers;
+    frameBuffers.reserve(instanceBuffers.size() * 3);
+    for (size_t frame = 0; frame < instanceBuffers.size(); ++frame) {
+        frameBuffers.push_back(instanceBuffers[frame]);
+        frameBuffers.push_back(jointPaletteBuffers[frame]);
+        frameBuffers.push_back(materialBuffer);
+    }
+    std::vector<Texture*> noTextures;
+    materialDescriptorSets = shader->createDescriptorSets(renderer, noTextures, frameBuffers);
+    const VkDescriptorImageInfo samplerInfo = { .sampler = materialSampler };
+    std::vector<VkWriteDescriptorSet> samplerWrites;
+    samplerWrites.reserve(materialDescriptorSets.size());
+    for (VkDescriptorSet set : materialDescriptorSets) {
+        samplerWrites.push_back({
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = set,
+            .dstBinding = 4,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER,
+            .pImageInfo = &samplerInfo
+        });
+    }
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(samplerWrites.size()), samplerWrites.data(), 0, nullptr);
+}
+
+void engine::EntityManager::destroyMaterialTable() {
+    VkDevice device = renderer->getDevice();
+    if (!materialDescriptorSets.empty()) {
+        GraphicsShader* shader = renderer->getShaderManager()->getGraphicsShader("gbuffer");
+        if (shader && shader->descriptorPool != VK_NULL_HANDLE) {
+            vkFreeDescriptorSets(device, shader->descriptorPool,
+                static_cast<uint32_t>(materialDescriptorSets.size()), materialDescriptorSets.data());
+        }
+        materialDescriptorSets.clear();
+    }
+    if (materialSampler != VK_NULL_HANDLE) {
+        vkDestroySampler(device, materialSampler, nullptr);
+        materialSampler = VK_NULL_HANDLE;
+    }
+    if (materialBufferMapped != nullptr) {
+        vkUnmapMemory(device, materialBufferMemory);
+        materialBufferMapped = nullptr;
+    }
+    if (materialBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, materialBuffer, nullptr);
+        materialBuffer = VK_NULL_HANDLE;
+    }
+    if (materialBufferMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(device, materialBufferMemory, nullptr);
+        materialBufferMemory = VK_NULL_HANDLE;
+    }
+    materialIds.clear();
+    bindlessTextureSlots.clear();
+}
+
+uint32_t engine::EntityManager::registerMaterial(const std::vector<Texture*>& textures) {
+    std::string materialKey;
+    for (Texture* texture : textures) {
+        materialKey += std::to_string(reinterpret_cast<uintptr_t>(texture));
+        materialKey += ';';
+    }
+    auto it = materialIds.find(materialKey);
+    if (it != materialIds.end()) {
+        return it->second;
+    }
+    if (materialIds.size() >= kMaxGBufferMaterials) {
+        std::cout << std::format("Warning: Material limit of {} reached. Using material 0 instead.\n", kMaxGBufferMaterials);
+        return 0;
+    }
+    const uint32_t materialId = static_cast<uint32_t>(materialIds.size());
+    static_cast<GBufferMaterial*>(materialBufferMapped)[materialId] = {
+        .albedo = registerBindlessTexture(textures[0]),
+        .metallic = registerBindlessTexture(textures[1]),
+        .roughness = registerBindlessTexture(textures[2]),
+        .normal = registerBindlessTexture(textures[3])
+    };
+    materialIds.emplace(std::move(materialKey), materialId);
+    return materialId;
+}
+
+uint32_t engine::EntityManager::registerBindlessTexture(Texture* texture) {
+    auto it = bindlessTextureSlots.find(texture);
+    if (it != bindlessTextureSlots.end()) {
+        return it->second;
+    }
+    if (bindlessTextureSlots.size() >= kMaxBindlessTextures) {
+        std::cout << std::format("Warning: Bindless texture limit of {} reached. Using slot 0 for texture {}.\n", kMaxBindlessTextures, texture->name);
+        return 0;
+    }
+    const uint32_t slot = static_cast<uint32_t>(bindlessTextureSlots.size());
+    // the slot is unused by frames in flight, so it can be written while they are pending
+    const VkDescriptorImageInfo imageInfo = {
+        .sampler = VK_NULL_HANDLE,
+        .imageView = texture->imageView,
+        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+    std::vector<VkWriteDescriptorSet> writes;
+    writes.reserve(materialDescriptorSets.size());
+    for (VkDescriptorSet set : materialDescriptorSets) {
+        writes.push_back({
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = set,
+            .dstBinding = 3,
+            .dstArrayElement = slot,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+            .pImageInfo = &imageInfo
+        });
+    }
+    vkUpdateDescriptorSets(renderer->getDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    bindlessTextureSlots.emplace(texture, slot);
+    return slot;
+}
+
+void engine::EntityManager::ensureDepthPyramid() {
+    const VkExtent2D extent = renderer->getRenderExtent();
+    if (depthPyramidImage != VK_NULL_HANDLE
+        && depthPyramidSourceExtent.width == extent.width
+        && depthPyramidSourceExtent.height == extent.height) {
+        return;
+    }
+    destroyDepthPyramid();
+    ComputeShader* shader = renderer->getShaderManager()->getComputeShader("depthpyramid");
+    VkImageView depthView = renderer->getPassImageView("gbuffer", "Depth");
+    if (!shader || shader->descriptorPool == VK_NULL_HANDLE || depthView == VK_NULL_HANDLE || extent.width == 0 || extent.height == 0) {
+        return;
+    }
+    VkDevice device = renderer->getDevice();
+    // mip 0 is already a 2x2 reduction of the depth buffer
+    const uint32_t width = (extent.width + 1u) / 2u;
+    const uint32_t height = (extent.height + 1u) / 2u;
+    uint32_t mipLevels = 1;
+    while (mipLevels < kMaxDepthPyramidMips && (std::max(width, height) >> mipLevels) > 0u) {
+        ++mipLevels;
+    }
+    std::tie(depthPyramidImage, depthPyramidMemory) = renderer->createImage(
+        width,
+        height,
+        mipLevels,
+        VK_SAMPLE_COUNT_1_BIT,
+        VK_FORMAT_R32_SFLOAT,
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        1
+    );
+    depthPyramidView = renderer->createImageView(depthPyramidImage, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels);
+    depthPyramidMipViews.resize(mipLevels, VK_NULL_HANDLE);
+    for (uint32_t mip = 0; mip < mipLevels; ++mip) {
+        VkImageViewCreateInfo viewInfo = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .image = depthPyramidImage,
+            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .format = VK_FORMAT_R32_SFLOAT,
+            .subresourceRange = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel = mip,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+            }
+        };
+        if (vkCreateImageView(device, &viewInfo, nullptr, &depthPyramidMipViews[mip]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create depth pyramid mip view!");
+        }
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(mipLevels, shader->descriptorSetLayout);
+    VkDescriptorSetAllocateInfo allocInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = shader->descriptorPool,
+        .descriptorSetCount = mipLevels,
+        .pSetLayouts = layouts.data()
+    };
+    depthPyramidSets.resize(mipLevels, VK_NULL_HANDLE);
+    if (vkAllocateDescriptorSets(device, &allocInfo, depthPyramidSets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate depth pyramid descriptor sets!");
+    }
+    std::vector<VkDescriptorImageInfo> imageInfos;
+    imageInfos.reserve(mipLevels * 2u);
+    std::vector<VkWriteDescriptorSet> writes;
+    writes.reserve(mipLevels * 2u);
+    for (uint32_t mip = 0; mip < mipLevels; ++mip) {
+        imageInfos.push_back(mip == 0
+            ? VkDescriptorImageInfo{ .imageView = depthView, .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }
+            : VkDescriptorImageInfo{ .imageView = depthPyramidMipViews[mip - 1], .imageLayout = VK_IMAGE_LAYOUT_GENERAL });
+        writes.push_back({
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = depthPyramidSets[mip],
+            .dstBinding = 0,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+            .pImageInfo = &imageInfos.back()
+        });
+        imageInfos.push_back({ .imageView = depthPyramidMipViews[mip], .imageLayout = VK_IMAGE_LAYOUT_GENERAL });
+        writes.push_back({
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = depthPyramidSets[mip],
+            .dstBinding = 1,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .pImageInfo = &imageInfos.back()
+        });
+    }
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    depthPyramidSourceExtent = extent;
+}
+
+void engine::EntityManager::destroyDepthPyramid() {
+    VkDevice device = renderer->getDevice();
+    if (!depthPyramidSets.empty()) {
+        ComputeShader* shader = renderer->getShaderManager()->getComputeShader("depthpyramid");
+        if (shader && shader->descriptorPool != VK_NULL_HANDLE) {
+            vkFreeDescriptorSets(device, shader->descriptorPool,
+                static_cast<uint32_t>(depthPyramidSets.size()), depthPyramidSets.data());
+        }
+        depthPyramidSets.clear();
+    }
+    for (VkImageView view : depthPyramidMipViews) {
+        if (view != VK_NULL_HANDLE) {
+            vkDestroyImageView(device, view, nullptr);
+        }
+    }
+    depthPyramidMipViews.clear();
+    if (depthPyramidView != VK_NULL_HANDLE) {
+        vkDestroyImageView(device, depthPyramidView, nullptr);
+        depthPyramidView = VK_NULL_HANDLE;
+    }
+    if (depthPyramidImage != VK_NULL_HANDLE) {
+        vkDestroyImage(device, depthPyramidImage, nullptr);
+        depthPyramidImage = VK_NULL_HANDLE;
+    }
+    if (depthPyramidMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(device, depthPyramidMemory, nullptr);
+        depthPyramidMemory = VK_NULL_HANDLE;
+    }
+    depthPyramidSourceExtent = { 0, 0 };
+    depthPyramidInitialized = false;
+    depthPyramidPending = false;
+    occlusionCullEnabled = false;
+}
+
 void engine::EntityManager::addEntity(const std::string& name, Entity* entity) {
     pendingAdditions.push_back(std::make_pair(name, entity));
 }
@@ -490,10 +922,11 @@ static std::unordered_set<engine::Entity::EntityType> wontResetShadows = {
 };
 
 void engine::EntityManager::processPendingAdditions() {
-    bool resetShadows = false;
+    LightManager* lightManager = getRenderer()->getLightManager();
     if (!pendingAdditions.empty()) {
         textureLoadDirty = true;
         renderable3DCacheDirty = true;
+        renderProxiesDirty = true;
     }
     for (const auto& [name, entity] : pendingAdditions) {
         entities[name] = entity;
@@ -503,6 +936,9 @@ void engine::EntityManager::processPendingAdditions() {
         if (entities[name]->getParent() == nullptr) {
             addRootEntry(entity);
         }
+        if (!entity->getIsMovable() && lightManager) {
+            lightManager->markStaticCastersDirty();
+        }
         if (!entity->getIsMovable() && !wontResetShadows.contains(entity->getType())) {
             bool hasMovableParent = false;
             Entity* current = entity->getParent();
@@ -513,15 +949,13 @@ void engine::EntityManager::processPendingAdditions() {
                 }
                 current = current->getParent();
             }
-            resetShadows = !hasMovableParent;
+            // static casters only re-bake the lights that reach them, spread over frames
+            if (!hasMovableParent && lightManager) {
+                lightManager->invalidateStaticCaster(entity);
+            }
         }
     }
     pendingAdditions.clear();
-    if (resetShadows) {
-        getRenderer()->getLightManager()->createAllShadowMaps();
-        vkDeviceWaitIdle(renderer->getDevice());
-        renderer->createPostProcessDescriptorSets();
-    }
 }
 
 void engine::EntityManager::removeEntity(const std::string& name) {
@@ -552,17 +986,28 @@ void engine::EntityManager::unregisterEntity(const std::string& name) {
             spatialGrid.remove(collider);
             std::erase(colliders, collider);
         }
+        if (!entity->getIsMovable()) {
+            if (LightManager* lightManager = getRenderer()->getLightManager()) {
+                lightManager->markStaticCastersDirty();
+            }
+        }
         entities.erase(it);
+        renderProxiesDirty = true;
     }
 }
 
 void engine::EntityManager::clear() {
     renderable3DCacheDirty = true;
+    renderProxiesDirty = true;
+    renderProxies.clear();
+    depthPyramidPending = false;
     movableEntities.clear();
     colliders.clear();
     dynamicColliders.clear();
     spatialGrid.clear();
     entities.clear();
+    streamingMaterialEntities.clear();
+    streamingModelEntities.clear();
     pendingDeletions.clear();
     pendingAdditions.clear();
     auto roots = std::move(rootEntities);
@@ -576,8 +1021,12 @@ void engine::EntityManager::loadTextures() {
     if (dummySkinningBuffer == VK_NULL_HANDLE) {
         createDummySkinningBuffer();
     }
+    ensureInstanceBuffers();
+    if (materialDescriptorSets.empty()) {
+        createMaterialTable();
+    }
     for (auto& [name, entity] : entities) {
-        if (!entity->getDescriptorSets().empty()) continue;
+        if (!entity->getDescriptorSets().empty() || entity->hasMaterial()) continue;
         const std::vector<std::string>& textures = entity->getTextures();
         TextureManager* textureManager = renderer->getTextureManager();
         if (!textureManager) throw std::runtime_error("TextureManager not registered in Renderer");
@@ -589,16 +1038,26 @@ void engine::EntityManager::loadTextures() {
             }
             continue;
         }
+        // shadow-only entities are drawn from the shared caster instances and need no sets of their own
+        if (shader->name == "shadow") continue;
         std::vector<std::string> defaultTextures;
         if (shader->name == "gbuffer") {
-            defaultTextures = {
-                "materials_default_albedo", "materials_default_metallic", "materials_default_roughness", "materials_default_normal"
-            };
+            defaultTextures.assign(kDefaultMaterialTextures.begin(), kDefaultMaterialTextures.end());
         } else if (shader->name == "ui") {
             defaultTextures = { "ui_window" };
         }
+        bool awaitingStream = false;
         for (size_t i = 0; i < textures.size(); ++i) {
             Texture* found = textureManager->getTexture(textures[i]);
+            if (!found && textureManager->requestTexture(textures[i]) == AssetState::Pending) {
+                // bind the default until the real texture streams in
+                Texture* placeholder = i < defaultTextures.size() ? textureManager->getTexture(defaultTextures[i]) : nullptr;
+                if (placeholder) {
+                    awaitingStream = true;
+                    texturePtrs.push_back(placeholder);
+                    continue;
+                }
+            }
             if (!found && i < defaultTextures.size()) {
                 found = textureManager->getTexture(defaultTextures[i]);
                 if (found) {
@@ -635,38 +1094,92 @@ void engine::EntityManager::loadTextures() {
             return 1u;
         };
         size_t requiredTextures = 0;
-        for (size_t i = 0; i < static_cast<size_t>(fragmentBindings); ++i) {
-            VkDescriptorType type = getFragmentType(i);
-            if (type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER || type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE) {
-                requiredTextures += getFragmentCount(i);
+        if (shader->config.partiallyBoundTextures) {
+            requiredTextures = defaultTextures.size();
+        } else {
+            for (size_t i = 0; i < static_cast<size_t>(fragmentBindings); ++i) {
+                VkDescriptorType type = getFragmentType(i);
+                if (type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER || type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE) {
+                    requiredTextures += getFragmentCount(i);
+                }
             }
         }
         if (texturePtrs.size() < requiredTextures) {
             std::cout << std::format("Error: Not enough textures for Entity {}. Expected {} image bindings, got {}. Skipping descriptor set creation.\n", name, requiredTextures, texturePtrs.size());
             continue;
         }
+        // per-entity descriptor sets are not rewritten later, so wait for the real textures
+        if (awaitingStream && shader->name != "gbuffer") continue;
         entity->ensureUniformBuffers(renderer, shader);
-        entity->setDescriptorSets(shader->createDescriptorSets(renderer, texturePtrs, entity->getUniformBuffers()));
-        if (entity->getCastShadow() && !entity->getUniformBuffers().empty()) {
-            GraphicsShader* shadowShader = renderer->getShaderManager()->getGraphicsShader("shadow");
-            LightManager* lightManager = renderer->getLightManager();
-            if (shadowShader && lightManager && entity->getShadowDescriptorSets().empty()) {
-                lightManager->createShadowLightsBuffers();
-                auto& entityBuffers = entity->getUniformBuffers();
-                auto& shadowLightsBuffers = lightManager->getShadowLightsBuffers();
-                const size_t framesInFlight = std::min(entityBuffers.size(), shadowLightsBuffers.size());
-                if (framesInFlight > 0) {
-                    std::vector<VkBuffer> interleavedBuffers;
-                    interleavedBuffers.reserve(framesInFlight * 2);
-                    for (size_t frame = 0; frame < framesInFlight; ++frame) {
-                        interleavedBuffers.push_back(entityBuffers[frame]);
-                        interleavedBuffers.push_back(shadowLightsBuffers[frame]);
-                    }
-                    std::vector<Texture*> noTextures;
-                    entity->setShadowDescriptorSets(shadowShader->createDescriptorSets(renderer, noTextures, interleavedBuffers));
-                }
+        if (shader->name == "gbuffer") {
+            entity->setMaterialId(registerMaterial(texturePtrs));
+            if (awaitingStream) {
+                streamingMaterialEntities.push_back(name);
+            }
+            renderProxiesDirty = true;
+        } else {
+            entity->setDescriptorSets(shader->createDescriptorSets(renderer, texturePtrs, entity->getUniformBuffers()));
+        }
+    }
+}
+
+void engine::EntityManager::refreshStreamedModels() {
+    LightManager* lightManager = renderer->getLightManager();
+    bool staticChanged = false;
+    bool arrived = false;
+    std::erase_if(streamingModelEntities, [&](const std::string& name) {
+        auto it = entities.find(name);
+        if (it == entities.end()) return true;
+        Entity* entity = it->second;
+        if (!entity->getModel()) return false;
+        arrived = true;
+        if (!entity->getIsMovable()) {
+            // the bakes ran without it, re-bake only the faces it reaches
+            lightManager->invalidateStaticCaster(entity);
+        }
+        staticChanged |= entity->getType() == Entity::EntityType::Static;
+        return true;
+    });
+    if (!arrived) return;
+    // hull colliders load from their model on the next grid rebuild
+    renderProxiesDirty = true;
+    renderable3DCacheDirty = true;
+    spatialGridDirty = true;
+    if (staticChanged) {
+        renderer->getIrradianceManager()->setIrradianceBakingPending(true);
+    }
+}
+
+void engine::EntityManager::refreshStreamedMaterials() {
+    // entities skipped while their textures were pending get another pass
+    textureLoadDirty = true;
+    TextureManager* textureManager = renderer->getTextureManager();
+    bool staticChanged = false;
+    std::erase_if(streamingMaterialEntities, [&](const std::string& name) {
+        auto it = entities.find(name);
+        if (it == entities.end() || !it->second->hasMaterial()) return true;
+        Entity* entity = it->second;
+        const std::vector<std::string>& textures = entity->getTextures();
+        std::vector<Texture*> texturePtrs;
+        texturePtrs.reserve(kDefaultMaterialTextures.size());
+        for (size_t i = 0; i < kDefaultMaterialTextures.size(); ++i) {
+            Texture* found = nullptr;
+            if (i < textures.size()) {
+                found = textureManager->getTexture(textures[i]);
+                if (!found && textureManager->requestTexture(textures[i]) == AssetState::Pending) return false;
             }
+            if (!found) found = textureManager->getTexture(kDefaultMaterialTextures[i]);
+            if (!found) return true;
+            texturePtrs.push_back(found);
         }
+        entity->setMaterialId(registerMaterial(texturePtrs));
+        staticChanged |= entity->getType() == Entity::EntityType::Static;
+        renderProxiesDirty = true;
+        return true;
+    });
+    // baked probes saw the placeholders
+    if (staticChanged) {
+        renderer->getIrradianceManager()->setIrradianceBakingPending(true);
     }
 }
 
@@ -741,12 +1254,11 @@ bool engine::EntityManager::computeHasRenderable3D() const {
     return walk(walk, rootEntities);
 }
 
-bool engine::EntityManager::hasRenderable3D() {
+void engine::EntityManager::refreshRenderable3DCache() {
     if (renderable3DCacheDirty) {
         renderable3DCache = computeHasRenderable3D();
         renderable3DCacheDirty = false;
     }
-    return renderable3DCache;
 }
 
 void engine::EntityManager::processPendingDeletions() {
@@ -763,156 +1275,669 @@ void engine::EntityManager::processPendingDeletions() {
     }
 }
 
-void engine::EntityManager::renderEntities(VkCommandBuffer commandBuffer, uint32_t currentFrame, bool DEBUG_RENDER_LOGS) {
-    std::vector<Entity*>& rootEntities = getRootEntities();
+void engine::EntityManager::uploadJointMatrices(uint32_t currentFrame) {
+    // written once per frame before recording so gbuffer and shadow recording only read
+    glm::mat4* palette = currentFrame < jointPaletteBuffersMapped.size()
+        ? static_cast<glm::mat4*>(jointPaletteBuffersMapped[currentFrame])
+        : nullptr;
+    uint32_t paletteCursor = 0;
+    auto upload = [&](auto& self, Entity* entity) -> void {
+        entity->setJointPaletteOffset(UINT32_MAX);
+        if (entity->isAnimated()) {
+            const auto& jointMatrices = entity->getJointMatrices();
+            auto& uniformBuffers = entity->getUniformBuffers();
+            auto& uniformBuffersMapped = entity->getUniformBuffersMapped();
+            if (!jointMatrices.empty()
+             && currentFrame < uniformBuffers.size()
+             && currentFrame < uniformBuffersMapped.size()
+             && uniformBuffers[currentFrame] != VK_NULL_HANDLE
+             && uniformBuffersMapped[currentFrame] != nullptr
+            ) {
+                memcpy(uniformBuffersMapped[currentFrame], jointMatrices.data(), jointMatrices.size() * sizeof(glm::mat4));
+            }
+            const uint32_t jointCount = static_cast<uint32_t>(jointMatrices.size());
+            if (palette && jointCount > 0 && paletteCursor + jointCount <= kMaxJointPaletteMatrices) {
+                memcpy(palette + paletteCursor, jointMatrices.data(), jointCount * sizeof(glm::mat4));
+                entity->setJointPaletteOffset(paletteCursor);
+                paletteCursor += jointCount;
+            }
+        }
+        for (Entity* child : entity->getChildren()) {
+            self(self, child);
+        }
+    };
+    for (Entity* root : rootEntities) {
+        upload(upload, root);
+    }
+}
+
+void engine::EntityManager::prepareDepthPyramid() {
     Camera* camera = getCamera();
-    if (!camera) {
-        std::cout << "Warning: No camera set in EntityManager. Skipping entity rendering.\n";
-        return;
+    // last frame's pyramid is only trusted when it was rendered from the same camera
+    occlusionCullEnabled = depthPyramidPending && camera != nullptr && camera == depthPyramidCamera;
+    occlusionViewProj = depthPyramidViewProj;
+    depthPyramidPending = depthPyramidImage != VK_NULL_HANDLE && camera != nullptr && hasRenderable3D();
+    depthPyramidCamera = camera;
+    if (camera) {
+        depthPyramidViewProj = camera->getProjectionMatrix() * camera->getViewMatrix();
     }
-    ShaderManager* shaderManager = renderer->getShaderManager();
-    GraphicsShader* shader = shaderManager->getGraphicsShader("gbuffer");
-    if (!shader) return;
+}
+
+void engine::EntityManager::buildDepthPyramid(VkCommandBuffer commandBuffer, uint32_t currentFrame) {
+    ComputeShader* shader = renderer->getShaderManager()->getComputeShader("depthpyramid");
+    if (!shader || shader->pipeline == VK_NULL_HANDLE || depthPyramidSets.empty()) return;
+    const uint32_t mipLevels = static_cast<uint32_t>(depthPyramidSets.size());
 
-    auto updateJointMatricesUBO = [&](Entity* entity) {
-        if (!entity->isAnimated()) return;
-        const auto& jointMatrices = entity->getJointMatrices();
-        if (jointMatrices.empty()) return;
-        auto& uniformBuffers = entity->getUniformBuffers();
-        if (uniformBuffers.empty()) return;
-        const size_t stride = 1;
-        const size_t bufferIndex = currentFrame * stride + 0;
-        if (bufferIndex >= uniformBuffers.size()) return;
-        VkBuffer buffer = uniformBuffers[bufferIndex];
-        if (buffer == VK_NULL_HANDLE) return;
-        memcpy(entity->getUniformBuffersMapped()[bufferIndex], jointMatrices.data(), jointMatrices.size() * sizeof(glm::mat4));
+    // the early cull of this frame reads the previous pyramid
+    VkImageMemoryBarrier toWrite = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_READ_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .oldLayout = depthPyramidInitialized ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout = VK_IMAGE_LAYOUT_GENERAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = depthPyramidImage,
+        .subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, 0, 1 }
     };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        0, nullptr,
+        0, nullptr,
+        1, &toWrite
+    );
+    depthPyramidInitialized = true;
 
-    // separate into cullables and alwaysVisible (animated)
-    static thread_local std::vector<Entity*> cullables;
-    static thread_local std::vector<float> aabbMinX, aabbMinY, aabbMinZ;
-    static thread_local std::vector<float> aabbMaxX, aabbMaxY, aabbMaxZ;
-    static thread_local std::vector<uint8_t> visible;
-    static thread_local std::vector<Entity*> alwaysVisible;
-    cullables.clear();
-    aabbMinX.clear(); aabbMinY.clear(); aabbMinZ.clear();
-    aabbMaxX.clear(); aabbMaxY.clear(); aabbMaxZ.clear();
-    alwaysVisible.clear();
-
-    auto computeWorldAABB = [](const AABB& local, const glm::mat4& world) -> AABB {
-        const glm::vec3 corners[8] = {
-            {local.min.x, local.min.y, local.min.z},
-            {local.max.x, local.min.y, local.min.z},
-            {local.min.x, local.max.y, local.min.z},
-            {local.max.x, local.max.y, local.min.z},
-            {local.min.x, local.min.y, local.max.z},
-            {local.max.x, local.min.y, local.max.z},
-            {local.min.x, local.max.y, local.max.z},
-            {local.max.x, local.max.y, local.max.z}
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, shader->pipeline);
+    glm::uvec2 srcSize(depthPyramidSourceExtent.width, depthPyramidSourceExtent.height);
+    for (uint32_t mip = 0; mip < mipLevels; ++mip) {
+        const glm::uvec2 dstSize = glm::max((srcSize + 1u) / 2u, glm::uvec2(1u));
+        vkCmdBindDescriptorSets(
+            commandBuffer,
+            VK_PIPELINE_BIND_POINT_COMPUTE,
+            shader->pipelineLayout,
+            0,
+            1,
+            &depthPyramidSets[mip],
+            0,
+            nullptr
+        );
+        DepthPyramidPC pc = {
+            .srcSize = srcSize,
+            .dstSize = dstSize
         };
-        glm::vec3 mn(std::numeric_limits<float>::max());
-        glm::vec3 mx(std::numeric_limits<float>::lowest());
-        for (const glm::vec3& c : corners) {
-            const glm::vec3 wc = glm::vec3(world * glm::vec4(c, 1.0f));
-            mn = glm::min(mn, wc);
-            mx = glm::max(mx, wc);
-        }
-        return {mn, mx};
-    };
+        vkCmdPushConstants(commandBuffer, shader->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(DepthPyramidPC), &pc);
+        vkCmdDispatch(commandBuffer, (dstSize.x + 7u) / 8u, (dstSize.y + 7u) / 8u, 1u);
 
+        // each mip feeds the next reduction, the finished pyramid feeds the late re-test and next frame's cull
+        VkImageMemoryBarrier toRead = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_GENERAL,
+            .newLayout = VK_IMAGE_LAYOUT_GENERAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = depthPyramidImage,
+            .subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, mip, 1, 0, 1 }
+        };
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0,
+            0, nullptr,
+            0, nullptr,
+            1, &toRead
+        );
+        srcSize = dstSize;
+    }
+}
+
+void engine::EntityManager::rebuildRenderProxies() {
+    renderProxies.clear();
     auto collect = [&](auto& self, Entity* entity) -> void {
         Model* model = entity->getModel();
-        if (model && entity->isVisible()) {
-            if (entity->isAnimated()) {
-                alwaysVisible.push_back(entity);
-            } else {
-                const AABB world = computeWorldAABB(model->getAABB(), entity->getWorldTransform());
-                cullables.push_back(entity);
-                aabbMinX.push_back(world.min.x);
-                aabbMinY.push_back(world.min.y);
-                aabbMinZ.push_back(world.min.z);
-                aabbMaxX.push_back(world.max.x);
-                aabbMaxY.push_back(world.max.y);
-                aabbMaxZ.push_back(world.max.z);
-            }
+        if (model && entity->hasMaterial()) {
+            renderProxies.push_back({ entity, model, entity->getMaterialId(), entity->getTransformGeneration(), model->hasSkinning() });
         }
         for (Entity* child : entity->getChildren()) {
             self(self, child);
         }
     };
-    for (Entity* root : rootEntities) {
+    for (Entity* root : getRootEntities()) {
         collect(collect, root);
     }
+    // materials are bindless and read per instance, so proxies of a mesh only need to be adjacent
+    std::sort(renderProxies.begin(), renderProxies.end(), [](const RenderProxy& a, const RenderProxy& b) {
+        if (a.model != b.model) return std::less<Model*>()(a.model, b.model);
+        return a.materialId < b.materialId;
+    });
+    const size_t count = renderProxies.size();
+    proxyMinX.resize(count); proxyMinY.resize(count); proxyMinZ.resize(count);
+    proxyMaxX.resize(count); proxyMaxY.resize(count); proxyMaxZ.resize(count);
+    renderProxiesDirty = false;
+    updateRenderProxyBounds(true);
+}
 
-    // SIMD batched frustum cull for all cullables
-    visible.assign(cullables.size(), 0);
-    if (!cullables.empty()) {
-        const auto& planes4 = camera->getFrustumPlanes();
-        engine::simd::Plane planes[6];
-        for (int i = 0; i < 6; ++i) {
-            planes[i] = { planes4[i].x, planes4[i].y, planes4[i].z, planes4[i].w };
+void engine::EntityManager::updateRenderProxyBounds(bool all) {
+    static thread_local std::vector<uint32_t> dirty;
+    static thread_local std::vector<float> localMinX, localMinY, localMinZ;
+    static thread_local std::vector<float> localMaxX, localMaxY, localMaxZ;
+    static thread_local std::vector<glm::mat4> matrices;
+    static thread_local std::vector<float> worldMinX, worldMinY, worldMinZ;
+    static thread_local std::vector<float> worldMaxX, worldMaxY, worldMaxZ;
+    dirty.clear();
+    for (uint32_t p = 0; p < static_cast<uint32_t>(renderProxies.size()); ++p) {
+        RenderProxy& proxy = renderProxies[p];
+        const uint32_t generation = proxy.entity->getTransformGeneration();
+        if (all || generation != proxy.transformGeneration) {
+            proxy.transformGeneration = generation;
+            dirty.push_back(p);
         }
-        engine::simd::cullAABBsAgainstFrustum(
-            aabbMinX.data(), aabbMinY.data(), aabbMinZ.data(),
-            aabbMaxX.data(), aabbMaxY.data(), aabbMaxZ.data(),
-            cullables.size(),
-            planes,
-            visible.data());
     }
+    if (dirty.empty()) return;
 
-    // render visible cullables, then alwaysVisible (animated) entities
-    auto drawOne = [&](Entity* entity) {
-        Model* model = entity->getModel();
-        updateJointMatricesUBO(entity);
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->pipeline);
-        VkBuffer vertexBuffers[] = { model->getVertexBuffer().first };
-        VkDeviceSize offsets[] = { 0 };
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-        vkCmdBindIndexBuffer(commandBuffer, model->getIndexBuffer().first, 0, VK_INDEX_TYPE_UINT32);
-        if (model->hasSkinning()) {
-            VkBuffer skinBuffers[] = { model->getSkinningBuffer().first };
-            vkCmdBindVertexBuffers(commandBuffer, 1, 1, skinBuffers, offsets);
-        } else {
-            VkBuffer dummyBuffers[] = { dummySkinningBuffer };
-            vkCmdBindVertexBuffers(commandBuffer, 1, 1, dummyBuffers, offsets);
+    const size_t count = dirty.size();
+    localMinX.resize(count); localMinY.resize(count); localMinZ.resize(count);
+    localMaxX.resize(count); localMaxY.resize(count); localMaxZ.resize(count);
+    matrices.resize(count);
+    worldMinX.resize(count); worldMinY.resize(count); worldMinZ.resize(count);
+    worldMaxX.resize(count); worldMaxY.resize(count); worldMaxZ.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const RenderProxy& proxy = renderProxies[dirty[i]];
+        const AABB& local = proxy.model->getAABB();
+        localMinX[i] = local.min.x; localMinY[i] = local.min.y; localMinZ[i] = local.min.z;
+        localMaxX[i] = local.max.x; localMaxY[i] = local.max.y; localMaxZ[i] = local.max.z;
+        matrices[i] = proxy.entity->getWorldTransform();
+    }
+    static_assert(sizeof(glm::mat4) == 16 * sizeof(float), "glm::mat4 must be tightly packed for transformAABBs");
+    engine::simd::transformAABBs(
+        localMinX.data(), localMinY.data(), localMinZ.data(),
+        localMaxX.data(), localMaxY.data(), localMaxZ.data(),
+        reinterpret_cast<const float*>(matrices.data()),
+        count,
+        worldMinX.data(), worldMinY.data(), worldMinZ.data(),
+        worldMaxX.data(), worldMaxY.data(), worldMaxZ.data());
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t p = dirty[i];
+        proxyMinX[p] = worldMinX[i]; proxyMinY[p] = worldMinY[i]; proxyMinZ[p] = worldMinZ[i];
+        proxyMaxX[p] = worldMaxX[i]; proxyMaxY[p] = worldMaxY[i]; proxyMaxZ[p] = worldMaxZ[i];
+    }
+}
+
+// proxies, batches and cull inputs are written on the main thread before recording, cullEntities only records
+void engine::EntityManager::prepareCull(uint32_t currentFrame) {
+    modelDraws.clear();
+    earlyCullPending = false;
+    lateCullPending = false;
+    Camera* camera = getCamera();
+    if (!camera) return;
+    GBufferCullInput* cullInputs = currentFrame < cullInputBuffersMapped.size()
+        ? static_cast<GBufferCullInput*>(cullInputBuffersMapped[currentFrame])
+        : nullptr;
+    GBufferDrawBatch* batches = currentFrame < drawBatchBuffersMapped.size()
+        ? static_cast<GBufferDrawBatch*>(drawBatchBuffersMapped[currentFrame])
+        : nullptr;
+    uint32_t* drawCounts = currentFrame < drawCountBuffersMapped.size()
+        ? static_cast<uint32_t*>(drawCountBuffersMapped[currentFrame])
+        : nullptr;
+    if (!cullInputs || !batches || !drawCounts) return;
+
+    if (renderProxiesDirty) {
+        rebuildRenderProxies();
+    } else {
+        updateRenderProxyBounds(false);
+    }
+
+    // proxies are already in mesh/material order, so visible ones form the batches directly
+    static thread_local std::vector<uint32_t> drawProxies;
+    drawProxies.clear();
+    for (uint32_t p = 0; p < static_cast<uint32_t>(renderProxies.size()); ++p) {
+        if (renderProxies[p].entity->isVisible()) {
+            drawProxies.push_back(p);
+        }
+    }
+    if (drawProxies.empty()) return;
+    if (drawProxies.size() > kMaxGBufferInstances) {
+        if (!instanceLimitWarned) {
+            std::cout << std::format("Warning: {} entities exceed the gbuffer instance limit of {}. Dropping the rest.\n", drawProxies.size(), kMaxGBufferInstances);
+            instanceLimitWarned = true;
         }
-        if (shader->config.fillPushConstants) {
-            shader->config.fillPushConstants(renderer, shader, commandBuffer);
+        drawProxies.resize(kMaxGBufferInstances);
+    }
+
+    // one batch per mesh and lod, instances of every material are compacted into its range.
+    // lod k of every mesh lives in the k-th block of drawProxies.size() instances.
+    // shadow casters follow in the same buffers, LightManager::prepareShadows fills their region
+    const size_t drawCount = drawProxies.size();
+    uint32_t batchCount = 0;
+    uint32_t modelFirstBatch = 0;
+    for (size_t i = 0; i < drawCount; ++i) {
+        const uint32_t p = drawProxies[i];
+        const RenderProxy& proxy = renderProxies[p];
+        if (modelDraws.empty() || modelDraws.back().model != proxy.model) {
+            modelFirstBatch = batchCount;
+            const uint32_t lodCount = proxy.model->getLodCount();
+            for (uint32_t level = 0; level < lodCount; ++level) {
+                const Model::Lod& lod = proxy.model->getLod(level);
+                batches[batchCount++] = {
+                    .indexCount = lod.indexCount,
+                    .instanceCount = 0u,
+                    .firstIndex = lod.firstIndex,
+                    .vertexOffset = 0,
+                    .firstInstance = static_cast<uint32_t>(level * drawCount + i),
+                    .drawFirst = modelFirstBatch,
+                    .lodError = lod.error
+                };
+            }
+            drawCounts[modelFirstBatch] = 0u;
+            modelDraws.push_back({ proxy.model, modelFirstBatch, lodCount });
         }
-        GBufferPC pc = {
+        Entity* entity = proxy.entity;
+        const uint32_t paletteOffset = entity->getJointPaletteOffset();
+        const bool skinned = proxy.skinned && paletteOffset != UINT32_MAX;
+        // animated entities skip culling since their bind pose AABB doesn't bound the pose
+        const uint32_t flags = (skinned ? 1u : 0u) | (entity->isAnimated() ? 2u : 0u) | (proxy.materialId << 16u);
+        cullInputs[i] = {
             .model = entity->getWorldTransform(),
-            .view = camera->getViewMatrix(),
-            .projection = camera->getProjectionMatrix(),
-            .camPos = glm::vec4(camera->getWorldPosition(), model->hasSkinning() ? 1u : 0u)
+            .params = glm::uvec4(skinned ? paletteOffset : 0u, flags, modelFirstBatch, proxy.model->getLodCount()),
+            .boundsMin = glm::vec4(proxyMinX[p], proxyMinY[p], proxyMinZ[p], 0.0f),
+            .boundsMax = glm::vec4(proxyMaxX[p], proxyMaxY[p], proxyMaxZ[p], 0.0f)
         };
-        vkCmdPushConstants(commandBuffer, shader->pipelineLayout, shader->config.pushConstantRange.stageFlags, 0, sizeof(GBufferPC), &pc);
-        const std::vector<VkDescriptorSet>& descriptorSets = entity->getDescriptorSets();
-        if (!descriptorSets.empty()) {
-            const uint32_t dsIndex = std::min<uint32_t>(currentFrame, static_cast<uint32_t>(descriptorSets.size() - 1));
-            if (DEBUG_RENDER_LOGS) {
-                std::cout << "[drawEntities] shader=" << shader->name << " bind DS idx=" << dsIndex
-                          << " handle=" << descriptorSets[dsIndex] << std::endl;
+    }
+
+    const VkExtent2D extent = renderer->getRenderExtent();
+    const float focalPixels = std::abs(camera->getProjectionMatrix()[1][1]) * 0.5f * static_cast<float>(extent.height) / kLodPixelError;
+    const glm::vec3 cameraPos = camera->getWorldPosition();
+
+    const auto& planes4 = camera->getFrustumPlanes();
+    ComputeShader* cullShader = renderer->getShaderManager()->getComputeShader("gbuffercull");
+    if (cullShader && cullShader->pipeline != VK_NULL_HANDLE && !cullShader->descriptorSets.empty()) {
+        uint32_t* occludedInstances = currentFrame < occludedInstanceBuffersMapped.size()
+            ? static_cast<uint32_t*>(occludedInstanceBuffersMapped[currentFrame])
+            : nullptr;
+        lateCullPending = occlusionCullEnabled && occludedInstances != nullptr;
+        if (lateCullPending) {
+            // the late set mirrors the early one past its batches and instance ranges
+            occludedInstances[0] = 0u;
+            const uint32_t lateInstanceOffset = static_cast<uint32_t>(cooked::kMaxModelLods * drawCount);
+            for (uint32_t b = 0; b < batchCount; ++b) {
+                GBufferDrawBatch& late = batches[batchCount + b];
+                late = batches[b];
+                late.firstInstance += lateInstanceOffset;
+                late.drawFirst += batchCount;
+            }
+            for (const ModelDraw& draw : modelDraws) {
+                drawCounts[batchCount + draw.firstBatch] = 0u;
             }
-            vkCmdBindDescriptorSets(
+        }
+        GBufferCullPC pc = {
+            .occlusionViewProj = occlusionViewProj,
+            .instanceCount = static_cast<uint32_t>(drawProxies.size()),
+            .occlusionEnabled = lateCullPending ? 1u : 0u,
+            .depthWidth = depthPyramidSourceExtent.width,
+            .depthHeight = depthPyramidSourceExtent.height,
+            .depthPyramidMips = static_cast<uint32_t>(depthPyramidSets.size()),
+            .phase = 0u,
+            .batchCount = batchCount,
+            .batchOffset = 0u,
+            .lodParams = glm::vec4(cameraPos, focalPixels)
+        };
+        for (int i = 0; i < 6; ++i) {
+            pc.frustumPlanes[i] = planes4[i];
+        }
+        earlyCullPC = pc;
+        earlyCullPending = true;
+        // the late re-test projects with this frame's camera onto the pyramid of the early draws
+        lateCullPC = pc;
+        lateCullPC.occlusionViewProj = depthPyramidViewProj;
+        lateCullPC.phase = 2u;
+        lateCullPC.batchOffset = batchCount;
+        return;
+    }
+
+    // no cull pipeline yet, compact on the host with the SIMD frustum test instead
+    GBufferInstance* instances = currentFrame < instanceBuffersMapped.size()
+        ? static_cast<GBufferInstance*>(instanceBuffersMapped[currentFrame])
+        : nullptr;
+    GBufferDrawCommand* commands = currentFrame < drawCommandBuffersMapped.size()
+        ? static_cast<GBufferDrawCommand*>(drawCommandBuffersMapped[currentFrame])
+        : nullptr;
+    if (!instances || !commands) {
+        modelDraws.clear();
+        return;
+    }
+    static thread_local std::vector<uint8_t> visible;
+    const size_t proxyCount = renderProxies.size();
+    visible.assign(proxyCount, 0);
+    engine::simd::Plane planes[6];
+    for (int i = 0; i < 6; ++i) {
+        planes[i] = { planes4[i].x, planes4[i].y, planes4[i].z, planes4[i].w };
+    }
+    engine::simd::cullAABBsAgainstFrustum(
+        proxyMinX.data(), proxyMinY.data(), proxyMinZ.data(),
+        proxyMaxX.data(), proxyMaxY.data(), proxyMaxZ.data(),
+        proxyCount,
+        planes,
+        visible.data());
+    for (size_t i = 0; i < drawCount; ++i) {
+        const GBufferCullInput& input = cullInputs[i];
+        if (!visible[drawProxies[i]] && (input.params.y & 2u) == 0u) continue;
+        const RenderProxy& proxy = renderProxies[drawProxies[i]];
+        const uint32_t level = proxy.model->selectLod(input.model, cameraPos, focalPixels);
+        GBufferDrawBatch& batch = batches[input.params.z + level];
+        instances[batch.firstInstance + batch.instanceCount++] = {
+            .model = input.model,
+            .params = glm::uvec4(input.params.x, input.params.y & 1u, input.params.y >> 16u, 0u)
+        };
+    }
+    for (uint32_t b = 0; b < batchCount; ++b) {
+        const GBufferDrawBatch& batch = batches[b];
+        if (batch.instanceCount == 0u) continue;
+        commands[batch.drawFirst + drawCounts[batch.drawFirst]++] = {
+            .indexCount = batch.indexCount,
+            .instanceCount = batch.instanceCount,
+            .firstIndex = batch.firstIndex,
+            .vertexOffset = batch.vertexOffset,
+            .firstInstance = batch.firstInstance
+        };
+    }
+}
+
+void engine::EntityManager::cullEntities(VkCommandBuffer commandBuffer, uint32_t currentFrame) {
+    if (!earlyCullPending) return;
+    ComputeShader* cullShader = renderer->getShaderManager()->getComputeShader("gbuffercull");
+    const uint32_t dsIndex = std::min(currentFrame, static_cast<uint32_t>(cullShader->descriptorSets.size() - 1));
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullShader->pipeline);
+    vkCmdBindDescriptorSets(
+        commandBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        cullShader->pipelineLayout,
+        0,
+        1,
+        &cullShader->descriptorSets[dsIndex],
+        0,
+        nullptr
+    );
+    GBufferCullPC pc = earlyCullPC;
+    vkCmdPushConstants(commandBuffer, cullShader->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(GBufferCullPC), &pc);
+    vkCmdDispatch(commandBuffer, (pc.instanceCount + 63u) / 64u, 1u, 1u);
+
+    // instance counts are final, pack each mesh's non-empty lods into its command range
+    VkMemoryBarrier cullToCompact = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        1, &cullToCompact,
+        0, nullptr,
+        0, nullptr
+    );
+    pc.phase = 1u;
+    vkCmdPushConstants(commandBuffer, cullShader->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(GBufferCullPC), &pc);
+    vkCmdDispatch(commandBuffer, (pc.batchCount + 63u) / 64u, 1u, 1u);
+
+    VkMemoryBarrier cullToDraw = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        0,
+        1, &cullToDraw,
+        0, nullptr,
+        0, nullptr
+    );
+}
+
+void engine::EntityManager::renderEntities(VkCommandBuffer commandBuffer, uint32_t currentFrame, bool DEBUG_RENDER_LOGS) {
+    if (!getCamera()) {
+        std::cout << "Warning: No camera set in EntityManager. Skipping entity rendering.\n";
+        return;
+    }
+    recordModelDraws(commandBuffer, currentFrame, 0u, DEBUG_RENDER_LOGS);
+}
+
+// batchOffset selects the early or the late batch set written by the cull pass
+void engine::EntityManager::recordModelDraws(VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t batchOffset, bool DEBUG_RENDER_LOGS) {
+    Camera* camera = getCamera();
+    if (!camera) return;
+    ShaderManager* shaderManager = renderer->getShaderManager();
+    GraphicsShader* shader = shaderManager->getGraphicsShader("gbuffer");
+    if (!shader) return;
+    if (modelDraws.empty() || materialDescriptorSets.empty() || currentFrame >= drawCommandBuffers.size()) return;
+    VkBuffer drawBatchBuffer = drawBatchBuffers[currentFrame];
+    VkBuffer drawCommandBuffer = drawCommandBuffers[currentFrame];
+    VkBuffer drawCountBuffer = drawCountBuffers[currentFrame];
+    const bool drawIndirectCount = renderer->isDrawIndirectCountSupported();
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->pipeline);
+    if (shader->config.fillPushConstants) {
+        shader->config.fillPushConstants(renderer, shader, commandBuffer);
+    }
+    GBufferPC pc = {
+        .view = camera->getViewMatrix(),
+        .projection = camera->getProjectionMatrix(),
+        .camPos = glm::vec4(camera->getWorldPosition(), 0.0f),
+        .positionOffset = glm::vec4(0.0f),
+        .positionScale = glm::vec4(1.0f)
+    };
+    vkCmdPushConstants(commandBuffer, shader->pipelineLayout, shader->config.pushConstantRange.stageFlags, 0, sizeof(GBufferPC), &pc);
+
+    const uint32_t dsIndex = std::min<uint32_t>(currentFrame, static_cast<uint32_t>(materialDescriptorSets.size() - 1));
+    if (DEBUG_RENDER_LOGS) {
+        std::cout << "[drawEntities] shader=" << shader->name << " bind DS idx=" << dsIndex
+                  << " handle=" << materialDescriptorSets[dsIndex] << std::endl;
+    }
+    vkCmdBindDescriptorSets(
+        commandBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        shader->pipelineLayout,
+        0,
+        1,
+        &materialDescriptorSets[dsIndex],
+        0,
+        nullptr
+    );
+
+    // instance and draw counts come from the cull pass, and materials are read per instance,
+    // so every mesh is a single indirect draw over its non-empty lods
+    for (const ModelDraw& draw : modelDraws) {
+        Model* model = draw.model;
+        const uint32_t firstBatch = batchOffset + draw.firstBatch;
+        VkBuffer vertexBuffers[] = { model->getVertexBuffer().first };
+        VkDeviceSize offsets[] = { 0 };
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+        vkCmdBindIndexBuffer(commandBuffer, model->getIndexBuffer().first, 0, model->getIndexType());
+        VkBuffer skinBuffers[] = { model->hasSkinning() ? model->getSkinningBuffer().first : dummySkinningBuffer };
+        vkCmdBindVertexBuffers(commandBuffer, 1, 1, skinBuffers, offsets);
+        const glm::vec4 dequantize[2] = { model->getPositionOffset(), model->getPositionScale() };
+        vkCmdPushConstants(
+            commandBuffer,
+            shader->pipelineLayout,
+            shader->config.pushConstantRange.stageFlags,
+            offsetof(GBufferPC, positionOffset),
+            sizeof(dequantize),
+            dequantize
+        );
+        if (drawIndirectCount) {
+            vkCmdDrawIndexedIndirectCount(
                 commandBuffer,
-                VK_PIPELINE_BIND_POINT_GRAPHICS,
-                shader->pipelineLayout,
-                0,
+                drawCommandBuffer,
+                static_cast<VkDeviceSize>(firstBatch * sizeof(GBufferDrawCommand)),
+                drawCountBuffer,
+                static_cast<VkDeviceSize>(firstBatch * sizeof(uint32_t)),
+                draw.batchCount,
+                sizeof(GBufferDrawCommand)
+            );
+            continue;
+        }
+        for (uint32_t batchIdx = firstBatch; batchIdx < firstBatch + draw.batchCount; ++batchIdx) {
+            vkCmdDrawIndexedIndirect(
+                commandBuffer,
+                drawBatchBuffer,
+                static_cast<VkDeviceSize>(batchIdx * sizeof(GBufferDrawBatch)),
                 1,
-                &descriptorSets[dsIndex],
-                0,
-                nullptr
+                sizeof(GBufferDrawBatch)
             );
-        } else if (DEBUG_RENDER_LOGS) {
-            std::cout << "[drawEntities] shader=" << shader->name << " has NO descriptor sets" << std::endl;
         }
-        vkCmdDrawIndexed(commandBuffer, model->getIndexCount(), 1, 0, 0, 0);
+    }
+}
+
+void engine::EntityManager::renderDisoccludedEntities(VkCommandBuffer commandBuffer, uint32_t currentFrame) {
+    if (!depthPyramidPending) return;
+    GraphicsShader* shader = renderer->getShaderManager()->getGraphicsShader("gbuffer");
+    PassInfo* pass = shader ? shader->config.passInfo.get() : nullptr;
+    if (!pass || !pass->images.has_value() || !pass->depthAttachment.has_value()) return;
+    VkImage depthImage = VK_NULL_HANDLE;
+    for (const PassImage& image : *pass->images) {
+        if (image.usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT) {
+            depthImage = image.image;
+        }
+    }
+    if (depthImage == VK_NULL_HANDLE) return;
+    const VkImageSubresourceRange depthRange = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1 };
+
+    // the pyramid is reduced from the early draws, so it serves both the re-test below and next frame's cull
+    VkImageMemoryBarrier depthToRead = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+        .oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = depthImage,
+        .subresourceRange = depthRange
     };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        0, nullptr,
+        0, nullptr,
+        1, &depthToRead
+    );
+    buildDepthPyramid(commandBuffer, currentFrame);
+
+    ComputeShader* cullShader = renderer->getShaderManager()->getComputeShader("gbuffercull");
+    const bool drawLate = lateCullPending
+        && cullShader && cullShader->pipeline != VK_NULL_HANDLE && !cullShader->descriptorSets.empty();
+    if (drawLate) {
+        const uint32_t dsIndex = std::min(currentFrame, static_cast<uint32_t>(cullShader->descriptorSets.size() - 1));
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullShader->pipeline);
+        vkCmdBindDescriptorSets(
+            commandBuffer,
+            VK_PIPELINE_BIND_POINT_COMPUTE,
+            cullShader->pipelineLayout,
+            0,
+            1,
+            &cullShader->descriptorSets[dsIndex],
+            0,
+            nullptr
+        );
+        GBufferCullPC pc = lateCullPC;
+        vkCmdPushConstants(commandBuffer, cullShader->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(GBufferCullPC), &pc);
+        vkCmdDispatch(commandBuffer, (pc.instanceCount + 63u) / 64u, 1u, 1u);
 
-    for (size_t i = 0; i < cullables.size(); ++i) {
-        if (visible[i]) drawOne(cullables[i]);
+        VkMemoryBarrier retestToCompact = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+        };
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0,
+            1, &retestToCompact,
+            0, nullptr,
+            0, nullptr
+        );
+        pc.phase = 1u;
+        vkCmdPushConstants(commandBuffer, cullShader->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(GBufferCullPC), &pc);
+        vkCmdDispatch(commandBuffer, (pc.batchCount + 63u) / 64u, 1u, 1u);
     }
-    for (Entity* entity : alwaysVisible) {
-        drawOne(entity);
+
+    // depth goes back to the attachment layout the pass's own transitions expect
+    VkMemoryBarrier retestToDraw = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT
+            | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+    };
+    VkImageMemoryBarrier depthToAttachment = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_READ_BIT,
+        .dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        .oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        .newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = depthImage,
+        .subresourceRange = depthRange
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT
+            | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT
+            | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        0,
+        1, &retestToDraw,
+        0, nullptr,
+        1, &depthToAttachment
+    );
+    if (!drawLate) return;
+
+    // instances that came back into view are drawn over the early results
+    static thread_local std::vector<VkRenderingAttachmentInfo> colorAttachments;
+    colorAttachments = pass->colorAttachments;
+    for (VkRenderingAttachmentInfo& attachment : colorAttachments) {
+        attachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
     }
+    VkRenderingAttachmentInfo depthAttachment = pass->depthAttachment.value();
+    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    const VkExtent2D extent = renderer->getRenderExtent();
+    VkRenderingInfo renderingInfo = {
+        .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+        .renderArea = {
+            .offset = { 0, 0 },
+            .extent = extent
+        },
+        .layerCount = 1,
+        .colorAttachmentCount = static_cast<uint32_t>(colorAttachments.size()),
+        .pColorAttachments = colorAttachments.data(),
+        .pDepthAttachment = &depthAttachment
+    };
+    renderer->getFpCmdBeginRendering()(commandBuffer, &renderingInfo);
+    VkViewport viewport = {
+        .x = 0.0f,
+        .y = 0.0f,
+        .width = static_cast<float>(extent.width),
+        .height = static_cast<float>(extent.height),
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f
+    };
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    VkRect2D scissor = {
+        .offset = { 0, 0 },
+        .extent = extent
+    };
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+    recordModelDraws(commandBuffer, currentFrame, lateCullPC.batchOffset, false);
+    renderer->getFpCmdEndRendering()(commandBuffer);
 }
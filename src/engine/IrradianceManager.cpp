@@ -202,6 +202,8 @@ void engine::IrradianceProbe::bakeCubemap(Renderer* renderer, VkCommandBuffer co
     }
     
     GraphicsShader* irradianceBakeShader = renderer->getShaderManager()->getGraphicsShader("irradiance");
+    const std::vector<VkDescriptorSet>& materialDescriptorSets = renderer->getEntityManager()->getMaterialDescriptorSets();
+    if (materialDescriptorSets.empty()) return;
     VkImageLayout previousBakedLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     renderer->transitionImageLayoutInline(
         commandBuffer,
@@ -220,6 +222,16 @@ void engine::IrradianceProbe::bakeCubemap(Renderer* renderer, VkCommandBuffer co
     }
     std::vector<Entity*>& rootEntities = renderer->getEntityManager()->getRootEntities();
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, irradianceBakeShader->pipeline);
+    vkCmdBindDescriptorSets(
+        commandBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        irradianceBakeShader->pipelineLayout,
+        0,
+        1,
+        &materialDescriptorSets[0],
+        0,
+        nullptr
+    );
     VkViewport viewport = {
         .x = 0.0f,
         .y = 0.0f,
@@ -235,20 +247,26 @@ void engine::IrradianceProbe::bakeCubemap(Renderer* renderer, VkCommandBuffer co
     };
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
     int entitiesUsed = 0;
+    // the faces are only cubemapSize texels wide, so most geometry lands on its coarsest lod
+    const float focalPixels = static_cast<float>(cubemapSize) * 0.5f;
     auto drawStaticEntity = [&](auto& self, Entity* entity, glm::mat4& viewProj) -> void {
         if (!entity->getIsMovable()
          && entity->getModel()
          && entity->getType() == Entity::EntityType::Static
-         && !entity->getDescriptorSets().empty()
+         && entity->hasMaterial()
         ) {
             Model* model = entity->getModel();
+            const Model::Lod& lod = model->getLod(model->selectLod(entity->getWorldTransform(), probePos, focalPixels));
             VkBuffer vertexBuffers[] = { model->getVertexBuffer().first };
             VkDeviceSize offsets[] = { 0 };
             vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-            vkCmdBindIndexBuffer(commandBuffer, model->getIndexBuffer().first, 0, VK_INDEX_TYPE_UINT32);
+            vkCmdBindIndexBuffer(commandBuffer, model->getIndexBuffer().first, 0, model->getIndexType());
             IrradianceBakePC pc = {
                 .model = entity->getWorldTransform(),
-                .viewProj = viewProj
+                .viewProj = viewProj,
+                .materialParams = glm::uvec4(entity->getMaterialId(), 0u, 0u, 0u),
+                .positionOffset = model->getPositionOffset(),
+                .positionScale = model->getPositionScale()
             };
             vkCmdPushConstants(
                 commandBuffer,
@@ -258,18 +276,7 @@ void engine::IrradianceProbe::bakeCubemap(Renderer* renderer, VkCommandBuffer co
                 sizeof(IrradianceBakePC),
                 &pc
             );
-            const std::vector<VkDescriptorSet>& descriptorSets = entity->getDescriptorSets();
-            vkCmdBindDescriptorSets(
-                commandBuffer,
-                VK_PIPELINE_BIND_POINT_GRAPHICS,
-                irradianceBakeShader->pipelineLayout,
-                0,
-                1,
-                &descriptorSets[0],
-                0,
-                nullptr
-            );
-            vkCmdDrawIndexed(commandBuffer, model->getIndexCount(), 1, 0, 0, 0);
+            vkCmdDrawIndexed(commandBuffer, lod.indexCount, 1, lod.firstIndex, 0, 0);
             entitiesUsed++;
         }
         for (Entity* child : entity->getChildren()) {
@@ -7,10 +7,18 @@
 #include <engine/EntityManager.h>
 #include <engine/ShaderManager.h>
 #include <engine/SettingsManager.h>
+#include <engine/Camera.h>
+#include <engine/Profiler.h>
+#include <engine/SIMD.h>
 #include <algorithm>
+#include <bit>
+#include <cmath>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+// shadow maps are filtered, so casters tolerate a coarser lod than the gbuffer does
+static constexpr float kShadowLodTexelError = 2.0f;
+
 engine::Light::Light(
     LightManager* lightManager,
     LightHandle handle,
@@ -61,6 +69,17 @@ void engine::Light::updateShadowMatrices() {
     for (int i = 0; i < 6; ++i) {
         glm::mat4 faceView = glm::lookAt(lightPos, lightPos + faces[i].dir, faces[i].up);
         viewProjs[i] = shadowProj * faceView;
+        // side planes only, near and far are covered by the range test
+        const glm::mat4 rows = glm::transpose(viewProjs[i]);
+        const glm::vec4 planes[4] = {
+            rows[3] + rows[0],
+            rows[3] - rows[0],
+            rows[3] + rows[1],
+            rows[3] - rows[1]
+        };
+        for (int p = 0; p < 4; ++p) {
+            faceSidePlanes[i * 4 + p] = { planes[p].x, planes[p].y, planes[p].z, planes[p].w };
+        }
     }
 }
 
@@ -81,161 +100,382 @@ engine::PointLight engine::Light::getPointLightData() {
         .positionRadius = glm::vec4(worldPos, radius),
         .colorIntensity = glm::vec4(color, intensity),
         .shadowParams = glm::vec4(0.005f, radius, 0.1f, 1.0f), // bias, far, near, strength
-        .shadowData = glm::uvec4(shadowIdx, hasShadowMap ? 1 : 0, 0, 0)
+        .shadowData = glm::uvec4(shadowIdx, hasShadowMap ? 1 : 0, hasShadowMap ? shadowSlot : 0u, 0) // layer, has shadow, atlas slot
     };
     return pl;
 }
 
-void engine::Light::createShadowMaps(engine::Renderer* renderer, bool forceRecreate) {
-    if (hasShadowMap) {
-        if (!forceRecreate) return;
-        destroyShadowResources(renderer->getDevice());
+VkImageView engine::Light::getShadowImageView(size_t frameIndex) const {
+    if (!hasShadowMap || !lightManager) {
+        return VK_NULL_HANDLE;
     }
-    float settingsValue = renderer->getSettingsManager()->getSettings()->shadowQuality;
-     // 256, 512, 1024, 2048
-    shadowMapSize = static_cast<uint32_t>(pow(2, 8 + std::min(static_cast<int>(settingsValue), 3)));
-    VkFormat depthFormat = VK_FORMAT_D32_SFLOAT;
+    const LightManager::ShadowAtlasSlot* slot = lightManager->getShadowSlot(shadowSlot);
+    if (!slot || slot->cubeViews.empty()) {
+        return VK_NULL_HANDLE;
+    }
+    return slot->cubeViews[frameIndex % slot->cubeViews.size()];
+}
 
-    const uint32_t framesInFlight = std::max(1u, renderer->getFramesInFlight());
-    shadowDepthImages.assign(framesInFlight, VK_NULL_HANDLE);
-    shadowDepthMemories.assign(framesInFlight, VK_NULL_HANDLE);
-    shadowDepthImageViews.assign(framesInFlight, VK_NULL_HANDLE);
-    shadowDepthFaceViews.assign(framesInFlight, {});
-    shadowDepthArrayViews.assign(framesInFlight, VK_NULL_HANDLE);
-    shadowImageReady.assign(framesInFlight, 0u);
-
-    for (uint32_t frame = 0; frame < framesInFlight; ++frame) {
-        std::tie(shadowDepthImages[frame], shadowDepthMemories[frame]) = renderer->createImage(
-            shadowMapSize, shadowMapSize,
-            1,
-            VK_SAMPLE_COUNT_1_BIT,
-            depthFormat,
-            VK_IMAGE_TILING_OPTIMAL,
-            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            6,
-            VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT
-        );
-        shadowDepthImageViews[frame] = renderer->createImageView(
-            shadowDepthImages[frame],
-            depthFormat,
-            VK_IMAGE_ASPECT_DEPTH_BIT,
-            1,
-            VK_IMAGE_VIEW_TYPE_CUBE,
-            6
-        );
-        for (uint32_t i = 0; i < 6; ++i) {
-            VkImageViewCreateInfo viewInfo = {
-                .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-                .image = shadowDepthImages[frame],
-                .viewType = VK_IMAGE_VIEW_TYPE_2D,
-                .format = depthFormat,
-                .subresourceRange = {
-                    .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
-                    .baseMipLevel = 0,
-                    .levelCount = 1,
-                    .baseArrayLayer = i,
-                    .layerCount = 1
-                }
-            };
-            vkCreateImageView(renderer->getDevice(), &viewInfo, nullptr, &shadowDepthFaceViews[frame][i]);
+void engine::Light::attachShadowSlot(uint32_t slot, uint32_t size) {
+    shadowSlot = slot;
+    shadowMapSize = size;
+    hasShadowMap = true;
+    shadowBaked = false;
+    rebakeFaces = 0;
+    const uint32_t framesInFlight = std::max(1u, lightManager->getRenderer()->getFramesInFlight());
+    renderedGenerations.assign(framesInFlight, {});
+    frameValid.assign(framesInFlight, 0u);
+    pendingUpdate = {};
+    staleFrames = 0;
+    updateShadowMatrices();
+    lightManager->markLightsDirty();
+}
+
+void engine::Light::detachShadowSlot() {
+    shadowSlot = kInvalidShadowSlot;
+    hasShadowMap = false;
+    shadowBaked = false;
+    renderedGenerations.clear();
+    frameValid.clear();
+    pendingUpdate = {};
+    if (lightManager) {
+        lightManager->markLightsDirty();
+    }
+}
+
+void engine::Light::invalidateBake() {
+    shadowBaked = false;
+    std::fill(frameValid.begin(), frameValid.end(), 0u);
+}
+
+// frame images keep their content until the new bake lands, then only the touched faces are refreshed
+void engine::Light::beginRebake() {
+    shadowBaked = false;
+    markFacesDirty(rebakeFaces);
+    rebakeFaces = 0;
+}
+
+float engine::Light::computeShadowImportance(const Camera* camera) const {
+    if (!camera) {
+        return radius;
+    }
+    const glm::vec3 cameraPos = glm::vec3(camera->getInvViewMatrix()[3]);
+    const float distance = glm::length(getWorldPosition() - cameraPos);
+    if (distance <= radius) {
+        // camera inside the light volume outranks anything seen from outside
+        return 2.0f + (1.0f - distance / std::max(radius, 1e-4f));
+    }
+    // projected radius relative to half the screen height
+    const float halfFovTan = std::tan(glm::radians(camera->getFovY()) * 0.5f);
+    float importance = radius / (distance * std::max(halfFovTan, 1e-4f));
+    if (!camera->isSphereInFrustum(getWorldPosition(), radius)) {
+        importance *= 0.25f;
+    }
+    return std::min(importance, 2.0f);
+}
+
+uint8_t engine::Light::computeFaceMask(const engine::AABB& worldBounds, float rangeLimit) const {
+    const glm::vec3 lightPos = getWorldPosition();
+    const float range = (rangeLimit >= 0.0f && rangeLimit < radius) ? rangeLimit : radius;
+    const glm::vec3 closest = glm::clamp(lightPos, worldBounds.min, worldBounds.max);
+    if (glm::length(closest - lightPos) > range * 1.02f) {
+        return 0;
+    }
+    uint8_t mask = 0;
+    for (uint32_t face = 0; face < 6; ++face) {
+        bool inside = true;
+        for (uint32_t p = 0; p < 4; ++p) {
+            const simd::Plane& plane = faceSidePlanes[face * 4 + p];
+            const glm::vec3 v(
+                plane.nx >= 0.0f ? worldBounds.max.x : worldBounds.min.x,
+                plane.ny >= 0.0f ? worldBounds.max.y : worldBounds.min.y,
+                plane.nz >= 0.0f ? worldBounds.max.z : worldBounds.min.z
+            );
+            if (plane.nx * v.x + plane.ny * v.y + plane.nz * v.z + plane.d < 0.0f) {
+                inside = false;
+                break;
+            }
         }
-        VkImageViewCreateInfo arrayViewInfo = {
-            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-            .image = shadowDepthImages[frame],
-            .viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY,
-            .format = depthFormat,
-            .subresourceRange = {
-                .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
-                .baseMipLevel = 0,
-                .levelCount = 1,
-                .baseArrayLayer = 0,
-                .layerCount = 6
+        if (inside) {
+            mask |= static_cast<uint8_t>(1u << face);
+        }
+    }
+    return mask;
+}
+
+void engine::Light::markFacesDirty(uint8_t faceMask) {
+    for (uint32_t face = 0; face < 6; ++face) {
+        if (faceMask & (1u << face)) {
+            ++faceGenerations[face];
+        }
+    }
+}
+
+uint8_t engine::Light::getStaleFaces(uint32_t frameIdx) const {
+    if (frameIdx >= frameValid.size()) {
+        return 0;
+    }
+    if (!frameValid[frameIdx]) {
+        return 0x3Fu;
+    }
+    uint8_t mask = 0;
+    for (uint32_t face = 0; face < 6; ++face) {
+        if (renderedGenerations[frameIdx][face] != faceGenerations[face]) {
+            mask |= static_cast<uint8_t>(1u << face);
+        }
+    }
+    return mask;
+}
+
+bool engine::Light::isShadowFrameValid(uint32_t frameIdx) const {
+    return frameIdx < frameValid.size() && frameValid[frameIdx] != 0u;
+}
+
+void engine::Light::scheduleShadowUpdate(uint32_t frameIdx, uint8_t faceMask, bool frameWasReady, bool bakedWasReady) {
+    pendingUpdate = {
+        .faceMask = faceMask,
+        .bake = !shadowBaked,
+        .frameWasReady = frameWasReady,
+        .bakedWasReady = bakedWasReady
+    };
+    shadowBaked = true;
+    if (faceMask == 0 || frameIdx >= frameValid.size()) {
+        return;
+    }
+    for (uint32_t face = 0; face < 6; ++face) {
+        if (faceMask & (1u << face)) {
+            renderedGenerations[frameIdx][face] = faceGenerations[face];
+        }
+    }
+    if (faceMask == 0x3Fu) {
+        frameValid[frameIdx] = 1u;
+    }
+    staleFrames = 0;
+}
+
+void engine::Light::gatherShadowCasters(const ShadowCasterGrid& staticGrid, const ShadowCasterGrid& movingGrid, ShadowCullTarget& target) {
+    const float cullRangeScale = 1.02f;
+    staticCasters.clear();
+    movingCasters.clear();
+    staticDraws.clear();
+    movingDraws.clear();
+    if (pendingUpdate.bake) {
+        staticGrid.querySphere(getWorldPosition(), radius * cullRangeScale, staticCasters);
+        appendCasterPass(staticGrid, staticCasters, 0x3Fu, staticDraws, target);
+    }
+    if (pendingUpdate.faceMask != 0) {
+        movingGrid.querySphere(getWorldPosition(), std::min(radius, kMovableShadowCastRange) * cullRangeScale, movingCasters);
+        appendCasterPass(movingGrid, movingCasters, pendingUpdate.faceMask, movingDraws, target);
+    }
+}
+
+// writes one pass's casters as cull inputs, grouped by mesh so each mesh's lods are one batch range.
+// lod k of the pass's n entries lives in the k-th block of n instances past the region's cursor
+void engine::Light::appendCasterPass(const ShadowCasterGrid& grid, std::vector<Entity*>& casters, uint8_t allowedFaces, std::vector<CasterDraw>& draws, ShadowCullTarget& target) const {
+    static thread_local std::vector<uint8_t> casterFaces;
+    static thread_local std::vector<uint32_t> order;
+    if (!target.cullInputs || !target.instances || !target.batches || !target.commands || !target.drawCounts) return;
+    if (target.hostCull && target.forceAllFaces) {
+        casterFaces.assign(casters.size(), allowedFaces);
+    } else if (target.hostCull) {
+        computeCasterFaces(grid, casters, casterFaces, allowedFaces);
+    }
+    order.clear();
+    for (uint32_t i = 0; i < static_cast<uint32_t>(casters.size()); ++i) {
+        if (casters[i]->getModel()) {
+            order.push_back(i);
+        }
+    }
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return casters[a]->getModel() < casters[b]->getModel();
+    });
+    const uint32_t room = kMaxShadowCasterInstances - target.inputCount;
+    if (order.size() > room) {
+        order.resize(room);
+        target.overflowed = true;
+    }
+    const uint32_t count = static_cast<uint32_t>(order.size());
+    if (count == 0) return;
+
+    const uint32_t inputBase = kMaxGBufferInstances + target.inputCount;
+    const uint32_t instanceBase = kGBufferDrawSlots + cooked::kMaxModelLods * target.inputCount;
+    // 90 degree faces, so the focal length is half the face size
+    const float focalPixels = static_cast<float>(shadowMapSize) * 0.5f / kShadowLodTexelError;
+    const glm::vec3 lightPos = getWorldPosition();
+    uint32_t modelFirstBatch = 0;
+    for (uint32_t j = 0; j < count; ++j) {
+        Entity* entity = casters[order[j]];
+        Model* model = entity->getModel();
+        if (draws.empty() || draws.back().model != model) {
+            modelFirstBatch = kGBufferDrawSlots + target.batchCount;
+            const uint32_t lodCount = model->getLodCount();
+            for (uint32_t level = 0; level < lodCount; ++level) {
+                const Model::Lod& lod = model->getLod(level);
+                target.batches[kGBufferDrawSlots + target.batchCount++] = {
+                    .indexCount = lod.indexCount,
+                    .instanceCount = 0u,
+                    .firstIndex = lod.firstIndex,
+                    .vertexOffset = 0,
+                    .firstInstance = instanceBase + level * count + j,
+                    .drawFirst = modelFirstBatch,
+                    .lodError = lod.error
+                };
             }
+            target.drawCounts[modelFirstBatch] = 0u;
+            draws.push_back({ model, modelFirstBatch, lodCount });
+        }
+        const uint32_t paletteOffset = entity->getJointPaletteOffset();
+        const bool skinned = model->hasSkinning() && paletteOffset != UINT32_MAX;
+        const glm::mat4& world = entity->getWorldTransform();
+        if (target.hostCull) {
+            GBufferDrawBatch& batch = target.batches[modelFirstBatch + model->selectLod(world, lightPos, focalPixels)];
+            target.instances[batch.firstInstance + batch.instanceCount++] = {
+                .model = world,
+                .params = glm::uvec4(skinned ? paletteOffset : 0u, skinned ? 1u : 0u, casterFaces[order[j]], lightIdx)
+            };
+            continue;
+        }
+        const AABB& bounds = grid.getBounds(entity);
+        const uint32_t flags = (skinned ? 1u : 0u) | (target.forceAllFaces ? 4u : 0u) | (static_cast<uint32_t>(allowedFaces) << 8u) | (lightIdx << 16u);
+        target.cullInputs[inputBase + j] = {
+            .model = world,
+            .params = glm::uvec4(skinned ? paletteOffset : 0u, flags, modelFirstBatch, model->getLodCount()),
+            .boundsMin = glm::vec4(bounds.min, 0.0f),
+            .boundsMax = glm::vec4(bounds.max, 0.0f)
         };
-        vkCreateImageView(renderer->getDevice(), &arrayViewInfo, nullptr, &shadowDepthArrayViews[frame]);
     }
+    target.inputCount += count;
+    if (!target.hostCull) return;
+    for (const CasterDraw& draw : draws) {
+        for (uint32_t b = draw.firstBatch; b < draw.firstBatch + draw.batchCount; ++b) {
+            const GBufferDrawBatch& batch = target.batches[b];
+            if (batch.instanceCount == 0u) continue;
+            target.commands[batch.drawFirst + target.drawCounts[batch.drawFirst]++] = {
+                .indexCount = batch.indexCount,
+                .instanceCount = batch.instanceCount,
+                .firstIndex = batch.firstIndex,
+                .vertexOffset = batch.vertexOffset,
+                .firstInstance = batch.firstInstance
+            };
+        }
+    }
+}
 
-    std::tie(bakedShadowImage, bakedShadowMemory) = renderer->createImage(
-        shadowMapSize, shadowMapSize,
-        1,
-        VK_SAMPLE_COUNT_1_BIT,
-        depthFormat,
-        VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        6,
-        VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT
+// casters touching none of the rendered faces are dropped from the list
+void engine::Light::computeCasterFaces(const ShadowCasterGrid& grid, std::vector<Entity*>& casters, std::vector<uint8_t>& casterFaces, uint8_t allowedFaces) const {
+    static thread_local std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+    const size_t count = casters.size();
+    minX.resize(count); minY.resize(count); minZ.resize(count);
+    maxX.resize(count); maxY.resize(count); maxZ.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const AABB& bounds = grid.getBounds(casters[i]);
+        minX[i] = bounds.min.x; minY[i] = bounds.min.y; minZ[i] = bounds.min.z;
+        maxX[i] = bounds.max.x; maxY[i] = bounds.max.y; maxZ[i] = bounds.max.z;
+    }
+    casterFaces.resize(count);
+    simd::cubeFaceMasks(
+        minX.data(), minY.data(), minZ.data(),
+        maxX.data(), maxY.data(), maxZ.data(),
+        count,
+        faceSidePlanes.data(),
+        casterFaces.data()
     );
-    bakedShadowImageView = renderer->createImageView(
-        bakedShadowImage,
-        depthFormat,
-        VK_IMAGE_ASPECT_DEPTH_BIT,
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t faces = casterFaces[i] & allowedFaces;
+        if (faces == 0) continue;
+        casters[kept] = casters[i];
+        casterFaces[kept] = faces;
+        ++kept;
+    }
+    casters.resize(kept);
+    casterFaces.resize(kept);
+}
+
+// instance and draw counts come from the cull pass, so every caster mesh is a single indirect draw over its non-empty lods
+void engine::Light::drawShadowCasters(Renderer* renderer, VkCommandBuffer commandBuffer, const std::vector<CasterDraw>& draws, uint32_t currentFrame) {
+    const std::vector<VkDescriptorSet>& shadowDS = lightManager->getShadowDescriptorSets();
+    if (draws.empty() || shadowDS.empty()) return;
+    GraphicsShader* shader = renderer->getShaderManager()->getGraphicsShader("shadow");
+    EntityManager* entityManager = renderer->getEntityManager();
+    VkBuffer dummySkinningBuffer = entityManager->getDummySkinningBuffer();
+    VkBuffer drawBatchBuffer = entityManager->getDrawBatchBuffer(currentFrame);
+    VkBuffer drawCommandBuffer = entityManager->getDrawCommandBuffer(currentFrame);
+    VkBuffer drawCountBuffer = entityManager->getDrawCountBuffer(currentFrame);
+    const bool drawIndirectCount = renderer->isDrawIndirectCountSupported();
+    VkDeviceSize offsets[] = { 0 };
+    const uint32_t dsIndex = std::min<uint32_t>(currentFrame, static_cast<uint32_t>(shadowDS.size() - 1));
+    vkCmdBindDescriptorSets(
+        commandBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        shader->pipelineLayout,
+        0,
         1,
-        VK_IMAGE_VIEW_TYPE_CUBE,
-        6
+        &shadowDS[dsIndex],
+        0,
+        nullptr
     );
-    for (uint32_t i = 0; i < 6; ++i) {
-        VkImageViewCreateInfo viewInfo = {
-            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-            .image = bakedShadowImage,
-            .viewType = VK_IMAGE_VIEW_TYPE_2D,
-            .format = depthFormat,
-            .subresourceRange = {
-                .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
-                .baseMipLevel = 0,
-                .levelCount = 1,
-                .baseArrayLayer = i,
-                .layerCount = 1
-            }
+    for (const CasterDraw& draw : draws) {
+        Model* model = draw.model;
+        VkBuffer vertexBuffers[] = { model->getVertexBuffer().first };
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+        vkCmdBindIndexBuffer(commandBuffer, model->getIndexBuffer().first, 0, model->getIndexType());
+        VkBuffer skinBuffers[] = { model->hasSkinning() ? model->getSkinningBuffer().first : dummySkinningBuffer };
+        vkCmdBindVertexBuffers(commandBuffer, 1, 1, skinBuffers, offsets);
+        ShadowPC pc = {
+            .positionOffset = model->getPositionOffset(),
+            .positionScale = model->getPositionScale()
         };
-        vkCreateImageView(renderer->getDevice(), &viewInfo, nullptr, &bakedShadowFaceViews[i]);
-    }
-    VkImageViewCreateInfo bakedArrayViewInfo = {
-        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-        .image = bakedShadowImage,
-        .viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY,
-        .format = depthFormat,
-        .subresourceRange = {
-            .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
-            .baseMipLevel = 0,
-            .levelCount = 1,
-            .baseArrayLayer = 0,
-            .layerCount = 6
+        vkCmdPushConstants(
+            commandBuffer,
+            shader->pipelineLayout,
+            VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+            0,
+            sizeof(ShadowPC),
+            &pc
+        );
+        if (drawIndirectCount) {
+            vkCmdDrawIndexedIndirectCount(
+                commandBuffer,
+                drawCommandBuffer,
+                static_cast<VkDeviceSize>(draw.firstBatch * sizeof(GBufferDrawCommand)),
+                drawCountBuffer,
+                static_cast<VkDeviceSize>(draw.firstBatch * sizeof(uint32_t)),
+                draw.batchCount,
+                sizeof(GBufferDrawCommand)
+            );
+            continue;
+        }
+        for (uint32_t batchIdx = draw.firstBatch; batchIdx < draw.firstBatch + draw.batchCount; ++batchIdx) {
+            vkCmdDrawIndexedIndirect(
+                commandBuffer,
+                drawBatchBuffer,
+                static_cast<VkDeviceSize>(batchIdx * sizeof(GBufferDrawBatch)),
+                1,
+                sizeof(GBufferDrawBatch)
+            );
         }
-    };
-    vkCreateImageView(renderer->getDevice(), &bakedArrayViewInfo, nullptr, &bakedShadowArrayView);
-
-    updateShadowMatrices();
-
-    hasShadowMap = true;
-    if (lightManager) {
-        lightManager->markLightsDirty();
     }
 }
 
-void engine::Light::bakeShadowMap(Renderer* renderer, VkCommandBuffer commandBuffer) {
-    if (shadowBaked) return; // only bake once
-    if (!hasShadowMap) {
-        createShadowMaps(renderer);
-    }
-    
+void engine::Light::bakeShadowMap(Renderer* renderer, VkCommandBuffer commandBuffer, uint32_t currentFrame) {
+    const LightManager::ShadowAtlasSlot* slot = lightManager->getShadowSlot(shadowSlot);
+    if (!slot) return;
+    const LightManager::ShadowAtlasTier& tier = lightManager->getShadowTier(slot->tier);
     GraphicsShader* shader = renderer->getShaderManager()->getGraphicsShader("shadow");
-    VkImageLayout previousBakedLayout = bakedImageReady
+    VkImageLayout previousBakedLayout = pendingUpdate.bakedWasReady
         ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
         : VK_IMAGE_LAYOUT_UNDEFINED;
     renderer->transitionImageLayoutInline(
         commandBuffer,
-        bakedShadowImage,
+        tier.bakedImage,
         VK_FORMAT_D32_SFLOAT,
         previousBakedLayout,
         VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
         1,
-        6
+        6,
+        slot->baseLayer
     );
-    
-    std::vector<Entity*>& rootEntities = renderer->getEntityManager()->getRootEntities();
-    VkBuffer dummySkinningBuffer = renderer->getEntityManager()->getDummySkinningBuffer();
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->pipeline);
     VkViewport viewport = {
         .x = 0.0f,
@@ -252,65 +492,9 @@ void engine::Light::bakeShadowMap(Renderer* renderer, VkCommandBuffer commandBuf
     };
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-    const uint32_t lightIndex = lightIdx;
-    auto drawStaticEntity = [&](auto& self, Entity* entity) -> void {
-        if (!entity->getIsMovable()
-         && entity->getModel()
-         && entity->getType() == Entity::EntityType::Static
-         && entity->getCastShadow()
-         && intersectsShadowRange(entity->getModel()->getAABB(), entity->getWorldTransform())) {
-            Model* model = entity->getModel();
-            const auto& shadowDS = entity->getShadowDescriptorSets();
-            if (shadowDS.empty()) {
-                for (Entity* child : entity->getChildren()) {
-                    self(self, child);
-                }
-                return;
-            }
-            VkBuffer vertexBuffers[] = { model->getVertexBuffer().first };
-            VkDeviceSize offsets[] = { 0 };
-            vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-            vkCmdBindIndexBuffer(commandBuffer, model->getIndexBuffer().first, 0, VK_INDEX_TYPE_UINT32);
-            if (model->hasSkinning()) {
-                VkBuffer skinBuffers[] = { model->getSkinningBuffer().first };
-                vkCmdBindVertexBuffers(commandBuffer, 1, 1, skinBuffers, offsets);
-            } else {
-                VkBuffer dummyBuffers[] = { dummySkinningBuffer };
-                vkCmdBindVertexBuffers(commandBuffer, 1, 1, dummyBuffers, offsets);
-            }
-            vkCmdBindDescriptorSets(
-                commandBuffer,
-                VK_PIPELINE_BIND_POINT_GRAPHICS,
-                shader->pipelineLayout,
-                0,
-                1,
-                &shadowDS[0],
-                0,
-                nullptr
-            );
-            ShadowPC pc = {
-                .model = entity->getWorldTransform(),
-                .lightIndex = lightIndex,
-                .flags = model->hasSkinning() ? 1u : 0u
-            };
-            vkCmdPushConstants(
-                commandBuffer,
-                shader->pipelineLayout,
-                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                0,
-                sizeof(ShadowPC),
-                &pc
-            );
-            vkCmdDrawIndexed(commandBuffer, model->getIndexCount(), 1, 0, 0, 0);
-        }
-        for (Entity* child : entity->getChildren()) {
-            self(self, child);
-        }
-    };
-
     VkRenderingAttachmentInfo depthAttachment = {
         .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
-        .imageView = bakedShadowArrayView,
+        .imageView = slot->bakedArrayView,
         .imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
         .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
         .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
@@ -329,21 +513,20 @@ void engine::Light::bakeShadowMap(Renderer* renderer, VkCommandBuffer commandBuf
         .pDepthAttachment = &depthAttachment
     };
     renderer->getFpCmdBeginRendering()(commandBuffer, &renderInfo);
-    for (Entity* entity : rootEntities) {
-        drawStaticEntity(drawStaticEntity, entity);
-    }
+    lightManager->beginShadowStatsQuery(commandBuffer, lightIdx, renderInfo.viewMask);
+    drawShadowCasters(renderer, commandBuffer, staticDraws, currentFrame);
+    lightManager->endShadowStatsQuery(commandBuffer);
     renderer->getFpCmdEndRendering()(commandBuffer);
     renderer->transitionImageLayoutInline(
         commandBuffer,
-        bakedShadowImage,
+        tier.bakedImage,
         VK_FORMAT_D32_SFLOAT,
         VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
         1,
-        6
+        6,
+        slot->baseLayer
     );
-    bakedImageReady = true;
-    shadowBaked = true;
 }
 
 static std::unordered_set<engine::Entity::EntityType> notShadowTypes = {
@@ -353,43 +536,26 @@ static std::unordered_set<engine::Entity::EntityType> notShadowTypes = {
 };
 
 void engine::Light::renderShadowMap(Renderer* renderer, VkCommandBuffer commandBuffer, uint32_t currentFrame) {
-    if (!hasShadowMap) {
-        createShadowMaps(renderer);
+    const ShadowUpdate update = pendingUpdate;
+    if (update.faceMask == 0 && !update.bake) {
+        return;
     }
-    if (!shadowBaked) {
-        bakeShadowMap(renderer, commandBuffer);
+    const LightManager::ShadowAtlasSlot* slot = lightManager->getShadowSlot(shadowSlot);
+    if (!slot || slot->arrayViews.empty()) {
+        return;
     }
-    GraphicsShader* shader = renderer->getShaderManager()->getGraphicsShader("shadow");
-    EntityManager* entityManager = renderer->getEntityManager();
-    VkBuffer dummySkinningBuffer = entityManager->getDummySkinningBuffer();
-    
-    auto updateJointMatricesUBO = [&](Entity* entity) {
-        if (!entity->isAnimated()) return;
-        const auto& jointMatrices = entity->getJointMatrices();
-        if (jointMatrices.empty()) return;
-        auto& uniformBuffers = entity->getUniformBuffers();
-        if (uniformBuffers.empty()) return;
-        const size_t stride = 1;
-        const size_t bufferIndex = currentFrame * stride + 0;
-        if (bufferIndex >= uniformBuffers.size()) return;
-        VkBuffer buffer = uniformBuffers[bufferIndex];
-        if (buffer == VK_NULL_HANDLE) return;
-        void* mapped = entity->getUniformBuffersMapped()[bufferIndex];
-        if (mapped != nullptr) {
-            memcpy(mapped, jointMatrices.data(), jointMatrices.size() * sizeof(glm::mat4));
-        }
-    };
-    
-    const uint32_t frameIdx = shadowDepthImages.empty()
-        ? 0u
-        : (currentFrame % static_cast<uint32_t>(shadowDepthImages.size()));
-    VkImage shadowDepthImage = shadowDepthImages.empty() ? VK_NULL_HANDLE : shadowDepthImages[frameIdx];
-    if (shadowDepthImage == VK_NULL_HANDLE) {
+    const LightManager::ShadowAtlasTier& tier = lightManager->getShadowTier(slot->tier);
+    if (update.bake) {
+        bakeShadowMap(renderer, commandBuffer, currentFrame);
+    }
+    if (update.faceMask == 0) {
         return;
     }
+    GraphicsShader* shader = renderer->getShaderManager()->getGraphicsShader("shadow");
 
-    const bool frameShadowReady = frameIdx < shadowImageReady.size() && shadowImageReady[frameIdx] != 0u;
-    VkImageLayout previousDepthLayout = frameShadowReady
+    const uint32_t frameIdx = currentFrame % static_cast<uint32_t>(slot->arrayViews.size());
+    VkImage shadowDepthImage = tier.images[frameIdx];
+    VkImageLayout previousDepthLayout = update.frameWasReady
         ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
         : VK_IMAGE_LAYOUT_UNDEFINED;
     renderer->transitionImageLayoutInline(
@@ -399,33 +565,40 @@ void engine::Light::renderShadowMap(Renderer* renderer, VkCommandBuffer commandB
         previousDepthLayout,
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
         1,
-        6
+        6,
+        slot->baseLayer
     );
-    VkImageCopy copyRegion = {
-        .srcSubresource = {
-            .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
-            .mipLevel = 0,
-            .baseArrayLayer = 0,
-            .layerCount = 6
-        },
-        .srcOffset = {0, 0, 0},
-        .dstSubresource = {
-            .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
-            .mipLevel = 0,
-            .baseArrayLayer = 0,
-            .layerCount = 6
-        },
-        .dstOffset = {0, 0, 0},
-        .extent = {shadowMapSize, shadowMapSize, 1}
-    };
+    // only stale faces are reset to the baked static casters, the rest keep last update's content
+    VkImageCopy copyRegions[6];
+    uint32_t copyCount = 0;
+    for (uint32_t face = 0; face < 6; ++face) {
+        if ((update.faceMask & (1u << face)) == 0) continue;
+        copyRegions[copyCount++] = {
+            .srcSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
+                .mipLevel = 0,
+                .baseArrayLayer = slot->baseLayer + face,
+                .layerCount = 1
+            },
+            .srcOffset = {0, 0, 0},
+            .dstSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
+                .mipLevel = 0,
+                .baseArrayLayer = slot->baseLayer + face,
+                .layerCount = 1
+            },
+            .dstOffset = {0, 0, 0},
+            .extent = {shadowMapSize, shadowMapSize, 1}
+        };
+    }
     vkCmdCopyImage(
         commandBuffer,
-        bakedShadowImage,
+        tier.bakedImage,
         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
         shadowDepthImage,
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        1,
-        &copyRegion
+        copyCount,
+        copyRegions
     );
     renderer->transitionImageLayoutInline(
         commandBuffer,
@@ -434,10 +607,10 @@ void engine::Light::renderShadowMap(Renderer* renderer, VkCommandBuffer commandB
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
         VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
         1,
-        6
+        6,
+        slot->baseLayer
     );
-    std::vector<Entity*>& movableEntities = renderer->getEntityManager()->getMovableEntities();
-    if (!movableEntities.empty()) {
+    if (!movingDraws.empty()) {
         vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->pipeline);
         VkViewport viewport = {
             .x = 0.0f,
@@ -453,67 +626,9 @@ void engine::Light::renderShadowMap(Renderer* renderer, VkCommandBuffer commandB
             .extent = {shadowMapSize, shadowMapSize}
         };
         vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
-        const uint32_t lightIndex = lightIdx;
-        auto drawMovableEntity = [&](auto& self, Entity* entity) -> void {
-            if (entity->getModel()
-             && !notShadowTypes.contains(entity->getType())
-             && entity->getCastShadow()
-             && intersectsShadowRange(entity->getModel()->getAABB(), entity->getWorldTransform(), kMovableShadowCastRange)) {
-                Model* model = entity->getModel();
-                const auto& shadowDS = entity->getShadowDescriptorSets();
-                if (shadowDS.empty()) {
-                    for (Entity* child : entity->getChildren()) {
-                        self(self, child);
-                    }
-                    return;
-                }
-                updateJointMatricesUBO(entity);
-                VkBuffer vertexBuffers[] = { model->getVertexBuffer().first };
-                VkDeviceSize offsets[] = { 0 };
-                vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-                vkCmdBindIndexBuffer(commandBuffer, model->getIndexBuffer().first, 0, VK_INDEX_TYPE_UINT32);
-
-                if (model->hasSkinning()) {
-                    VkBuffer skinBuffers[] = { model->getSkinningBuffer().first };
-                    vkCmdBindVertexBuffers(commandBuffer, 1, 1, skinBuffers, offsets);
-                } else {
-                    VkBuffer dummyBuffers[] = { dummySkinningBuffer };
-                    vkCmdBindVertexBuffers(commandBuffer, 1, 1, dummyBuffers, offsets);
-                }
-                const uint32_t dsIndex = std::min<uint32_t>(currentFrame, static_cast<uint32_t>(shadowDS.size() - 1));
-                vkCmdBindDescriptorSets(
-                    commandBuffer,
-                    VK_PIPELINE_BIND_POINT_GRAPHICS,
-                    shader->pipelineLayout,
-                    0,
-                    1,
-                    &shadowDS[dsIndex],
-                    0,
-                    nullptr
-                );
-
-                ShadowPC pc = {
-                    .model = entity->getWorldTransform(),
-                    .lightIndex = lightIndex,
-                    .flags = model->hasSkinning() ? 1u : 0u
-                };
-                vkCmdPushConstants(
-                    commandBuffer,
-                    shader->pipelineLayout,
-                    VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                    0,
-                    sizeof(ShadowPC),
-                    &pc
-                );
-                vkCmdDrawIndexed(commandBuffer, model->getIndexCount(), 1, 0, 0, 0);
-            }
-            for (Entity* child : entity->getChildren()) {
-                self(self, child);
-            }
-        };
         VkRenderingAttachmentInfo depthAttachment = {
             .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
-            .imageView = shadowDepthArrayViews[frameIdx],
+            .imageView = slot->arrayViews[frameIdx],
             .imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
             .loadOp = VK_ATTACHMENT_LOAD_OP_LOAD,
             .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
@@ -526,18 +641,18 @@ void engine::Light::renderShadowMap(Renderer* renderer, VkCommandBuffer commandB
                 .extent = {shadowMapSize, shadowMapSize}
             },
             .layerCount = 1,
-            .viewMask = 0x3Fu,
+            .viewMask = update.faceMask,
             .colorAttachmentCount = 0,
             .pColorAttachments = nullptr,
             .pDepthAttachment = &depthAttachment
         };
         renderer->getFpCmdBeginRendering()(commandBuffer, &renderInfo);
-        for (Entity* entity : movableEntities) {
-            drawMovableEntity(drawMovableEntity, entity);
-        }
+        lightManager->beginShadowStatsQuery(commandBuffer, lightIdx, renderInfo.viewMask);
+        drawShadowCasters(renderer, commandBuffer, movingDraws, currentFrame);
+        lightManager->endShadowStatsQuery(commandBuffer);
         renderer->getFpCmdEndRendering()(commandBuffer);
     }
-    
+
     renderer->transitionImageLayoutInline(
         commandBuffer,
         shadowDepthImage,
@@ -545,106 +660,45 @@ void engine::Light::renderShadowMap(Renderer* renderer, VkCommandBuffer commandB
         VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
         1,
-        6
+        6,
+        slot->baseLayer
     );
-    if (frameIdx < shadowImageReady.size()) {
-        shadowImageReady[frameIdx] = 1u;
-    }
-}
-
-engine::Light::ShadowResources engine::Light::takeShadowResources() {
-    ShadowResources res;
-    for (size_t frame = 0; frame < shadowDepthImageViews.size(); ++frame) {
-        if (shadowDepthImageViews[frame]) {
-            res.views.push_back(shadowDepthImageViews[frame]);
-        }
-        if (frame < shadowDepthFaceViews.size()) {
-            for (int i = 0; i < 6; ++i) {
-                if (shadowDepthFaceViews[frame][i]) {
-                    res.views.push_back(shadowDepthFaceViews[frame][i]);
-                }
-            }
-        }
-        if (frame < shadowDepthArrayViews.size() && shadowDepthArrayViews[frame]) {
-            res.views.push_back(shadowDepthArrayViews[frame]);
-        }
-        if (frame < shadowDepthImages.size() && shadowDepthImages[frame]) {
-            res.images.push_back(shadowDepthImages[frame]);
-        }
-        if (frame < shadowDepthMemories.size() && shadowDepthMemories[frame]) {
-            res.memories.push_back(shadowDepthMemories[frame]);
-        }
-    }
-    shadowDepthImageViews.clear();
-    shadowDepthFaceViews.clear();
-    shadowDepthArrayViews.clear();
-    shadowDepthImages.clear();
-    shadowDepthMemories.clear();
-
-    if (bakedShadowImageView) {
-        res.views.push_back(bakedShadowImageView);
-        bakedShadowImageView = VK_NULL_HANDLE;
-    }
-    for (int i = 0; i < 6; ++i) {
-        if (bakedShadowFaceViews[i]) {
-            res.views.push_back(bakedShadowFaceViews[i]);
-            bakedShadowFaceViews[i] = VK_NULL_HANDLE;
-        }
-    }
-    if (bakedShadowArrayView) {
-        res.views.push_back(bakedShadowArrayView);
-        bakedShadowArrayView = VK_NULL_HANDLE;
-    }
-    if (bakedShadowImage) {
-        res.images.push_back(bakedShadowImage);
-        bakedShadowImage = VK_NULL_HANDLE;
-    }
-    if (bakedShadowMemory) {
-        res.memories.push_back(bakedShadowMemory);
-        bakedShadowMemory = VK_NULL_HANDLE;
-    }
-
-    hasShadowMap = false;
-    shadowImageReady.clear();
-    shadowBaked = false;
-    bakedImageReady = false;
-    if (lightManager) {
-        lightManager->markLightsDirty();
-    }
-    return res;
 }
 
-void engine::Light::freeShadowResources(VkDevice device, ShadowResources& resources) {
-    for (VkImageView view : resources.views) {
-        if (view) {
-            vkDestroyImageView(device, view, nullptr);
-        }
-    }
-    for (VkImage image : resources.images) {
-        if (image) {
-            vkDestroyImage(device, image, nullptr);
-        }
+void engine::Light::fillShadowLightEntry(ShadowLightEntry& entry) const {
+    for (uint32_t i = 0; i < 6; ++i) {
+        entry.viewProjs[i] = viewProjs[i];
     }
-    for (VkDeviceMemory memory : resources.memories) {
-        if (memory) {
-            vkFreeMemory(device, memory, nullptr);
-        }
+    entry.lightPosRadius = glm::vec4(getWorldPosition(), radius);
+    for (uint32_t i = 0; i < 24; ++i) {
+        const simd::Plane& plane = faceSidePlanes[i];
+        entry.faceSidePlanes[i] = glm::vec4(plane.nx, plane.ny, plane.nz, plane.d);
     }
-    resources.views.clear();
-    resources.images.clear();
-    resources.memories.clear();
+    entry.lodParams = glm::vec4(getWorldPosition(), static_cast<float>(shadowMapSize) * 0.5f / kShadowLodTexelError);
 }
 
-void engine::Light::destroyShadowResources(VkDevice device) {
-    ShadowResources res = takeShadowResources();
-    freeShadowResources(device, res);
+// world space bounds of a transformed local AABB
+static engine::AABB transformAABB(const engine::AABB& local, const glm::mat4& world) {
+    const glm::vec3 center = glm::vec3(world * glm::vec4((local.min + local.max) * 0.5f, 1.0f));
+    const glm::vec3 localExtents = (local.max - local.min) * 0.5f;
+    glm::mat3 basis = glm::mat3(world);
+    basis[0] = glm::abs(basis[0]);
+    basis[1] = glm::abs(basis[1]);
+    basis[2] = glm::abs(basis[2]);
+    const glm::vec3 worldExtents = basis * localExtents;
+    return { center - worldExtents, center + worldExtents };
 }
 
-void engine::Light::fillShadowLightEntry(ShadowLightEntry& entry) const {
-    for (uint32_t i = 0; i < 6; ++i) {
-        entry.viewProjs[i] = viewProjs[i];
+// lights ranked by importance fill the full resolution tier first
+static uint32_t shadowTierForRank(size_t rank) {
+    size_t capacity = 0;
+    for (uint32_t tier = 0; tier < engine::kShadowAtlasTierCount; ++tier) {
+        capacity += engine::kShadowAtlasTierSlots[tier];
+        if (rank < capacity) {
+            return tier;
+        }
     }
-    entry.lightPosRadius = glm::vec4(getWorldPosition(), radius);
+    return engine::kShadowAtlasTierCount - 1;
 }
 
 engine::LightManager::LightManager(engine::Renderer* renderer) : renderer(renderer) {
@@ -653,7 +707,20 @@ engine::LightManager::LightManager(engine::Renderer* renderer) : renderer(render
 
 engine::LightManager::~LightManager() {
     clear();
+    destroyShadowAtlas();
     VkDevice device = renderer->getDevice();
+    if (!shadowDescriptorSets.empty()) {
+        GraphicsShader* shader = renderer->getShaderManager()->getGraphicsShader("shadow");
+        if (shader && shader->descriptorPool != VK_NULL_HANDLE) {
+            vkFreeDescriptorSets(device, shader->descriptorPool,
+                static_cast<uint32_t>(shadowDescriptorSets.size()), shadowDescriptorSets.data());
+        }
+        shadowDescriptorSets.clear();
+    }
+    if (shadowStatsPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(device, shadowStatsPool, nullptr);
+        shadowStatsPool = VK_NULL_HANDLE;
+    }
     for (size_t i = 0; i < lightBuffersMapped.size(); ++i) {
         if (lightBuffersMapped[i] != nullptr && i < lightsBuffersMemory.size() && lightsBuffersMemory[i] != VK_NULL_HANDLE) {
             vkUnmapMemory(device, lightsBuffersMemory[i]);
@@ -688,6 +755,23 @@ engine::LightManager::~LightManager() {
     shadowLightsBuffers.clear();
     shadowLightsMemories.clear();
     shadowLightsMapped.clear();
+    for (size_t i = 0; i < lightClusterMapped.size(); ++i) {
+        if (lightClusterMapped[i] != nullptr && i < lightClusterMemories.size() && lightClusterMemories[i] != VK_NULL_HANDLE) {
+            vkUnmapMemory(device, lightClusterMemories[i]);
+            lightClusterMapped[i] = nullptr;
+        }
+    }
+    for (size_t i = 0; i < lightClusterBuffers.size(); ++i) {
+        if (lightClusterBuffers[i] != VK_NULL_HANDLE) {
+            vkDestroyBuffer(device, lightClusterBuffers[i], nullptr);
+        }
+        if (i < lightClusterMemories.size() && lightClusterMemories[i] != VK_NULL_HANDLE) {
+            vkFreeMemory(device, lightClusterMemories[i], nullptr);
+        }
+    }
+    lightClusterBuffers.clear();
+    lightClusterMemories.clear();
+    lightClusterMapped.clear();
 }
 
 engine::LightHandle engine::LightManager::addLight(const std::string& name, const glm::mat4& transform, const glm::vec3& color, float intensity, float radius) {
@@ -695,7 +779,18 @@ engine::LightHandle engine::LightManager::addLight(const std::string& name, cons
     lights.push_back(std::make_unique<Light>(this, handle, name, transform, color, intensity, radius));
     Light* light = lights.back().get();
     lightLookup[handle] = light;
-    light->createShadowMaps(renderer);
+    if (shadowSlots.empty()) {
+        createShadowAtlas();
+    }
+    const float importance = light->computeShadowImportance(renderer->getEntityManager()->getCamera());
+    light->setShadowImportance(importance);
+    size_t rank = 0;
+    for (const auto& other : lights) {
+        if (other.get() != light && other->shadowMapReady() && other->getShadowImportance() > importance) {
+            ++rank;
+        }
+    }
+    assignShadowSlot(light, shadowTierForRank(rank));
     reorderLights();
     vkDeviceWaitIdle(renderer->getDevice());
     renderer->createComputeDescriptorSets();
@@ -715,9 +810,7 @@ void engine::LightManager::unregisterLight(LightHandle handle) {
         lightLookup.erase(lookupIt);
         return;
     }
-    if (light->shadowMapReady()) {
-        scheduleShadowResourceDestroy(light->takeShadowResources());
-    }
+    releaseShadowSlot(light);
     lightLookup.erase(lookupIt);
     lights.erase(storageIt);
     reorderLights();
@@ -732,49 +825,376 @@ engine::Light* engine::LightManager::getLight(LightHandle handle) {
 }
 
 void engine::LightManager::clear() {
-    flushDeferredDestroys();
     for (auto& light : lights) {
-        if (light->shadowMapReady()) {
-            light->destroyShadowResources(renderer->getDevice());
-        }
+        releaseShadowSlot(light.get());
     }
     lights.clear();
     lightLookup.clear();
+    movingCasterBounds.clear();
+    staticCasterGrid.clear();
+    movingCasterGrid.clear();
+    staticCastersDirty = true;
     markLightsDirty();
 }
 
-void engine::LightManager::scheduleShadowResourceDestroy(Light::ShadowResources&& resources) {
-    if (resources.views.empty() && resources.images.empty() && resources.memories.empty()) {
-        return;
+void engine::LightManager::createShadowAtlas() {
+    float settingsValue = renderer->getSettingsManager()->getSettings()->shadowQuality;
+    // 256, 512, 1024, 2048 for the full resolution tier
+    const uint32_t baseSize = static_cast<uint32_t>(pow(2, 8 + std::min(static_cast<int>(settingsValue), 3)));
+    const uint32_t framesInFlight = std::max(1u, renderer->getFramesInFlight());
+    const VkFormat depthFormat = VK_FORMAT_D32_SFLOAT;
+    VkDevice device = renderer->getDevice();
+
+    auto createLayerView = [&](VkImage image, VkImageViewType viewType, uint32_t baseLayer) {
+        VkImageViewCreateInfo viewInfo = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .image = image,
+            .viewType = viewType,
+            .format = depthFormat,
+            .subresourceRange = {
+                .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = baseLayer,
+                .layerCount = 6
+            }
+        };
+        VkImageView view = VK_NULL_HANDLE;
+        if (vkCreateImageView(device, &viewInfo, nullptr, &view) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create shadow atlas view!");
+        }
+        return view;
+    };
+
+    shadowSlots.clear();
+    for (uint32_t tierIdx = 0; tierIdx < kShadowAtlasTierCount; ++tierIdx) {
+        ShadowAtlasTier& tier = shadowTiers[tierIdx];
+        tier.size = std::max(baseSize >> tierIdx, 64u);
+        const uint32_t layers = kShadowAtlasTierSlots[tierIdx] * 6u;
+        tier.images.assign(framesInFlight, VK_NULL_HANDLE);
+        tier.memories.assign(framesInFlight, VK_NULL_HANDLE);
+        for (uint32_t frame = 0; frame < framesInFlight; ++frame) {
+            std::tie(tier.images[frame], tier.memories[frame]) = renderer->createImage(
+                tier.size, tier.size,
+                1,
+                VK_SAMPLE_COUNT_1_BIT,
+                depthFormat,
+                VK_IMAGE_TILING_OPTIMAL,
+                VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                layers,
+                VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT
+            );
+        }
+        std::tie(tier.bakedImage, tier.bakedMemory) = renderer->createImage(
+            tier.size, tier.size,
+            1,
+            VK_SAMPLE_COUNT_1_BIT,
+            depthFormat,
+            VK_IMAGE_TILING_OPTIMAL,
+            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            layers,
+            VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT
+        );
+        for (uint32_t local = 0; local < kShadowAtlasTierSlots[tierIdx]; ++local) {
+            ShadowAtlasSlot slot = {
+                .tier = tierIdx,
+                .baseLayer = local * 6u
+            };
+            slot.cubeViews.resize(framesInFlight, VK_NULL_HANDLE);
+            slot.arrayViews.resize(framesInFlight, VK_NULL_HANDLE);
+            for (uint32_t frame = 0; frame < framesInFlight; ++frame) {
+                slot.cubeViews[frame] = createLayerView(tier.images[frame], VK_IMAGE_VIEW_TYPE_CUBE, slot.baseLayer);
+                slot.arrayViews[frame] = createLayerView(tier.images[frame], VK_IMAGE_VIEW_TYPE_2D_ARRAY, slot.baseLayer);
+            }
+            slot.bakedArrayView = createLayerView(tier.bakedImage, VK_IMAGE_VIEW_TYPE_2D_ARRAY, slot.baseLayer);
+            slot.frameReady.assign(framesInFlight, 1u);
+            shadowSlots.push_back(std::move(slot));
+        }
+    }
+
+    // every slot is bound to shadowimage whether it has an owner or not, so start all layers readable
+    for (uint32_t tierIdx = 0; tierIdx < kShadowAtlasTierCount; ++tierIdx) {
+        const uint32_t layers = kShadowAtlasTierSlots[tierIdx] * 6u;
+        for (VkImage image : shadowTiers[tierIdx].images) {
+            renderer->transitionImageLayout(image, depthFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, 1, layers);
+            renderer->transitionImageLayout(image, depthFormat, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1, layers);
+        }
     }
-    const uint32_t lifetime = renderer->getFramesInFlight() + 1u;
-    deferredDestroys.push_back({ std::move(resources), lifetime });
 }
 
-void engine::LightManager::processDeferredDestroys() {
-    if (deferredDestroys.empty()) {
-        return;
+void engine::LightManager::destroyShadowAtlas() {
+    for (auto& light : lights) {
+        light->detachShadowSlot();
     }
     VkDevice device = renderer->getDevice();
-    for (auto it = deferredDestroys.begin(); it != deferredDestroys.end();) {
-        if (it->framesRemaining > 0u) {
-            --it->framesRemaining;
+    for (ShadowAtlasSlot& slot : shadowSlots) {
+        for (VkImageView view : slot.cubeViews) {
+            if (view != VK_NULL_HANDLE) {
+                vkDestroyImageView(device, view, nullptr);
+            }
+        }
+        for (VkImageView view : slot.arrayViews) {
+            if (view != VK_NULL_HANDLE) {
+                vkDestroyImageView(device, view, nullptr);
+            }
+        }
+        if (slot.bakedArrayView != VK_NULL_HANDLE) {
+            vkDestroyImageView(device, slot.bakedArrayView, nullptr);
+        }
+    }
+    shadowSlots.clear();
+    for (ShadowAtlasTier& tier : shadowTiers) {
+        for (VkImage image : tier.images) {
+            if (image != VK_NULL_HANDLE) {
+                vkDestroyImage(device, image, nullptr);
+            }
+        }
+        for (VkDeviceMemory memory : tier.memories) {
+            if (memory != VK_NULL_HANDLE) {
+                vkFreeMemory(device, memory, nullptr);
+            }
+        }
+        if (tier.bakedImage != VK_NULL_HANDLE) {
+            vkDestroyImage(device, tier.bakedImage, nullptr);
+        }
+        if (tier.bakedMemory != VK_NULL_HANDLE) {
+            vkFreeMemory(device, tier.bakedMemory, nullptr);
+        }
+        tier = {};
+    }
+}
+
+bool engine::LightManager::assignShadowSlot(Light* light, uint32_t preferredTier) {
+    // preferred tier first, then lower resolutions, then higher ones
+    std::array<uint32_t, kShadowAtlasTierCount> order{};
+    uint32_t count = 0;
+    for (uint32_t tier = preferredTier; tier < kShadowAtlasTierCount; ++tier) {
+        order[count++] = tier;
+    }
+    for (uint32_t tier = preferredTier; tier-- > 0;) {
+        order[count++] = tier;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        for (uint32_t slotIdx = 0; slotIdx < shadowSlots.size(); ++slotIdx) {
+            ShadowAtlasSlot& slot = shadowSlots[slotIdx];
+            if (slot.tier != order[i] || slot.owner != nullptr) continue;
+            slot.owner = light;
+            light->attachShadowSlot(slotIdx, shadowTiers[slot.tier].size);
+            return true;
+        }
+    }
+    return false;
+}
+
+void engine::LightManager::releaseShadowSlot(Light* light) {
+    if (ShadowAtlasSlot* slot = getShadowSlot(light->getShadowSlot())) {
+        slot->owner = nullptr;
+    }
+    light->detachShadowSlot();
+}
+
+void engine::LightManager::rankShadowTiers() {
+    std::vector<Light*> ranked;
+    ranked.reserve(lights.size());
+    for (auto& light : lights) {
+        if (light->shadowMapReady()) {
+            ranked.push_back(light.get());
+        }
+    }
+    // lights keep a bonus for the tier they hold so near-equal lights don't trade slots back and forth
+    auto rankKey = [this](const Light* light) {
+        const uint32_t tier = shadowSlots[light->getShadowSlot()].tier;
+        return light->getShadowImportance() * (1.0f + 0.25f * static_cast<float>(kShadowAtlasTierCount - 1 - tier));
+    };
+    std::stable_sort(ranked.begin(), ranked.end(), [&](const Light* a, const Light* b) {
+        return rankKey(a) > rankKey(b);
+    });
+    std::vector<std::pair<Light*, uint32_t>> moves;
+    for (size_t rank = 0; rank < ranked.size(); ++rank) {
+        const uint32_t desiredTier = shadowTierForRank(rank);
+        if (shadowSlots[ranked[rank]->getShadowSlot()].tier != desiredTier) {
+            moves.push_back({ ranked[rank], desiredTier });
+        }
+    }
+    if (moves.empty()) return;
+    for (auto& [light, tier] : moves) {
+        releaseShadowSlot(light);
+    }
+    for (auto& [light, tier] : moves) {
+        assignShadowSlot(light, tier);
+    }
+    reorderLights();
+}
+
+void engine::LightManager::rebuildStaticCasterGrid() {
+    staticCasterGrid.clear();
+    // same casters the bake used to find by walking the whole tree per light
+    auto visit = [&](auto& self, Entity* entity) -> void {
+        if (!entity->getIsMovable()
+         && entity->getModel()
+         && entity->getType() == Entity::EntityType::Static
+         && entity->getCastShadow()) {
+            staticCasterGrid.insert(entity, transformAABB(entity->getModel()->getAABB(), entity->getWorldTransform()));
+        }
+        for (Entity* child : entity->getChildren()) {
+            self(self, child);
         }
-        if (it->framesRemaining == 0u) {
-            Light::freeShadowResources(device, it->resources);
-            it = deferredDestroys.erase(it);
+    };
+    for (Entity* entity : renderer->getEntityManager()->getRootEntities()) {
+        visit(visit, entity);
+    }
+    staticCastersDirty = false;
+}
+
+void engine::LightManager::markMovingCasterFaces() {
+    ++casterFrame;
+    static thread_local std::vector<AABB> changedBounds;
+    changedBounds.clear();
+    auto visit = [&](auto& self, Entity* entity) -> void {
+        if (entity->getModel() && !notShadowTypes.contains(entity->getType()) && entity->getCastShadow()) {
+            const AABB bounds = transformAABB(entity->getModel()->getAABB(), entity->getWorldTransform());
+            auto [it, inserted] = movingCasterBounds.try_emplace(entity, CasterBounds{ bounds, casterFrame });
+            if (inserted) {
+                changedBounds.push_back(bounds);
+                movingCasterGrid.insert(entity, bounds);
+            } else {
+                const AABB& previous = it->second.bounds;
+                // animated casters change shape without moving their bounds
+                if (entity->isAnimated() || previous.min != bounds.min || previous.max != bounds.max) {
+                    changedBounds.push_back({ glm::min(previous.min, bounds.min), glm::max(previous.max, bounds.max) });
+                    it->second.bounds = bounds;
+                    movingCasterGrid.update(entity, bounds);
+                }
+                it->second.lastSeen = casterFrame;
+            }
+        }
+        for (Entity* child : entity->getChildren()) {
+            self(self, child);
+        }
+    };
+    for (Entity* entity : renderer->getEntityManager()->getMovableEntities()) {
+        visit(visit, entity);
+    }
+    // casters that were removed or stopped being movable leave their old faces dirty
+    for (auto it = movingCasterBounds.begin(); it != movingCasterBounds.end();) {
+        if (it->second.lastSeen != casterFrame) {
+            changedBounds.push_back(it->second.bounds);
+            movingCasterGrid.remove(it->first);
+            it = movingCasterBounds.erase(it);
         } else {
             ++it;
         }
     }
+    if (changedBounds.empty()) return;
+    for (auto& light : lights) {
+        if (!light->shadowMapReady()) continue;
+        uint8_t mask = 0;
+        for (const AABB& bounds : changedBounds) {
+            mask |= light->computeFaceMask(bounds, kMovableShadowCastRange);
+            if (mask == 0x3Fu) break;
+        }
+        light->markFacesDirty(mask);
+    }
 }
 
-void engine::LightManager::flushDeferredDestroys() {
-    VkDevice device = renderer->getDevice();
-    for (auto& pending : deferredDestroys) {
-        Light::freeShadowResources(device, pending.resources);
+void engine::LightManager::invalidateStaticCaster(Entity* entity) {
+    staticCastersDirty = true;
+    // runs before the frame's transform update, so a freshly added entity's world transform is
+    // still its local one. the chain is composed here instead
+    glm::mat4 parentWorld(1.0f);
+    for (Entity* parent = entity->getParent(); parent; parent = parent->getParent()) {
+        parentWorld = parent->getTransform() * parentWorld;
+    }
+    auto visit = [&](auto& self, Entity* node, const glm::mat4& parentTransform) -> void {
+        const glm::mat4 world = parentTransform * node->getTransform();
+        if (node->getModel() && node->getCastShadow()) {
+            const AABB bounds = transformAABB(node->getModel()->getAABB(), world);
+            for (auto& light : lights) {
+                if (light->shadowMapReady() && light->isBaked()) {
+                    light->requestRebake(light->computeFaceMask(bounds));
+                }
+            }
+        }
+        for (Entity* child : node->getChildren()) {
+            self(self, child, world);
+        }
+    };
+    visit(visit, entity, parentWorld);
+}
+
+void engine::LightManager::startPendingRebakes() {
+    static thread_local std::vector<Light*> pending;
+    pending.clear();
+    for (auto& light : lights) {
+        if (light->getPendingRebake() != 0 && light->shadowMapReady() && light->isBaked()) {
+            pending.push_back(light.get());
+        }
+    }
+    if (pending.empty()) return;
+    const size_t count = std::min(pending.size(), static_cast<size_t>(kShadowRebakeBudget));
+    std::partial_sort(pending.begin(), pending.begin() + count, pending.end(), [](const Light* a, const Light* b) {
+        return a->getShadowImportance() > b->getShadowImportance();
+    });
+    for (size_t i = 0; i < count; ++i) {
+        pending[i]->beginRebake();
+    }
+}
+
+void engine::LightManager::scheduleShadowUpdates(uint32_t currentFrame) {
+    struct Candidate {
+        Light* light;
+        uint8_t faceMask;
+        float priority;
+    };
+    static thread_local std::vector<Candidate> candidates;
+    candidates.clear();
+    uint32_t budget = kShadowFaceUpdateBudget;
+    auto schedule = [&](Light* light, uint8_t faceMask) {
+        ShadowAtlasSlot& slot = shadowSlots[light->getShadowSlot()];
+        const uint32_t frameIdx = currentFrame % static_cast<uint32_t>(slot.frameReady.size());
+        const bool bake = !light->isBaked();
+        light->scheduleShadowUpdate(frameIdx, faceMask, slot.frameReady[frameIdx] != 0u, slot.bakedReady);
+        if (faceMask != 0) {
+            slot.frameReady[frameIdx] = 1u;
+        }
+        if (bake) {
+            slot.bakedReady = true;
+        }
+        const uint32_t faces = static_cast<uint32_t>(std::popcount(faceMask));
+        budget = faces < budget ? budget - faces : 0u;
+    };
+    for (auto& lightPtr : lights) {
+        Light* light = lightPtr.get();
+        if (!light->shadowMapReady()) continue;
+        const uint32_t frameIdx = currentFrame % static_cast<uint32_t>(shadowSlots[light->getShadowSlot()].frameReady.size());
+        const uint8_t stale = light->getStaleFaces(frameIdx);
+        if (!light->isShadowFrameValid(frameIdx)) {
+            // fresh slots have to be filled before they can be sampled
+            schedule(light, 0x3Fu);
+        } else if (stale != 0) {
+            const float age = static_cast<float>(light->getShadowStaleFrames() + 1u);
+            candidates.push_back({ light, stale, light->getShadowImportance() * age });
+        } else {
+            schedule(light, 0);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.priority > b.priority;
+    });
+    bool scheduledAny = false;
+    for (const Candidate& candidate : candidates) {
+        const uint32_t faces = static_cast<uint32_t>(std::popcount(candidate.faceMask));
+        // the top candidate always goes through so a single light can't starve
+        if (faces <= budget || !scheduledAny) {
+            schedule(candidate.light, candidate.faceMask);
+            scheduledAny = true;
+        } else {
+            candidate.light->skipShadowUpdate();
+            schedule(candidate.light, 0);
+        }
     }
-    deferredDestroys.clear();
 }
 
 void engine::LightManager::markLightsDirty() {
@@ -865,6 +1285,101 @@ void engine::LightManager::updateShadowLightsBuffer(uint32_t frameIndex) {
     shadowLightsDirty[frameIndex] = 0u;
 }
 
+void engine::LightManager::createLightClusterBuffers() {
+    const size_t frames = static_cast<size_t>(renderer->getFramesInFlight());
+    if (lightClusterBuffers.size() == frames) {
+        return;
+    }
+    VkDevice device = renderer->getDevice();
+    for (size_t i = 0; i < lightClusterMapped.size(); ++i) {
+        if (lightClusterMapped[i] != nullptr && i < lightClusterMemories.size() && lightClusterMemories[i] != VK_NULL_HANDLE) {
+            vkUnmapMemory(device, lightClusterMemories[i]);
+            lightClusterMapped[i] = nullptr;
+        }
+    }
+    for (size_t i = 0; i < lightClusterBuffers.size(); ++i) {
+        if (lightClusterBuffers[i] != VK_NULL_HANDLE) {
+            vkDestroyBuffer(device, lightClusterBuffers[i], nullptr);
+        }
+        if (i < lightClusterMemories.size() && lightClusterMemories[i] != VK_NULL_HANDLE) {
+            vkFreeMemory(device, lightClusterMemories[i], nullptr);
+        }
+    }
+    lightClusterBuffers.assign(frames, VK_NULL_HANDLE);
+    lightClusterMemories.assign(frames, VK_NULL_HANDLE);
+    lightClusterMapped.assign(frames, nullptr);
+    for (size_t frame = 0; frame < frames; ++frame) {
+        std::tie(lightClusterBuffers[frame], lightClusterMemories[frame]) = renderer->createBuffer(
+            kLightClusterBufferSize,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        );
+        vkMapMemory(device, lightClusterMemories[frame], 0, kLightClusterBufferSize, 0, &lightClusterMapped[frame]);
+        *static_cast<LightClusterHeader*>(lightClusterMapped[frame]) = {};
+    }
+}
+
+void engine::LightManager::updateLightClusters(uint32_t frameIndex) {
+    createLightClusterBuffers();
+    if (frameIndex >= lightClusterBuffers.size() || lightClusterMapped[frameIndex] == nullptr) {
+        return;
+    }
+    LightClusterHeader* header = static_cast<LightClusterHeader*>(lightClusterMapped[frameIndex]);
+    Camera* camera = renderer->getEntityManager()->getCamera();
+    if (!camera) {
+        header->dims.w = 0u;
+        return;
+    }
+    const glm::mat4 view = camera->getViewMatrix();
+    const glm::mat4 proj = camera->getProjectionMatrix();
+    const float nearPlane = camera->getNearPlane();
+    const float farPlane = camera->getFarPlane();
+    const size_t count = std::min(lights.size(), static_cast<size_t>(kMaxLights));
+
+    static thread_local std::vector<float> lightX, lightY, lightDepth, lightRadius;
+    static thread_local std::vector<uint64_t> masks;
+    lightX.resize(count);
+    lightY.resize(count);
+    lightDepth.resize(count);
+    lightRadius.resize(count);
+    masks.resize(kLightClusterCount);
+    for (size_t i = 0; i < count; ++i) {
+        const glm::vec3 viewPos = glm::vec3(view * glm::vec4(lights[i]->getWorldPosition(), 1.0f));
+        lightX[i] = viewPos.x;
+        lightY[i] = viewPos.y;
+        lightDepth[i] = -viewPos.z;
+        lightRadius[i] = lights[i]->getRadius();
+    }
+    // ndc = proj * view / depth, so view over depth at an ndc edge is ndc / proj (y carries the vulkan flip)
+    simd::assignLightsToClusters(
+        lightX.data(), lightY.data(), lightDepth.data(), lightRadius.data(),
+        count,
+        kLightClusterDimX, kLightClusterDimY, kLightClusterDimZ,
+        1.0f / proj[0][0], 1.0f / proj[1][1],
+        nearPlane, farPlane,
+        masks.data()
+    );
+
+    uint32_t* ranges = reinterpret_cast<uint32_t*>(header + 1);
+    uint32_t* indices = ranges + 2u * kLightClusterCount;
+    uint32_t offset = 0;
+    for (uint32_t cluster = 0; cluster < kLightClusterCount; ++cluster) {
+        ranges[2u * cluster] = offset;
+        for (uint64_t mask = masks[cluster]; mask != 0; mask &= mask - 1) {
+            indices[offset++] = static_cast<uint32_t>(std::countr_zero(mask));
+        }
+        ranges[2u * cluster + 1u] = offset - ranges[2u * cluster];
+    }
+    const float logRatio = std::log(farPlane / nearPlane);
+    header->zParams = glm::vec4(
+        static_cast<float>(kLightClusterDimZ) / logRatio,
+        -static_cast<float>(kLightClusterDimZ) * std::log(nearPlane) / logRatio,
+        0.0f,
+        0.0f
+    );
+    header->dims = glm::uvec4(kLightClusterDimX, kLightClusterDimY, kLightClusterDimZ, 1u);
+}
+
 void engine::LightManager::updateLightsUBO(uint32_t frameIndex) {
     if (lightsBuffers.size() < static_cast<size_t>(renderer->getFramesInFlight())) {
         createLightsUBO();
@@ -881,7 +1396,7 @@ void engine::LightManager::updateLightsUBO(uint32_t frameIndex) {
     }
     LightsUBO* gpuData = static_cast<LightsUBO*>(lightBuffersMapped[frameIndex]);
     auto& lights = getLights();
-    size_t count = std::min(lights.size(), static_cast<size_t>(kMaxPointLights));
+    size_t count = std::min(lights.size(), static_cast<size_t>(kMaxLights));
 
     for (size_t i = 0; i < count; ++i) {
         gpuData->pointLights[i] = lights[i]->getPointLightData();
@@ -902,17 +1417,269 @@ void engine::LightManager::reorderLights() {
 
 void engine::LightManager::createAllShadowMaps() {
     vkDeviceWaitIdle(renderer->getDevice());
+    staticCastersDirty = true;
     for (auto& light : lights) {
-        light->createShadowMaps(renderer, true);
+        releaseShadowSlot(light.get());
     }
+    destroyShadowAtlas();
+    createShadowAtlas();
+    Camera* camera = renderer->getEntityManager()->getCamera();
+    std::vector<Light*> ranked;
+    ranked.reserve(lights.size());
+    for (auto& light : lights) {
+        light->setShadowImportance(light->computeShadowImportance(camera));
+        ranked.push_back(light.get());
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [](const Light* a, const Light* b) {
+        return a->getShadowImportance() > b->getShadowImportance();
+    });
+    for (size_t rank = 0; rank < ranked.size(); ++rank) {
+        assignShadowSlot(ranked[rank], shadowTierForRank(rank));
+    }
+    framesSinceTierRank = 0;
+    reorderLights();
 }
 
-void engine::LightManager::renderShadows(VkCommandBuffer commandBuffer, uint32_t currentFrame) {
-    processDeferredDestroys();
+void engine::LightManager::prepareShadows(uint32_t currentFrame) {
+    // slot assignment and update scheduling stay on the main thread, renderShadows only records
+    if (shadowSlots.empty()) {
+        createShadowAtlas();
+    }
+    readShadowStatistics(currentFrame);
+    Camera* camera = renderer->getEntityManager()->getCamera();
+    bool assigned = false;
+    for (auto& light : lights) {
+        light->setShadowImportance(light->computeShadowImportance(camera));
+        if (!light->shadowMapReady()) {
+            assigned |= assignShadowSlot(light.get(), kShadowAtlasTierCount - 1);
+        }
+    }
+    if (assigned) {
+        reorderLights();
+    }
+    if (++framesSinceTierRank >= kShadowTierRankInterval) {
+        framesSinceTierRank = 0;
+        rankShadowTiers();
+    }
+    markMovingCasterFaces();
+    startPendingRebakes();
+    scheduleShadowUpdates(currentFrame);
+    if (staticCastersDirty) {
+        rebuildStaticCasterGrid();
+    }
+    ensureShadowDescriptorSets();
+    // every light's passes go into the shadow region of this frame's cull buffers, one dispatch culls them all
+    EntityManager* entityManager = renderer->getEntityManager();
+    const EntityManager::MappedCullBuffers mapped = entityManager->getMappedCullBuffers(currentFrame);
+    ComputeShader* cullShader = renderer->getShaderManager()->getComputeShader("gbuffercull");
+    ShadowCullTarget target = {
+        .cullInputs = mapped.cullInputs,
+        .instances = mapped.instances,
+        .batches = mapped.batches,
+        .commands = mapped.commands,
+        .drawCounts = mapped.drawCounts,
+        .hostCull = !cullShader || cullShader->pipeline == VK_NULL_HANDLE || cullShader->descriptorSets.empty(),
+        .forceAllFaces = forceAllShadowFaces
+    };
+    for (auto& light : lights) {
+        light->gatherShadowCasters(staticCasterGrid, movingCasterGrid, target);
+    }
+    if (target.overflowed && !shadowCasterLimitWarned) {
+        std::cout << std::format("Warning: shadow casters exceed the limit of {} entries per frame. Dropping the rest.\n", kMaxShadowCasterInstances);
+        shadowCasterLimitWarned = true;
+    }
+    shadowCullInputCount = target.inputCount;
+    shadowCullBatchCount = target.batchCount;
+    shadowCullOnGPU = !target.hostCull && target.inputCount > 0;
     createShadowLightsBuffers();
     updateShadowLightsBuffer(currentFrame);
+    updateLightsUBO(currentFrame);
+    updateLightClusters(currentFrame);
+}
+
+void engine::LightManager::readShadowStatistics(uint32_t currentFrame) {
+    profiler::Profiler* profiler = renderer->getProfiler();
+    if (!profiler || !renderer->isPipelineStatisticsSupported()) {
+        return;
+    }
+    if (shadowStatsPool == VK_NULL_HANDLE) {
+        const uint32_t framesInFlight = renderer->getFramesInFlight();
+        VkQueryPoolCreateInfo poolInfo = {
+            .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            .queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+            .queryCount = framesInFlight * kShadowStatsQueriesPerFrame,
+            .pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT
+                | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT
+                | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT
+        };
+        if (vkCreateQueryPool(renderer->getDevice(), &poolInfo, nullptr, &shadowStatsPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create shadow statistics query pool!");
+        }
+        shadowStatsPasses.assign(framesInFlight, {});
+        return;
+    }
+    // the fence for this frame has been waited, so the queries it recorded last time are complete
+    std::vector<ShadowStatsPass>& passes = shadowStatsPasses[currentFrame];
+    if (passes.empty()) {
+        return;
+    }
+    const uint32_t queryCount = passes.back().firstQuery + static_cast<uint32_t>(std::popcount(passes.back().viewMask));
+    // results are written in statistic bit order, three per query
+    static thread_local std::vector<uint64_t> results;
+    results.assign(static_cast<size_t>(queryCount) * 3u, 0u);
+    const VkResult result = vkGetQueryPoolResults(
+        renderer->getDevice(), shadowStatsPool, currentFrame * kShadowStatsQueriesPerFrame, queryCount,
+        results.size() * sizeof(uint64_t), results.data(), 3u * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT
+    );
+    if (result != VK_SUCCESS) {
+        passes.clear();
+        return;
+    }
+    std::array<uint64_t, 3> totals{};
+    std::array<uint64_t, 6> facePrimitives{};
+    std::array<uint64_t, profiler::kMaxLightCounters> lightPrimitives{};
+    uint64_t lightMask = 0;
+    for (const ShadowStatsPass& pass : passes) {
+        // query k of a pass belongs to its k-th view, drivers that report the whole pass in the first
+        // query put it on the lowest face
+        uint32_t query = pass.firstQuery;
+        for (uint32_t face = 0; face < 6; ++face) {
+            if ((pass.viewMask & (1u << face)) == 0) continue;
+            const uint64_t* stats = &results[static_cast<size_t>(query++) * 3u];
+            for (size_t i = 0; i < totals.size(); ++i) {
+                totals[i] += stats[i];
+            }
+            facePrimitives[face] += stats[2];
+            if (pass.lightIdx < lightPrimitives.size()) {
+                lightPrimitives[pass.lightIdx] += stats[2];
+                lightMask |= 1ull << pass.lightIdx;
+            }
+        }
+    }
+    passes.clear();
+    profiler->setCounter(profiler::Counter::ShadowInputPrimitives, totals[0]);
+    profiler->setCounter(profiler::Counter::ShadowClippingInvocations, totals[1]);
+    profiler->setCounter(profiler::Counter::ShadowClippingPrimitives, totals[2]);
+    for (uint32_t face = 0; face < 6; ++face) {
+        profiler->setCounter(static_cast<profiler::Counter>(static_cast<uint32_t>(profiler::Counter::ShadowFace0Primitives) + face), facePrimitives[face]);
+    }
+    for (uint32_t light = 0; light < lightPrimitives.size(); ++light) {
+        if (lightMask & (1ull << light)) {
+            profiler->setLightCounter(light, lightPrimitives[light]);
+        }
+    }
+}
+
+void engine::LightManager::beginShadowStatsQuery(VkCommandBuffer commandBuffer, uint32_t lightIdx, uint32_t viewMask) {
+    const uint32_t views = static_cast<uint32_t>(std::popcount(viewMask));
+    if (shadowStatsPool == VK_NULL_HANDLE || shadowStatsQueryCount + views > kShadowStatsQueriesPerFrame) {
+        return;
+    }
+    shadowStatsPasses[shadowStatsFrame].push_back({ lightIdx, viewMask, shadowStatsQueryCount });
+    vkCmdBeginQuery(commandBuffer, shadowStatsPool, shadowStatsFrame * kShadowStatsQueriesPerFrame + shadowStatsQueryCount, 0);
+    shadowStatsQueryCount += views;
+    shadowStatsQueryOpen = true;
+}
+
+void engine::LightManager::endShadowStatsQuery(VkCommandBuffer commandBuffer) {
+    if (!shadowStatsQueryOpen) {
+        return;
+    }
+    const ShadowStatsPass& pass = shadowStatsPasses[shadowStatsFrame].back();
+    vkCmdEndQuery(commandBuffer, shadowStatsPool, shadowStatsFrame * kShadowStatsQueriesPerFrame + pass.firstQuery);
+    shadowStatsQueryOpen = false;
+}
+
+void engine::LightManager::ensureShadowDescriptorSets() {
+    if (!shadowDescriptorSets.empty()) return;
+    GraphicsShader* shader = renderer->getShaderManager()->getGraphicsShader("shadow");
+    EntityManager* entityManager = renderer->getEntityManager();
+    if (!shader || shader->descriptorPool == VK_NULL_HANDLE || !entityManager) return;
+    entityManager->ensureInstanceBuffers();
+    createShadowLightsBuffers();
+    const uint32_t frames = renderer->getFramesInFlight();
+    std::vector<VkBuffer> frameBuffers;
+    frameBuffers.reserve(frames * 3);
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        frameBuffers.push_back(entityManager->getJointPaletteBuffer(frame));
+        frameBuffers.push_back(shadowLightsBuffers[frame]);
+        frameBuffers.push_back(entityManager->getInstanceBuffer(frame));
+    }
+    std::vector<Texture*> noTextures;
+    shadowDescriptorSets = shader->createDescriptorSets(renderer, noTextures, frameBuffers);
+}
+
+// phase 3 of the gbuffer cull tests each caster against its light's face frusta, phase 1 compacts the batches
+void engine::LightManager::cullShadowCasters(VkCommandBuffer commandBuffer, uint32_t currentFrame) {
+    ComputeShader* cullShader = renderer->getShaderManager()->getComputeShader("gbuffercull");
+    const uint32_t dsIndex = std::min(currentFrame, static_cast<uint32_t>(cullShader->descriptorSets.size() - 1));
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullShader->pipeline);
+    vkCmdBindDescriptorSets(
+        commandBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        cullShader->pipelineLayout,
+        0,
+        1,
+        &cullShader->descriptorSets[dsIndex],
+        0,
+        nullptr
+    );
+    GBufferCullPC pc = {
+        .instanceCount = shadowCullInputCount,
+        .phase = 3u,
+        .batchCount = shadowCullBatchCount,
+        .batchOffset = kMaxGBufferInstances
+    };
+    vkCmdPushConstants(commandBuffer, cullShader->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(GBufferCullPC), &pc);
+    vkCmdDispatch(commandBuffer, (pc.instanceCount + 63u) / 64u, 1u, 1u);
+
+    VkMemoryBarrier cullToCompact = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        1, &cullToCompact,
+        0, nullptr,
+        0, nullptr
+    );
+    pc.phase = 1u;
+    pc.batchOffset = kGBufferDrawSlots;
+    vkCmdPushConstants(commandBuffer, cullShader->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(GBufferCullPC), &pc);
+    vkCmdDispatch(commandBuffer, (pc.batchCount + 63u) / 64u, 1u, 1u);
+
+    VkMemoryBarrier cullToDraw = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        0,
+        1, &cullToDraw,
+        0, nullptr,
+        0, nullptr
+    );
+}
+
+void engine::LightManager::renderShadows(VkCommandBuffer commandBuffer, uint32_t currentFrame) {
+    if (shadowCullOnGPU) {
+        cullShadowCasters(commandBuffer, currentFrame);
+    }
+    // each light's passes take queries from this frame's range, readShadowStatistics reads them once its fence is waited
+    if (shadowStatsPool != VK_NULL_HANDLE) {
+        vkCmdResetQueryPool(commandBuffer, shadowStatsPool, currentFrame * kShadowStatsQueriesPerFrame, kShadowStatsQueriesPerFrame);
+        shadowStatsPasses[currentFrame].clear();
+        shadowStatsFrame = currentFrame;
+        shadowStatsQueryCount = 0;
+    }
     for (auto& light : lights) {
         light->renderShadowMap(renderer, commandBuffer, currentFrame);
     }
 }
-
@@ -1,5 +1,6 @@
 #include <engine/ModelManager.h>
 #include <engine/Renderer.h>
+#include <engine/ThreadPool.h>
 
 #include <fastgltf/core.hpp>
 #include <fastgltf/tools.hpp>
@@ -8,7 +9,17 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/matrix_decompose.hpp>
 #include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/packing.hpp>
 #include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <numeric>
+#include <thread>
+#include <tuple>
+#include <utility>
 
 engine::Model::Model(
     const std::string& name,
@@ -45,7 +56,225 @@ engine::Model::~Model() {
     }
 }
 
-void engine::Model::loadFromMemory() {
+// null for a raw glb, throws when a cooked blob is stale or truncated
+static const engine::cooked::ModelHeader* getCookedHeader(const std::string& name, const unsigned char* data, size_t size) {
+    using namespace engine::cooked;
+    if (size < sizeof(ModelHeader)) return nullptr;
+    const ModelHeader* header = reinterpret_cast<const ModelHeader*>(data);
+    if (header->magic != kModelMagic) return nullptr;
+    if (header->version != kModelVersion) {
+        throw std::runtime_error("Cooked model " + name + " has version " + std::to_string(header->version) + ", expected " + std::to_string(kModelVersion) + ". Rebuild the assets.");
+    }
+    auto fits = [&](uint32_t offset, size_t count, size_t stride) {
+        return count == 0 || (offset % 16 == 0 && offset <= size && count * stride <= size - offset);
+    };
+    const size_t indexSize = (header->flags & kModelIndex16) ? sizeof(uint16_t) : sizeof(uint32_t);
+    const bool valid = fits(header->vertexOffset, header->vertexCount, sizeof(Vertex))
+        && fits(header->indexOffset, header->indexCount, indexSize)
+        && (!(header->flags & kModelSkinned) || fits(header->skinningOffset, header->vertexCount, kFloatsPerSkinnedVertex * sizeof(float)))
+        && fits(header->jointOffset, header->jointCount, sizeof(Joint))
+        && fits(header->clipOffset, header->clipCount, sizeof(Clip))
+        && fits(header->samplerOffset, header->samplerCount, sizeof(Sampler))
+        && fits(header->channelOffset, header->channelCount, sizeof(Channel))
+        && fits(header->floatPoolOffset, header->floatPoolCount, sizeof(float))
+        && fits(header->stringOffset, header->stringBytes, 1)
+        && fits(header->hullVertexOffset, header->hullVertexCount, sizeof(glm::vec3))
+        && fits(header->hullFaceOffset, header->hullFaceCount, sizeof(HullFace))
+        && fits(header->hullEdgeOffset, header->hullEdgeCount, sizeof(glm::vec3))
+        && fits(header->lodOffset, header->lodCount, sizeof(Lod));
+    if (!valid) {
+        throw std::runtime_error("Cooked model is truncated or corrupt: " + name);
+    }
+    return header;
+}
+
+template <typename T>
+static std::span<const T> cookedSpan(const unsigned char* data, uint32_t offset, size_t count) {
+    return {reinterpret_cast<const T*>(data + offset), count};
+}
+
+void engine::Model::parse() {
+    if (const cooked::ModelHeader* header = getCookedHeader(name, embeddedData, embeddedSize)) {
+        parseCooked(*header);
+    } else {
+        parseGltf();
+    }
+}
+
+void engine::Model::parseCooked(const cooked::ModelHeader& header) {
+    const std::span<const char> strings = cookedSpan<char>(embeddedData, header.stringOffset, header.stringBytes);
+    auto getString = [&](uint32_t offset, uint32_t length) -> std::string {
+        if (offset > strings.size() || length > strings.size() - offset) {
+            throw std::runtime_error("Cooked model has an invalid string reference: " + name);
+        }
+        return std::string(strings.data() + offset, length);
+    };
+
+    skeleton.resize(header.jointCount);
+    const std::span<const cooked::Joint> joints = cookedSpan<cooked::Joint>(embeddedData, header.jointOffset, header.jointCount);
+    for (size_t i = 0; i < joints.size(); ++i) {
+        const cooked::Joint& src = joints[i];
+        Joint& joint = skeleton[i];
+        joint.name = getString(src.nameOffset, src.nameLength);
+        joint.parentIndex = src.parentIndex;
+        std::memcpy(&joint.inverseBindMatrix, src.inverseBindMatrix, sizeof(glm::mat4));
+        std::memcpy(&joint.localTransform, src.localTransform, sizeof(glm::mat4));
+        joint.localTranslation = glm::vec3(src.translation[0], src.translation[1], src.translation[2]);
+        joint.localRotation = glm::quat(src.rotation[3], src.rotation[0], src.rotation[1], src.rotation[2]);
+        joint.localScale = glm::vec3(src.scale[0], src.scale[1], src.scale[2]);
+    }
+
+    const std::span<const float> floatPool = cookedSpan<float>(embeddedData, header.floatPoolOffset, header.floatPoolCount);
+    const std::span<const cooked::Sampler> samplers = cookedSpan<cooked::Sampler>(embeddedData, header.samplerOffset, header.samplerCount);
+    const std::span<const cooked::Channel> channels = cookedSpan<cooked::Channel>(embeddedData, header.channelOffset, header.channelCount);
+    for (const cooked::Clip& clip : cookedSpan<cooked::Clip>(embeddedData, header.clipOffset, header.clipCount)) {
+        if (clip.firstSampler + clip.samplerCount > samplers.size() || clip.firstChannel + clip.channelCount > channels.size()) {
+            throw std::runtime_error("Cooked model has an invalid animation clip: " + name);
+        }
+        AnimationClip animationClip{};
+        animationClip.name = getString(clip.nameOffset, clip.nameLength);
+        animationClip.duration = clip.duration;
+        animationClip.samplers.reserve(clip.samplerCount);
+        for (const cooked::Sampler& sampler : samplers.subspan(clip.firstSampler, clip.samplerCount)) {
+            if (sampler.timesOffset + sampler.timeCount > floatPool.size()
+                || sampler.valuesOffset + sampler.valueCount * 4ull > floatPool.size()) {
+                throw std::runtime_error("Cooked model has an invalid animation sampler: " + name);
+            }
+            animationClip.samplers.push_back({
+                .inputTimes = floatPool.subspan(sampler.timesOffset, sampler.timeCount),
+                .outputValues = {reinterpret_cast<const glm::vec4*>(floatPool.data() + sampler.valuesOffset), sampler.valueCount},
+                .interpolation = static_cast<AnimationSampler::Interpolation>(sampler.interpolation)
+            });
+        }
+        animationClip.channels.reserve(clip.channelCount);
+        for (const cooked::Channel& channel : channels.subspan(clip.firstChannel, clip.channelCount)) {
+            if (channel.samplerIndex >= clip.samplerCount || channel.targetJoint >= skeleton.size()) {
+                throw std::runtime_error("Cooked model has an invalid animation channel: " + name);
+            }
+            animationClip.channels.push_back({
+                .samplerIndex = channel.samplerIndex,
+                .targetNode = channel.targetJoint,
+                .path = static_cast<AnimationChannel::Path>(channel.path)
+            });
+        }
+        animationsMap[animationClip.name] = std::move(animationClip);
+    }
+
+    aabb.min = glm::vec3(header.aabbMin[0], header.aabbMin[1], header.aabbMin[2]);
+    aabb.max = glm::vec3(header.aabbMax[0], header.aabbMax[1], header.aabbMax[2]);
+    positionOffset = aabb.min;
+    positionScale = aabb.max - aabb.min;
+    if (header.vertexCount == 0 || header.indexCount == 0) {
+        throw std::runtime_error("No valid geometry found in model: " + name);
+    }
+    // the cooker already ordered the triangles for the vertex cache and the vertices for fetch
+    vertexData = cookedSpan<cooked::Vertex>(embeddedData, header.vertexOffset, header.vertexCount);
+    indexType = (header.flags & cooked::kModelIndex16) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+    const size_t indexSize = indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+    indexData = cookedSpan<std::byte>(embeddedData, header.indexOffset, header.indexCount * indexSize);
+    for (const cooked::Lod& lod : cookedSpan<cooked::Lod>(embeddedData, header.lodOffset, std::min(header.lodCount, cooked::kMaxModelLods))) {
+        if (lod.indexCount == 0 || lod.firstIndex > header.indexCount || lod.indexCount > header.indexCount - lod.firstIndex) {
+            throw std::runtime_error("Cooked model has an invalid LOD: " + name);
+        }
+        lods.push_back({ .firstIndex = lod.firstIndex, .indexCount = lod.indexCount, .error = lod.error });
+    }
+    if (lods.empty()) {
+        lods.push_back({ .firstIndex = 0, .indexCount = header.indexCount, .error = 0.0f });
+    }
+    indexCount = lods[0].indexCount;
+    if (header.flags & cooked::kModelSkinned) {
+        skinningData = cookedSpan<float>(embeddedData, header.skinningOffset, header.vertexCount * cooked::kFloatsPerSkinnedVertex);
+    }
+}
+
+void engine::Model::createBuffers(std::vector<BufferUpload>& uploads) {
+    if (!skinningData.empty()) {
+        std::tie(skinningBuffer, skinningBufferMemory) = renderer->createBuffer(
+            skinningData.size_bytes(),
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+        );
+        uploads.push_back({skinningData.data(), skinningData.size_bytes(), skinningBuffer});
+    }
+    std::tie(vertexBuffer, vertexBufferMemory) = renderer->createBuffer(
+        vertexData.size_bytes(),
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+    );
+    std::tie(indexBuffer, indexBufferMemory) = renderer->createBuffer(
+        indexData.size_bytes(),
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+    );
+    uploads.push_back({vertexData.data(), vertexData.size_bytes(), vertexBuffer});
+    uploads.push_back({indexData.data(), indexData.size_bytes(), indexBuffer});
+}
+
+uint32_t engine::Model::selectLod(const glm::mat4& world, const glm::vec3& viewPos, float focalPixels) const {
+    if (lods.size() < 2) return 0;
+    const float scale = std::max({ glm::length(glm::vec3(world[0])), glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2])) });
+    const glm::vec3 center = glm::vec3(world * glm::vec4((aabb.min + aabb.max) * 0.5f, 1.0f));
+    const float radius = glm::length(aabb.max - aabb.min) * 0.5f * scale;
+    const float distance = glm::length(center - viewPos) - radius;
+    if (distance <= 0.0f) return 0;
+    const float pixelsPerUnit = focalPixels * scale / distance;
+    uint32_t level = 0;
+    for (uint32_t i = 1; i < lods.size(); ++i) {
+        if (lods[i].error * pixelsPerUnit > 1.0f) break;
+        level = i;
+    }
+    return level;
+}
+
+void engine::Model::releaseStagingData() {
+    vertexData = {};
+    indexData = {};
+    skinningData = {};
+    stagedVertices = {};
+    stagedIndices16 = {};
+    stagedIndices = {};
+    stagedSkinning = {};
+}
+
+static int16_t snorm16(float value) {
+    return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+static glm::vec2 octahedralEncode(glm::vec3 v) {
+    const float length = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+    if (length < 1e-12f) {
+        return glm::vec2(0.0f);
+    }
+    v /= length;
+    glm::vec2 e(v.x, v.y);
+    if (v.z < 0.0f) {
+        const glm::vec2 signs(e.x >= 0.0f ? 1.0f : -1.0f, e.y >= 0.0f ? 1.0f : -1.0f);
+        e = (1.0f - glm::abs(glm::vec2(e.y, e.x))) * signs;
+    }
+    return e;
+}
+
+// v is pos(3), normal(3), uv(2), tangent(4)
+static engine::cooked::Vertex quantizeVertex(const float* v, const glm::vec3& offset, const glm::vec3& invExtent) {
+    engine::cooked::Vertex out{};
+    for (int i = 0; i < 3; ++i) {
+        const float q = std::round((v[i] - offset[i]) * invExtent[i]);
+        out.position[i] = static_cast<uint16_t>(std::clamp(q, 0.0f, 65535.0f));
+    }
+    out.position[3] = v[11] >= 0.0f ? 65535u : 0u;
+    const glm::vec2 normal = octahedralEncode(glm::vec3(v[3], v[4], v[5]));
+    const glm::vec2 tangent = octahedralEncode(glm::vec3(v[8], v[9], v[10]));
+    out.normalTangent[0] = snorm16(normal.x);
+    out.normalTangent[1] = snorm16(normal.y);
+    out.normalTangent[2] = snorm16(tangent.x);
+    out.normalTangent[3] = snorm16(tangent.y);
+    out.texCoord[0] = glm::packHalf1x16(std::clamp(v[6], -65504.0f, 65504.0f));
+    out.texCoord[1] = glm::packHalf1x16(std::clamp(v[7], -65504.0f, 65504.0f));
+    return out;
+}
+
+// fallback for glbs embedded without the cooker
+void engine::Model::parseGltf() {
     auto dataResult = fastgltf::GltfDataBuffer::FromBytes(
         reinterpret_cast<const std::byte*>(embeddedData), embeddedSize);
     if (!dataResult) {
@@ -175,11 +404,13 @@ void engine::Model::loadFromMemory() {
                     std::cerr << "Warning: Unsupported animation sampler interpolation in model " << name << "\n";
                     continue;
             };
+            std::vector<float>& inputTimes = ownedTimes.emplace_back();
+            std::vector<glm::vec4>& outputValues = ownedValues.emplace_back();
             const fastgltf::Accessor& inputAccessor = gltf.accessors[sampler.inputAccessor];
             float maxTime = 0.0f;
             fastgltf::iterateAccessor<float>(gltf, inputAccessor,
                 [&](float time) {
-                    keyframes.inputTimes.push_back(time);
+                    inputTimes.push_back(time);
                     if (time > maxTime) {
                         maxTime = time;
                     }
@@ -191,17 +422,20 @@ void engine::Model::loadFromMemory() {
             if (outputAccessor.type == fastgltf::AccessorType::Vec3) {
                 fastgltf::iterateAccessor<glm::vec3>(gltf, outputAccessor,
                     [&](glm::vec3 value) {
-                        keyframes.outputValues.emplace_back(value, 0.0f);
+                        outputValues.emplace_back(value, 0.0f);
                     });
             } else if (outputAccessor.type == fastgltf::AccessorType::Vec4) {
                 fastgltf::iterateAccessor<glm::vec4>(gltf, outputAccessor,
                     [&](glm::vec4 value) {
-                        keyframes.outputValues.push_back(value);
+                        outputValues.push_back(value);
                     });
             } else {
                 std::cerr << "Warning: Unsupported animation output accessor type in model " << name << "\n";
                 continue;
             }
+            // moving the outer vectors later keeps these buffers in place
+            keyframes.inputTimes = inputTimes;
+            keyframes.outputValues = outputValues;
             samplers.push_back(keyframes);
         }
         animationClip.samplers = std::move(samplers);
@@ -212,7 +446,7 @@ void engine::Model::loadFromMemory() {
     constexpr std::size_t floatsPerVertex = 12; // pos(3), normal(3), uv(2), tangent(4)
     std::vector<float> tempVertices;
     std::vector<uint32_t> tempIndices;
-    std::vector<float> skinningData; // 4 joint indices + 4 weights per vertex
+    std::vector<float> tempSkinning; // 4 joint indices + 4 weights per vertex
     bool hasSkinningData = false;
     for (const auto& primitive : mesh.primitives) {
         if (!primitive.indicesAccessor.has_value()) {
@@ -243,7 +477,7 @@ void engine::Model::loadFromMemory() {
             tempVertices[base + 11] = 1.0f; // tangent.w (handedness, default +1)
         }
         tempIndices.reserve(tempIndices.size() + indexAccessor.count);
-        skinningData.resize(vertexCount * 8, 0.0f); // 4 joint indices + 4 weights per vertex
+        tempSkinning.resize(vertexCount * 8, 0.0f); // 4 joint indices + 4 weights per vertex
         fastgltf::iterateAccessor<std::uint32_t>(gltf, gltf.accessors[primitive.indicesAccessor.value()], 
             [&](std::uint32_t index) {
                 tempIndices.push_back(static_cast<uint32_t>(initialVertexCount + index));
@@ -364,63 +598,79 @@ void engine::Model::loadFromMemory() {
             fastgltf::iterateAccessorWithIndex<fastgltf::math::uvec4>(gltf, jointsAccessor,
                 [&](fastgltf::math::uvec4 jointIndices, std::size_t index) {
                     const std::size_t base = index * 8;
-                    skinningData[base + 0] = static_cast<float>(jointIndices[0]);
-                    skinningData[base + 1] = static_cast<float>(jointIndices[1]);
-                    skinningData[base + 2] = static_cast<float>(jointIndices[2]);
-                    skinningData[base + 3] = static_cast<float>(jointIndices[3]);
+                    tempSkinning[base + 0] = static_cast<float>(jointIndices[0]);
+                    tempSkinning[base + 1] = static_cast<float>(jointIndices[1]);
+                    tempSkinning[base + 2] = static_cast<float>(jointIndices[2]);
+                    tempSkinning[base + 3] = static_cast<float>(jointIndices[3]);
                 });
             fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec4>(gltf, weightsAccessor,
                 [&](fastgltf::math::fvec4 jointWeights, std::size_t index) {
                     const std::size_t base = index * 8;
-                    skinningData[base + 4] = jointWeights[0];
-                    skinningData[base + 5] = jointWeights[1];
-                    skinningData[base + 6] = jointWeights[2];
-                    skinningData[base + 7] = jointWeights[3];
+                    tempSkinning[base + 4] = jointWeights[0];
+                    tempSkinning[base + 5] = jointWeights[1];
+                    tempSkinning[base + 6] = jointWeights[2];
+                    tempSkinning[base + 7] = jointWeights[3];
                 });
         }
     }
     if (tempVertices.empty() || tempIndices.empty()) {
         throw std::runtime_error("No valid geometry found in model: " + name);
     }
-    if (hasSkinningData && !skinningData.empty()) {
-        std::tie(skinningBuffer, skinningBufferMemory) = renderer->createBuffer(
-            sizeof(float) * skinningData.size(),
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-        );
-        renderer->copyDataToBuffer(
-            skinningData.data(),
-            sizeof(float) * skinningData.size(),
-            skinningBuffer,
-            skinningBufferMemory
-        );
-    }
-    std::tie(vertexBuffer, vertexBufferMemory) = renderer->createBuffer(
-        sizeof(float) * tempVertices.size(),
-        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-    );
-    std::tie(indexBuffer, indexBufferMemory) = renderer->createBuffer(
-        sizeof(uint32_t) * tempIndices.size(),
-        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-    );
-    renderer->copyDataToBuffer(
-        tempVertices.data(),
-        sizeof(float) * tempVertices.size(),
-        vertexBuffer,
-        vertexBufferMemory
-    );
-    renderer->copyDataToBuffer(
-        tempIndices.data(),
-        sizeof(uint32_t) * tempIndices.size(),
-        indexBuffer,
-        indexBufferMemory
+    // same layout the cooker writes, just without its cache and overdraw reordering
+    positionOffset = aabb.min;
+    positionScale = aabb.max - aabb.min;
+    const glm::vec3 invExtent = glm::vec3(
+        positionScale.x > 0.0f ? 65535.0f / positionScale.x : 0.0f,
+        positionScale.y > 0.0f ? 65535.0f / positionScale.y : 0.0f,
+        positionScale.z > 0.0f ? 65535.0f / positionScale.z : 0.0f
     );
+    stagedVertices.reserve(tempVertices.size() / floatsPerVertex);
+    for (std::size_t base = 0; base < tempVertices.size(); base += floatsPerVertex) {
+        stagedVertices.push_back(quantizeVertex(&tempVertices[base], positionOffset, invExtent));
+    }
+    vertexData = stagedVertices;
     indexCount = static_cast<uint32_t>(tempIndices.size());
+    lods = { { .firstIndex = 0, .indexCount = indexCount, .error = 0.0f } };
+    if (stagedVertices.size() <= 0x10000) {
+        stagedIndices16.assign(tempIndices.begin(), tempIndices.end());
+        indexType = VK_INDEX_TYPE_UINT16;
+        indexData = std::as_bytes(std::span<const uint16_t>(stagedIndices16));
+    } else {
+        stagedIndices = std::move(tempIndices);
+        indexData = std::as_bytes(std::span<const uint32_t>(stagedIndices));
+    }
+    if (hasSkinningData) {
+        stagedSkinning = std::move(tempSkinning);
+        skinningData = stagedSkinning;
+    }
 }
 
-std::pair<std::vector<glm::vec3>, std::vector<uint32_t>> engine::Model::loadVertsForModel() {
+// folds the sign away and snaps to a 1/256 grid, so parallel and opposite axes land on the
+// same key instead of being compared against every axis kept so far
+static uint64_t axisKey(glm::vec3 axis) {
+    const glm::vec3 a = glm::abs(axis);
+    const int major = (a.x >= a.y && a.x >= a.z) ? 0 : (a.y >= a.z ? 1 : 2);
+    if (axis[major] < 0.0f) axis = -axis;
+    auto snap = [](float c) { return static_cast<uint64_t>(std::lround(c * 256.0f) + 256); };
+    return (snap(axis.x) << 20) | (snap(axis.y) << 10) | snap(axis.z);
+}
+
+engine::Model::ConvexHull engine::Model::loadConvexHull() const {
+    ConvexHull hull;
+    if (const cooked::ModelHeader* header = getCookedHeader(name, embeddedData, embeddedSize)) {
+        const std::span<const glm::vec3> vertices = cookedSpan<glm::vec3>(embeddedData, header->hullVertexOffset, header->hullVertexCount);
+        const std::span<const cooked::HullFace> faces = cookedSpan<cooked::HullFace>(embeddedData, header->hullFaceOffset, header->hullFaceCount);
+        const std::span<const glm::vec3> edges = cookedSpan<glm::vec3>(embeddedData, header->hullEdgeOffset, header->hullEdgeCount);
+        hull.vertices.assign(vertices.begin(), vertices.end());
+        hull.faceAxes.reserve(faces.size());
+        hull.faceExtents.reserve(faces.size());
+        for (const cooked::HullFace& face : faces) {
+            hull.faceAxes.emplace_back(face.normal[0], face.normal[1], face.normal[2]);
+            hull.faceExtents.emplace_back(face.projMin, face.projMax);
+        }
+        hull.edgeAxes.assign(edges.begin(), edges.end());
+        return hull;
+    }
     auto dataResult = fastgltf::GltfDataBuffer::FromBytes(
         reinterpret_cast<const std::byte*>(embeddedData), embeddedSize);
     if (!dataResult) {
@@ -462,7 +712,58 @@ std::pair<std::vector<glm::vec3>, std::vector<uint32_t>> engine::Model::loadVert
                 });
         }
     }
-    return {vertices, indices};
+
+    // no cooked hull for a raw glb, the triangle soup stands in for it
+    std::unordered_map<uint64_t, size_t> faceKeys;
+    std::unordered_map<uint64_t, size_t> edgeKeys;
+    std::vector<float> edgeLengths;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        if (indices[i] >= vertices.size() || indices[i + 1] >= vertices.size() || indices[i + 2] >= vertices.size()) {
+            continue;
+        }
+        const glm::vec3 corners[3] = {vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]]};
+        const glm::vec3 normal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+        const float area = glm::length(normal);
+        if (area > 1e-12f && faceKeys.emplace(axisKey(normal / area), hull.faceAxes.size()).second) {
+            hull.faceAxes.push_back(normal / area);
+        }
+        for (int k = 0; k < 3; ++k) {
+            const glm::vec3 edge = corners[(k + 1) % 3] - corners[k];
+            const float length = glm::length(edge);
+            if (length < 1e-6f) continue;
+            auto [it, inserted] = edgeKeys.emplace(axisKey(edge / length), hull.edgeAxes.size());
+            if (inserted) {
+                hull.edgeAxes.push_back(edge / length);
+                edgeLengths.push_back(0.0f);
+            }
+            edgeLengths[it->second] += length;
+        }
+    }
+    std::vector<size_t> order(hull.edgeAxes.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return edgeLengths[a] > edgeLengths[b]; });
+    std::vector<glm::vec3> edgeAxes;
+    edgeAxes.reserve(order.size());
+    for (size_t i : order) {
+        edgeAxes.push_back(hull.edgeAxes[i]);
+    }
+    hull.edgeAxes = std::move(edgeAxes);
+
+    std::sort(vertices.begin(), vertices.end(), [](const glm::vec3& a, const glm::vec3& b) {
+        return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+    });
+    vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+    hull.vertices = std::move(vertices);
+    hull.faceExtents.reserve(hull.faceAxes.size());
+    for (const glm::vec3& axis : hull.faceAxes) {
+        glm::vec2 extent(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
+        for (const glm::vec3& v : hull.vertices) {
+            const float p = glm::dot(v, axis);
+            extent = glm::vec2(std::min(extent.x, p), std::max(extent.y, p));
+        }
+        hull.faceExtents.push_back(extent);
+    }
+    return hull;
 }
 
 engine::ModelManager::ModelManager(Renderer* renderer) : renderer(renderer) {
@@ -470,6 +771,13 @@ engine::ModelManager::ModelManager(Renderer* renderer) : renderer(renderer) {
 }
 
 engine::ModelManager::~ModelManager() {
+    // in-flight parses write into the models, let them drain before deleting
+    cancelStreaming.store(true, std::memory_order_relaxed);
+    while (streamingInFlight.load(std::memory_order_acquire) > 0) {
+        std::this_thread::yield();
+    }
+    // submitted copies target model buffers, finish them before deleting
+    renderer->waitForUploads();
     for (auto& [name, model] : models) {
         delete model;
     }
@@ -486,8 +794,103 @@ void engine::ModelManager::init() {
             std::cout << "Warning: Duplicate model name detected: " << modelName << ". Skipping.\n";
             continue;
         }
-        Model* model = new Model(modelName, asset.data, asset.size, renderer);
-        model->loadFromMemory();
-        models[modelName] = model;
+        models[modelName] = new Model(modelName, asset.data, asset.size, renderer);
     }
 }
+
+engine::AssetState engine::ModelManager::requestModel(const std::string& name) {
+    auto it = models.find(name);
+    if (it == models.end()) return AssetState::Missing;
+    return requestModel(it->second);
+}
+
+engine::AssetState engine::ModelManager::requestModel(Model* model) {
+    if (model->getState() != AssetState::Pending) return model->getState();
+    if (requestedModels.insert(model).second) {
+        streamingInFlight.fetch_add(1, std::memory_order_relaxed);
+        ThreadPool::global().submit([this, model] {
+            ParsedModel parsed{ model, nullptr };
+            if (!cancelStreaming.load(std::memory_order_relaxed)) {
+                try {
+                    model->parse();
+                } catch (...) {
+                    parsed.error = std::current_exception();
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(streamedMutex);
+                streamedModels.push_back(parsed);
+            }
+            streamingInFlight.fetch_sub(1, std::memory_order_release);
+        });
+    }
+    return AssetState::Pending;
+}
+
+void engine::ModelManager::preloadModels(const std::vector<std::string>& names) {
+    for (const std::string& name : names) {
+        requestModel(name);
+    }
+}
+
+void engine::ModelManager::waitForModels(const std::vector<std::string>& names) {
+    preloadModels(names);
+    auto anyPending = [&] {
+        return std::any_of(names.begin(), names.end(), [&](const std::string& name) {
+            return requestModel(name) == AssetState::Pending;
+        });
+    };
+    while (anyPending()) {
+        const bool submitted = submitStreamedModels(std::numeric_limits<size_t>::max());
+        if (!renderer->processCompletedUploads() && !submitted) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool engine::ModelManager::processStreamedModels(size_t maxUploads) {
+    submitStreamedModels(maxUploads);
+    return std::exchange(streamedModelsResident, false);
+}
+
+bool engine::ModelManager::submitStreamedModels(size_t maxUploads) {
+    std::vector<ParsedModel> ready;
+    {
+        std::lock_guard<std::mutex> lock(streamedMutex);
+        const size_t count = std::min(maxUploads, streamedModels.size());
+        if (count == 0) return false;
+        ready.assign(streamedModels.begin(), streamedModels.begin() + static_cast<std::ptrdiff_t>(count));
+        streamedModels.erase(streamedModels.begin(), streamedModels.begin() + static_cast<std::ptrdiff_t>(count));
+    }
+    // buffer creation stays on this thread, the copies share one fenced submission and the
+    // models stay requested and pending until it signals
+    std::vector<BufferUpload> uploads;
+    uploads.reserve(ready.size() * 3);
+    std::vector<Model*> uploaded;
+    uploaded.reserve(ready.size());
+    for (const ParsedModel& parsed : ready) {
+        if (parsed.error) {
+            // stale or corrupt cooked data, same as a failed startup load
+            requestedModels.erase(parsed.model);
+            parsed.model->setState(AssetState::Missing);
+            std::rethrow_exception(parsed.error);
+        }
+        parsed.model->createBuffers(uploads);
+        uploaded.push_back(parsed.model);
+    }
+    VkCommandBuffer commandBuffer = renderer->beginUploadCommands();
+    std::vector<std::pair<VkBuffer, VkDeviceMemory>> stagingBuffers;
+    renderer->copyDataToBuffersInline(commandBuffer, uploads, stagingBuffers);
+    // the host copies are in staging memory now
+    for (Model* model : uploaded) {
+        model->releaseStagingData();
+    }
+    renderer->submitUploadCommands(commandBuffer, std::move(stagingBuffers), [this, uploaded = std::move(uploaded)] {
+        for (Model* model : uploaded) {
+            requestedModels.erase(model);
+            model->setState(AssetState::Resident);
+        }
+        streamedModelsResident = true;
+    });
+    return true;
+}
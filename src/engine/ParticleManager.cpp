@@ -9,6 +9,9 @@
 #include <engine/Profiler.h>
 #include <engine/SIMD.h>
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 void engine::ParticleManager::ParticleSoA::clearAll() {
     posX.clear(); posY.clear(); posZ.clear();
@@ -49,33 +52,71 @@ size_t engine::ParticleManager::ParticleSoA::push(
 void engine::ParticleManager::ParticleSoA::truncateFront(size_t n) {
     if (n == 0) return;
     if (n >= count()) { clearAll(); return; }
-    for (size_t i = 0; i < n; ++i) dead[i] = 1;
-    compactDead();
+    for (std::vector<float>* array : floatArrays()) {
+        array->erase(array->begin(), array->begin() + static_cast<ptrdiff_t>(n));
+    }
+    dead.erase(dead.begin(), dead.begin() + static_cast<ptrdiff_t>(n));
 }
 
-void engine::ParticleManager::ParticleSoA::compactDead() {
+void engine::ParticleManager::ParticleSoA::compactDead(bool preserveOrder) {
     const size_t n = count();
-    size_t w = 0;
-    for (size_t r = 0; r < n; ++r) {
-        if (dead[r]) continue;
-        if (w != r) {
-            posX[w] = posX[r]; posY[w] = posY[r]; posZ[w] = posZ[r];
-            velX[w] = velX[r]; velY[w] = velY[r]; velZ[w] = velZ[r];
-            prevPosX[w] = prevPosX[r]; prevPosY[w] = prevPosY[r]; prevPosZ[w] = prevPosZ[r];
-            prevPrevPosX[w] = prevPrevPosX[r]; prevPrevPosY[w] = prevPrevPosY[r]; prevPrevPosZ[w] = prevPrevPosZ[r];
-            age[w] = age[r]; lifetime[w] = lifetime[r]; type[w] = type[r];
-            dead[w] = 0;
-            size[w] = size[r];
-            colorR[w] = colorR[r]; colorG[w] = colorG[r]; colorB[w] = colorB[r];
+    const size_t deadCount = static_cast<size_t>(std::count(dead.begin(), dead.end(), uint8_t{1}));
+    if (deadCount == 0) return;
+    if (deadCount == n) { clearAll(); return; }
+    auto arrays = floatArrays();
+
+    // a handful of holes is cheaper to fill from the back than to stream every array
+    if (!preserveOrder && deadCount * 16 < n) {
+        size_t last = n;
+        for (size_t i = 0; i < last; ++i) {
+            if (!dead[i]) continue;
+            while (last > i + 1 && dead[last - 1]) --last;
+            --last;
+            if (last != i) {
+                for (std::vector<float>* array : arrays) {
+                    (*array)[i] = (*array)[last];
+                }
+                dead[i] = 0;
+            }
+        }
+        const size_t alive = n - deadCount;
+        for (std::vector<float>* array : arrays) {
+            array->resize(alive);
+        }
+        dead.assign(alive, 0);
+        return;
+    }
+
+    // chunk survivor counts give each chunk its output offset, survivors are packed into scratch arrays
+    static thread_local std::array<std::vector<float>, 19> scratch;
+    static thread_local std::vector<size_t> chunkBase;
+    ThreadPool& pool = ThreadPool::global();
+    constexpr size_t kMinChunk = 4096;
+    const size_t chunks = pool.numChunks(0, n, kMinChunk);
+    chunkBase.assign(chunks + 1, 0);
+    pool.parallel_for_chunks(0, n, kMinChunk, [&](size_t b, size_t e, size_t chunk) {
+        size_t alive = 0;
+        for (size_t i = b; i < e; ++i) {
+            alive += dead[i] == 0;
+        }
+        chunkBase[chunk + 1] = alive;
+    });
+    for (size_t c = 0; c < chunks; ++c) {
+        chunkBase[c + 1] += chunkBase[c];
+    }
+    const size_t alive = n - deadCount;
+    for (std::vector<float>& array : scratch) {
+        array.resize(alive);
+    }
+    pool.parallel_for_chunks(0, n, kMinChunk, [&](size_t b, size_t e, size_t chunk) {
+        for (size_t a = 0; a < arrays.size(); ++a) {
+            engine::simd::compactFloats(arrays[a]->data() + b, dead.data() + b, e - b, scratch[a].data() + chunkBase[chunk]);
         }
-        ++w;
-    }
-    posX.resize(w); posY.resize(w); posZ.resize(w);
-    velX.resize(w); velY.resize(w); velZ.resize(w);
-    prevPosX.resize(w); prevPosY.resize(w); prevPosZ.resize(w);
-    prevPrevPosX.resize(w); prevPrevPosY.resize(w); prevPrevPosZ.resize(w);
-    age.resize(w); lifetime.resize(w); type.resize(w); dead.resize(w);
-    size.resize(w); colorR.resize(w); colorG.resize(w); colorB.resize(w);
+    });
+    for (size_t a = 0; a < arrays.size(); ++a) {
+        arrays[a]->swap(scratch[a]);
+    }
+    dead.assign(alive, 0);
 }
 
 engine::ParticleGPU engine::ParticleManager::makeGPU(size_t i) const {
@@ -87,34 +128,175 @@ engine::ParticleGPU engine::ParticleManager::makeGPU(size_t i) const {
     };
 }
 
-void engine::ParticleManager::collideOne(size_t i, float deltaTime) {
-    if (particles.dead[i]) return;
-    if (particles.type[i] == 1.0f) return;
-    if (particles.age[i] <= 0.15f) return;
+static constexpr float kParticleRadius = 0.05f;
 
-    const float vx = particles.velX[i];
-    const float vy = particles.velY[i];
-    const float vz = particles.velZ[i];
-    const float speedSq = vx * vx + vy * vy + vz * vz;
-    if (speedSq <= 1.0f) return;
+float engine::ParticleManager::spawnScale(const glm::vec3& position, float reach) const {
+    Camera* camera = renderer->getEntityManager()->getCamera();
+    if (!camera) return 1.0f;
+    const float distance = glm::length(position - glm::vec3(camera->getWorldTransform()[3]));
+    float scale = distance > kFullDetailDistance ? std::max(kFullDetailDistance / distance, kMinSpawnScale) : 1.0f;
+    if (!camera->isSphereInFrustum(position, reach)) {
+        scale *= kOffscreenSpawnScale;
+    }
+    // thin bursts out as the pool fills instead of letting truncateFront kill the oldest
+    const float fill = static_cast<float>(particles.count()) / static_cast<float>(hardCap);
+    if (fill > 0.5f) {
+        scale *= std::max(2.0f * (1.0f - fill), 0.0f);
+    }
+    return scale;
+}
 
-    const glm::vec3 currentPos(particles.prevPosX[i], particles.prevPosY[i], particles.prevPosZ[i]);
-    glm::vec3 newPos(particles.posX[i], particles.posY[i], particles.posZ[i]);
+void engine::ParticleManager::assignSimulationTiers() {
+    const size_t n = particles.count();
+    stepScale.resize(n);
+    cameraDistanceSq.resize(n);
+    Camera* camera = renderer->getEntityManager()->getCamera();
+    if (!camera) {
+        std::fill(stepScale.begin(), stepScale.end(), 1.0f);
+        std::fill(cameraDistanceSq.begin(), cameraDistanceSq.end(), 0.0f);
+        return;
+    }
+    const glm::vec3 cameraPos = glm::vec3(camera->getWorldTransform()[3]);
+    // far particles all step together on even frames with twice the dt
+    const float farStep = (simFrame & 1u) == 0u ? 2.0f : 0.0f;
+    constexpr float kFarTierDistanceSq = kFarTierDistance * kFarTierDistance;
+    for (size_t i = 0; i < n; ++i) {
+        const float dx = particles.posX[i] - cameraPos.x;
+        const float dy = particles.posY[i] - cameraPos.y;
+        const float dz = particles.posZ[i] - cameraPos.z;
+        const float distanceSq = dx * dx + dy * dy + dz * dz;
+        cameraDistanceSq[i] = distanceSq;
+        stepScale[i] = distanceSq > kFarTierDistanceSq ? farStep : 1.0f;
+    }
+}
 
-    const float particleRadius = 0.05f;
-    const float stepLen = std::sqrt(speedSq) * deltaTime;
-    const float expand = particleRadius + stepLen;
-    engine::AABB sweepAABB = {
-        .min = glm::min(currentPos, newPos) - glm::vec3(expand),
-        .max = glm::max(currentPos, newPos) + glm::vec3(expand)
+void engine::ParticleManager::collideParticles(float deltaTime) {
+    // particles are binned by the grid cell of their sweep, each cell queries the grid once for all of them
+    struct BinnedParticle {
+        size_t cell;
+        uint32_t index;
     };
-    static thread_local engine::SpatialGrid::Candidates candidates;
-    renderer->getEntityManager()->getSpatialGrid().query(sweepAABB, candidates, 0.0f);
+    static thread_local std::vector<BinnedParticle> binned;
+    static thread_local std::vector<engine::AABB> sweeps;
+    static thread_local std::vector<size_t> binStarts;
+    binned.clear();
+    binStarts.clear();
+    const size_t count = particles.count();
+    sweeps.resize(count);
+    const SpatialGrid& grid = renderer->getEntityManager()->getSpatialGrid();
+    constexpr float kFarTierDistanceSq = kFarTierDistance * kFarTierDistance;
+    for (size_t i = 0; i < count; ++i) {
+        if (particles.dead[i] || particles.type[i] == 1.0f || particles.age[i] <= 0.15f) continue;
+        if (cameraDistanceSq[i] > kFarTierDistanceSq) continue;
+        const float vx = particles.velX[i];
+        const float vy = particles.velY[i];
+        const float vz = particles.velZ[i];
+        const float speedSq = vx * vx + vy * vy + vz * vz;
+        if (speedSq <= 1.0f) continue;
+        const glm::vec3 currentPos(particles.prevPosX[i], particles.prevPosY[i], particles.prevPosZ[i]);
+        const glm::vec3 newPos(particles.posX[i], particles.posY[i], particles.posZ[i]);
+        const float expand = kParticleRadius + std::sqrt(speedSq) * deltaTime;
+        sweeps[i] = {
+            .min = glm::min(currentPos, newPos) - glm::vec3(expand),
+            .max = glm::max(currentPos, newPos) + glm::vec3(expand)
+        };
+        binned.push_back({ grid.cellIndexAt((sweeps[i].min + sweeps[i].max) * 0.5f), static_cast<uint32_t>(i) });
+    }
+    if (binned.empty()) return;
+    // over budget, only the particles nearest the camera collide this frame
+    if (binned.size() > kCollisionBudgetPerFrame) {
+        std::nth_element(binned.begin(), binned.begin() + kCollisionBudgetPerFrame, binned.end(), [&](const BinnedParticle& a, const BinnedParticle& b) {
+            return cameraDistanceSq[a.index] < cameraDistanceSq[b.index];
+        });
+        binned.resize(kCollisionBudgetPerFrame);
+    }
+    std::sort(binned.begin(), binned.end(), [](const BinnedParticle& a, const BinnedParticle& b) {
+        return a.cell != b.cell ? a.cell < b.cell : a.index < b.index;
+    });
+    for (size_t b = 0; b < binned.size(); ++b) {
+        if (b == 0 || binned[b].cell != binned[b - 1].cell) {
+            binStarts.push_back(b);
+        }
+    }
+    binStarts.push_back(binned.size());
+
+    auto collideBin = [&](size_t bin) {
+        static thread_local engine::SpatialGrid::Candidates candidates;
+        static thread_local std::vector<float> px, py, pz;
+        static thread_local std::vector<uint8_t> hits;
+        const size_t first = binStarts[bin];
+        const size_t n = binStarts[bin + 1] - first;
+        engine::AABB binBounds = sweeps[binned[first].index];
+        px.resize(n); py.resize(n); pz.resize(n);
+        hits.assign(n, 0);
+        for (size_t j = 0; j < n; ++j) {
+            const uint32_t i = binned[first + j].index;
+            binBounds.min = glm::min(binBounds.min, sweeps[i].min);
+            binBounds.max = glm::max(binBounds.max, sweeps[i].max);
+            px[j] = particles.posX[i];
+            py[j] = particles.posY[i];
+            pz[j] = particles.posZ[i];
+        }
+        grid.query(binBounds, candidates, 0.0f);
+
+        // SIMD pass over the whole bin finds which particles touch anything, only those run the scalar narrow phase
+        bool anyHit = false;
+        for (size_t c = 0; c < candidates.size(); ++c) {
+            if (!candidates.intersects[c]) continue;
+            const float boundsMin[3] = { candidates.minX[c], candidates.minY[c], candidates.minZ[c] };
+            const float boundsMax[3] = { candidates.maxX[c], candidates.maxY[c], candidates.maxZ[c] };
+            float center[3] = {};
+            float axes[9] = {};
+            float halfSize[3] = {};
+            Collider* collider = candidates.colliders[c];
+            const bool oriented = collider->getColliderType() == Collider::ColliderType::OBB;
+            if (oriented) {
+                OBBCollider* obb = static_cast<OBBCollider*>(collider);
+                const glm::mat4 worldTransform = obb->getWorldTransform();
+                const glm::vec3 obbHalfSize = obb->getHalfSize();
+                for (int a = 0; a < 3; ++a) {
+                    const glm::vec3 axis = glm::normalize(glm::vec3(worldTransform[a]));
+                    axes[a * 3 + 0] = axis.x;
+                    axes[a * 3 + 1] = axis.y;
+                    axes[a * 3 + 2] = axis.z;
+                    center[a] = worldTransform[3][a];
+                    halfSize[a] = obbHalfSize[a];
+                }
+            }
+            // convex hulls only get the bounds test here, the narrow phase decides
+            engine::simd::pointsVsBox(
+                px.data(), py.data(), pz.data(), n,
+                boundsMin, boundsMax, kParticleRadius,
+                oriented, center, axes, halfSize,
+                hits.data());
+            anyHit = true;
+        }
+        if (!anyHit) return;
+        for (size_t j = 0; j < n; ++j) {
+            if (hits[j]) {
+                resolveCollision(binned[first + j].index, candidates, deltaTime);
+            }
+        }
+    };
+    const size_t binCount = binStarts.size() - 1;
+    if (binCount > 1) {
+        ThreadPool::global().parallel_for_chunks(0, binCount, 4, [&](size_t b, size_t e, size_t) {
+            for (size_t bin = b; bin < e; ++bin) {
+                collideBin(bin);
+            }
+        });
+    } else {
+        collideBin(0);
+    }
+}
 
+void engine::ParticleManager::resolveCollision(size_t i, const engine::SpatialGrid::Candidates& candidates, float deltaTime) {
+    glm::vec3 newPos(particles.posX[i], particles.posY[i], particles.posZ[i]);
     Collider::Collision collision = narrowPhaseCollision(newPos, candidates);
     if (!collision.other) return;
 
-    glm::vec3 velocity(vx, vy, vz);
+    const glm::vec3 currentPos(particles.prevPosX[i], particles.prevPosY[i], particles.prevPosZ[i]);
+    glm::vec3 velocity(particles.velX[i], particles.velY[i], particles.velZ[i]);
     glm::vec3 normal = glm::normalize(collision.mtv.normal);
     velocity = velocity - 2.0f * glm::dot(velocity, normal) * normal;
     velocity *= 0.5f;
@@ -134,10 +316,9 @@ void engine::ParticleManager::collideOne(size_t i, float deltaTime) {
 }
 
 engine::Collider::Collision engine::ParticleManager::checkCollision(const glm::vec3& position) {
-    const float particleRadius = 0.05f;
     engine::AABB particleAABB = {
-        .min = position - glm::vec3(particleRadius),
-        .max = position + glm::vec3(particleRadius)
+        .min = position - glm::vec3(kParticleRadius),
+        .max = position + glm::vec3(kParticleRadius)
     };
     static thread_local engine::SpatialGrid::Candidates candidates;
     renderer->getEntityManager()->getSpatialGrid().query(particleAABB, candidates, 0.0f);
@@ -145,10 +326,9 @@ engine::Collider::Collision engine::ParticleManager::checkCollision(const glm::v
 }
 
 engine::Collider::Collision engine::ParticleManager::narrowPhaseCollision(const glm::vec3& position, const engine::SpatialGrid::Candidates& candidates) {
-    const float particleRadius = 0.05f;
     engine::AABB particleAABB = {
-        .min = position - glm::vec3(particleRadius),
-        .max = position + glm::vec3(particleRadius)
+        .min = position - glm::vec3(kParticleRadius),
+        .max = position + glm::vec3(kParticleRadius)
     };
     const size_t n = candidates.size();
     for (size_t idx = 0; idx < n; ++idx) {
@@ -216,6 +396,7 @@ engine::Collider::Collision engine::ParticleManager::narrowPhaseCollision(const
                 ConvexHullCollider* hull = static_cast<ConvexHullCollider*>(collider);
                 const std::vector<glm::vec3>& faceAxes = hull->getFaceAxesCached();
                 const std::vector<glm::vec3>& worldVerts = hull->getWorldVerts();
+                if (worldVerts.empty()) break; // hull model still streaming
                 bool inside = true;
                 float minDist = std::numeric_limits<float>::max();
                 glm::vec3 closestNormal(0.0f);
@@ -292,10 +473,50 @@ engine::ParticleManager::~ParticleManager() {
     particleBufferMemory.clear();
     particleBuffersMapped.clear();
     particles.clearAll();
+
+    VkDevice device = renderer->getDevice();
+    for (size_t i = 0; i < gpuEmitBuffers.size(); ++i) {
+        if (gpuEmitMapped[i] != nullptr) {
+            vkUnmapMemory(device, gpuEmitMemory[i]);
+        }
+        vkDestroyBuffer(device, gpuEmitBuffers[i], nullptr);
+        vkFreeMemory(device, gpuEmitMemory[i], nullptr);
+    }
+    for (size_t p = 0; p < gpuPools.size(); ++p) {
+        if (gpuPools[p] == VK_NULL_HANDLE) continue;
+        vkDestroyBuffer(device, gpuPools[p], nullptr);
+        vkFreeMemory(device, gpuPoolMemory[p], nullptr);
+    }
+    if (gpuCounters != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, gpuCounters, nullptr);
+        vkFreeMemory(device, gpuCountersMemory, nullptr);
+    }
 }
 
 void engine::ParticleManager::clear() {
     std::fill(particles.dead.begin(), particles.dead.end(), uint8_t{1});
+    pendingEmits.clear();
+    gpuCountersDirty = true;
+    gpuLiveUntil = gpuTime;
+}
+
+bool engine::ParticleManager::hasParticles() const {
+    return gpuSimulation ? gpuTime < gpuLiveUntil : !particles.empty();
+}
+
+void engine::ParticleManager::setGPUSimulation(bool enabled) {
+    if (enabled == gpuSimulation) return;
+    if (enabled) {
+        if (gpuPools[0] == VK_NULL_HANDLE) {
+            createGPUResources();
+        }
+        particles.clearAll();
+        visibleCount = 0;
+    }
+    pendingEmits.clear();
+    gpuCountersDirty = true;
+    gpuLiveUntil = gpuTime;
+    gpuSimulation = enabled;
 }
 
 void engine::ParticleManager::createParticleDescriptorSets() {
@@ -367,13 +588,223 @@ void engine::ParticleManager::createParticleDescriptorSets() {
         }};
         vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
     }
+    drawSources.assign(frames, -1);
+    if (gpuPools[0] != VK_NULL_HANDLE) {
+        writeGPUDescriptorSets();
+    }
+}
+
+void engine::ParticleManager::createGPUResources() {
+    VkDevice device = renderer->getDevice();
+    ComputeShader* shader = renderer->getShaderManager()->getComputeShader("particlesim");
+    if (!shader || shader->descriptorPool == VK_NULL_HANDLE) {
+        throw std::runtime_error("Failed to get particle sim compute shader!");
+    }
+    const VkDeviceSize poolSize = static_cast<VkDeviceSize>(kMaxGPUParticles) * (sizeof(ParticleGPU) + sizeof(glm::vec4));
+    for (size_t p = 0; p < gpuPools.size(); ++p) {
+        std::tie(gpuPools[p], gpuPoolMemory[p]) = renderer->createBuffer(
+            poolSize,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+        );
+    }
+    std::tie(gpuCounters, gpuCountersMemory) = renderer->createBuffer(
+        kGPUParticleCounterCount * sizeof(uint32_t),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+    );
+
+    const size_t frames = static_cast<size_t>(renderer->getMaxFramesInFlight());
+    const VkDeviceSize emitSize = kMaxGPUParticleEmits * sizeof(GPUParticleEmit);
+    gpuEmitBuffers.resize(frames);
+    gpuEmitMemory.resize(frames);
+    gpuEmitMapped.resize(frames, nullptr);
+    for (size_t i = 0; i < frames; ++i) {
+        std::tie(gpuEmitBuffers[i], gpuEmitMemory[i]) = renderer->createBuffer(
+            emitSize,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        );
+        vkMapMemory(device, gpuEmitMemory[i], 0, emitSize, 0, &gpuEmitMapped[i]);
+    }
+    gpuFrames.assign(frames, GPUFrame{});
+
+    std::vector<VkDescriptorSetLayout> layouts(frames * 2, shader->descriptorSetLayout);
+    VkDescriptorSetAllocateInfo allocInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = shader->descriptorPool,
+        .descriptorSetCount = static_cast<uint32_t>(layouts.size()),
+        .pSetLayouts = layouts.data()
+    };
+    gpuSimSets.resize(layouts.size(), VK_NULL_HANDLE);
+    if (vkAllocateDescriptorSets(device, &allocInfo, gpuSimSets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate particle sim descriptor sets!");
+    }
+    writeGPUDescriptorSets();
+}
+
+void engine::ParticleManager::writeGPUDescriptorSets() {
+    VkDevice device = renderer->getDevice();
+    VkImageView depthImageView = renderer->getPassImageView("gbuffer", "Depth");
+    VkImageView normalImageView = renderer->getPassImageView("gbuffer", "Normal");
+    if (depthImageView == VK_NULL_HANDLE || normalImageView == VK_NULL_HANDLE) {
+        throw std::runtime_error("Failed to get gbuffer image views for particle simulation!");
+    }
+    const VkDeviceSize particleRange = static_cast<VkDeviceSize>(kMaxGPUParticles) * sizeof(ParticleGPU);
+    const VkDeviceSize velocityRange = static_cast<VkDeviceSize>(kMaxGPUParticles) * sizeof(glm::vec4);
+    const size_t frames = gpuEmitBuffers.size();
+    for (size_t i = 0; i < frames; ++i) {
+        for (uint32_t src = 0; src < 2; ++src) {
+            const uint32_t dst = src ^ 1u;
+            const VkDescriptorSet set = gpuSimSets[i * 2 + src];
+            std::array<VkDescriptorBufferInfo, 6> bufferInfos = {{
+                { gpuPools[src], 0, particleRange },
+                { gpuPools[src], particleRange, velocityRange },
+                { gpuPools[dst], 0, particleRange },
+                { gpuPools[dst], particleRange, velocityRange },
+                { gpuCounters, 0, VK_WHOLE_SIZE },
+                { gpuEmitBuffers[i], 0, VK_WHOLE_SIZE }
+            }};
+            std::array<VkDescriptorImageInfo, 2> imageInfos = {{
+                { .sampler = VK_NULL_HANDLE, .imageView = depthImageView, .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+                { .sampler = VK_NULL_HANDLE, .imageView = normalImageView, .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }
+            }};
+            std::array<VkWriteDescriptorSet, 8> writes{};
+            for (uint32_t b = 0; b < writes.size(); ++b) {
+                const bool isImage = b >= bufferInfos.size();
+                writes[b] = {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = set,
+                    .dstBinding = b,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = isImage ? VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .pImageInfo = isImage ? &imageInfos[b - bufferInfos.size()] : nullptr,
+                    .pBufferInfo = isImage ? nullptr : &bufferInfos[b]
+                };
+            }
+            vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+        }
+    }
+}
+
+void engine::ParticleManager::bindDrawSource(uint32_t currentFrame, int32_t source) {
+    if (drawSources[currentFrame] == source) return;
+    // the frame's fence has been waited on, so its set can be repointed in place
+    VkDescriptorBufferInfo bufferInfo = source < 0
+        ? VkDescriptorBufferInfo{ particleBuffers[currentFrame], 0, VK_WHOLE_SIZE }
+        : VkDescriptorBufferInfo{ gpuPools[source], 0, static_cast<VkDeviceSize>(kMaxGPUParticles) * sizeof(ParticleGPU) };
+    VkWriteDescriptorSet write = {
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = descriptorSets[currentFrame],
+        .dstBinding = 0,
+        .dstArrayElement = 0,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .pBufferInfo = &bufferInfo
+    };
+    vkUpdateDescriptorSets(renderer->getDevice(), 1, &write, 0, nullptr);
+    drawSources[currentFrame] = source;
+}
+
+void engine::ParticleManager::simulateGPU(VkCommandBuffer commandBuffer, uint32_t currentFrame) {
+    ComputeShader* shader = renderer->getShaderManager()->getComputeShader("particlesim");
+    Camera* camera = renderer->getEntityManager()->getCamera();
+    if (!shader || shader->pipeline == VK_NULL_HANDLE || gpuSimSets.empty() || !camera) return;
+    const GPUFrame& frame = gpuFrames[currentFrame];
+
+    auto memoryBarrier = [&](VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) {
+        VkMemoryBarrier barrier = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = srcAccess,
+            .dstAccessMask = dstAccess
+        };
+        vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    };
+    constexpr VkPipelineStageFlags kPreviousUse = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+    constexpr VkAccessFlags kPreviousAccess = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    constexpr VkPipelineStageFlags kSimStages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+    constexpr VkAccessFlags kSimAccess = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+
+    // the previous frame's simulation and draw are done with the pool this frame writes
+    if (frame.resetCounters) {
+        memoryBarrier(kPreviousUse, kPreviousAccess, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+        vkCmdFillBuffer(commandBuffer, gpuCounters, 0, VK_WHOLE_SIZE, 0u);
+        memoryBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, kSimStages, kSimAccess);
+    } else {
+        memoryBarrier(kPreviousUse, kPreviousAccess, kSimStages, kSimAccess);
+    }
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, shader->pipeline);
+    vkCmdBindDescriptorSets(
+        commandBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        shader->pipelineLayout,
+        0,
+        1,
+        &gpuSimSets[currentFrame * 2 + frame.srcPool],
+        0,
+        nullptr
+    );
+    const VkExtent2D extent = renderer->getRenderExtent();
+    ParticleSimPC pc = {
+        .viewProj = camera->getViewProjectionMatrix(),
+        .simParams = glm::vec4(kGravity, frame.deltaTime, 0.15f, 0.5f),
+        .depthSize = glm::uvec2(extent.width, extent.height),
+        .mode = 0u,
+        .srcPool = frame.srcPool,
+        .emitCount = frame.emitCount,
+        .capacity = kMaxGPUParticles
+    };
+    vkCmdPushConstants(commandBuffer, shader->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ParticleSimPC), &pc);
+    // group count was written by the previous finalize from the live count of the source pool
+    vkCmdDispatchIndirect(commandBuffer, gpuCounters, kGPUParticleDispatchArgsOffset * sizeof(uint32_t));
+    memoryBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+    if (frame.emitCount > 0) {
+        pc.mode = 1u;
+        vkCmdPushConstants(commandBuffer, shader->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ParticleSimPC), &pc);
+        vkCmdDispatch(commandBuffer, frame.emitCount, 1, 1);
+        memoryBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+    }
+
+    pc.mode = 2u;
+    vkCmdPushConstants(commandBuffer, shader->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ParticleSimPC), &pc);
+    vkCmdDispatch(commandBuffer, 1, 1, 1);
+    memoryBarrier(
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_ACCESS_SHADER_WRITE_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT
+    );
 }
 
 void engine::ParticleManager::burstParticles(const glm::vec3& position, const glm::vec3& color, const glm::vec3& velocity, int count, float lifetime, float spread, float size) {
+    if (count <= 0) return;
+    // far, offscreen and late bursts spawn fewer particles, and the frame's spawn budget caps them all
+    const float reach = glm::length(velocity) * lifetime + 1.0f;
+    size_t spawnCount = static_cast<size_t>(std::ceil(static_cast<float>(count) * spawnScale(position, reach)));
+    spawnCount = std::min(spawnCount, static_cast<size_t>(kSpawnBudgetPerFrame - std::min(spawnedThisFrame, kSpawnBudgetPerFrame)));
+    if (spawnCount == 0) return;
+    if (gpuSimulation) {
+        if (pendingEmits.size() >= kMaxGPUParticleEmits) return;
+        spawnedThisFrame += static_cast<uint32_t>(spawnCount);
+        // per-particle jitter is hashed from the seed on the GPU
+        const float velLength = glm::length(velocity) + dist(rng) * 0.1f * glm::length(velocity);
+        pendingEmits.push_back({
+            .positionLifetime = glm::vec4(position, lifetime),
+            .velocitySpread = glm::vec4(velocity, spread * velLength),
+            .colorSize = glm::vec4(color, size),
+            .params = glm::uvec4(static_cast<uint32_t>(spawnCount), 0u, static_cast<uint32_t>(rng()), 0u)
+        });
+        gpuLiveUntil = std::max(gpuLiveUntil, gpuTime + lifetime * 1.2);
+        return;
+    }
     if (particles.count() >= hardCap) return;
     float velLength = glm::length(velocity) + dist(rng) * 0.1f * glm::length(velocity);
     size_t remaining = hardCap - particles.count();
-    size_t spawnCount = std::min(static_cast<size_t>(count), remaining);
+    spawnCount = std::min(spawnCount, remaining);
+    spawnedThisFrame += static_cast<uint32_t>(spawnCount);
     for (size_t i = 0; i < spawnCount; ++i) {
         float offsetX = dist(rng) * spread * velLength;
         float offsetY = dist(rng) * spread * velLength;
@@ -388,6 +819,19 @@ void engine::ParticleManager::burstParticles(const glm::vec3& position, const gl
 }
 
 void engine::ParticleManager::spawnTrail(const glm::vec3& start, const glm::vec3& dir, const glm::vec3& color, float lifetime, float fakeAge) {
+    if (spawnedThisFrame >= kSpawnBudgetPerFrame) return;
+    ++spawnedThisFrame;
+    if (gpuSimulation) {
+        if (pendingEmits.size() >= kMaxGPUParticleEmits) return;
+        pendingEmits.push_back({
+            .positionLifetime = glm::vec4(start, lifetime),
+            .velocitySpread = glm::vec4(dir, 0.0f),
+            .colorSize = glm::vec4(color, 1.0f),
+            .params = glm::uvec4(1u, 1u, 0u, glm::floatBitsToUint(fakeAge))
+        });
+        gpuLiveUntil = std::max(gpuLiveUntil, gpuTime + static_cast<double>(lifetime - fakeAge));
+        return;
+    }
     if (particles.count() >= hardCap) return;
     const size_t i = particles.push(start, color, glm::vec3(0.0f), lifetime, 1.0f, 1.0f);
     // Trail particles encode (start, dir) into the prevPrev / prev slots for streak rendering
@@ -402,6 +846,27 @@ void engine::ParticleManager::spawnTrail(const glm::vec3& start, const glm::vec3
 
 void engine::ParticleManager::updateParticleBuffer(uint32_t currentFrame) {
     VkDevice device = renderer->getDevice();
+    if (gpuSimulation) {
+        const uint32_t emitCount = static_cast<uint32_t>(pendingEmits.size());
+        if (emitCount > 0) {
+            std::memcpy(gpuEmitMapped[currentFrame], pendingEmits.data(), emitCount * sizeof(GPUParticleEmit));
+            pendingEmits.clear();
+        }
+        GPUFrame& frame = gpuFrames[currentFrame];
+        frame = {
+            .srcPool = gpuSrcPool,
+            .emitCount = emitCount,
+            .deltaTime = gpuDeltaTime,
+            .resetCounters = gpuCountersDirty,
+            .live = hasParticles()
+        };
+        gpuSrcPool ^= 1u;
+        gpuDeltaTime = 0.0f;
+        gpuCountersDirty = false;
+        bindDrawSource(currentFrame, static_cast<int32_t>(frame.srcPool ^ 1u));
+        visibleCount = 0;
+        return;
+    }
     if (particles.count() > hardCap) {
         size_t toRemove = particles.count() - hardCap;
         particles.truncateFront(toRemove);
@@ -439,26 +904,60 @@ void engine::ParticleManager::updateParticleBuffer(uint32_t currentFrame) {
         createParticleDescriptorSets();
         renderer->createComputeDescriptorSets();
     }
+    bindDrawSource(currentFrame, -1);
     ParticleGPU* gpuData = static_cast<ParticleGPU*>(particleBuffersMapped[currentFrame]);
     visibleCount = 0;
-    uint32_t backIdx = static_cast<uint32_t>(particles.count());
     Camera* camera = renderer->getEntityManager()->getCamera();
     if (!camera) return;
     const size_t n = particles.count();
-    for (size_t i = 0; i < n; ++i) {
-        if (camera->isSphereInFrustum(positionAt(i), 0.1f)) {
-            gpuData[visibleCount++] = makeGPU(i);
-        } else {
-            gpuData[--backIdx] = makeGPU(i);
-        }
+    if (n == 0) return;
+
+    const auto& planes4 = camera->getFrustumPlanes();
+    engine::simd::Plane planes[6];
+    for (int i = 0; i < 6; ++i) {
+        planes[i] = { planes4[i].x, planes4[i].y, planes4[i].z, planes4[i].w };
     }
-    for (size_t i = visibleCount; i < n; ++i) {
-        gpuData[i] = gpuData[backIdx++];
+
+    // visible particles go first, the rest follow in order, each chunk writes its own contiguous runs
+    static thread_local std::vector<uint8_t> visible;
+    static thread_local std::vector<size_t> chunkVisible;
+    static thread_local std::vector<size_t> chunkVisibleBase;
+    visible.resize(n);
+    ThreadPool& pool = ThreadPool::global();
+    constexpr size_t kMinChunk = 2048;
+    const size_t chunks = pool.numChunks(0, n, kMinChunk);
+    chunkVisible.assign(chunks, 0);
+    chunkVisibleBase.resize(chunks);
+    pool.parallel_for_chunks(0, n, kMinChunk, [&](size_t b, size_t e, size_t chunk) {
+        engine::simd::cullSpheresAgainstFrustum(
+            particles.posX.data() + b, particles.posY.data() + b, particles.posZ.data() + b,
+            e - b,
+            0.1f,
+            planes,
+            visible.data() + b);
+        size_t count = 0;
+        for (size_t i = b; i < e; ++i) {
+            count += visible[i];
+        }
+        chunkVisible[chunk] = count;
+    });
+    size_t totalVisible = 0;
+    for (size_t c = 0; c < chunks; ++c) {
+        chunkVisibleBase[c] = totalVisible;
+        totalVisible += chunkVisible[c];
     }
+    pool.parallel_for_chunks(0, n, kMinChunk, [&](size_t b, size_t e, size_t chunk) {
+        size_t visibleIdx = chunkVisibleBase[chunk];
+        size_t hiddenIdx = totalVisible + (b - chunkVisibleBase[chunk]);
+        for (size_t i = b; i < e; ++i) {
+            gpuData[visible[i] ? visibleIdx++ : hiddenIdx++] = makeGPU(i);
+        }
+    });
+    visibleCount = static_cast<uint32_t>(totalVisible);
 }
 
 void engine::ParticleManager::renderParticles(VkCommandBuffer commandBuffer, uint32_t currentFrame) {
-    if (particles.empty()) return;
+    if (gpuSimulation ? !gpuFrames[currentFrame].live : particles.empty()) return;
     GraphicsShader* shader = renderer->getShaderManager()->getGraphicsShader("particle");
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->pipeline);
     vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
@@ -473,16 +972,28 @@ void engine::ParticleManager::renderParticles(VkCommandBuffer commandBuffer, uin
         .streakScale = 0.00045f
     };
     vkCmdPushConstants(commandBuffer, shader->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(ParticlePC), &pushConstants);
+    if (gpuSimulation) {
+        vkCmdDrawIndirect(commandBuffer, gpuCounters, kGPUParticleDrawArgsOffset * sizeof(uint32_t), 1, sizeof(VkDrawIndirectCommand));
+        return;
+    }
     vkCmdDraw(commandBuffer, 4, static_cast<uint32_t>(visibleCount), 0, 0);
 }
 
 void engine::ParticleManager::updateAll(float deltaTime) {
+    spawnedThisFrame = 0;
+    ++simFrame;
+    if (gpuSimulation) {
+        gpuDeltaTime += deltaTime;
+        gpuTime += deltaTime;
+        return;
+    }
     const size_t count = particles.count();
     profiler::Profiler* profiler = renderer->getProfiler();
 
     {
         PROFILER_ZONE(profiler, profiler::Zone::Update_Particles_Integrate);
-        // SIMD kinematics for every particle
+        // SIMD kinematics, far particles take coarser steps
+        assignSimulationTiers();
         engine::simd::integrateParticleKinematics(
             particles.posX.data(), particles.posY.data(), particles.posZ.data(),
             particles.velX.data(), particles.velY.data(), particles.velZ.data(),
@@ -492,6 +1003,7 @@ void engine::ParticleManager::updateAll(float deltaTime) {
             particles.lifetime.data(),
             particles.type.data(),
             particles.dead.data(),
+            stepScale.data(),
             count,
             deltaTime,
             kGravity
@@ -500,22 +1012,12 @@ void engine::ParticleManager::updateAll(float deltaTime) {
 
     {
         PROFILER_ZONE(profiler, profiler::Zone::Update_Particles_Collision);
-        // scalar collision for the subset of particles that need it
-        if (count > 32) {
-            ThreadPool::global().parallel_for_chunks(0, count, 32, [&](size_t b, size_t e, size_t) {
-                for (size_t i = b; i < e; ++i) {
-                    collideOne(i, deltaTime);
-                }
-            });
-        } else {
-            for (size_t i = 0; i < count; ++i) {
-                collideOne(i, deltaTime);
-            }
-        }
+        collideParticles(deltaTime);
     }
 
     {
         PROFILER_ZONE(profiler, profiler::Zone::Update_Particles_Compact);
-        particles.compactDead();
+        // spawns already respect hardCap, so the draw order of survivors doesn't matter here
+        particles.compactDead(false);
     }
 }
@@ -1,44 +1,62 @@
 #include <engine/Platform.h>
 
 #include <exception>
+#include <filesystem>
 #include <iostream>
+#include <string>
+#include <system_error>
+#include <vector>
 
 #if defined(__APPLE__)
 #include <cstdlib>
-#include <filesystem>
 #include <fstream>
 #include <limits.h>
 #include <mach-o/dyld.h>
-#include <string>
-#include <system_error>
-#include <vector>
+#elif defined(_WIN32)
+#include <windows.h>
 #endif
 
 namespace engine {
 namespace Platform {
 
+	std::filesystem::path executableDir() {
+#if defined(__APPLE__)
+		uint32_t size = PATH_MAX;
+		std::vector<char> buf(size + 1, '\0');
+		if (_NSGetExecutablePath(buf.data(), &size) != 0) {
+			buf.assign(size + 1, '\0');
+			if (_NSGetExecutablePath(buf.data(), &size) != 0) return {};
+		}
+		std::error_code ec;
+		auto p = std::filesystem::weakly_canonical(std::filesystem::path(buf.data()), ec);
+		return ec ? std::filesystem::path{} : p.parent_path();
+#elif defined(_WIN32)
+		char buf[MAX_PATH];
+		DWORD n = GetModuleFileNameA(nullptr, buf, MAX_PATH);
+		if (n == 0 || n == MAX_PATH) return {};
+		std::error_code ec;
+		auto p = std::filesystem::weakly_canonical(std::filesystem::path(std::string(buf, n)), ec);
+		return ec ? std::filesystem::path{} : p.parent_path();
+#else
+		std::error_code ec;
+		auto p = std::filesystem::read_symlink("/proc/self/exe", ec);
+		return ec ? std::filesystem::path{} : p.parent_path();
+#endif
+	}
+
 #if defined(__APPLE__)
 	static void configureBundledVulkanIcd() {
 		if (std::getenv("VK_ICD_FILENAMES") || std::getenv("VK_DRIVER_FILES")) {
 			return;
 		}
 
-		uint32_t executablePathSize = PATH_MAX;
-		std::vector<char> executablePath(executablePathSize + 1, '\0');
-		if (_NSGetExecutablePath(executablePath.data(), &executablePathSize) != 0) {
-			executablePath.assign(executablePathSize + 1, '\0');
-			if (_NSGetExecutablePath(executablePath.data(), &executablePathSize) != 0) {
-				return;
-			}
-		}
-
-		std::error_code ec;
-		std::filesystem::path resolvedExecutable = std::filesystem::weakly_canonical(std::filesystem::path(executablePath.data()), ec);
-		if (ec) {
+		const std::filesystem::path exeDir = executableDir();
+		if (exeDir.empty()) {
 			return;
 		}
 
-		const std::filesystem::path bundledIcdPath = resolvedExecutable.parent_path() / "icd" / "MoltenVK_icd.json";
+		std::error_code ec;
+		const std::filesystem::path bundledIcdPath = exeDir / "icd" / "MoltenVK_icd.json";
 		if (!std::filesystem::exists(bundledIcdPath, ec) || ec) {
 			return;
 		}
@@ -17,6 +17,7 @@
 #include <engine/SettingsManager.h>
 #include <engine/Platform.h>
 #include <engine/Profiler.h>
+#include <engine/ThreadPool.h>
 
 
 #include <glm/glm.hpp>
@@ -54,6 +55,7 @@ void engine::Renderer::cleanup() {
     }
     if (device != VK_NULL_HANDLE) {
         vkDeviceWaitIdle(device);
+        waitForUploads();
         for (VkFence fence : inFlightFences) {
             if (fence != VK_NULL_HANDLE) vkDestroyFence(device, fence, nullptr);
         }
@@ -127,6 +129,7 @@ void engine::Renderer::cleanup() {
             vkDestroySampler(device, linearClampSampler, nullptr);
             linearClampSampler = VK_NULL_HANDLE;
         }
+        destroyRecordWorkerPools();
         if (commandPool != VK_NULL_HANDLE) {
             vkDestroyCommandPool(device, commandPool, nullptr);
             commandPool = VK_NULL_HANDLE;
@@ -193,6 +196,9 @@ void engine::Renderer::initVulkan() {
     ensureFallback2DTexture();
     ensureFallbackShadowCubeTexture();
     particleManager->init();
+    if (settingsManager && settingsManager->getSettings()->gpuParticles) {
+        particleManager->setGPUSimulation(true);
+    }
     volumetricManager->init();
     modelManager->init();
     sceneManager->setActiveScene(0);
@@ -203,6 +209,7 @@ void engine::Renderer::initVulkan() {
     irradianceManager->createAllIrradianceMaps();
     createPostProcessDescriptorSets();
     createCommandBuffers();
+    createRecordWorkerPools();
     createSyncObjects();
     createQuadResources();
 }
@@ -769,6 +776,18 @@ void engine::Renderer::drawFrame() {
             PROFILER_ZONE(profiler, profiler::Zone::Cleanup_Additions);
             entityManager->processPendingAdditions();
         }
+        {
+            PROFILER_ZONE(profiler, profiler::Zone::Cleanup_Streaming);
+            // a few uploads per frame keeps streaming from hitching the frame, uploads run behind a fence
+            // and turn resident here on a later frame once it has signaled
+            processCompletedUploads();
+            if (textureManager->processStreamedTextures(4)) {
+                entityManager->refreshStreamedMaterials();
+            }
+            if (modelManager->processStreamedModels(2)) {
+                entityManager->refreshStreamedModels();
+            }
+        }
         if (shadowMapRecreationPending) {
             PROFILER_ZONE(profiler, profiler::Zone::Cleanup_ShadowMaps);
             lightManager->createAllShadowMaps();
@@ -935,9 +954,49 @@ void engine::Renderer::drawFrame() {
 
     {
         PROFILER_ZONE(profiler, profiler::Zone::Record);
-        for (size_t submissionIdx = 0; submissionIdx < submissions.size(); ++submissionIdx) {
+        // shared state is written here so worker-recorded nodes only read it
+        entityManager->uploadJointMatrices(currentFrame);
+        lightManager->prepareShadows(currentFrame);
+        entityManager->refreshRenderable3DCache();
+        entityManager->prepareDepthPyramid();
+        entityManager->prepareCull(currentFrame);
+
+        recordWorkerSubmissions.clear();
+        if (!recordWorkerPools.empty() && !recordWorkerPools[currentFrame].empty()) {
+            for (size_t submissionIdx = 0; submissionIdx < submissions.size(); ++submissionIdx) {
+                if (renderGraph[submissions[submissionIdx].nodeIdx].canRecordOnWorkerThread) {
+                    recordWorkerSubmissions.push_back(submissionIdx);
+                }
+            }
+        }
+        auto recordSubmission = [&](size_t submissionIdx, VkCommandBuffer commandBuffer) {
             const size_t submissionNodeIdx = submissions[submissionIdx].nodeIdx;
-            recordCommandBuffer(frameSubmissionCommandBuffers[submissionIdx], imageIndex, std::span<const size_t>(&submissionNodeIdx, 1), submissions[submissionIdx].queueClass);
+            recordCommandBuffer(commandBuffer, imageIndex, std::span<const size_t>(&submissionNodeIdx, 1), submissions[submissionIdx].queueClass);
+        };
+        // worker nodes are independent, chunk 0 records into the frame's own command buffers on the caller
+        // thread and the other chunks record into per-worker pools
+        ThreadPool::global().parallel_for_chunks(0, recordWorkerSubmissions.size(), 1, [&](size_t begin, size_t end, size_t chunkIdx) {
+            RecordWorkerPools* pools = nullptr;
+            if (chunkIdx > 0) {
+                pools = &recordWorkerPools[currentFrame][chunkIdx - 1];
+                vkResetCommandPool(device, pools->graphicsPool, 0);
+                vkResetCommandPool(device, pools->computePool, 0);
+                pools->usedGraphics = 0;
+                pools->usedCompute = 0;
+            }
+            for (size_t job = begin; job < end; ++job) {
+                const size_t submissionIdx = recordWorkerSubmissions[job];
+                if (pools) {
+                    frameSubmissionCommandBuffers[submissionIdx] = acquireWorkerCommandBuffer(*pools, submissions[submissionIdx].queueClass);
+                }
+                recordSubmission(submissionIdx, frameSubmissionCommandBuffers[submissionIdx]);
+            }
+        });
+        // main-thread nodes record after the parallel section, so their own parallel_for calls still fan out
+        for (size_t submissionIdx = 0; submissionIdx < submissions.size(); ++submissionIdx) {
+            if (!renderGraph[submissions[submissionIdx].nodeIdx].canRecordOnWorkerThread || recordWorkerSubmissions.empty()) {
+                recordSubmission(submissionIdx, frameSubmissionCommandBuffers[submissionIdx]);
+            }
         }
     }
 
@@ -1110,10 +1169,10 @@ void engine::Renderer::recordCommandBuffer(
             continue;
         }
         const bool skipDraw = node.skipCondition && node.skipCondition(this);
-        recordPreBarriers.clear();
-        recordPostBarriers.clear();
-        std::vector<VkImageMemoryBarrier2>& preBarriers = recordPreBarriers;
-        std::vector<VkImageMemoryBarrier2>& postBarriers = recordPostBarriers;
+        static thread_local std::vector<VkImageMemoryBarrier2> preBarriers;
+        static thread_local std::vector<VkImageMemoryBarrier2> postBarriers;
+        preBarriers.clear();
+        postBarriers.clear();
 
         if (node.passInfo->usesSwapchain) {
             VkImageLayout currentLayout = swapChainImageLayouts.at(imageIndex);
@@ -1363,7 +1422,7 @@ void engine::Renderer::recordCommandBuffer(
             }
         };
         if (!preBarriers.empty()) {
-            std::vector<VkImageMemoryBarrier>& legacyBarriers = recordLegacyBarriers;
+            static thread_local std::vector<VkImageMemoryBarrier> legacyBarriers;
             legacyBarriers.clear();
             legacyBarriers.reserve(preBarriers.size());
             VkPipelineStageFlags srcStages = 0;
@@ -1395,6 +1454,9 @@ void engine::Renderer::recordCommandBuffer(
                 legacyBarriers.data()
             );
         }
+        if (!skipDraw && node.preRenderFunc) {
+            node.preRenderFunc(this, commandBuffer, currentFrame);
+        }
         const bool usesRendering = node.usesRendering;
         bool beganRendering = false;
         bool renderingBlocked = false;
@@ -1516,9 +1578,12 @@ void engine::Renderer::recordCommandBuffer(
         if (beganRendering) {
             fpCmdEndRendering(commandBuffer);
         }
+        if (!skipDraw && node.postRenderFunc) {
+            node.postRenderFunc(this, commandBuffer, currentFrame);
+        }
 
         if (!postBarriers.empty()) {
-            std::vector<VkImageMemoryBarrier>& legacyBarriers = recordLegacyBarriers;
+            static thread_local std::vector<VkImageMemoryBarrier> legacyBarriers;
             legacyBarriers.clear();
             legacyBarriers.reserve(postBarriers.size());
             VkPipelineStageFlags srcStages = 0;
@@ -1771,7 +1836,8 @@ void engine::Renderer::createLogicalDevice() {
         .samplerAnisotropy = VK_TRUE,
         .fragmentStoresAndAtomics = VK_TRUE,
         .shaderStorageImageReadWithoutFormat = VK_TRUE,
-        .shaderStorageImageWriteWithoutFormat = VK_TRUE
+        .shaderStorageImageWriteWithoutFormat = VK_TRUE,
+        .shaderSampledImageArrayDynamicIndexing = VK_TRUE
     };
     VkPhysicalDeviceVulkan13Features vulkan13Features = {
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
@@ -1794,6 +1860,21 @@ void engine::Renderer::createLogicalDevice() {
     if (vulkan11Features.multiview != VK_TRUE) {
         throw std::runtime_error("Device does not support multiview, which is required for shadow rendering.");
     }
+    if (vulkan12Features.descriptorBindingPartiallyBound != VK_TRUE || vulkan12Features.descriptorBindingUpdateUnusedWhilePending != VK_TRUE) {
+        throw std::runtime_error("Device does not support partially bound descriptors, which are required for bindless materials.");
+    }
+    if (vulkan12Features.shaderSampledImageArrayNonUniformIndexing != VK_TRUE) {
+        throw std::runtime_error("Device does not support non-uniform sampled image indexing, which is required for bindless materials.");
+    }
+    pipelineStatisticsSupported = deviceFeatures2.features.pipelineStatisticsQuery == VK_TRUE;
+    deviceFeatures.pipelineStatisticsQuery = pipelineStatisticsSupported ? VK_TRUE : VK_FALSE;
+    blockCompressionSupported = deviceFeatures2.features.textureCompressionBC == VK_TRUE;
+    deviceFeatures.textureCompressionBC = blockCompressionSupported ? VK_TRUE : VK_FALSE;
+    if (!blockCompressionSupported) {
+        std::cout << "Warning: Device does not support BC texture compression, cooked textures will be expanded to RGBA8.\n";
+    }
+    drawIndirectCountSupported = vulkan12Features.drawIndirectCount == VK_TRUE && deviceFeatures2.features.multiDrawIndirect == VK_TRUE;
+    deviceFeatures.multiDrawIndirect = drawIndirectCountSupported ? VK_TRUE : VK_FALSE;
     VkDeviceCreateInfo createInfo = {
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
         .pNext = &vulkan12Features,
@@ -1804,6 +1885,10 @@ void engine::Renderer::createLogicalDevice() {
     VkPhysicalDeviceVulkan12Features enabledVulkan12Features = {
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
         .pNext = &enabledVulkan13Features,
+        .drawIndirectCount = drawIndirectCountSupported ? VK_TRUE : VK_FALSE,
+        .shaderSampledImageArrayNonUniformIndexing = VK_TRUE,
+        .descriptorBindingUpdateUnusedWhilePending = VK_TRUE,
+        .descriptorBindingPartiallyBound = VK_TRUE,
         .scalarBlockLayout = VK_TRUE
     };
     VkPhysicalDeviceVulkan11Features enabledVulkan11Features = {
@@ -1985,6 +2070,9 @@ void engine::Renderer::recreateSwapChain() {
     swapChainImageViews.clear();
 
     destroyAttachmentResources();
+    if (entityManager) {
+        entityManager->destroyDepthPyramid();
+    }
 
     if (swapChain != VK_NULL_HANDLE) {
         vkDestroySwapchainKHR(device, swapChain, nullptr);
@@ -2123,6 +2211,79 @@ void engine::Renderer::endSingleTimeCommands(VkCommandBuffer commandBuffer) {
     vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
 }
 
+void engine::Renderer::destroyStagingBuffers(std::vector<std::pair<VkBuffer, VkDeviceMemory>>& stagingBuffers) {
+    for (auto& [buffer, memory] : stagingBuffers) {
+        vkDestroyBuffer(device, buffer, nullptr);
+        vkFreeMemory(device, memory, nullptr);
+    }
+    stagingBuffers.clear();
+}
+
+VkCommandBuffer engine::Renderer::beginUploadCommands() {
+    return beginSingleTimeCommands();
+}
+
+void engine::Renderer::submitUploadCommands(
+    VkCommandBuffer commandBuffer,
+    std::vector<std::pair<VkBuffer, VkDeviceMemory>> stagingBuffers,
+    std::function<void()> onComplete
+) {
+    vkEndCommandBuffer(commandBuffer);
+    VkFenceCreateInfo fenceInfo = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO
+    };
+    VkFence fence;
+    if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create upload fence!");
+    }
+    VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &commandBuffer
+    };
+    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, fence) != VK_SUCCESS) {
+        vkDestroyFence(device, fence, nullptr);
+        throw std::runtime_error("Failed to submit upload command buffer!");
+    }
+    pendingUploads.push_back({
+        .commandBuffer = commandBuffer,
+        .fence = fence,
+        .stagingBuffers = std::move(stagingBuffers),
+        .onComplete = std::move(onComplete)
+    });
+}
+
+bool engine::Renderer::processCompletedUploads() {
+    // retire the signaled prefix so callbacks run in submission order
+    size_t completed = 0;
+    while (completed < pendingUploads.size() && vkGetFenceStatus(device, pendingUploads[completed].fence) == VK_SUCCESS) {
+        ++completed;
+    }
+    if (completed == 0) return false;
+    std::vector<PendingUpload> finished(
+        std::make_move_iterator(pendingUploads.begin()),
+        std::make_move_iterator(pendingUploads.begin() + static_cast<std::ptrdiff_t>(completed)));
+    pendingUploads.erase(pendingUploads.begin(), pendingUploads.begin() + static_cast<std::ptrdiff_t>(completed));
+    for (PendingUpload& upload : finished) {
+        vkDestroyFence(device, upload.fence, nullptr);
+        vkFreeCommandBuffers(device, commandPool, 1, &upload.commandBuffer);
+        destroyStagingBuffers(upload.stagingBuffers);
+        if (upload.onComplete) upload.onComplete();
+    }
+    return true;
+}
+
+void engine::Renderer::waitForUploads() {
+    if (pendingUploads.empty()) return;
+    std::vector<VkFence> fences;
+    fences.reserve(pendingUploads.size());
+    for (const PendingUpload& upload : pendingUploads) {
+        fences.push_back(upload.fence);
+    }
+    vkWaitForFences(device, static_cast<uint32_t>(fences.size()), fences.data(), VK_TRUE, UINT64_MAX);
+    processCompletedUploads();
+}
+
 VkResult engine::Renderer::tryCreateImage(
     uint32_t width,
     uint32_t height,
@@ -2336,7 +2497,8 @@ void engine::Renderer::transitionImageLayoutInline(
     VkImageLayout oldLayout,
     VkImageLayout newLayout,
     uint32_t mipLevels,
-    uint32_t layerCount
+    uint32_t layerCount,
+    uint32_t baseArrayLayer
 ) {
     const VkPipelineStageFlags shaderReadStages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
     VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -2362,7 +2524,7 @@ void engine::Renderer::transitionImageLayoutInline(
             .aspectMask = aspectMask,
             .baseMipLevel = 0,
             .levelCount = mipLevels,
-            .baseArrayLayer = 0,
+            .baseArrayLayer = baseArrayLayer,
             .layerCount = layerCount
         }
     };
@@ -2490,6 +2652,66 @@ void engine::Renderer::copyDataToBuffer(
     vkFreeMemory(device, stagingBufferMemory, nullptr);
 }
 
+void engine::Renderer::copyDataToBuffers(std::span<const BufferUpload> uploads) {
+    std::vector<std::pair<VkBuffer, VkDeviceMemory>> stagingBuffers;
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+    copyDataToBuffersInline(commandBuffer, uploads, stagingBuffers);
+    endSingleTimeCommands(commandBuffer);
+    destroyStagingBuffers(stagingBuffers);
+}
+
+void engine::Renderer::copyDataToBuffersInline(
+    VkCommandBuffer commandBuffer,
+    std::span<const BufferUpload> uploads,
+    std::vector<std::pair<VkBuffer, VkDeviceMemory>>& stagingBuffers
+) {
+    VkDeviceSize totalSize = 0;
+    for (const BufferUpload& upload : uploads) {
+        totalSize = (totalSize + 15) & ~VkDeviceSize(15);
+        totalSize += upload.size;
+    }
+    if (totalSize == 0) return;
+    void* mappedData;
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+    std::tie(stagingBuffer, stagingBufferMemory) = createBuffer(
+        totalSize,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    );
+    stagingBuffers.emplace_back(stagingBuffer, stagingBufferMemory);
+    vkMapMemory(device, stagingBufferMemory, 0, totalSize, 0, &mappedData);
+    VkDeviceSize offset = 0;
+    for (const BufferUpload& upload : uploads) {
+        offset = (offset + 15) & ~VkDeviceSize(15);
+        if (upload.size == 0) continue;
+        memcpy(static_cast<char*>(mappedData) + offset, upload.data, static_cast<size_t>(upload.size));
+        VkBufferCopy copyRegion = {
+            .srcOffset = offset,
+            .dstOffset = 0,
+            .size = upload.size
+        };
+        vkCmdCopyBuffer(commandBuffer, stagingBuffer, upload.buffer, 1, &copyRegion);
+        offset += upload.size;
+    }
+    vkUnmapMemory(device, stagingBufferMemory);
+    // later submissions on this queue read the buffers without waiting on the upload
+    VkMemoryBarrier uploadToRead = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT
+    };
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        1, &uploadToRead,
+        0, nullptr,
+        0, nullptr
+    );
+}
+
 void engine::Renderer::copyBufferToImage(
     VkBuffer buffer,
     VkImage image,
@@ -2585,6 +2807,179 @@ std::pair<VkImage, VkDeviceMemory> engine::Renderer::createImageFromPixels(
     return std::make_pair(textureImage, textureImageMemory);
 }
 
+std::pair<VkImage, VkDeviceMemory> engine::Renderer::createImageFromPixelsInline(
+    VkCommandBuffer commandBuffer,
+    const void* pixels,
+    VkDeviceSize pixelSize,
+    uint32_t width,
+    uint32_t height,
+    uint32_t mipLevels,
+    VkFormat format,
+    VkImageUsageFlags usage,
+    std::vector<std::pair<VkBuffer, VkDeviceMemory>>& stagingBuffers
+) {
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+    std::tie(stagingBuffer, stagingBufferMemory) = createBuffer(
+        pixelSize,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    );
+    stagingBuffers.emplace_back(stagingBuffer, stagingBufferMemory);
+    void* data;
+    vkMapMemory(device, stagingBufferMemory, 0, pixelSize, 0, &data);
+    memcpy(data, pixels, static_cast<size_t>(pixelSize));
+    vkUnmapMemory(device, stagingBufferMemory);
+    VkImage textureImage;
+    VkDeviceMemory textureImageMemory;
+    std::tie(textureImage, textureImageMemory) = createImage(
+        width,
+        height,
+        mipLevels,
+        VK_SAMPLE_COUNT_1_BIT,
+        format,
+        VK_IMAGE_TILING_OPTIMAL,
+        usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        1,
+        0
+    );
+    transitionImageLayoutInline(
+        commandBuffer,
+        textureImage,
+        format,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        mipLevels
+    );
+    VkBufferImageCopy region = {
+        .bufferOffset = 0,
+        .bufferRowLength = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .mipLevel = 0,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        },
+        .imageOffset = {0, 0, 0},
+        .imageExtent = {
+            .width = width,
+            .height = height,
+            .depth = 1
+        }
+    };
+    vkCmdCopyBufferToImage(
+        commandBuffer,
+        stagingBuffer,
+        textureImage,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        1,
+        &region
+    );
+    return std::make_pair(textureImage, textureImageMemory);
+}
+
+std::pair<VkImage, VkDeviceMemory> engine::Renderer::createImageFromMipChain(
+    const void* data,
+    VkDeviceSize size,
+    uint32_t width,
+    uint32_t height,
+    std::span<const VkDeviceSize> mipOffsets,
+    VkFormat format
+) {
+    std::vector<std::pair<VkBuffer, VkDeviceMemory>> stagingBuffers;
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+    auto image = createImageFromMipChainInline(commandBuffer, data, size, width, height, mipOffsets, format, stagingBuffers);
+    endSingleTimeCommands(commandBuffer);
+    destroyStagingBuffers(stagingBuffers);
+    return image;
+}
+
+std::pair<VkImage, VkDeviceMemory> engine::Renderer::createImageFromMipChainInline(
+    VkCommandBuffer commandBuffer,
+    const void* data,
+    VkDeviceSize size,
+    uint32_t width,
+    uint32_t height,
+    std::span<const VkDeviceSize> mipOffsets,
+    VkFormat format,
+    std::vector<std::pair<VkBuffer, VkDeviceMemory>>& stagingBuffers
+) {
+    const uint32_t mipLevels = static_cast<uint32_t>(mipOffsets.size());
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+    std::tie(stagingBuffer, stagingBufferMemory) = createBuffer(
+        size,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    );
+    stagingBuffers.emplace_back(stagingBuffer, stagingBufferMemory);
+    void* mappedData;
+    vkMapMemory(device, stagingBufferMemory, 0, size, 0, &mappedData);
+    memcpy(mappedData, data, static_cast<size_t>(size));
+    vkUnmapMemory(device, stagingBufferMemory);
+    VkImage textureImage;
+    VkDeviceMemory textureImageMemory;
+    std::tie(textureImage, textureImageMemory) = createImage(
+        width,
+        height,
+        mipLevels,
+        VK_SAMPLE_COUNT_1_BIT,
+        format,
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        1,
+        0
+    );
+    transitionImageLayoutInline(
+        commandBuffer,
+        textureImage,
+        format,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        mipLevels
+    );
+    std::vector<VkBufferImageCopy> regions(mipLevels);
+    for (uint32_t level = 0; level < mipLevels; ++level) {
+        regions[level] = {
+            .bufferOffset = mipOffsets[level],
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = level,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+            },
+            .imageOffset = {0, 0, 0},
+            .imageExtent = {
+                std::max(1u, width >> level),
+                std::max(1u, height >> level),
+                1
+            }
+        };
+    }
+    vkCmdCopyBufferToImage(
+        commandBuffer,
+        stagingBuffer,
+        textureImage,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        mipLevels,
+        regions.data()
+    );
+    transitionImageLayoutInline(
+        commandBuffer,
+        textureImage,
+        format,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        mipLevels
+    );
+    return std::make_pair(textureImage, textureImageMemory);
+}
+
 bool engine::Renderer::formatSupportsLinearBlit(VkFormat format) {
     VkFormatProperties props;
     vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &props);
@@ -2602,6 +2997,23 @@ void engine::Renderer::generateMipmaps(
     uint32_t height,
     uint32_t mipLevels,
     uint32_t layerCount
+) {
+    if (mipLevels <= 1) {
+        return;
+    }
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+    generateMipmapsInline(commandBuffer, image, format, width, height, mipLevels, layerCount);
+    endSingleTimeCommands(commandBuffer);
+}
+
+void engine::Renderer::generateMipmapsInline(
+    VkCommandBuffer commandBuffer,
+    VkImage image,
+    VkFormat format,
+    uint32_t width,
+    uint32_t height,
+    uint32_t mipLevels,
+    uint32_t layerCount
 ) {
     if (mipLevels <= 1) {
         return;
@@ -2609,7 +3021,6 @@ void engine::Renderer::generateMipmaps(
     if (!formatSupportsLinearBlit(format)) {
         throw std::runtime_error("Texture format does not support linear blit for mipmap generation!");
     }
-    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
     VkImageMemoryBarrier barrier = {
         .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
         .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
@@ -2685,7 +3096,6 @@ void engine::Renderer::generateMipmaps(
         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
         0, 0, nullptr, 0, nullptr, 1, &barrier
     );
-    endSingleTimeCommands(commandBuffer);
 }
 
 VkImageView engine::Renderer::createImageView(
@@ -3760,6 +4170,68 @@ void engine::Renderer::createCommandBuffers() {
     }
 }
 
+void engine::Renderer::createRecordWorkerPools() {
+    QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
+    const size_t workerCount = ThreadPool::global().workerCount();
+    recordWorkerPools.resize(MAX_FRAMES_IN_FLIGHT);
+    for (auto& framePools : recordWorkerPools) {
+        framePools.resize(workerCount);
+        for (RecordWorkerPools& pools : framePools) {
+            // whole pool is reset once per frame, no per-buffer reset flag needed
+            VkCommandPoolCreateInfo poolInfo = {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                .queueFamilyIndex = queueFamilyIndices.graphicsFamily.value()
+            };
+            if (vkCreateCommandPool(device, &poolInfo, nullptr, &pools.graphicsPool) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create worker command pool!");
+            }
+            VkCommandPoolCreateInfo computePoolInfo = {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                .queueFamilyIndex = queueFamilyIndices.computeFamily.value_or(queueFamilyIndices.graphicsFamily.value())
+            };
+            if (vkCreateCommandPool(device, &computePoolInfo, nullptr, &pools.computePool) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create worker compute command pool!");
+            }
+        }
+    }
+}
+
+void engine::Renderer::destroyRecordWorkerPools() {
+    for (auto& framePools : recordWorkerPools) {
+        for (RecordWorkerPools& pools : framePools) {
+            if (pools.graphicsPool != VK_NULL_HANDLE) {
+                vkDestroyCommandPool(device, pools.graphicsPool, nullptr);
+            }
+            if (pools.computePool != VK_NULL_HANDLE) {
+                vkDestroyCommandPool(device, pools.computePool, nullptr);
+            }
+        }
+    }
+    recordWorkerPools.clear();
+}
+
+VkCommandBuffer engine::Renderer::acquireWorkerCommandBuffer(RecordWorkerPools& pools, NodeQueueClass queueClass) {
+    const bool isCompute = queueClass == NodeQueueClass::Compute;
+    std::vector<VkCommandBuffer>& buffers = isCompute ? pools.computeBuffers : pools.graphicsBuffers;
+    uint32_t& used = isCompute ? pools.usedCompute : pools.usedGraphics;
+    if (used >= buffers.size()) {
+        VkCommandBufferAllocateInfo allocInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = isCompute ? pools.computePool : pools.graphicsPool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1
+        };
+        VkCommandBuffer newBuffer = VK_NULL_HANDLE;
+        if (vkAllocateCommandBuffers(device, &allocInfo, &newBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate worker command buffer!");
+        }
+        buffers.push_back(newBuffer);
+    }
+    return buffers[used++];
+}
+
 void engine::Renderer::createSyncObjects() {
     imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
     renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
@@ -4054,6 +4526,10 @@ int engine::Renderer::rateDeviceSuitability(VkPhysicalDevice device) {
         return 0;
     }
     int score = 0;
+    // BC is optional, cooked textures fall back to rgba8 at four to eight times the memory
+    if (deviceFeatures.textureCompressionBC) {
+        score += 500;
+    }
     if (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) {
         score += 1000;
     }
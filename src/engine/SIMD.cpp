@@ -36,6 +36,42 @@ namespace engine::simd {
         );
     }
 
+    void cullSpheresAgainstFrustum(
+        const float* centerX, const float* centerY, const float* centerZ,
+        size_t count,
+        float radius,
+        const Plane planes[6],
+        uint8_t* outVisible
+    ) {
+        if (count == 0) return;
+        ispc::cullSpheresAgainstFrustum(
+            centerX, centerY, centerZ,
+            static_cast<int32_t>(count),
+            radius,
+            reinterpret_cast<const ispc::Plane*>(planes),
+            outVisible
+        );
+    }
+
+    void transformAABBs(
+        const float* localMinX, const float* localMinY, const float* localMinZ,
+        const float* localMaxX, const float* localMaxY, const float* localMaxZ,
+        const float* matrices,
+        size_t count,
+        float* outMinX, float* outMinY, float* outMinZ,
+        float* outMaxX, float* outMaxY, float* outMaxZ
+    ) {
+        if (count == 0) return;
+        ispc::transformAABBs(
+            localMinX, localMinY, localMinZ,
+            localMaxX, localMaxY, localMaxZ,
+            matrices,
+            static_cast<int32_t>(count),
+            outMinX, outMinY, outMinZ,
+            outMaxX, outMaxY, outMaxZ
+        );
+    }
+
     void aabbVsManyAABBs(
         const float aMin[3], const float aMax[3],
         const float* bMinX, const float* bMinY, const float* bMinZ,
@@ -54,6 +90,28 @@ namespace engine::simd {
         );
     }
 
+    void pointsVsBox(
+        const float* px, const float* py, const float* pz,
+        size_t count,
+        const float boundsMin[3], const float boundsMax[3],
+        float margin,
+        bool oriented,
+        const float center[3], const float axes[9], const float halfSize[3],
+        uint8_t* inOutHit
+    ) {
+        if (count == 0) return;
+        ispc::pointsVsBox(
+            px, py, pz,
+            static_cast<int32_t>(count),
+            boundsMin[0], boundsMin[1], boundsMin[2],
+            boundsMax[0], boundsMax[1], boundsMax[2],
+            margin,
+            oriented,
+            center, axes, halfSize,
+            inOutHit
+        );
+    }
+
     void rayVsManyAABBs(
         const float rayOrigin[3], const float rayDir[3],
         const float* bMinX, const float* bMinY, const float* bMinZ,
@@ -74,6 +132,16 @@ namespace engine::simd {
         );
     }
 
+    size_t compactFloats(
+        const float* src,
+        const uint8_t* dead,
+        size_t count,
+        float* dst
+    ) {
+        if (count == 0) return 0;
+        return static_cast<size_t>(ispc::compactFloats(src, dead, static_cast<int32_t>(count), dst));
+    }
+
     void integrateParticleKinematics(
         float* posX, float* posY, float* posZ,
         float* velX, float* velY, float* velZ,
@@ -83,6 +151,7 @@ namespace engine::simd {
         const float* lifetime,
         const float* type,
         uint8_t* dead,
+        const float* stepScale,
         size_t count,
         float dt,
         float gravity
@@ -93,9 +162,62 @@ namespace engine::simd {
             velX, velY, velZ,
             prevPosX, prevPosY, prevPosZ,
             prevPrevPosX, prevPrevPosY, prevPrevPosZ,
-            age, lifetime, type, dead,
+            age, lifetime, type, dead, stepScale,
             static_cast<int32_t>(count),
             dt, gravity
         );
     }
+
+    size_t buildVolumetricGPUData(
+        const VolumetricStreams& streams,
+        size_t count,
+        const Plane planes[6],
+        float* out,
+        size_t capacity
+    ) {
+        if (count == 0 || capacity == 0) return 0;
+        static_assert(sizeof(VolumetricStreams) == sizeof(ispc::VolumetricStreams),
+                      "engine::simd::VolumetricStreams and ispc::VolumetricStreams must have identical layout");
+        return static_cast<size_t>(ispc::buildVolumetricGPUData(
+            reinterpret_cast<const ispc::VolumetricStreams*>(&streams),
+            static_cast<int32_t>(count),
+            reinterpret_cast<const ispc::Plane*>(planes),
+            out,
+            static_cast<int32_t>(capacity)
+        ));
+    }
+
+    void assignLightsToClusters(
+        const float* lightX, const float* lightY, const float* lightDepth,
+        const float* lightRadius,
+        size_t lightCount,
+        uint32_t dimX, uint32_t dimY, uint32_t dimZ,
+        float slopeX, float slopeY,
+        float nearPlane, float farPlane,
+        uint64_t* outMasks
+    ) {
+        ispc::assignLightsToClusters(
+            lightX, lightY, lightDepth, lightRadius,
+            static_cast<int32_t>(lightCount),
+            static_cast<int32_t>(dimX), static_cast<int32_t>(dimY), static_cast<int32_t>(dimZ),
+            slopeX, slopeY, nearPlane, farPlane,
+            outMasks
+        );
+    }
+
+    void cubeFaceMasks(
+        const float* minX, const float* minY, const float* minZ,
+        const float* maxX, const float* maxY, const float* maxZ,
+        size_t count,
+        const Plane sidePlanes[24],
+        uint8_t* outMasks
+    ) {
+        if (count == 0) return;
+        ispc::cubeFaceMasks(
+            minX, minY, minZ, maxX, maxY, maxZ,
+            static_cast<int32_t>(count),
+            reinterpret_cast<const ispc::Plane*>(sidePlanes),
+            outMasks
+        );
+    }
 }
@@ -7,6 +7,8 @@
 #include <engine/LightManager.h>
 #include <engine/IrradianceManager.h>
 #include <engine/AudioManager.h>
+#include <engine/TextureManager.h>
+#include <engine/ModelManager.h>
 
 engine::SceneManager::SceneManager(Renderer* renderer, std::vector<std::unique_ptr<Scene>> scenes)
     : renderer(renderer), scenes(std::move(scenes)) {
@@ -31,13 +33,28 @@ void engine::SceneManager::setActiveScene(int index) {
     renderer->getVolumetricManager()->clear();
     renderer->getAudioManager()->stopAllSounds();
     renderer->resetPerObjectDescriptorPools();
+    TextureManager* textureManager = renderer->getTextureManager();
+    ModelManager* modelManager = renderer->getModelManager();
+    textureManager->waitForTextures(scenes[index]->getPreloadTextures());
+    modelManager->waitForModels(scenes[index]->getPreloadModels());
     scenes[index]->run(renderer);
     renderer->getIrradianceManager()->setIrradianceBakingPending(true);
     renderer->refreshDescriptorSets();
+    // the other scenes stream in the background while this one is up
+    for (size_t i = 0; i < scenes.size(); ++i) {
+        if (i != static_cast<size_t>(index)) {
+            textureManager->preloadTextures(scenes[i]->getPreloadTextures());
+            modelManager->preloadModels(scenes[i]->getPreloadModels());
+        }
+    }
 }
 
 void engine::SceneManager::setActiveSceneDeferred(int index) {
     pendingSceneIndex = index;
+    if (index >= 0 && index < static_cast<int>(scenes.size())) {
+        renderer->getTextureManager()->preloadTextures(scenes[index]->getPreloadTextures());
+        renderer->getModelManager()->preloadModels(scenes[index]->getPreloadModels());
+    }
 }
 
 void engine::SceneManager::processPendingSceneChange() {
@@ -11,6 +11,7 @@
 #include <engine/UIManager.h>
 #include <engine/EmbeddedAssets.h>
 #include <engine/PushConstants.h>
+#include <engine/CookedModel.h>
 #include <glm/glm.hpp>
 #include <shader/shader_registry.h>
 #include <smaa/Textures/AreaTex.h>
@@ -234,12 +235,7 @@ const std::vector<std::unique_ptr<engine::ComputeShader>>& engine::ShaderManager
 }
 
 namespace {
-    struct Vertex {
-        glm::vec3 pos;
-        glm::vec3 normal;
-        glm::vec2 texCoord;
-        glm::vec4 tangent; // xyz = tangent, w = bitangent handedness (+1 or -1)
-    };
+    using Vertex = engine::cooked::Vertex;
 
     struct UIVertex {
         glm::vec2 pos;
@@ -298,6 +294,12 @@ void engine::ShaderManager::createDefaultShaders() {
         gbufferPass->images = images;
     }
 
+    // Particle Sim Pass, integrates and emits GPU particles when that mode is enabled
+    auto particleSimPass = std::make_shared<PassInfo>();
+    particleSimPass->name = "ParticleSimPass";
+    particleSimPass->usesSwapchain = false;
+    renderPasses.push_back(particleSimPass);
+
     // Shadow Pass
     auto shadowPass = std::make_shared<PassInfo>();
     shadowPass->name = "ShadowPass";
@@ -642,21 +644,23 @@ void engine::ShaderManager::createDefaultShaders() {
             .vertex = { shaderPath("gbuffer.vert"), VK_SHADER_STAGE_VERTEX_BIT },
             .fragment = { shaderPath("gbuffer.frag"), VK_SHADER_STAGE_FRAGMENT_BIT },
             .config = {
-                .poolMultiplier = 512,
-                .vertexBitBindings = 1,
-                .fragmentBitBindings = 5,
-                .vertexDescriptorCounts = { 1 },
-                .vertexDescriptorTypes = { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                .poolMultiplier = 1,
+                .vertexBitBindings = 3,
+                .fragmentBitBindings = 2,
+                .vertexDescriptorCounts = { 1, 1, 1 },
+                .vertexDescriptorTypes = {
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                },
                 .fragmentDescriptorCounts = {
-                    1, 1, 1, 1, 1
+                    kMaxBindlessTextures, 1
                 },
                 .fragmentDescriptorTypes = {
-                    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-                    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-                    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
                     VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
                     VK_DESCRIPTOR_TYPE_SAMPLER
                 },
+                .partiallyBoundTextures = true,
                 .cullMode = VK_CULL_MODE_BACK_BIT,
                 .depthWrite = true,
                 .enableDepth = true,
@@ -668,14 +672,13 @@ void engine::ShaderManager::createDefaultShaders() {
                         { .binding = 0, .stride = sizeof(Vertex), .inputRate = VK_VERTEX_INPUT_RATE_VERTEX },
                         { .binding = 1, .stride = sizeof(SkinnedVertex), .inputRate = VK_VERTEX_INPUT_RATE_VERTEX }
                     };
-                    attributes.resize(6);
+                    attributes.resize(5);
                     attributes = {
-                        { .location = 0, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = offsetof(Vertex, pos) },
-                        { .location = 1, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = offsetof(Vertex, normal) },
-                        { .location = 2, .binding = 0, .format = VK_FORMAT_R32G32_SFLOAT, .offset = offsetof(Vertex, texCoord) },
-                        { .location = 3, .binding = 0, .format = VK_FORMAT_R32G32B32A32_SFLOAT, .offset = offsetof(Vertex, tangent) },
-                        { .location = 4, .binding = 1, .format = VK_FORMAT_R32G32B32A32_SFLOAT, .offset = offsetof(SkinnedVertex, joints) },
-                        { .location = 5, .binding = 1, .format = VK_FORMAT_R32G32B32A32_SFLOAT, .offset = offsetof(SkinnedVertex, weights) }
+                        { .location = 0, .binding = 0, .format = VK_FORMAT_R16G16B16A16_UNORM, .offset = offsetof(Vertex, position) },
+                        { .location = 1, .binding = 0, .format = VK_FORMAT_R16G16B16A16_SNORM, .offset = offsetof(Vertex, normalTangent) },
+                        { .location = 2, .binding = 0, .format = VK_FORMAT_R16G16_SFLOAT, .offset = offsetof(Vertex, texCoord) },
+                        { .location = 3, .binding = 1, .format = VK_FORMAT_R32G32B32A32_SFLOAT, .offset = offsetof(SkinnedVertex, joints) },
+                        { .location = 4, .binding = 1, .format = VK_FORMAT_R32G32B32A32_SFLOAT, .offset = offsetof(SkinnedVertex, weights) }
                     };
                 }
             }
@@ -684,18 +687,199 @@ void engine::ShaderManager::createDefaultShaders() {
         addGraphicsShader(std::move(shader));
     }
 
+    // GBuffer Cull Shader, dispatched by EntityManager::cullEntities and for shadow casters by LightManager::renderShadows
+    {
+        ComputeShader shader = {
+            .name = "gbuffercull",
+            .compute = { shaderPath("gbuffercull.comp"), VK_SHADER_STAGE_COMPUTE_BIT },
+            .config = {
+                .poolMultiplier = 1,
+                .computeBitBindings = 8,
+                .computeDescriptorCounts = { 1, 1, 1, 1, 1, 1, 1, 1 },
+                .computeDescriptorTypes = {
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                },
+                .workgroupSizeX = 64,
+                .workgroupSizeY = 1,
+                .workgroupSizeZ = 1,
+                .inputBindings = {
+                    {
+                        .binding = 0,
+                        .bufferProvider = [](Renderer* renderer, size_t frameIndex) -> VkDescriptorBufferInfo {
+                            EntityManager* entityManager = renderer->getEntityManager();
+                            if (!entityManager) {
+                                return VkDescriptorBufferInfo{};
+                            }
+                            entityManager->ensureInstanceBuffers();
+                            VkBuffer buffer = entityManager->getCullInputBuffer(static_cast<uint32_t>(frameIndex));
+                            if (buffer == VK_NULL_HANDLE) {
+                                return VkDescriptorBufferInfo{};
+                            }
+                            return VkDescriptorBufferInfo{ buffer, 0, VK_WHOLE_SIZE };
+                        },
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                    },
+                    {
+                        .binding = 1,
+                        .bufferProvider = [](Renderer* renderer, size_t frameIndex) -> VkDescriptorBufferInfo {
+                            EntityManager* entityManager = renderer->getEntityManager();
+                            if (!entityManager) {
+                                return VkDescriptorBufferInfo{};
+                            }
+                            entityManager->ensureInstanceBuffers();
+                            VkBuffer buffer = entityManager->getInstanceBuffer(static_cast<uint32_t>(frameIndex));
+                            if (buffer == VK_NULL_HANDLE) {
+                                return VkDescriptorBufferInfo{};
+                            }
+                            return VkDescriptorBufferInfo{ buffer, 0, VK_WHOLE_SIZE };
+                        },
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                    },
+                    {
+                        .binding = 2,
+                        .bufferProvider = [](Renderer* renderer, size_t frameIndex) -> VkDescriptorBufferInfo {
+                            EntityManager* entityManager = renderer->getEntityManager();
+                            if (!entityManager) {
+                                return VkDescriptorBufferInfo{};
+                            }
+                            entityManager->ensureInstanceBuffers();
+                            VkBuffer buffer = entityManager->getDrawBatchBuffer(static_cast<uint32_t>(frameIndex));
+                            if (buffer == VK_NULL_HANDLE) {
+                                return VkDescriptorBufferInfo{};
+                            }
+                            return VkDescriptorBufferInfo{ buffer, 0, VK_WHOLE_SIZE };
+                        },
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                    },
+                    {
+                        .binding = 3,
+                        .imageArrayProvider = [](Renderer* renderer, size_t, uint32_t, std::vector<VkDescriptorImageInfo>& imageInfos) {
+                            EntityManager* entityManager = renderer->getEntityManager();
+                            if (!entityManager) return;
+                            // attachments were just recreated, so the pyramid follows the new render extent
+                            entityManager->ensureDepthPyramid();
+                            VkImageView view = entityManager->getDepthPyramidView();
+                            if (view == VK_NULL_HANDLE) return;
+                            imageInfos.push_back({
+                                .imageView = view,
+                                .imageLayout = VK_IMAGE_LAYOUT_GENERAL
+                            });
+                        },
+                        .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE
+                    },
+                    {
+                        .binding = 4,
+                        .bufferProvider = [](Renderer* renderer, size_t frameIndex) -> VkDescriptorBufferInfo {
+                            EntityManager* entityManager = renderer->getEntityManager();
+                            if (!entityManager) {
+                                return VkDescriptorBufferInfo{};
+                            }
+                            entityManager->ensureInstanceBuffers();
+                            VkBuffer buffer = entityManager->getDrawCommandBuffer(static_cast<uint32_t>(frameIndex));
+                            if (buffer == VK_NULL_HANDLE) {
+                                return VkDescriptorBufferInfo{};
+                            }
+                            return VkDescriptorBufferInfo{ buffer, 0, VK_WHOLE_SIZE };
+                        },
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                    },
+                    {
+                        .binding = 5,
+                        .bufferProvider = [](Renderer* renderer, size_t frameIndex) -> VkDescriptorBufferInfo {
+                            EntityManager* entityManager = renderer->getEntityManager();
+                            if (!entityManager) {
+                                return VkDescriptorBufferInfo{};
+                            }
+                            entityManager->ensureInstanceBuffers();
+                            VkBuffer buffer = entityManager->getDrawCountBuffer(static_cast<uint32_t>(frameIndex));
+                            if (buffer == VK_NULL_HANDLE) {
+                                return VkDescriptorBufferInfo{};
+                            }
+                            return VkDescriptorBufferInfo{ buffer, 0, VK_WHOLE_SIZE };
+                        },
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                    },
+                    {
+                        .binding = 6,
+                        .bufferProvider = [](Renderer* renderer, size_t frameIndex) -> VkDescriptorBufferInfo {
+                            EntityManager* entityManager = renderer->getEntityManager();
+                            if (!entityManager) {
+                                return VkDescriptorBufferInfo{};
+                            }
+                            entityManager->ensureInstanceBuffers();
+                            VkBuffer buffer = entityManager->getOccludedInstanceBuffer(static_cast<uint32_t>(frameIndex));
+                            if (buffer == VK_NULL_HANDLE) {
+                                return VkDescriptorBufferInfo{};
+                            }
+                            return VkDescriptorBufferInfo{ buffer, 0, VK_WHOLE_SIZE };
+                        },
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                    },
+                    {
+                        .binding = 7,
+                        .bufferProvider = [](Renderer* renderer, size_t frameIndex) -> VkDescriptorBufferInfo {
+                            LightManager* lightManager = renderer->getLightManager();
+                            if (!lightManager) {
+                                return VkDescriptorBufferInfo{};
+                            }
+                            lightManager->createShadowLightsBuffers();
+                            auto& shadowLightsBuffers = lightManager->getShadowLightsBuffers();
+                            if (frameIndex >= shadowLightsBuffers.size()) {
+                                return VkDescriptorBufferInfo{};
+                            }
+                            return VkDescriptorBufferInfo{ shadowLightsBuffers[frameIndex], 0, VK_WHOLE_SIZE };
+                        },
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                    }
+                }
+            }
+        };
+        shader.config.setPushConstant<GBufferCullPC>(VK_SHADER_STAGE_COMPUTE_BIT);
+        addComputeShader(std::move(shader));
+    }
+
+    // Depth Pyramid Shader, dispatched once per mip by EntityManager::buildDepthPyramid
+    {
+        ComputeShader shader = {
+            .name = "depthpyramid",
+            .compute = { shaderPath("depthpyramid.comp"), VK_SHADER_STAGE_COMPUTE_BIT },
+            .config = {
+                .poolMultiplier = static_cast<int>(kMaxDepthPyramidMips),
+                .computeBitBindings = 2,
+                .computeDescriptorCounts = { 1, 1 },
+                .computeDescriptorTypes = {
+                    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                    VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+                },
+                .workgroupSizeX = 8,
+                .workgroupSizeY = 8,
+                .workgroupSizeZ = 1
+            }
+        };
+        shader.config.setPushConstant<DepthPyramidPC>(VK_SHADER_STAGE_COMPUTE_BIT);
+        addComputeShader(std::move(shader));
+    }
+
     // Shadow Shader
     {
         GraphicsShader shader = {
             .name = "shadow",
             .vertex = { shaderPath("shadow.vert"), VK_SHADER_STAGE_VERTEX_BIT },
             .config = {
-                .poolMultiplier = 512,
-                .vertexBitBindings = 2,
+                .poolMultiplier = 1,
+                .vertexBitBindings = 3,
                 .fragmentBitBindings = 0,
-                .vertexDescriptorCounts = { 1, 1 },
+                .vertexDescriptorCounts = { 1, 1, 1 },
                 .vertexDescriptorTypes = {
-                    VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
                     VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
                 },
                 .cullMode = VK_CULL_MODE_NONE,
@@ -713,7 +897,7 @@ void engine::ShaderManager::createDefaultShaders() {
                     };
                     attributes.resize(3);
                     attributes = {
-                        { .location = 0, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = offsetof(Vertex, pos) },
+                        { .location = 0, .binding = 0, .format = VK_FORMAT_R16G16B16A16_UNORM, .offset = offsetof(Vertex, position) },
                         { .location = 1, .binding = 1, .format = VK_FORMAT_R32G32B32A32_SFLOAT, .offset = offsetof(SkinnedVertex, joints) },
                         { .location = 2, .binding = 1, .format = VK_FORMAT_R32G32B32A32_SFLOAT, .offset = offsetof(SkinnedVertex, weights) }
                     };
@@ -810,7 +994,7 @@ void engine::ShaderManager::createDefaultShaders() {
                             auto* textureManager = renderer->getTextureManager();
                             Texture* fallbackTex = textureManager ? textureManager->getTexture("fallback_shadow_cube") : nullptr;
                             VkImageView fallbackView = (fallbackTex && fallbackTex->imageView != VK_NULL_HANDLE) ? fallbackTex->imageView : VK_NULL_HANDLE;
-                            auto& lights = renderer->getLightManager()->getLights();
+                            LightManager* lightManager = renderer->getLightManager();
 
                             const size_t startIdx = imageInfos.size();
                             imageInfos.resize(startIdx + count, {
@@ -819,14 +1003,11 @@ void engine::ShaderManager::createDefaultShaders() {
                                 .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
                             });
 
-                            const uint32_t lightCount = static_cast<uint32_t>(std::min<size_t>(lights.size(), count));
-                            uint32_t shadowLayer = 0;
-                            for (uint32_t i = 0; i < lightCount && shadowLayer < count; ++i) {
-                                Light& light = *lights[i];
-                                VkImageView shadowView = light.getShadowImageView(frameIndex);
-                                if (shadowView != VK_NULL_HANDLE) {
-                                    imageInfos[startIdx + shadowLayer].imageView = shadowView;
-                                    ++shadowLayer;
+                            // atlas slots are bound by index, lights pick theirs through shadowData.z
+                            for (uint32_t i = 0; i < count; ++i) {
+                                const LightManager::ShadowAtlasSlot* slot = lightManager->getShadowSlot(i);
+                                if (slot && !slot->cubeViews.empty()) {
+                                    imageInfos[startIdx + i].imageView = slot->cubeViews[frameIndex % slot->cubeViews.size()];
                                 }
                             }
                         },
@@ -1143,6 +1324,34 @@ void engine::ShaderManager::createDefaultShaders() {
         addGraphicsShader(std::move(shader));
     }
 
+    // Particle Sim Shader, dispatched by ParticleManager::simulateGPU
+    {
+        ComputeShader shader = {
+            .name = "particlesim",
+            .compute = { shaderPath("particlesim.comp"), VK_SHADER_STAGE_COMPUTE_BIT },
+            .config = {
+                .poolMultiplier = 2,
+                .computeBitBindings = 8,
+                .computeDescriptorCounts = { 1, 1, 1, 1, 1, 1, 1, 1 },
+                .computeDescriptorTypes = {
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE
+                },
+                .workgroupSizeX = 64,
+                .workgroupSizeY = 1,
+                .workgroupSizeZ = 1
+            }
+        };
+        shader.config.setPushConstant<ParticleSimPC>(VK_SHADER_STAGE_COMPUTE_BIT);
+        addComputeShader(std::move(shader));
+    }
+
     // Simple Particle (for irradiance)
     {
         ComputeShader shader = {
@@ -1489,28 +1698,30 @@ void engine::ShaderManager::createDefaultShaders() {
         addComputeShader(std::move(shader));
     }
 
-    // Irradiance Shader
+    // Irradiance Shader, same layout as gbuffer so the shared material descriptor sets bind to it
     {
         GraphicsShader shader = {
             .name = "irradiance",
             .vertex = { shaderPath("irradiance.vert"), VK_SHADER_STAGE_VERTEX_BIT },
             .fragment = { shaderPath("irradiance.frag"), VK_SHADER_STAGE_FRAGMENT_BIT },
             .config = {
-                .poolMultiplier = 512,
-                .vertexBitBindings = 1,
-                .fragmentBitBindings = 5,
-                .vertexDescriptorCounts = { 1 },
-                .vertexDescriptorTypes = { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                .poolMultiplier = 1,
+                .vertexBitBindings = 3,
+                .fragmentBitBindings = 2,
+                .vertexDescriptorCounts = { 1, 1, 1 },
+                .vertexDescriptorTypes = {
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                },
                 .fragmentDescriptorCounts = {
-                    1, 1, 1, 1, 1
+                    kMaxBindlessTextures, 1
                 },
                 .fragmentDescriptorTypes = {
-                    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-                    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-                    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
                     VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
                     VK_DESCRIPTOR_TYPE_SAMPLER
                 },
+                .partiallyBoundTextures = true,
                 .cullMode = VK_CULL_MODE_NONE,
                 .depthWrite = false,
                 .depthCompare = VK_COMPARE_OP_ALWAYS,
@@ -1524,9 +1735,9 @@ void engine::ShaderManager::createDefaultShaders() {
                     };
                     attributes.resize(3);
                     attributes = {
-                        { .location = 0, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = offsetof(Vertex, pos) },
-                        { .location = 2, .binding = 0, .format = VK_FORMAT_R32G32_SFLOAT, .offset = offsetof(Vertex, texCoord) },
-                        { .location = 1, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = offsetof(Vertex, normal) },
+                        { .location = 0, .binding = 0, .format = VK_FORMAT_R16G16B16A16_UNORM, .offset = offsetof(Vertex, position) },
+                        { .location = 1, .binding = 0, .format = VK_FORMAT_R16G16B16A16_SNORM, .offset = offsetof(Vertex, normalTangent) },
+                        { .location = 2, .binding = 0, .format = VK_FORMAT_R16G16_SFLOAT, .offset = offsetof(Vertex, texCoord) },
                     };
                 }
             }
@@ -1590,14 +1801,14 @@ void engine::ShaderManager::createDefaultShaders() {
             .fragment = { shaderPath("lighting.frag"), VK_SHADER_STAGE_FRAGMENT_BIT },
             .config = {
                 .vertexBitBindings = 2,
-                .fragmentBitBindings = 10,
+                .fragmentBitBindings = 11,
                 .vertexDescriptorCounts = { 1, 1 },
                 .vertexDescriptorTypes = {
                     VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
                     VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
                 },
                 .fragmentDescriptorCounts = {
-                    1, 1, 1, 1, 1, 1, 1, 1, 1, 1
+                    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1
                 },
                 .fragmentDescriptorTypes = {
                     VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
@@ -1609,6 +1820,7 @@ void engine::ShaderManager::createDefaultShaders() {
                     VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
                     VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
                     VK_DESCRIPTOR_TYPE_SAMPLER,
+                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
                     VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
                 },
                 .cullMode = VK_CULL_MODE_NONE,
@@ -1628,7 +1840,7 @@ void engine::ShaderManager::createDefaultShaders() {
                         if (volumetricQuality >= 2.0f) flags |= 1u;
                         if (settings->aoMode != 0u) flags |= 2u;
                         ParticleManager* particleManager = renderer->getParticleManager();
-                        if (particleManager && particleManager->getParticleCount() > 0u) flags |= 4u;
+                        if (particleManager && particleManager->hasParticles()) flags |= 4u;
                         VolumetricManager* volumetricManager = renderer->getVolumetricManager();
                         if (volumetricManager && volumetricManager->getVisibleVolumetrics() > 0u) flags |= 8u;
                         LightingPC pc = {
@@ -1664,6 +1876,20 @@ void engine::ShaderManager::createDefaultShaders() {
                         },
                         .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
                     },
+                    {
+                        .binding = 12,
+                        .bufferProvider = [](Renderer* renderer, size_t i) -> VkDescriptorBufferInfo {
+                            LightManager* lightManager = renderer->getLightManager();
+                            lightManager->createLightClusterBuffers();
+                            auto& clusterBuffers = lightManager->getLightClusterBuffers();
+                            if (i >= clusterBuffers.size() || clusterBuffers[i] == VK_NULL_HANDLE) {
+                                std::cout << "Warning: Light cluster buffer missing for frame " << i << " after ensure. Skipping descriptor write.\n";
+                                return VkDescriptorBufferInfo{};
+                            }
+                            return VkDescriptorBufferInfo{clusterBuffers[i], 0, kLightClusterBufferSize};
+                        },
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                    },
                     {
                         .binding = 0,
                         .bufferProvider = [](Renderer* renderer, size_t i) -> VkDescriptorBufferInfo {
@@ -2288,19 +2514,42 @@ void engine::ShaderManager::createDefaultShaders() {
             .passInfo = gbufferPass.get(),
             .shaderNames = { "gbuffer" },
             .lane = generalGraphicsLane,
+            .canRecordOnWorkerThread = true,
+            .preRenderFunc = [](Renderer* renderer, VkCommandBuffer cmd, uint32_t frame) {
+                renderer->getEntityManager()->cullEntities(cmd, frame);
+            },
             .customRenderFunc = [](Renderer* renderer, VkCommandBuffer cmd, uint32_t frame) {
                 renderer->getEntityManager()->renderEntities(cmd, frame);
             },
+            .postRenderFunc = [](Renderer* renderer, VkCommandBuffer cmd, uint32_t frame) {
+                renderer->getEntityManager()->renderDisoccludedEntities(cmd, frame);
+            },
             .skipCondition = [](Renderer* renderer) {
                 return !renderer->getEntityManager()->hasRenderable3D();
             }
         },
+        {
+            .name = "particle_sim",
+            .is2D = false,
+            .passInfo = particleSimPass.get(),
+            .dependsOnNodeNames = { "gbuffer" },
+            .lane = generalGraphicsLane,
+            .usesRendering = false,
+            .usePassManagedTransitions = false,
+            .storageWriteStage = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+            .customRenderFunc = [](Renderer* renderer, VkCommandBuffer cmd, uint32_t frame) {
+                renderer->getParticleManager()->simulateGPU(cmd, frame);
+            },
+            .skipCondition = [](Renderer* renderer) {
+                return !renderer->getParticleManager()->isGPUSimulation();
+            }
+        },
         {
             .name = "particle",
             .is2D = true,
             .passInfo = particlePass.get(),
             .shaderNames = { "particle" },
-            .dependsOnNodeNames = { "gbuffer" },
+            .dependsOnNodeNames = { "gbuffer", "particle_sim" },
             .lane = generalGraphicsLane,
             .customRenderFunc = [](Renderer* renderer, VkCommandBuffer cmd, uint32_t frame) {
                 renderer->getParticleManager()->renderParticles(cmd, frame);
@@ -2325,9 +2574,9 @@ void engine::ShaderManager::createDefaultShaders() {
             .lane = shadowLane,
             .usesRendering = false,
             .usePassManagedTransitions = false,
+            .canRecordOnWorkerThread = true,
             .customRenderFunc = [](Renderer* renderer, VkCommandBuffer cmd, uint32_t frame) {
                 renderer->getLightManager()->renderShadows(cmd, frame);
-                renderer->getLightManager()->updateLightsUBO(frame);
             }
         },
         {
@@ -2956,11 +3205,16 @@ std::vector<VkDescriptorSet> engine::GraphicsShader::createDescriptorSets(Render
         return false;
     };
 
+    auto isPartiallyBound = [&](VkDescriptorType type, uint32_t count) {
+        return config.partiallyBoundTextures && type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE && count > 1;
+    };
+
     size_t requiredTextureBindings = 0;
     for (size_t i = 0; i < fragmentBindings; ++i) {
         const uint32_t actualBinding = static_cast<uint32_t>(vertexBindings + i);
         if (isInputBinding(actualBinding)) continue;
         const VkDescriptorType type = getFragmentType(i);
+        if (isPartiallyBound(type, getFragmentCount(i))) continue;
         if (type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER || type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE) {
             requiredTextureBindings += getFragmentCount(i);
         }
@@ -3067,6 +3321,9 @@ std::vector<VkDescriptorSet> engine::GraphicsShader::createDescriptorSets(Render
                     break;
                 }
                 case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE: {
+                    if (isPartiallyBound(type, descriptorCount)) {
+                        break;
+                    }
                     for (uint32_t c = 0; c < descriptorCount; ++c) {
                         Texture* texture = textures.at(textureIndex++);
                         if (!texture || !texture->imageView) {
@@ -3176,8 +3433,22 @@ void engine::GraphicsShader::createDescriptorSetLayout(engine::Renderer* rendere
         };
         bindings.push_back(fragmentLayoutBinding);
     }
+    std::vector<VkDescriptorBindingFlags> bindingFlags(bindings.size(), 0);
+    if (config.partiallyBoundTextures) {
+        for (size_t i = 0; i < bindings.size(); ++i) {
+            if (bindings[i].descriptorType == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE && bindings[i].descriptorCount > 1) {
+                bindingFlags[i] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+            }
+        }
+    }
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+        .bindingCount = static_cast<uint32_t>(bindingFlags.size()),
+        .pBindingFlags = bindingFlags.data()
+    };
     VkDescriptorSetLayoutCreateInfo layoutInfo = {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = config.partiallyBoundTextures ? &bindingFlagsInfo : nullptr,
         .bindingCount = static_cast<uint32_t>(bindings.size()),
         .pBindings = bindings.data()
     };
@@ -0,0 +1,113 @@
+#include <engine/ShadowCasterGrid.h>
+#include <algorithm>
+
+void engine::ShadowCasterGrid::clear() {
+    cells.clear();
+    entries.clear();
+    oversized.clear();
+}
+
+void engine::ShadowCasterGrid::addToCells(Entity* entity, const Entry& entry) {
+    if (entry.oversized) {
+        oversized.push_back(entity);
+        return;
+    }
+    for (int32_t x = entry.minCell.x; x <= entry.maxCell.x; ++x) {
+        for (int32_t y = entry.minCell.y; y <= entry.maxCell.y; ++y) {
+            for (int32_t z = entry.minCell.z; z <= entry.maxCell.z; ++z) {
+                cells[getCellKey({x, y, z})].push_back(entity);
+            }
+        }
+    }
+}
+
+void engine::ShadowCasterGrid::removeFromCells(Entity* entity, const Entry& entry) {
+    if (entry.oversized) {
+        std::erase(oversized, entity);
+        return;
+    }
+    for (int32_t x = entry.minCell.x; x <= entry.maxCell.x; ++x) {
+        for (int32_t y = entry.minCell.y; y <= entry.maxCell.y; ++y) {
+            for (int32_t z = entry.minCell.z; z <= entry.maxCell.z; ++z) {
+                auto it = cells.find(getCellKey({x, y, z}));
+                if (it == cells.end()) continue;
+                std::erase(it->second, entity);
+                if (it->second.empty()) {
+                    cells.erase(it);
+                }
+            }
+        }
+    }
+}
+
+void engine::ShadowCasterGrid::insert(Entity* entity, const AABB& bounds) {
+    if (entries.contains(entity)) {
+        update(entity, bounds);
+        return;
+    }
+    const glm::ivec3 minCell = getCellPos(bounds.min);
+    const glm::ivec3 maxCell = getCellPos(bounds.max);
+    const Entry entry = { bounds, minCell, maxCell, isOversized(minCell, maxCell) };
+    entries.emplace(entity, entry);
+    addToCells(entity, entry);
+}
+
+void engine::ShadowCasterGrid::remove(const Entity* entity) {
+    auto it = entries.find(const_cast<Entity*>(entity));
+    if (it == entries.end()) return;
+    removeFromCells(it->first, it->second);
+    entries.erase(it);
+}
+
+void engine::ShadowCasterGrid::update(Entity* entity, const AABB& bounds) {
+    auto it = entries.find(entity);
+    if (it == entries.end()) {
+        insert(entity, bounds);
+        return;
+    }
+    Entry& entry = it->second;
+    entry.bounds = bounds;
+    const glm::ivec3 minCell = getCellPos(bounds.min);
+    const glm::ivec3 maxCell = getCellPos(bounds.max);
+    if (minCell == entry.minCell && maxCell == entry.maxCell) return;
+    removeFromCells(entity, entry);
+    entry.minCell = minCell;
+    entry.maxCell = maxCell;
+    entry.oversized = isOversized(minCell, maxCell);
+    addToCells(entity, entry);
+}
+
+void engine::ShadowCasterGrid::querySphere(const glm::vec3& center, float radius, std::vector<Entity*>& out) const {
+    const size_t first = out.size();
+    const glm::ivec3 minCell = getCellPos(center - glm::vec3(radius));
+    const glm::ivec3 maxCell = getCellPos(center + glm::vec3(radius));
+    const int64_t cellCount = (int64_t{maxCell.x} - minCell.x + 1) * (int64_t{maxCell.y} - minCell.y + 1) * (int64_t{maxCell.z} - minCell.z + 1);
+    if (cellCount > static_cast<int64_t>(cells.size())) {
+        // a range wider than the occupied cells is cheaper to answer from the cells themselves
+        for (const auto& [key, casters] : cells) {
+            out.insert(out.end(), casters.begin(), casters.end());
+        }
+    } else {
+        for (int32_t x = minCell.x; x <= maxCell.x; ++x) {
+            for (int32_t y = minCell.y; y <= maxCell.y; ++y) {
+                for (int32_t z = minCell.z; z <= maxCell.z; ++z) {
+                    auto it = cells.find(getCellKey({x, y, z}));
+                    if (it == cells.end()) continue;
+                    out.insert(out.end(), it->second.begin(), it->second.end());
+                }
+            }
+        }
+    }
+    out.insert(out.end(), oversized.begin(), oversized.end());
+    // casters spanning several cells show up once per cell
+    std::sort(out.begin() + first, out.end());
+    out.erase(std::unique(out.begin() + first, out.end()), out.end());
+    const float radiusSq = radius * radius;
+    auto outside = [&](Entity* entity) {
+        const AABB& bounds = entries.at(entity).bounds;
+        const glm::vec3 closest = glm::clamp(center, bounds.min, bounds.max);
+        const glm::vec3 delta = closest - center;
+        return glm::dot(delta, delta) > radiusSq;
+    };
+    out.erase(std::remove_if(out.begin() + first, out.end(), outside), out.end());
+}
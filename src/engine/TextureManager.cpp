@@ -1,6 +1,7 @@
 #include <engine/TextureManager.h>
 #include <engine/Renderer.h>
 #include <engine/ThreadPool.h>
+#include <engine/CookedTexture.h>
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
 
@@ -8,6 +9,15 @@
 #include <cstring>
 #include <cmath>
 #include <algorithm>
+#include <limits>
+#include <thread>
+
+static_assert(static_cast<uint32_t>(engine::cooked::TextureFormat::RGBA8_UNORM) == VK_FORMAT_R8G8B8A8_UNORM);
+static_assert(static_cast<uint32_t>(engine::cooked::TextureFormat::RGBA8_SRGB) == VK_FORMAT_R8G8B8A8_SRGB);
+static_assert(static_cast<uint32_t>(engine::cooked::TextureFormat::RGBA16_SFLOAT) == VK_FORMAT_R16G16B16A16_SFLOAT);
+static_assert(static_cast<uint32_t>(engine::cooked::TextureFormat::BC4_UNORM) == VK_FORMAT_BC4_UNORM_BLOCK);
+static_assert(static_cast<uint32_t>(engine::cooked::TextureFormat::BC5_UNORM) == VK_FORMAT_BC5_UNORM_BLOCK);
+static_assert(static_cast<uint32_t>(engine::cooked::TextureFormat::BC7_SRGB) == VK_FORMAT_BC7_SRGB_BLOCK);
 
 static inline uint16_t floatToHalf(float value) {
     union { float f; uint32_t i; } v;
@@ -27,6 +37,68 @@ static inline uint16_t floatToHalf(float value) {
     return static_cast<uint16_t>(sign | (exponent << 10) | (mantissa >> 13));
 }
 
+// bit reader for the block decoders, blocks are little endian with the first field in the lowest bits
+class BlockBitReader {
+public:
+    explicit BlockBitReader(const uint8_t* data) : data(data) {}
+    uint32_t read(uint32_t bits) {
+        uint32_t value = 0;
+        for (uint32_t i = 0; i < bits; ++i, ++pos) {
+            value |= static_cast<uint32_t>((data[pos >> 3] >> (pos & 7)) & 1u) << i;
+        }
+        return value;
+    }
+private:
+    const uint8_t* data;
+    uint32_t pos = 0;
+};
+
+// writes one channel of a 4x4 texel block, stride is the rgba texel size
+static void decodeBC4Block(const uint8_t* block, uint8_t* texels, size_t stride) {
+    const int r0 = block[0];
+    const int r1 = block[1];
+    int palette[8] = {r0, r1};
+    if (r0 > r1) {
+        for (int i = 2; i < 8; ++i) palette[i] = ((8 - i) * r0 + (i - 1) * r1 + 3) / 7;
+    } else {
+        for (int i = 2; i < 6; ++i) palette[i] = ((6 - i) * r0 + (i - 1) * r1 + 2) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    BlockBitReader reader(block + 2);
+    for (int i = 0; i < 16; ++i) {
+        texels[i * stride] = static_cast<uint8_t>(palette[reader.read(3)]);
+    }
+}
+
+// the cooker only writes single subset mode 6, any other mode is reported as unsupported
+static bool decodeBC7Block(const uint8_t* block, uint8_t texels[16][4]) {
+    constexpr int kWeights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+    BlockBitReader reader(block);
+    if (reader.read(7) != (1u << 6)) {
+        return false;
+    }
+    int endpoints[2][4];
+    for (int c = 0; c < 4; ++c) {
+        endpoints[0][c] = static_cast<int>(reader.read(7)) << 1;
+        endpoints[1][c] = static_cast<int>(reader.read(7)) << 1;
+    }
+    const int p0 = static_cast<int>(reader.read(1));
+    const int p1 = static_cast<int>(reader.read(1));
+    for (int c = 0; c < 4; ++c) {
+        endpoints[0][c] |= p0;
+        endpoints[1][c] |= p1;
+    }
+    for (int i = 0; i < 16; ++i) {
+        // the anchor texel's index msb is implied zero
+        const int w = kWeights[reader.read(i == 0 ? 3 : 4)];
+        for (int c = 0; c < 4; ++c) {
+            texels[i][c] = static_cast<uint8_t>(((64 - w) * endpoints[0][c] + w * endpoints[1][c] + 32) >> 6);
+        }
+    }
+    return true;
+}
+
 engine::TextureManager::TextureManager(
     engine::Renderer* renderer
 ) : renderer(renderer) {
@@ -34,6 +106,13 @@ engine::TextureManager::TextureManager(
     }
 
 engine::TextureManager::~TextureManager() {
+    // in-flight decodes write into this manager, let them drain before tearing down
+    cancelStreaming.store(true, std::memory_order_relaxed);
+    while (streamingInFlight.load(std::memory_order_acquire) > 0) {
+        std::this_thread::yield();
+    }
+    // submitted uploads land in textures before it is torn down
+    renderer->waitForUploads();
     VkDevice device = renderer->getDevice();
     for (auto& [name, texture] : textures) {
         if (texture.imageSampler != VK_NULL_HANDLE) {
@@ -55,19 +134,40 @@ void engine::TextureManager::registerEmbeddedTextures(const std::unordered_map<s
     embeddedAssets.insert(assets.begin(), assets.end());
 }
 
+struct engine::TextureManager::DecodedTexture {
+    std::string name;
+    bool valid = false;
+    bool isHDR = false;
+    int texWidth = 0;
+    int texHeight = 0;
+    unsigned char* stbiPixels = nullptr;
+    std::vector<uint16_t> halfPixels;
+    VkFormat cookedFormat = VK_FORMAT_UNDEFINED;
+    std::vector<uint8_t> mipData;
+    // raw levels viewed straight in the pack mapping, staged from there without an inflate or copy
+    std::span<const uint8_t> mappedMips;
+    std::vector<VkDeviceSize> mipOffsets; // into mappedMips when it is set, mipData otherwise
+
+    std::span<const uint8_t> mipBytes() const {
+        return mappedMips.empty() ? std::span<const uint8_t>(mipData) : mappedMips;
+    }
+
+    DecodedTexture() = default;
+    DecodedTexture(const DecodedTexture&) = delete;
+    DecodedTexture& operator=(const DecodedTexture&) = delete;
+    ~DecodedTexture() {
+        if (stbiPixels) stbi_image_free(stbiPixels);
+    }
+};
+
+// material sets are streamed on demand, the defaults stay resident as their placeholders
+static bool isStreamedTexture(const std::string& name) {
+    return name.starts_with("materials_") && !name.starts_with("materials_default_");
+}
+
 void engine::TextureManager::init() {
     stbi_set_flip_vertically_on_load(false);
 
-    struct DecodedTexture {
-        std::string name;
-        bool valid = false;
-        bool isHDR = false;
-        int texWidth = 0;
-        int texHeight = 0;
-        unsigned char* stbiPixels = nullptr;
-        std::vector<uint16_t> halfPixels;
-    };
-
     struct AssetEntry { std::string name; const EmbeddedAsset* asset; };
     std::vector<AssetEntry> assetList;
     assetList.reserve(embeddedAssets.size());
@@ -76,41 +176,15 @@ void engine::TextureManager::init() {
             std::cout << "Warning: Duplicate texture name detected: " << name << ". Skipping.\n";
             continue;
         }
+        if (isStreamedTexture(name)) continue;
         assetList.push_back({name, &asset});
     }
 
     std::vector<DecodedTexture> decoded(assetList.size());
+    const bool expandBlockFormats = !renderer->isBlockCompressionSupported();
     auto decodeOne = [&](size_t idx) {
-        const AssetEntry& entry = assetList[idx];
-        DecodedTexture& out = decoded[idx];
-        out.name = entry.name;
-        const EmbeddedAsset& asset = *entry.asset;
-        const bool isHDRFile = (std::strcmp(asset.ext, ".hdr") == 0);
-        int texChannels = 0;
-        if (isHDRFile) {
-            float* floatPixels = stbi_loadf_from_memory(asset.data, static_cast<int>(asset.size),
-                &out.texWidth, &out.texHeight, &texChannels, STBI_rgb_alpha);
-            if (!floatPixels) {
-                std::cerr << "Failed to load HDR texture: " << entry.name << std::endl;
-                return;
-            }
-            const size_t numFloats = static_cast<size_t>(out.texWidth) * static_cast<size_t>(out.texHeight) * 4;
-            out.halfPixels.resize(numFloats);
-            for (size_t i = 0; i < numFloats; ++i) {
-                out.halfPixels[i] = floatToHalf(floatPixels[i]);
-            }
-            stbi_image_free(floatPixels);
-            out.isHDR = true;
-        } else {
-            out.stbiPixels = stbi_load_from_memory(asset.data, static_cast<int>(asset.size),
-                &out.texWidth, &out.texHeight, &texChannels, STBI_rgb_alpha);
-            if (!out.stbiPixels) {
-                std::cerr << "Failed to load texture: " << entry.name << std::endl;
-                return;
-            }
-            out.isHDR = false;
-        }
-        out.valid = true;
+        decoded[idx].name = assetList[idx].name;
+        decodeTexture(*assetList[idx].asset, decoded[idx], expandBlockFormats);
     };
 
     // parallel decode
@@ -123,15 +197,230 @@ void engine::TextureManager::init() {
         decodeOne(0);
     }
 
-    // serial Vulkan upload
+    // serial Vulkan upload, one submission for the whole set
+    VkCommandBuffer commandBuffer = renderer->beginUploadCommands();
+    std::vector<std::pair<VkBuffer, VkDeviceMemory>> stagingBuffers;
+    std::vector<Texture> uploaded;
     for (DecodedTexture& dec : decoded) {
-        if (!dec.valid) continue;
-        const std::string& textureName = dec.name;
-        const int texWidth = dec.texWidth;
-        const int texHeight = dec.texHeight;
-        const bool isHDR = dec.isHDR;
+        if (dec.valid) uploaded.push_back(recordTextureUpload(dec, commandBuffer, stagingBuffers));
+    }
+    renderer->submitUploadCommands(commandBuffer, std::move(stagingBuffers), [this, uploaded = std::move(uploaded)]() mutable {
+        for (Texture& texture : uploaded) {
+            textures[texture.name] = std::move(texture);
+        }
+    });
+    renderer->waitForUploads();
+}
+
+void engine::TextureManager::decodeTexture(const EmbeddedAsset& asset, DecodedTexture& out, bool expandBlockFormats) {
+    if (asset.size >= sizeof(cooked::Ktx2Header)
+        && std::memcmp(asset.data, cooked::kKtx2Identifier, sizeof(cooked::kKtx2Identifier)) == 0) {
+        decodeCookedTexture(asset, out, expandBlockFormats);
+        return;
+    }
+    const bool isHDRFile = (std::strcmp(asset.ext, ".hdr") == 0);
+    int texChannels = 0;
+    if (isHDRFile) {
+        float* floatPixels = stbi_loadf_from_memory(asset.data, static_cast<int>(asset.size),
+            &out.texWidth, &out.texHeight, &texChannels, STBI_rgb_alpha);
+        if (!floatPixels) {
+            std::cerr << "Failed to load HDR texture: " << out.name << std::endl;
+            return;
+        }
+        const size_t numFloats = static_cast<size_t>(out.texWidth) * static_cast<size_t>(out.texHeight) * 4;
+        out.halfPixels.resize(numFloats);
+        for (size_t i = 0; i < numFloats; ++i) {
+            out.halfPixels[i] = floatToHalf(floatPixels[i]);
+        }
+        stbi_image_free(floatPixels);
+        out.isHDR = true;
+    } else {
+        out.stbiPixels = stbi_load_from_memory(asset.data, static_cast<int>(asset.size),
+            &out.texWidth, &out.texHeight, &texChannels, STBI_rgb_alpha);
+        if (!out.stbiPixels) {
+            std::cerr << "Failed to load texture: " << out.name << std::endl;
+            return;
+        }
+        out.isHDR = false;
+    }
+    out.valid = true;
+}
+
+void engine::TextureManager::decodeCookedTexture(const EmbeddedAsset& asset, DecodedTexture& out, bool expandBlockFormats) {
+    cooked::Ktx2Header header;
+    std::memcpy(&header, asset.data, sizeof(header));
+    const bool zlib = header.supercompressionScheme == cooked::kKtx2SupercompressionZlib;
+    if (header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1 || header.levelCount == 0
+        || (!zlib && header.supercompressionScheme != cooked::kKtx2SupercompressionNone)
+        || sizeof(header) + header.levelCount * sizeof(cooked::Ktx2Level) > asset.size) {
+        std::cerr << "Unsupported KTX2 texture: " << out.name << std::endl;
+        return;
+    }
+    std::vector<cooked::Ktx2Level> levels(header.levelCount);
+    std::memcpy(levels.data(), asset.data + sizeof(header), levels.size() * sizeof(cooked::Ktx2Level));
+    uint64_t firstByte = UINT64_MAX;
+    uint64_t lastByte = 0;
+    bool aligned = !zlib;
+    for (const cooked::Ktx2Level& level : levels) {
+        if (level.byteOffset + level.byteLength > asset.size) {
+            std::cerr << "Truncated KTX2 texture: " << out.name << std::endl;
+            return;
+        }
+        firstByte = std::min(firstByte, level.byteOffset);
+        lastByte = std::max(lastByte, level.byteOffset + level.byteLength);
+        aligned = aligned && level.byteOffset % 16 == 0 && level.byteLength == level.uncompressedByteLength;
+    }
+    out.texWidth = static_cast<int>(header.pixelWidth);
+    out.texHeight = static_cast<int>(header.pixelHeight);
+    out.cookedFormat = static_cast<VkFormat>(header.vkFormat);
+    out.isHDR = out.cookedFormat == VK_FORMAT_R16G16B16A16_SFLOAT;
+
+    // raw levels the cooker padded to 16 bytes are already valid copy regions, the pack keeps blobs 16 byte aligned
+    if (aligned) {
+        out.mappedMips = std::span<const uint8_t>(asset.data + firstByte, static_cast<size_t>(lastByte - firstByte));
+        out.mipOffsets.resize(levels.size());
+        for (size_t i = 0; i < levels.size(); ++i) {
+            out.mipOffsets[i] = levels[i].byteOffset - firstByte;
+        }
+        if (expandBlockFormats && !expandBlockCompressed(out)) {
+            std::cerr << "Failed to expand block compressed texture: " << out.name << std::endl;
+            return;
+        }
+        out.valid = true;
+        return;
+    }
+
+    // levels are packed largest first, each on a 16 byte boundary for the copy regions
+    VkDeviceSize total = 0;
+    out.mipOffsets.resize(levels.size());
+    for (size_t i = 0; i < levels.size(); ++i) {
+        out.mipOffsets[i] = total;
+        total = (total + levels[i].uncompressedByteLength + 15) & ~VkDeviceSize(15);
+    }
+    out.mipData.resize(total);
+    for (size_t i = 0; i < levels.size(); ++i) {
+        const unsigned char* src = asset.data + levels[i].byteOffset;
+        char* dst = reinterpret_cast<char*>(out.mipData.data() + out.mipOffsets[i]);
+        const int expected = static_cast<int>(levels[i].uncompressedByteLength);
+        if (zlib) {
+            int written = stbi_zlib_decode_buffer(dst, expected,
+                reinterpret_cast<const char*>(src), static_cast<int>(levels[i].byteLength));
+            if (written != expected) {
+                std::cerr << "Failed to inflate KTX2 level " << i << " of texture: " << out.name << std::endl;
+                return;
+            }
+        } else {
+            std::memcpy(dst, src, levels[i].uncompressedByteLength);
+        }
+    }
+    if (expandBlockFormats && !expandBlockCompressed(out)) {
+        std::cerr << "Failed to expand block compressed texture: " << out.name << std::endl;
+        return;
+    }
+    out.valid = true;
+}
+
+bool engine::TextureManager::expandBlockCompressed(DecodedTexture& out) {
+    // devices without textureCompressionBC get the cooked levels as rgba8, sampling reads the same channels
+    VkFormat expanded;
+    switch (out.cookedFormat) {
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+            expanded = VK_FORMAT_R8G8B8A8_UNORM;
+            break;
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            expanded = VK_FORMAT_R8G8B8A8_SRGB;
+            break;
+        default:
+            return true;
+    }
+    const size_t blockBytes = out.cookedFormat == VK_FORMAT_BC4_UNORM_BLOCK ? 8 : 16;
+    std::vector<VkDeviceSize> offsets(out.mipOffsets.size());
+    VkDeviceSize total = 0;
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        const VkDeviceSize w = std::max(1, out.texWidth >> i);
+        const VkDeviceSize h = std::max(1, out.texHeight >> i);
+        offsets[i] = total;
+        total = (total + w * h * 4 + 15) & ~VkDeviceSize(15);
+    }
+    const std::span<const uint8_t> source = out.mipBytes();
+    std::vector<uint8_t> pixels(total);
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        const uint32_t w = static_cast<uint32_t>(std::max(1, out.texWidth >> i));
+        const uint32_t h = static_cast<uint32_t>(std::max(1, out.texHeight >> i));
+        const uint32_t blocksX = (w + 3) / 4;
+        const uint32_t blocksY = (h + 3) / 4;
+        if (out.mipOffsets[i] + blocksX * blocksY * blockBytes > source.size()) {
+            return false;
+        }
+        const uint8_t* src = source.data() + out.mipOffsets[i];
+        uint8_t* dst = pixels.data() + offsets[i];
+        for (uint32_t by = 0; by < blocksY; ++by) {
+            for (uint32_t bx = 0; bx < blocksX; ++bx) {
+                const uint8_t* block = src + (by * blocksX + bx) * blockBytes;
+                uint8_t texels[16][4] = {};
+                switch (out.cookedFormat) {
+                    case VK_FORMAT_BC4_UNORM_BLOCK:
+                        decodeBC4Block(block, &texels[0][0], 4);
+                        break;
+                    case VK_FORMAT_BC5_UNORM_BLOCK:
+                        decodeBC4Block(block, &texels[0][0], 4);
+                        decodeBC4Block(block + 8, &texels[0][1], 4);
+                        break;
+                    default:
+                        if (!decodeBC7Block(block, texels)) return false;
+                        break;
+                }
+                if (expanded == VK_FORMAT_R8G8B8A8_UNORM) {
+                    for (auto& texel : texels) texel[3] = 255;
+                }
+                for (uint32_t y = 0; y < 4 && by * 4 + y < h; ++y) {
+                    for (uint32_t x = 0; x < 4 && bx * 4 + x < w; ++x) {
+                        std::memcpy(dst + ((by * 4 + y) * w + bx * 4 + x) * 4, texels[y * 4 + x], 4);
+                    }
+                }
+            }
+        }
+    }
+    out.mipData = std::move(pixels);
+    out.mappedMips = {};
+    out.mipOffsets = std::move(offsets);
+    out.cookedFormat = expanded;
+    return true;
+}
+
+engine::Texture engine::TextureManager::recordTextureUpload(
+    DecodedTexture& dec,
+    VkCommandBuffer commandBuffer,
+    std::vector<std::pair<VkBuffer, VkDeviceMemory>>& stagingBuffers
+) {
+    const std::string& textureName = dec.name;
+    const int texWidth = dec.texWidth;
+    const int texHeight = dec.texHeight;
+    const bool isHDR = dec.isHDR;
+    VkFormat format;
+    uint32_t mipLevels;
+    VkImage textureImage;
+    VkDeviceMemory textureImageMemory;
+    if (dec.cookedFormat != VK_FORMAT_UNDEFINED) {
+        // cooked textures carry their whole mip chain, no blits needed
+        format = dec.cookedFormat;
+        mipLevels = static_cast<uint32_t>(dec.mipOffsets.size());
+        const std::span<const uint8_t> mips = dec.mipBytes();
+        std::tie(textureImage, textureImageMemory) = renderer->createImageFromMipChainInline(
+            commandBuffer,
+            mips.data(),
+            static_cast<VkDeviceSize>(mips.size()),
+            static_cast<uint32_t>(texWidth),
+            static_cast<uint32_t>(texHeight),
+            dec.mipOffsets,
+            format,
+            stagingBuffers
+        );
+        dec.mipData = {};
+        dec.mappedMips = {};
+    } else {
         void* pixels = isHDR ? static_cast<void*>(dec.halfPixels.data()) : static_cast<void*>(dec.stbiPixels);
-        VkFormat format;
         VkDeviceSize pixelSize;
         if (isHDR) {
             format = VK_FORMAT_R16G16B16A16_SFLOAT;
@@ -145,37 +434,33 @@ void engine::TextureManager::init() {
             pixelSize = static_cast<VkDeviceSize>(texWidth) * static_cast<VkDeviceSize>(texHeight) * 4 * sizeof(uint8_t);
         }
         const bool canMipmap = renderer->formatSupportsLinearBlit(format);
-        const uint32_t mipLevels = canMipmap
+        mipLevels = canMipmap
             ? static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1
             : 1;
         VkImageUsageFlags imageUsage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
         if (mipLevels > 1) {
             imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
         }
-        VkImage textureImage;
-        VkDeviceMemory textureImageMemory;
-        std::tie(textureImage, textureImageMemory) = renderer->createImageFromPixels(
+        std::tie(textureImage, textureImageMemory) = renderer->createImageFromPixelsInline(
+            commandBuffer,
             pixels,
             pixelSize,
             texWidth,
             texHeight,
             mipLevels,
-            VK_SAMPLE_COUNT_1_BIT,
             format,
-            VK_IMAGE_TILING_OPTIMAL,
             imageUsage,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            1,
-            0
+            stagingBuffers
         );
         if (!isHDR) {
             stbi_image_free(dec.stbiPixels);
             dec.stbiPixels = nullptr;
         }
         if (mipLevels > 1) {
-            renderer->generateMipmaps(textureImage, format, texWidth, texHeight, mipLevels, 1);
+            renderer->generateMipmapsInline(commandBuffer, textureImage, format, texWidth, texHeight, mipLevels, 1);
         } else {
-            renderer->transitionImageLayout(
+            renderer->transitionImageLayoutInline(
+                commandBuffer,
                 textureImage,
                 format,
                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
@@ -184,42 +469,41 @@ void engine::TextureManager::init() {
                 1
             );
         }
-        VkImageView textureImageView = renderer->createImageView(
-            textureImage,
-            format,
-            VK_IMAGE_ASPECT_COLOR_BIT,
-            mipLevels
-        );
-        VkSampler textureSampler;
-        textureSampler = renderer->createTextureSampler(
-            VK_FILTER_LINEAR,
-            VK_FILTER_LINEAR,
-            VK_SAMPLER_MIPMAP_MODE_LINEAR,
-            VK_SAMPLER_ADDRESS_MODE_REPEAT,
-            VK_SAMPLER_ADDRESS_MODE_REPEAT,
-            VK_SAMPLER_ADDRESS_MODE_REPEAT,
-            0.0f,
-            VK_TRUE,
-            16.0f,
-            VK_FALSE,
-            VK_COMPARE_OP_ALWAYS,
-            0.0f,
-            static_cast<float>(mipLevels),
-            VK_BORDER_COLOR_INT_OPAQUE_BLACK,
-            VK_FALSE
-        );
-        Texture texture = {
-            .name = textureName,
-            .image = textureImage,
-            .imageView = textureImageView,
-            .imageMemory = textureImageMemory,
-            .imageSampler = textureSampler,
-            .format = format,
-            .width = texWidth,
-            .height = texHeight
-        };
-        textures[textureName] = std::move(texture);
     }
+    VkImageView textureImageView = renderer->createImageView(
+        textureImage,
+        format,
+        VK_IMAGE_ASPECT_COLOR_BIT,
+        mipLevels
+    );
+    VkSampler textureSampler;
+    textureSampler = renderer->createTextureSampler(
+        VK_FILTER_LINEAR,
+        VK_FILTER_LINEAR,
+        VK_SAMPLER_MIPMAP_MODE_LINEAR,
+        VK_SAMPLER_ADDRESS_MODE_REPEAT,
+        VK_SAMPLER_ADDRESS_MODE_REPEAT,
+        VK_SAMPLER_ADDRESS_MODE_REPEAT,
+        0.0f,
+        VK_TRUE,
+        16.0f,
+        VK_FALSE,
+        VK_COMPARE_OP_ALWAYS,
+        0.0f,
+        static_cast<float>(mipLevels),
+        VK_BORDER_COLOR_INT_OPAQUE_BLACK,
+        VK_FALSE
+    );
+    return {
+        .name = textureName,
+        .image = textureImage,
+        .imageView = textureImageView,
+        .imageMemory = textureImageMemory,
+        .imageSampler = textureSampler,
+        .format = format,
+        .width = texWidth,
+        .height = texHeight
+    };
 }
 
 engine::Texture* engine::TextureManager::getTexture(const std::string& name) {
@@ -230,6 +514,94 @@ engine::Texture* engine::TextureManager::getTexture(const std::string& name) {
     return nullptr;
 }
 
+engine::AssetState engine::TextureManager::requestTexture(const std::string& name) {
+    if (textures.contains(name)) return AssetState::Resident;
+    if (failedTextures.contains(name)) return AssetState::Missing;
+    auto assetIt = embeddedAssets.find(name);
+    if (assetIt == embeddedAssets.end()) return AssetState::Missing;
+    if (requestedTextures.insert(name).second) {
+        const EmbeddedAsset* asset = &assetIt->second;
+        streamingInFlight.fetch_add(1, std::memory_order_relaxed);
+        const bool expandBlockFormats = !renderer->isBlockCompressionSupported();
+        ThreadPool::global().submit([this, name, asset, expandBlockFormats] {
+            auto dec = std::make_unique<DecodedTexture>();
+            dec->name = name;
+            if (!cancelStreaming.load(std::memory_order_relaxed)) {
+                decodeTexture(*asset, *dec, expandBlockFormats);
+            }
+            {
+                std::lock_guard<std::mutex> lock(streamedMutex);
+                streamedTextures.push_back(std::move(dec));
+            }
+            streamingInFlight.fetch_sub(1, std::memory_order_release);
+        });
+    }
+    return AssetState::Pending;
+}
+
+void engine::TextureManager::preloadTextures(const std::vector<std::string>& names) {
+    for (const std::string& name : names) {
+        requestTexture(name);
+    }
+}
+
+void engine::TextureManager::waitForTextures(const std::vector<std::string>& names) {
+    preloadTextures(names);
+    auto anyPending = [&] {
+        return std::any_of(names.begin(), names.end(), [&](const std::string& name) {
+            return requestTexture(name) == AssetState::Pending;
+        });
+    };
+    while (anyPending()) {
+        const bool submitted = submitStreamedTextures(std::numeric_limits<size_t>::max());
+        if (!renderer->processCompletedUploads() && !submitted) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool engine::TextureManager::processStreamedTextures(size_t maxUploads) {
+    submitStreamedTextures(maxUploads);
+    return std::exchange(streamedTexturesResident, false);
+}
+
+bool engine::TextureManager::submitStreamedTextures(size_t maxUploads) {
+    std::vector<std::unique_ptr<DecodedTexture>> ready;
+    {
+        std::lock_guard<std::mutex> lock(streamedMutex);
+        const size_t count = std::min(maxUploads, streamedTextures.size());
+        if (count == 0) return false;
+        ready.assign(std::make_move_iterator(streamedTextures.begin()),
+            std::make_move_iterator(streamedTextures.begin() + static_cast<std::ptrdiff_t>(count)));
+        streamedTextures.erase(streamedTextures.begin(), streamedTextures.begin() + static_cast<std::ptrdiff_t>(count));
+    }
+    // names stay requested until the fence signals so nothing decodes twice
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    std::vector<std::pair<VkBuffer, VkDeviceMemory>> stagingBuffers;
+    std::vector<Texture> uploaded;
+    for (auto& dec : ready) {
+        if (!dec->valid) {
+            requestedTextures.erase(dec->name);
+            failedTextures.insert(dec->name);
+            continue;
+        }
+        if (commandBuffer == VK_NULL_HANDLE) {
+            commandBuffer = renderer->beginUploadCommands();
+        }
+        uploaded.push_back(recordTextureUpload(*dec, commandBuffer, stagingBuffers));
+    }
+    if (commandBuffer != VK_NULL_HANDLE) {
+        renderer->submitUploadCommands(commandBuffer, std::move(stagingBuffers), [this, uploaded = std::move(uploaded)]() mutable {
+            for (Texture& texture : uploaded) {
+                requestedTextures.erase(texture.name);
+                textures[texture.name] = std::move(texture);
+            }
+            streamedTexturesResident = true;
+        });
+    }
+    return true;
+}
+
 void engine::TextureManager::registerTextureFromRGBA(const std::string& name, const uint8_t* rgba, int width, int height) {
     createTextureFromRGBA(name, rgba, width, height);
 }
@@ -37,18 +37,40 @@ void engine::ThreadPool::workerLoop() {
     g_inParallel = true;
     while (true) {
         ChunkTask task{};
+        std::function<void()> job;
         {
             std::unique_lock<std::mutex> lk(m);
-            cv.wait(lk, [this] { return !tasks.empty() || !running; });
+            cv.wait(lk, [this] { return !tasks.empty() || !jobs.empty() || !running; });
             if (!running && tasks.empty()) return;
-            task = tasks.front();
-            tasks.pop_front();
+            if (!tasks.empty()) {
+                task = tasks.front();
+                tasks.pop_front();
+            } else {
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+        }
+        if (job) {
+            job();
+            continue;
         }
         (*task.fn)(task.begin, task.end, task.chunkIdx);
         task.remaining->fetch_sub(1, std::memory_order_release);
     }
 }
 
+void engine::ThreadPool::submit(std::function<void()> job) {
+    if (workers.empty()) {
+        job();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lk(m);
+        jobs.push_back(std::move(job));
+    }
+    cv.notify_one();
+}
+
 size_t engine::ThreadPool::numChunks(size_t begin, size_t end, size_t minChunk) const {
     if (end <= begin) return 0;
     const size_t n = end - begin;
@@ -89,7 +111,21 @@ void engine::ThreadPool::parallel_for_chunks(size_t begin, size_t end, size_t mi
     cv.notify_all();
     fn(begin, std::min(begin + chunkSize, end), 0);
     while (remaining.load(std::memory_order_acquire) > 0) {
-        std::this_thread::yield();
+        // run queued chunks here too, workers may be busy with background jobs
+        ChunkTask task{};
+        {
+            std::lock_guard<std::mutex> lk(m);
+            if (!tasks.empty()) {
+                task = tasks.front();
+                tasks.pop_front();
+            }
+        }
+        if (task.fn) {
+            (*task.fn)(task.begin, task.end, task.chunkIdx);
+            task.remaining->fetch_sub(1, std::memory_order_release);
+        } else {
+            std::this_thread::yield();
+        }
     }
     g_inParallel = false;
 }
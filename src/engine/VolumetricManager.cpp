@@ -5,18 +5,66 @@
 #include <engine/SettingsManager.h>
 #include <engine/PushConstants.h>
 #include <engine/Camera.h>
+#include <engine/SIMD.h>
+#include <algorithm>
 
-engine::Volumetric::Volumetric(
-    const glm::mat4& initialTransform,
-    const glm::mat4& finalTransform,
-    const glm::vec4& color,
-    float lifetime,
-    float acceleration
-) : initialTransform(initialTransform), finalTransform(finalTransform), color(color), lifetime(lifetime), acceleration(acceleration) {
-    glm::vec3 skew;
-    glm::vec4 persp;
-    glm::decompose(initialTransform, scaleA, rotA, transA, skew, persp);
-    glm::decompose(finalTransform, scaleB, rotB, transB, skew, persp);
+static_assert(sizeof(engine::VolumetricGPU) == engine::simd::kVolumetricGPUFloats * sizeof(float));
+
+void engine::VolumetricManager::VolumetricSoA::clearAll() {
+    for (std::vector<float>* array : floatArrays()) {
+        array->clear();
+    }
+    dead.clear();
+}
+
+void engine::VolumetricManager::VolumetricSoA::reserveAll(size_t n) {
+    for (std::vector<float>* array : floatArrays()) {
+        array->reserve(n);
+    }
+    dead.reserve(n);
+}
+
+void engine::VolumetricManager::VolumetricSoA::push(
+    const glm::vec3& scaleA, const glm::quat& rotA, const glm::vec3& transA,
+    const glm::vec3& scaleB, const glm::quat& rotB, const glm::vec3& transB,
+    const glm::vec4& color, float life, float accel)
+{
+    scaleAX.push_back(scaleA.x); scaleAY.push_back(scaleA.y); scaleAZ.push_back(scaleA.z);
+    scaleBX.push_back(scaleB.x); scaleBY.push_back(scaleB.y); scaleBZ.push_back(scaleB.z);
+    transAX.push_back(transA.x); transAY.push_back(transA.y); transAZ.push_back(transA.z);
+    transBX.push_back(transB.x); transBY.push_back(transB.y); transBZ.push_back(transB.z);
+    rotAX.push_back(rotA.x); rotAY.push_back(rotA.y); rotAZ.push_back(rotA.z); rotAW.push_back(rotA.w);
+    rotBX.push_back(rotB.x); rotBY.push_back(rotB.y); rotBZ.push_back(rotB.z); rotBW.push_back(rotB.w);
+    colorR.push_back(color.r); colorG.push_back(color.g); colorB.push_back(color.b); colorA.push_back(color.a);
+    age.push_back(0.0f);
+    lifetime.push_back(life);
+    acceleration.push_back(accel);
+    dead.push_back(0);
+}
+
+void engine::VolumetricManager::VolumetricSoA::truncateFront(size_t n) {
+    if (n == 0) return;
+    if (n >= count()) { clearAll(); return; }
+    for (std::vector<float>* array : floatArrays()) {
+        array->erase(array->begin(), array->begin() + static_cast<ptrdiff_t>(n));
+    }
+    dead.erase(dead.begin(), dead.begin() + static_cast<ptrdiff_t>(n));
+}
+
+void engine::VolumetricManager::VolumetricSoA::compactDead() {
+    const size_t n = count();
+    const size_t deadCount = static_cast<size_t>(std::count(dead.begin(), dead.end(), uint8_t{1}));
+    if (deadCount == 0) return;
+    if (deadCount == n) { clearAll(); return; }
+    static thread_local std::vector<float> scratch;
+    const size_t alive = n - deadCount;
+    scratch.resize(alive);
+    for (std::vector<float>* array : floatArrays()) {
+        engine::simd::compactFloats(array->data(), dead.data(), n, scratch.data());
+        array->swap(scratch);
+        scratch.resize(alive);
+    }
+    dead.assign(alive, 0);
 }
 
 engine::VolumetricManager::VolumetricManager(engine::Renderer* renderer)
@@ -42,11 +90,11 @@ engine::VolumetricManager::~VolumetricManager() {
         vkDestroyBuffer(renderer->getDevice(), cubeVertexBuffer, nullptr);
         vkFreeMemory(renderer->getDevice(), cubeVertexBufferMemory, nullptr);
     }
-    volumetrics.clear();
+    volumetrics.clearAll();
 }
 
 void engine::VolumetricManager::init() {
-    volumetrics.reserve(maxVolumetrics);
+    volumetrics.reserveAll(maxVolumetrics);
     VkDeviceSize cubeSize = sizeof(unitCube);
     std::tie(cubeVertexBuffer, cubeVertexBufferMemory) = renderer->createBuffer(
         cubeSize,
@@ -71,9 +119,17 @@ void engine::VolumetricManager::init() {
 }
 
 void engine::VolumetricManager::clear() {
-    for (auto& v : volumetrics) {
-        v.markForDeletion();
-    }
+    std::fill(volumetrics.dead.begin(), volumetrics.dead.end(), uint8_t{1});
+}
+
+void engine::VolumetricManager::createVolumetric(const glm::mat4& initialTransform, const glm::mat4& finalTransform, const glm::vec4& color, float lifetime, float acceleration) {
+    if (volumetrics.count() >= hardCap) return;
+    glm::vec3 scaleA, scaleB, transA, transB, skew;
+    glm::quat rotA, rotB;
+    glm::vec4 persp;
+    glm::decompose(initialTransform, scaleA, rotA, transA, skew, persp);
+    glm::decompose(finalTransform, scaleB, rotB, transB, skew, persp);
+    volumetrics.push(scaleA, rotA, transA, scaleB, rotB, transB, color, lifetime, acceleration);
 }
 
 void engine::VolumetricManager::createVolumetricDescriptorSets() {
@@ -148,13 +204,12 @@ void engine::VolumetricManager::createVolumetricDescriptorSets() {
 
 void engine::VolumetricManager::updateVolumetricBuffer(uint32_t currentFrame) {
     VkDevice device = renderer->getDevice();
-    if (volumetrics.size() > hardCap) {
-        size_t toRemove = volumetrics.size() - hardCap;
-        volumetrics.erase(volumetrics.begin(), volumetrics.begin() + toRemove);
+    if (volumetrics.count() > hardCap) {
+        volumetrics.truncateFront(volumetrics.count() - hardCap);
     }
-    if (volumetrics.size() > maxVolumetrics) {
+    if (volumetrics.count() > maxVolumetrics) {
         vkDeviceWaitIdle(device);
-        maxVolumetrics = std::min(std::max(maxVolumetrics * 2, static_cast<uint32_t>(volumetrics.size())), hardCap);
+        maxVolumetrics = std::min(std::max(maxVolumetrics * 2, static_cast<uint32_t>(volumetrics.count())), hardCap);
         for (size_t i = 0; i < volumetricBuffersMapped.size(); ++i) {
             if (volumetricBuffersMapped[i] != nullptr && i < volumetricBufferMemory.size() && volumetricBufferMemory[i] != VK_NULL_HANDLE) {
                 vkUnmapMemory(device, volumetricBufferMemory[i]);
@@ -184,17 +239,34 @@ void engine::VolumetricManager::updateVolumetricBuffer(uint32_t currentFrame) {
         vkResetDescriptorPool(renderer->getDevice(), shader->descriptorPool, 0);
         createVolumetricDescriptorSets();
     }
-    VolumetricGPU* gpuData = static_cast<VolumetricGPU*>(volumetricBuffersMapped[currentFrame]);
     Camera* camera = renderer->getEntityManager()->getCamera();
     if (!camera) return;
-    visibleVolumetrics = 0;
-    for (size_t i = 0; i < volumetrics.size(); ++i) {
-        const VolumetricGPU& curr = volumetrics[i].getGPUData();
-        float scale = glm::length(glm::vec3(curr.model[0])); // assuming uniform scale
-        if (camera->isSphereInFrustum(curr.model[3], scale)) {
-            gpuData[visibleVolumetrics++] = curr;
-        }
+    const auto& planes4 = camera->getFrustumPlanes();
+    engine::simd::Plane planes[6];
+    for (int i = 0; i < 6; ++i) {
+        planes[i] = { planes4[i].x, planes4[i].y, planes4[i].z, planes4[i].w };
     }
+    // one SIMD pass eases, builds both matrices, culls and packs straight into the mapped buffer
+    const engine::simd::VolumetricStreams streams = {
+        .scaleA = { volumetrics.scaleAX.data(), volumetrics.scaleAY.data(), volumetrics.scaleAZ.data() },
+        .scaleB = { volumetrics.scaleBX.data(), volumetrics.scaleBY.data(), volumetrics.scaleBZ.data() },
+        .transA = { volumetrics.transAX.data(), volumetrics.transAY.data(), volumetrics.transAZ.data() },
+        .transB = { volumetrics.transBX.data(), volumetrics.transBY.data(), volumetrics.transBZ.data() },
+        .rotA = { volumetrics.rotAX.data(), volumetrics.rotAY.data(), volumetrics.rotAZ.data(), volumetrics.rotAW.data() },
+        .rotB = { volumetrics.rotBX.data(), volumetrics.rotBY.data(), volumetrics.rotBZ.data(), volumetrics.rotBW.data() },
+        .color = { volumetrics.colorR.data(), volumetrics.colorG.data(), volumetrics.colorB.data(), volumetrics.colorA.data() },
+        .age = volumetrics.age.data(),
+        .lifetime = volumetrics.lifetime.data(),
+        .acceleration = volumetrics.acceleration.data(),
+        .dead = volumetrics.dead.data()
+    };
+    visibleVolumetrics = static_cast<uint32_t>(engine::simd::buildVolumetricGPUData(
+        streams,
+        volumetrics.count(),
+        planes,
+        static_cast<float*>(volumetricBuffersMapped[currentFrame]),
+        maxVolumetrics
+    ));
 }
 
 void engine::VolumetricManager::renderVolumetrics(VkCommandBuffer commandBuffer, uint32_t currentFrame) {
@@ -217,13 +289,12 @@ void engine::VolumetricManager::renderVolumetrics(VkCommandBuffer commandBuffer,
 }
 
 void engine::VolumetricManager::updateAll(float deltaTime) {
-    for (Volumetric& volumetric : volumetrics) {
-        volumetric.setAge(volumetric.getAge() + deltaTime);
-        if (volumetric.getAge() >= volumetric.getLifetime()) {
-            volumetric.markForDeletion();
+    const size_t count = volumetrics.count();
+    for (size_t i = 0; i < count; ++i) {
+        volumetrics.age[i] += deltaTime;
+        if (volumetrics.age[i] >= volumetrics.lifetime[i]) {
+            volumetrics.dead[i] = 1;
         }
     }
-    std::erase_if(volumetrics, [](const Volumetric& v) {
-        return v.isMarkedForDeletion();
-    });
+    volumetrics.compactDead();
 }
\ No newline at end of file
@@ -0,0 +1,26 @@
+struct PushConstants {
+    uint2 srcSize;
+    uint2 dstSize;
+};
+[[vk::push_constant]] PushConstants pc;
+
+[[vk::binding(0)]]
+Texture2D<float> srcDepth;
+
+[[vk::binding(1)]]
+RWTexture2D<float> dstDepth;
+
+// keeps the farthest depth of each 2x2 footprint, odd edges clamp onto the last row/column
+[numthreads(8, 8, 1)]
+void main(uint3 globalID : SV_DispatchThreadID) {
+    if (globalID.x >= pc.dstSize.x || globalID.y >= pc.dstSize.y) {
+        return;
+    }
+    uint2 base = globalID.xy * 2u;
+    uint2 maxCoord = pc.srcSize - 1u;
+    float d0 = srcDepth.Load(int3(min(base, maxCoord), 0));
+    float d1 = srcDepth.Load(int3(min(base + uint2(1u, 0u), maxCoord), 0));
+    float d2 = srcDepth.Load(int3(min(base + uint2(0u, 1u), maxCoord), 0));
+    float d3 = srcDepth.Load(int3(min(base + uint2(1u, 1u), maxCoord), 0));
+    dstDepth[globalID.xy] = max(max(d0, d1), max(d2, d3));
+}
@@ -3,6 +3,7 @@ struct VSOutput {
     [[vk::location(1)]] float3 fragNormal : TEXCOORD1;
     [[vk::location(2)]] float2 fragTexCoord : TEXCOORD2;
     [[vk::location(3)]] float3x3 fragTBN : TEXCOORD3;
+    [[vk::location(6)]] nointerpolation uint materialIndex : TEXCOORD6;
 };
 
 struct GBufferOutput {
@@ -11,19 +12,20 @@ struct GBufferOutput {
     [[vk::location(2)]] float4 outMaterial;
 };
 
-[[vk::binding(1)]]
-Texture2D<float4> albedoTexture;
+struct Material {
+    uint albedo;
+    uint metallic;
+    uint roughness;
+    uint normal;
+};
 
 [[vk::binding(2)]]
-Texture2D<float4> metallicTexture;
+StructuredBuffer<Material> materials;
 
 [[vk::binding(3)]]
-Texture2D<float4> roughnessTexture;
+Texture2D<float4> textures[1024];
 
 [[vk::binding(4)]]
-Texture2D<float4> normalTexture;
-
-[[vk::binding(5)]]
 SamplerState sampleSampler;
 
 float3 getNormalFromMap(float3 normalMap, float3x3 TBN) {
@@ -32,10 +34,14 @@ float3 getNormalFromMap(float3 normalMap, float3x3 TBN) {
 }
 
 GBufferOutput main(VSOutput input) : SV_Target {
-    float4 baseColor = albedoTexture.Sample(sampleSampler, input.fragTexCoord);
-    float metallic = metallicTexture.Sample(sampleSampler, input.fragTexCoord).r;
-    float roughness = max(roughnessTexture.Sample(sampleSampler, input.fragTexCoord).r, 0.01);
-    float3 normal = getNormalFromMap(normalTexture.Sample(sampleSampler, input.fragTexCoord).xyz * 2.0 - 1.0, input.fragTBN);
+    // one draw covers instances of every material, so texture slots can diverge within a wave
+    Material material = materials[input.materialIndex];
+    float4 baseColor = textures[NonUniformResourceIndex(material.albedo)].Sample(sampleSampler, input.fragTexCoord);
+    float metallic = textures[NonUniformResourceIndex(material.metallic)].Sample(sampleSampler, input.fragTexCoord).r;
+    float roughness = max(textures[NonUniformResourceIndex(material.roughness)].Sample(sampleSampler, input.fragTexCoord).r, 0.01);
+    // normal maps are cooked to two channels, rebuild z from xy
+    float2 normalXY = textures[NonUniformResourceIndex(material.normal)].Sample(sampleSampler, input.fragTexCoord).xy * 2.0 - 1.0;
+    float3 normal = getNormalFromMap(float3(normalXY, sqrt(saturate(1.0 - dot(normalXY, normalXY)))), input.fragTBN);
     GBufferOutput output;
     output.outAlbedo = baseColor;
     output.outNormal = float4(normalize(normal) * 0.5 + 0.5, 1.0);
@@ -6,29 +6,39 @@ struct VSOutput {
     [[vk::location(1)]] float3 fragNormal : TEXCOORD1;
     [[vk::location(2)]] float2 fragTexCoord : TEXCOORD2;
     [[vk::location(3)]] float3x3 fragTBN : TEXCOORD3;
+    [[vk::location(6)]] nointerpolation uint materialIndex : TEXCOORD6;
 };
 
 struct VSInput {
-    [[vk::location(0)]] float3 inPosition : POSITION;
-    [[vk::location(1)]] float3 inNormal : NORMAL;
+    [[vk::location(0)]] float4 inPosition : POSITION;       // unorm16 within the model aabb, w = tangent handedness
+    [[vk::location(1)]] float4 inNormalTangent : NORMAL;    // octahedral normal in xy, tangent in zw
     [[vk::location(2)]] float2 inTexCoord : TEXCOORD0;
-    [[vk::location(3)]] float4 inTangent : TANGENT;
-    [[vk::location(4)]] float4 inJoints : BLENDINDICES;   // joint indices as floats
-    [[vk::location(5)]] float4 inWeights : BLENDWEIGHT;   // joint weights (0.0-1.0)
+    [[vk::location(3)]] float4 inJoints : BLENDINDICES;   // joint indices as floats
+    [[vk::location(4)]] float4 inWeights : BLENDWEIGHT;   // joint weights (0.0-1.0)
 };
 
 struct PushConstants {
-    float4x4 model;
     float4x4 view;
     float4x4 projection;
-    float4 camPos; // w = bit 0, has skinning
+    float4 camPos;
+    float4 positionOffset; // model space = offset + position * scale
+    float4 positionScale;
 };
 [[vk::push_constant]] PushConstants pc;
 
-struct JointMatricesUBO {
-    float4x4 joints[128];
+struct GBufferInstance {
+    float4x4 model;
+    uint4 params; // x = joint palette offset, y = bit 0 has skinning, z = material index
 };
-[[vk::binding(0)]] ConstantBuffer<JointMatricesUBO> jointUBO;
+[[vk::binding(0)]] StructuredBuffer<GBufferInstance> instances;
+[[vk::binding(1)]] StructuredBuffer<float4x4> jointPalette;
+
+float3 octahedralDecode(float2 e) {
+    float3 n = float3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += select(n.xy >= 0.0, -t, t);
+    return normalize(n);
+}
 
 static const float4x4 IDENTITY = float4x4(
     1, 0, 0, 0,
@@ -37,30 +47,37 @@ static const float4x4 IDENTITY = float4x4(
     0, 0, 0, 1
 );
 
-VSOutput main(VSInput input) {
+VSOutput main(VSInput input, uint instanceID : SV_InstanceID) {
+    // SV_InstanceID includes the command's firstInstance, which is the start of its batch's range
+    GBufferInstance instance = instances[instanceID];
     float4x4 skinMatrix = IDENTITY;
-    if ((uint(pc.camPos.w) & 1u) != 0u) {
-        uint4 jointIndices = uint4(input.inJoints);
-        skinMatrix = jointUBO.joints[jointIndices.x] * input.inWeights.x +
-                     jointUBO.joints[jointIndices.y] * input.inWeights.y +
-                     jointUBO.joints[jointIndices.z] * input.inWeights.z +
-                     jointUBO.joints[jointIndices.w] * input.inWeights.w;
+    if ((instance.params.y & 1u) != 0u) {
+        uint4 jointIndices = uint4(input.inJoints) + instance.params.x;
+        skinMatrix = jointPalette[jointIndices.x] * input.inWeights.x +
+                     jointPalette[jointIndices.y] * input.inWeights.y +
+                     jointPalette[jointIndices.z] * input.inWeights.z +
+                     jointPalette[jointIndices.w] * input.inWeights.w;
     }
-    float4 skinnedPosition = mul(float4(input.inPosition, 1.0), skinMatrix);
-    float4 worldPos = mul(skinnedPosition, pc.model);
-    float3x3 modelMatrix3 = (float3x3) pc.model;
+    float3 position = pc.positionOffset.xyz + input.inPosition.xyz * pc.positionScale.xyz;
+    float3 normal = octahedralDecode(input.inNormalTangent.xy);
+    float3 tangent = octahedralDecode(input.inNormalTangent.zw);
+    float handedness = input.inPosition.w * 2.0 - 1.0;
+    float4 skinnedPosition = mul(float4(position, 1.0), skinMatrix);
+    float4 worldPos = mul(skinnedPosition, instance.model);
+    float3x3 modelMatrix3 = (float3x3) instance.model;
     float3x3 skinMatrix3 = (float3x3) skinMatrix;
     float3x3 combinedMatrix = mul(skinMatrix3, modelMatrix3);
     float3x3 normalMatrix = transpose(combinedMatrix);
-    float3 T = normalize(mul(input.inTangent.xyz, combinedMatrix));
-    float3 N = normalize(mul(normalMatrix, input.inNormal));
+    float3 T = normalize(mul(tangent, combinedMatrix));
+    float3 N = normalize(mul(normalMatrix, normal));
     T = normalize(T - dot(T, N) * N);
-    float3 B = cross(N, T) * input.inTangent.w;
+    float3 B = cross(N, T) * handedness;
     VSOutput output;
     output.gl_Position = mul(mul(worldPos, pc.view), pc.projection);
     output.fragPosition = worldPos.xyz;
     output.fragNormal = N;
     output.fragTexCoord = input.inTexCoord;
     output.fragTBN = float3x3(T, B, N);
+    output.materialIndex = instance.params.z;
     return output;
 }
\ No newline at end of file
@@ -0,0 +1,277 @@
+#pragma pack_matrix(row_major)
+
+struct GBufferInstance {
+    float4x4 model;
+    uint4 params; // x = joint palette offset, y = bit 0 has skinning, z = material index, or cube faces and light index for shadow casters
+};
+
+struct CullInput {
+    float4x4 model;
+    uint4 params; // x = joint palette offset, y = bit 0 has skinning, bit 1 skip culling, bits 16+ material index, z = first batch of the model, w = lod count
+    float4 boundsMin;
+    float4 boundsMax;
+};
+
+struct ShadowLightEntry {
+    float4x4 viewProjs[6];
+    float4 lightPosRadius;
+    float4 faceSidePlanes[24]; // four inward side planes per cube face
+    float4 lodParams; // xyz = light position, w = focal length in texels over the tolerated error
+};
+
+struct DrawBatch {
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance; // start of this batch's instance range
+    uint drawFirst; // first batch of the model, indexes its compacted commands and draw count
+    float lodError; // of the level this batch draws, in model units
+    uint pad;
+};
+
+struct DrawCommand {
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+};
+
+struct PushConstants {
+    float4 frustumPlanes[6];
+    float4x4 occlusionViewProj;
+    uint instanceCount;
+    uint occlusionEnabled;
+    uint depthWidth;
+    uint depthHeight;
+    uint depthPyramidMips;
+    uint phase; // 0 = cull instances, 1 = compact non-empty batches, 2 = re-test occluded instances, 3 = cull shadow casters
+    uint batchCount; // batches per set, the late set follows the early one
+    uint batchOffset; // 0 for the early set, batchCount for the late set, first shadow input in phase 3
+    float4 lodParams; // xyz = camera position, w = focal length in pixels over the tolerated error
+};
+[[vk::push_constant]] PushConstants pc;
+
+[[vk::binding(0)]]
+StructuredBuffer<CullInput> cullInputs;
+
+[[vk::binding(1)]]
+RWStructuredBuffer<GBufferInstance> instances;
+
+[[vk::binding(2)]]
+RWStructuredBuffer<DrawBatch> batches;
+
+[[vk::binding(3)]]
+Texture2D<float> depthPyramid; // farthest depth, last frame's in phase 0 and this frame's early draws in phase 2. mip 0 is half the depth buffer
+
+[[vk::binding(4)]]
+RWStructuredBuffer<DrawCommand> drawCommands;
+
+[[vk::binding(5)]]
+RWStructuredBuffer<uint> drawCounts; // indexed by drawFirst, cleared on the host
+
+[[vk::binding(6)]]
+RWStructuredBuffer<uint> occludedInstances; // [0] = count cleared on the host, then cull input indices rejected by phase 0
+
+[[vk::binding(7)]]
+StructuredBuffer<ShadowLightEntry> shadowLights;
+
+bool isAABBVisible(float3 boundsMin, float3 boundsMax) {
+    [unroll]
+    for (uint i = 0; i < 6; ++i) {
+        float4 plane = pc.frustumPlanes[i];
+        float3 p = float3(
+            plane.x >= 0.0 ? boundsMax.x : boundsMin.x,
+            plane.y >= 0.0 ? boundsMax.y : boundsMin.y,
+            plane.z >= 0.0 ? boundsMax.z : boundsMin.z
+        );
+        if (dot(plane.xyz, p) + plane.w < 0.0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// tests the AABB against the depth pyramid, projected with the view projection it was built from
+bool isAABBOccluded(float3 boundsMin, float3 boundsMax) {
+    float2 uvMin = float2(1.0, 1.0);
+    float2 uvMax = float2(0.0, 0.0);
+    float nearestZ = 1.0;
+    [unroll]
+    for (uint i = 0; i < 8; ++i) {
+        float3 corner = float3(
+            (i & 1u) ? boundsMax.x : boundsMin.x,
+            (i & 2u) ? boundsMax.y : boundsMin.y,
+            (i & 4u) ? boundsMax.z : boundsMin.z
+        );
+        float4 clip = mul(float4(corner, 1.0), pc.occlusionViewProj);
+        // crosses the near plane, the projected rect is unbounded
+        if (clip.w <= 1e-4) {
+            return false;
+        }
+        float3 ndc = clip.xyz / clip.w;
+        float2 uv = ndc.xy * 0.5 + 0.5;
+        uvMin = min(uvMin, uv);
+        uvMax = max(uvMax, uv);
+        nearestZ = min(nearestZ, ndc.z);
+    }
+    uvMin = saturate(uvMin);
+    uvMax = saturate(uvMax);
+    if (any(uvMax <= uvMin)) {
+        return false;
+    }
+
+    // pick the mip where the rect spans at most 2x2 texels
+    float2 depthSize = float2(pc.depthWidth, pc.depthHeight);
+    float2 rectPixels = (uvMax - uvMin) * depthSize;
+    float level = ceil(log2(max(max(rectPixels.x, rectPixels.y), 1.0))) - 1.0;
+    uint mip = (uint)clamp(level, 0.0, (float)(pc.depthPyramidMips - 1u));
+
+    uint mipWidth;
+    uint mipHeight;
+    uint mipCount;
+    depthPyramid.GetDimensions(mip, mipWidth, mipHeight, mipCount);
+    uint2 maxTexel = uint2(mipWidth, mipHeight) - 1u;
+    uint2 texelMin = min((uint2)(uvMin * depthSize) >> (mip + 1u), maxTexel);
+    uint2 texelMax = min((uint2)(uvMax * depthSize) >> (mip + 1u), maxTexel);
+    float d0 = depthPyramid.Load(int3(texelMin, mip));
+    float d1 = depthPyramid.Load(int3(uint2(texelMax.x, texelMin.y), mip));
+    float d2 = depthPyramid.Load(int3(uint2(texelMin.x, texelMax.y), mip));
+    float d3 = depthPyramid.Load(int3(texelMax, mip));
+    float farthest = max(max(d0, d1), max(d2, d3));
+    return nearestZ > farthest;
+}
+
+// cube faces whose four side planes all keep part of the AABB, the light range was applied by the host grid query
+uint cubeFaceMask(float3 boundsMin, float3 boundsMax, ShadowLightEntry light) {
+    uint mask = 0u;
+    [unroll]
+    for (uint face = 0; face < 6; ++face) {
+        bool inside = true;
+        [unroll]
+        for (uint p = 0; p < 4; ++p) {
+            float4 plane = light.faceSidePlanes[face * 4 + p];
+            float3 v = float3(
+                plane.x >= 0.0 ? boundsMax.x : boundsMin.x,
+                plane.y >= 0.0 ? boundsMax.y : boundsMin.y,
+                plane.z >= 0.0 ? boundsMax.z : boundsMin.z
+            );
+            inside = inside && dot(plane.xyz, v) + plane.w >= 0.0;
+        }
+        mask |= inside ? (1u << face) : 0u;
+    }
+    return mask;
+}
+
+// coarsest level whose error, projected from the nearest point of the bounds, stays under the tolerance
+uint selectLod(CullInput input, float4 lodParams) {
+    float3 nearest = clamp(lodParams.xyz, input.boundsMin.xyz, input.boundsMax.xyz);
+    float distance = length(nearest - lodParams.xyz);
+    if (distance <= 0.0) {
+        return 0u;
+    }
+    float scale = max(length(input.model[0].xyz), max(length(input.model[1].xyz), length(input.model[2].xyz)));
+    float pixelsPerUnit = lodParams.w * scale / distance;
+    uint lod = 0u;
+    for (uint i = 1u; i < input.params.w; ++i) {
+        if (batches[input.params.z + i].lodError * pixelsPerUnit > 1.0) {
+            break;
+        }
+        lod = i;
+    }
+    return lod;
+}
+
+// appends a batch that received instances to its model's commands, so empty lods are never drawn
+void compactBatch(uint batchIndex) {
+    DrawBatch batch = batches[batchIndex];
+    if (batch.instanceCount == 0u) {
+        return;
+    }
+    uint slot;
+    InterlockedAdd(drawCounts[batch.drawFirst], 1u, slot);
+    DrawCommand command;
+    command.indexCount = batch.indexCount;
+    command.instanceCount = batch.instanceCount;
+    command.firstIndex = batch.firstIndex;
+    command.vertexOffset = batch.vertexOffset;
+    command.firstInstance = batch.firstInstance;
+    drawCommands[batch.drawFirst + slot] = command;
+}
+
+void writeInstance(uint batchIndex, float4x4 model, uint4 params) {
+    uint slot;
+    InterlockedAdd(batches[batchIndex].instanceCount, 1u, slot);
+    GBufferInstance instance;
+    instance.model = model;
+    instance.params = params;
+    instances[batches[batchIndex].firstInstance + slot] = instance;
+}
+
+void emitInstance(CullInput input) {
+    uint batchIndex = pc.batchOffset + input.params.z + selectLod(input, pc.lodParams);
+    writeInstance(batchIndex, input.model, uint4(input.params.x, input.params.y & 1u, input.params.y >> 16u, 0u));
+}
+
+// the faces a caster overlaps go to the vertex shader, which collapses it in every other view
+void emitShadowCaster(CullInput input) {
+    uint lightIndex = input.params.y >> 16u;
+    ShadowLightEntry light = shadowLights[lightIndex];
+    uint allowedFaces = (input.params.y >> 8u) & 0x3Fu;
+    // bit 2 is the debug baseline that keeps every allowed face
+    uint faceMask = (input.params.y & 4u) != 0u
+        ? allowedFaces
+        : cubeFaceMask(input.boundsMin.xyz, input.boundsMax.xyz, light) & allowedFaces;
+    if (faceMask == 0u) {
+        return;
+    }
+    uint batchIndex = input.params.z + selectLod(input, light.lodParams);
+    writeInstance(batchIndex, input.model, uint4(input.params.x, input.params.y & 1u, faceMask, lightIndex));
+}
+
+[numthreads(64, 1, 1)]
+void main(uint3 globalID : SV_DispatchThreadID) {
+    if (pc.phase == 3u) {
+        // casters of every light pass, their batches sit past the gbuffer's in the same buffers
+        if (globalID.x < pc.instanceCount) {
+            emitShadowCaster(cullInputs[pc.batchOffset + globalID.x]);
+        }
+        return;
+    }
+    if (pc.phase == 1u) {
+        if (globalID.x < pc.batchCount) {
+            compactBatch(pc.batchOffset + globalID.x);
+        }
+        return;
+    }
+    if (pc.phase == 2u) {
+        // frustum was already tested in phase 0, only occlusion against this frame's early depth is left
+        if (globalID.x >= occludedInstances[0]) {
+            return;
+        }
+        CullInput occluded = cullInputs[occludedInstances[1u + globalID.x]];
+        if (isAABBOccluded(occluded.boundsMin.xyz, occluded.boundsMax.xyz)) {
+            return;
+        }
+        emitInstance(occluded);
+        return;
+    }
+    if (globalID.x >= pc.instanceCount) {
+        return;
+    }
+    CullInput input = cullInputs[globalID.x];
+    if ((input.params.y & 2u) == 0u) {
+        if (!isAABBVisible(input.boundsMin.xyz, input.boundsMax.xyz)) {
+            return;
+        }
+        if (pc.occlusionEnabled != 0u && isAABBOccluded(input.boundsMin.xyz, input.boundsMax.xyz)) {
+            // may have been disoccluded since last frame, phase 2 re-tests it
+            uint occludedSlot;
+            InterlockedAdd(occludedInstances[0], 1u, occludedSlot);
+            occludedInstances[1u + occludedSlot] = globalID.x;
+            return;
+        }
+    }
+    emitInstance(input);
+}
@@ -1,24 +1,26 @@
 struct VSOutput {
     [[vk::location(0)]] float3 worldNormal : TEXCOORD0;
     [[vk::location(1)]] float2 uv : TEXCOORD1;
+    [[vk::location(2)]] nointerpolation uint materialIndex : TEXCOORD2;
 };
 
-[[vk::binding(1)]]
-Texture2D<float4> albedoTexture;
+struct Material {
+    uint albedo;
+    uint metallic;
+    uint roughness;
+    uint normal;
+};
 
 [[vk::binding(2)]]
-Texture2D<float4> metallicTexture;
+StructuredBuffer<Material> materials;
 
 [[vk::binding(3)]]
-Texture2D<float4> roughnessTexture;
+Texture2D<float4> textures[1024];
 
 [[vk::binding(4)]]
-Texture2D<float4> normalTexture;
-
-[[vk::binding(5)]]
 SamplerState sampleSampler;
 
 float4 main(VSOutput input) : SV_Target {
-    float3 albedo = albedoTexture.Sample(sampleSampler, input.uv).rgb;
+    float3 albedo = textures[materials[input.materialIndex].albedo].Sample(sampleSampler, input.uv).rgb;
     return float4(albedo, 1.0);
 }
\ No newline at end of file
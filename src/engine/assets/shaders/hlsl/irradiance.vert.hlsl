@@ -4,30 +4,38 @@ struct VSOutput {
     float4 gl_Position : SV_Position;
     [[vk::location(0)]] float3 worldNormal : TEXCOORD0;
     [[vk::location(1)]] float2 uv : TEXCOORD1;
+    [[vk::location(2)]] nointerpolation uint materialIndex : TEXCOORD2;
 };
 
 struct VSInput {
-    [[vk::location(0)]] float3 inPosition : POSITION;
-    [[vk::location(1)]] float3 inNormal : NORMAL;
+    [[vk::location(0)]] float4 inPosition : POSITION;       // unorm16 within the model aabb
+    [[vk::location(1)]] float4 inNormalTangent : NORMAL;    // octahedral normal in xy, tangent in zw
     [[vk::location(2)]] float2 inTexCoord : TEXCOORD0;
 };
 
 struct PushConstants {
     float4x4 model;
     float4x4 viewProj;
+    uint4 materialParams; // x = material index
+    float4 positionOffset; // model space = offset + position * scale
+    float4 positionScale;
 };
 [[vk::push_constant]] PushConstants pc;
 
-struct JointMatricesUBO {
-    float4x4 joints[128];
-};
-[[vk::binding(0)]] ConstantBuffer<JointMatricesUBO> jointUBO;
+float3 octahedralDecode(float2 e) {
+    float3 n = float3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += select(n.xy >= 0.0, -t, t);
+    return normalize(n);
+}
 
 VSOutput main(VSInput input) {
     VSOutput output;
-    float4 worldPos = mul(float4(input.inPosition, 1.0), pc.model);
+    float3 position = pc.positionOffset.xyz + input.inPosition.xyz * pc.positionScale.xyz;
+    float4 worldPos = mul(float4(position, 1.0), pc.model);
     output.gl_Position = mul(worldPos, pc.viewProj);
-    output.worldNormal = normalize(mul(float4(input.inNormal, 0.0), pc.model).xyz);
+    output.worldNormal = normalize(mul(float4(octahedralDecode(input.inNormalTangent.xy), 0.0), pc.model).xyz);
     output.uv = input.inTexCoord;
+    output.materialIndex = pc.materialParams.x;
     return output;
 }
\ No newline at end of file
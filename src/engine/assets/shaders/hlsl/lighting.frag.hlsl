@@ -70,6 +70,12 @@ SamplerState sampleSampler;
 [[vk::binding(11)]]
 StructuredBuffer<ProbeSHData> irradianceProbeSH;
 
+// [0..3] = grid dims (w = built), [4..7] = z params, then (offset, count) per cluster, then light indices
+[[vk::binding(12)]]
+StructuredBuffer<uint> lightClusters;
+
+static const uint kClusterHeaderUints = 8u;
+
 struct PushConstants {
     float4x4 invView;
     float4x4 invProj;
@@ -275,11 +281,27 @@ float4 main(VSOutput input) : SV_Target {
     roughness = max(roughness, sigma);
 
     float NdotV = max(dot(N, V), 0.0);
-    uint numLights = lightsUBO.numPointLights.x;
     float3 F0 = lerp(float3(0.04, 0.04, 0.04), albedoSample.rgb, metallic);
     float3 Lo = float3(0.0, 0.0, 0.0);
+    uint4 clusterDims = uint4(lightClusters[0], lightClusters[1], lightClusters[2], lightClusters[3]);
+    uint numLights = lightsUBO.numPointLights.x;
+    uint listStart = 0u;
+    bool clustered = clusterDims.w != 0u;
+    if (clustered) {
+        float2 zParams = float2(asfloat(lightClusters[4]), asfloat(lightClusters[5]));
+        float viewDepth = max(-linearViewZ(depth), 1e-4);
+        uint3 cell = uint3(
+            min(uint(input.fragTexCoord.x * float(clusterDims.x)), clusterDims.x - 1u),
+            min(uint(input.fragTexCoord.y * float(clusterDims.y)), clusterDims.y - 1u),
+            uint(clamp(floor(log(viewDepth) * zParams.x + zParams.y), 0.0, float(clusterDims.z - 1u))));
+        uint cluster = (cell.z * clusterDims.y + cell.y) * clusterDims.x + cell.x;
+        listStart = lightClusters[kClusterHeaderUints + cluster * 2u];
+        numLights = lightClusters[kClusterHeaderUints + cluster * 2u + 1u];
+        listStart += kClusterHeaderUints + clusterDims.x * clusterDims.y * clusterDims.z * 2u;
+    }
     for (uint i = 0; i < numLights; ++i) {
-        PointLight light = lightsUBO.pointLights[i];
+        uint lightIndex = clustered ? lightClusters[listStart + i] : i;
+        PointLight light = lightsUBO.pointLights[lightIndex];
         float3 lightPos = light.positionRadius.xyz;
         float lightRadius = light.positionRadius.w;
         float3 lightColor = light.colorIntensity.rgb;
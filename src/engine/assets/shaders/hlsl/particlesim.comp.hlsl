@@ -0,0 +1,193 @@
+#pragma pack_matrix(row_major)
+
+struct ParticleData {
+    float4 position; // w = age
+    float4 prevPosition; // w = lifetime
+    float4 prevPrevPosition; // w = type
+    float4 color; // w = size
+};
+
+struct EmitCommand {
+    float4 positionLifetime;
+    float4 velocitySpread;
+    float4 colorSize;
+    uint4 params; // x = count, y = type, z = seed, w = starting age bits
+};
+
+struct PushConstants {
+    float4x4 viewProj;
+    float4 simParams; // x = gravity, y = dt, z = collision min age, w = bounce damping
+    uint2 depthSize;
+    uint mode;
+    uint srcPool;
+    uint emitCount;
+    uint capacity;
+    uint pad[2];
+};
+[[vk::push_constant]] PushConstants pc;
+
+[[vk::binding(0)]] StructuredBuffer<ParticleData> srcParticles;
+[[vk::binding(1)]] StructuredBuffer<float4> srcVelocities;
+[[vk::binding(2)]] RWStructuredBuffer<ParticleData> dstParticles;
+[[vk::binding(3)]] RWStructuredBuffer<float4> dstVelocities;
+// [0], [1] = live count per pool, [4..7] = draw args, [8..10] = dispatch args
+[[vk::binding(4)]] RWStructuredBuffer<uint> counters;
+[[vk::binding(5)]] StructuredBuffer<EmitCommand> emits;
+[[vk::binding(6)]] Texture2D<float> sceneDepth;
+[[vk::binding(7)]] Texture2D<float4> sceneNormal;
+
+static const uint kModeSimulate = 0u;
+static const uint kModeEmit = 1u;
+static const uint kModeFinalize = 2u;
+
+float hashSigned(uint seed) {
+    seed = seed * 747796405u + 2891336453u;
+    seed = ((seed >> ((seed >> 28u) + 4u)) ^ seed) * 277803737u;
+    return (float((seed >> 22u) ^ seed) / 4294967295.0) * 2.0 - 1.0;
+}
+
+bool projectToScreen(float3 worldPos, out uint2 pixel, out float depth) {
+    float4 clip = mul(float4(worldPos, 1.0), pc.viewProj);
+    pixel = uint2(0u, 0u);
+    depth = 0.0;
+    if (clip.w <= 0.0) {
+        return false;
+    }
+    float3 ndc = clip.xyz / clip.w;
+    if (any(abs(ndc.xy) >= 1.0) || ndc.z < 0.0 || ndc.z > 1.0) {
+        return false;
+    }
+    pixel = min(uint2((ndc.xy * 0.5 + 0.5) * float2(pc.depthSize)), pc.depthSize - 1u);
+    depth = ndc.z;
+    return true;
+}
+
+void appendParticle(ParticleData p, float3 velocity) {
+    uint dstPool = pc.srcPool ^ 1u;
+    uint index;
+    InterlockedAdd(counters[dstPool], 1u, index);
+    if (index >= pc.capacity) {
+        return;
+    }
+    dstParticles[index] = p;
+    dstVelocities[index] = float4(velocity, 0.0);
+}
+
+// mirrors integrateParticleKinematics, screen-space collision replaces the collider query
+void simulate(uint index) {
+    if (index >= counters[pc.srcPool]) {
+        return;
+    }
+    ParticleData p = srcParticles[index];
+    float3 velocity = srcVelocities[index].xyz;
+    float dt = pc.simParams.y;
+
+    p.position.w += dt;
+    if (p.position.w >= p.prevPosition.w) {
+        return;
+    }
+    if (p.prevPrevPosition.w > 0.5) { // trails only age
+        appendParticle(p, velocity);
+        return;
+    }
+
+    velocity.y -= pc.simParams.x * dt;
+    float3 currentPos = p.position.xyz;
+    p.prevPrevPosition.xyz = p.prevPosition.xyz;
+    p.prevPosition.xyz = currentPos;
+    float speedSq = dot(velocity, velocity);
+    if (speedSq < 0.01) {
+        return;
+    }
+    float3 newPos = currentPos + velocity * dt;
+
+    // a hit is the step crossing from in front of the depth buffer to behind it
+    if (p.position.w > pc.simParams.z && speedSq > 1.0) {
+        uint2 pixel;
+        float newDepth;
+        uint2 prevPixel;
+        float prevDepth;
+        if (projectToScreen(newPos, pixel, newDepth) && projectToScreen(currentPos, prevPixel, prevDepth)) {
+            float surfaceDepth = sceneDepth.Load(int3(pixel, 0));
+            if (surfaceDepth < 1.0 && newDepth > surfaceDepth && prevDepth <= surfaceDepth) {
+                float3 rawNormal = sceneNormal.Load(int3(pixel, 0)).xyz * 2.0 - 1.0;
+                float normalLen = length(rawNormal);
+                if (normalLen > 0.001) {
+                    float3 normal = rawNormal / normalLen;
+                    velocity = reflect(velocity, normal) * pc.simParams.w;
+                    newPos = currentPos + velocity * dt;
+                }
+            }
+        }
+    }
+
+    p.position.xyz = newPos;
+    appendParticle(p, velocity);
+}
+
+// one group per command, mirrors burstParticles and spawnTrail
+void emit(uint commandIndex, uint lane) {
+    if (commandIndex >= pc.emitCount) {
+        return;
+    }
+    EmitCommand command = emits[commandIndex];
+    float3 origin = command.positionLifetime.xyz;
+    float lifetime = command.positionLifetime.w;
+    uint count = command.params.x;
+    bool trail = command.params.y == 1u;
+    uint seed = command.params.z;
+
+    for (uint i = lane; i < count; i += 64u) {
+        ParticleData p;
+        if (trail) {
+            p.position = float4(origin, asfloat(command.params.w));
+            p.prevPosition = float4(command.velocitySpread.xyz, lifetime);
+            p.prevPrevPosition = float4(origin, 1.0);
+            p.color = command.colorSize;
+            appendParticle(p, float3(0.0, 0.0, 0.0));
+            continue;
+        }
+        uint particleSeed = seed + i * 8u;
+        float spread = command.velocitySpread.w;
+        float3 velocity = command.velocitySpread.xyz + float3(
+            hashSigned(particleSeed),
+            hashSigned(particleSeed + 1u),
+            hashSigned(particleSeed + 2u)) * spread;
+        float particleLifetime = lifetime + hashSigned(particleSeed + 3u) * 0.2 * lifetime;
+        float3 color = saturate(command.colorSize.xyz + float3(
+            hashSigned(particleSeed + 4u),
+            hashSigned(particleSeed + 5u),
+            hashSigned(particleSeed + 6u)) * 0.1);
+        p.position = float4(origin, 0.0);
+        p.prevPosition = float4(origin, particleLifetime);
+        p.prevPrevPosition = float4(origin, 0.0);
+        p.color = float4(color, command.colorSize.w);
+        appendParticle(p, velocity);
+    }
+}
+
+// clamps the new pool, writes next frame's dispatch and this frame's draw, empties the old pool
+void finalize() {
+    uint dstPool = pc.srcPool ^ 1u;
+    uint count = min(counters[dstPool], pc.capacity);
+    counters[dstPool] = count;
+    counters[4] = 4u;
+    counters[5] = count;
+    counters[6] = 0u;
+    counters[7] = 0u;
+    counters[8] = (count + 63u) / 64u;
+    counters[9] = 1u;
+    counters[10] = 1u;
+    counters[pc.srcPool] = 0u;
+}
+
+[numthreads(64, 1, 1)]
+void main(uint3 globalID : SV_DispatchThreadID, uint3 groupID : SV_GroupID, uint3 localID : SV_GroupThreadID) {
+    if (pc.mode == kModeSimulate) {
+        simulate(globalID.x);
+    } else if (pc.mode == kModeEmit) {
+        emit(groupID.x, localID.x);
+    } else if (pc.mode == kModeFinalize && globalID.x == 0u) {
+        finalize();
+    }
+}
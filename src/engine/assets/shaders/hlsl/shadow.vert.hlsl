@@ -1,7 +1,7 @@
 #pragma pack_matrix(row_major)
 
 struct VSInput {
-    [[vk::location(0)]] float3 inPosition : POSITION;
+    [[vk::location(0)]] float4 inPosition : POSITION; // unorm16 within the model aabb
     [[vk::location(1)]] float4 inJoints : JOINTS;
     [[vk::location(2)]] float4 inWeights : WEIGHTS;
 };
@@ -11,39 +11,51 @@ struct VSOutput {
 };
 
 struct PushConstants {
-    float4x4 model;
-    uint lightIndex;
-    uint flags;
-    uint pad[2];
+    float4 positionOffset; // model space = offset + position * scale
+    float4 positionScale;
 };
 
 [[vk::push_constant]] PushConstants pc;
 
-struct JointMatricesUBO {
-    float4x4 jointMatrices[128];
+struct ShadowInstance {
+    float4x4 model;
+    uint4 params; // x = joint palette offset, y = bit 0 has skinning, z = cube faces the caster overlaps, w = light index
 };
-[[vk::binding(0, 0)]] ConstantBuffer<JointMatricesUBO> joints;
+
+[[vk::binding(0, 0)]] StructuredBuffer<float4x4> jointPalette;
 
 struct ShadowLightEntry {
     float4x4 viewProjs[6];
     float4 lightPosRadius; // xyz = pos, w = radius
+    float4 faceSidePlanes[24];
+    float4 lodParams;
 };
 [[vk::binding(1, 0)]] StructuredBuffer<ShadowLightEntry> shadowLights;
+[[vk::binding(2, 0)]] StructuredBuffer<ShadowInstance> instances;
 
-VSOutput main(VSInput input, uint viewId : SV_ViewID) {
+VSOutput main(VSInput input, uint viewId : SV_ViewID, uint instanceID : SV_InstanceID) {
     VSOutput output;
-    float3 skinnedPos = input.inPosition;
-
-    if ((pc.flags & 1) != 0) {
-        float4x4 skinMatrix = mul(input.inWeights.x, joints.jointMatrices[uint(input.inJoints.x)]) +
-                            mul(input.inWeights.y, joints.jointMatrices[uint(input.inJoints.y)]) +
-                            mul(input.inWeights.z, joints.jointMatrices[uint(input.inJoints.z)]) +
-                            mul(input.inWeights.w, joints.jointMatrices[uint(input.inJoints.w)]);
-        skinnedPos = mul(float4(input.inPosition, 1.0), skinMatrix).xyz;
+    // SV_InstanceID includes the command's firstInstance, which is the start of its batch's range
+    ShadowInstance instance = instances[instanceID];
+    // every vertex of a caster outside this face lands on one point behind the near plane, so nothing rasterizes
+    if ((instance.params.z & (1u << viewId)) == 0u) {
+        output.gl_Position = float4(0.0, 0.0, -1.0, 1.0);
+        return output;
+    }
+    float3 position = pc.positionOffset.xyz + input.inPosition.xyz * pc.positionScale.xyz;
+    float3 skinnedPos = position;
+
+    if ((instance.params.y & 1u) != 0u) {
+        uint4 jointIndices = uint4(input.inJoints) + instance.params.x;
+        float4x4 skinMatrix = jointPalette[jointIndices.x] * input.inWeights.x +
+                              jointPalette[jointIndices.y] * input.inWeights.y +
+                              jointPalette[jointIndices.z] * input.inWeights.z +
+                              jointPalette[jointIndices.w] * input.inWeights.w;
+        skinnedPos = mul(float4(position, 1.0), skinMatrix).xyz;
     }
 
-    ShadowLightEntry light = shadowLights[pc.lightIndex];
-    float4 worldPos = mul(float4(skinnedPos, 1.0), pc.model);
+    ShadowLightEntry light = shadowLights[instance.params.w];
+    float4 worldPos = mul(float4(skinnedPos, 1.0), instance.model);
     float4 clipPos = mul(worldPos, light.viewProjs[viewId]);
     float distance = length(worldPos.xyz - light.lightPosRadius.xyz);
     float linearDepth = clamp(distance / light.lightPosRadius.w, 0.0, 1.0);
@@ -113,6 +113,7 @@ float3 reconstructPosition(float2 uv, float depth) {
 float computePointShadow(PointLight light, float3 fragPos, float3 geomNormal, float3 lightDir) {
     uint shadowIndex = light.shadowData.x;
     uint hasShadow = light.shadowData.y;
+    uint shadowSlot = light.shadowData.z;
     if (shadowIndex == INVALID_SHADOW_INDEX || hasShadow == 0) {
         return 1.0;
     }
@@ -153,7 +154,7 @@ float computePointShadow(PointLight light, float3 fragPos, float3 geomNormal, fl
         float2 so = diskOffsets[si];
         float2 srot = float2(so.x * ca - so.y * sa, so.x * sa + so.y * ca);
         float3 searchDir = sampleDir + (right * srot.x + forward * srot.y) * searchRadius;
-        float searchDepth = shadowMaps[shadowIndex].SampleLevel(sampleSampler, searchDir, 0.0);
+        float searchDepth = shadowMaps[shadowSlot].SampleLevel(sampleSampler, searchDir, 0.0);
         if (searchDepth < currentDepth - bias) {
             avgBlockerDepth += searchDepth;
             blockerCount += 1.0;
@@ -177,7 +178,7 @@ float computePointShadow(PointLight light, float3 fragPos, float3 geomNormal, fl
         float2 rotated = float2(o.x * ca - o.y * sa, o.x * sa + o.y * ca);
         float3 offsetDir = right * rotated.x + forward * rotated.y;
         float3 sampleOffset = sampleDir + offsetDir * diskRadius;
-        float sampleDepth = shadowMaps[shadowIndex].SampleLevel(sampleSampler, sampleOffset, 0.0);
+        float sampleDepth = shadowMaps[shadowSlot].SampleLevel(sampleSampler, sampleOffset, 0.0);
         float weight = 1.0;
         float diff = (currentDepth - bias) - sampleDepth;
         shadow += smoothstep(0.0, penumbraSize, diff) * weight;
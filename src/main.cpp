@@ -1,5 +1,6 @@
 #include <engine/Platform.h>
 #include <rind/GameInstance.h>
+#include <string_view>
 #if RIND_ENABLE_STEAM
 #include <rind/SteamManager.h>
 #include <rind/SteamInput.h>
@@ -41,12 +42,20 @@ static void fixupSteamOverlayPreload(char** argv) {
 #endif
 
 int main(int argc, char** argv) {
-	(void)argc;
 #if RIND_ENABLE_STEAM && defined(__linux__)
 	fixupSteamOverlayPreload(argv);
-#else
-	(void)argv;
 #endif
+	rind::LaunchOptions options;
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if (arg == "--gpu-particles") {
+			options.gpuParticles = true;
+		} else if (arg == "--particle-test") {
+			options.particleTest = true;
+		} else if (arg == "--shadow-all-faces") {
+			options.shadowAllFaces = true;
+		}
+	}
 #if RIND_ENABLE_STEAM
 	// must be the first Steam call
 	// true means Steam is relaunching, so exit
@@ -59,8 +68,8 @@ int main(int argc, char** argv) {
 	rind::steam::init();
 	rind::steaminput::init();
 #endif
-	int result = engine::Platform::runWithCrashReport([] {
-		rind::GameInstance game;
+	int result = engine::Platform::runWithCrashReport([options] {
+		rind::GameInstance game(options);
 		game.run();
 	});
 #if RIND_ENABLE_STEAM
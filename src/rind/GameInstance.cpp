@@ -41,9 +41,10 @@
 #include <rind/BashingBoss.h>
 #include <rind/GrenadeBoss.h>
 #include <rind/MissileBoss.h>
+#include <rind/ParticleTestEmitter.h>
 
-rind::GameInstance::GameInstance() {
-    std::function<void(engine::Renderer*)> titleScreenScene = [](engine::Renderer* renderer){
+rind::GameInstance::GameInstance(LaunchOptions options) {
+    std::function<void(engine::Renderer*)> titleScreenScene = [options](engine::Renderer* renderer){
         // Title screen UI setup
         engine::UIManager* uiManager = renderer->getUIManager();
         engine::EntityManager* entityManager = renderer->getEntityManager();
@@ -179,6 +180,16 @@ rind::GameInstance::GameInstance() {
             engine::Entity::EntityType::Static
         );
         playerEntity->setModel(playerModel);
+        if (options.gpuParticles || options.particleTest) {
+            renderer->getParticleManager()->setGPUSimulation(true);
+        }
+        if (options.particleTest) {
+            new rind::ParticleTestEmitter(
+                entityManager,
+                "particleTestEmitter",
+                glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 1.0f, -1.0f))
+            );
+        }
         lightManager->addLight(
             "titleLight",
             glm::translate(glm::mat4(1.0f), glm::vec3(-3.0f, 3.5f, -4.0f)),
@@ -281,17 +292,12 @@ rind::GameInstance::GameInstance() {
         engine::Model* platformModel = modelManager ? modelManager->getModel("groundplatform") : nullptr;
         engine::Model* platformColliderModel = modelManager ? modelManager->getModel("groundplatform-collider") : nullptr;
         groundplatform->setModel(platformModel);
-        auto [platformVerts, platformIndices] = platformColliderModel->loadVertsForModel();
         engine::ConvexHullCollider* platformCollider = new engine::ConvexHullCollider(
             entityManager,
             glm::mat4(1.0f),
             "groundplatform"
         );
-        platformCollider->setVertsFromModel(
-            std::move(platformVerts),
-            std::move(platformIndices),
-            glm::mat4(1.0f)
-        );
+        platformCollider->setHull(platformColliderModel);
         groundplatform->addChild(platformCollider);
         engine::Entity* groundblock = new engine::Entity(
             entityManager,
@@ -305,17 +311,12 @@ rind::GameInstance::GameInstance() {
         engine::Model* groundModel = modelManager ? modelManager->getModel("groundblock") : nullptr;
         groundblock->setModel(groundModel);
         engine::Model* groundColliderModel = modelManager ? modelManager->getModel("groundblock-collider") : nullptr;
-        auto [vertices, indices] = groundColliderModel->loadVertsForModel();
         engine::ConvexHullCollider* groundCollider = new engine::ConvexHullCollider(
             entityManager,
             glm::mat4(1.0f),
             "groundblock"
         );
-        groundCollider->setVertsFromModel(
-            std::move(vertices),
-            std::move(indices),
-            glm::mat4(1.0f)
-        );
+        groundCollider->setHull(groundColliderModel);
         groundblock->addChild(groundCollider);
 
         engine::Model* groundCubesModel = modelManager ? modelManager->getModel("groundcubes") : nullptr;
@@ -389,12 +390,7 @@ rind::GameInstance::GameInstance() {
             glm::mat4(1.0f),
             "lightObject1"
         );
-        auto [lightVerts, lightIndices] = lightColliderModel->loadVertsForModel();
-        lightCollider->setVertsFromModel(
-            lightVerts,
-            lightIndices,
-            glm::mat4(1.0f)
-        );
+        lightCollider->setHull(lightColliderModel);
         lightObject1->addChild(lightCollider);
 
         engine::Entity* lightObject2 = new engine::Entity(
@@ -430,11 +426,7 @@ rind::GameInstance::GameInstance() {
             glm::mat4(1.0f),
             "lightObject2"
         );
-        light2Collider->setVertsFromModel(
-            lightVerts,
-            lightIndices,
-            glm::mat4(1.0f)
-        );
+        light2Collider->setHull(lightColliderModel);
         lightObject2->addChild(light2Collider);
 
         engine::Entity* lightObject3 = new engine::Entity(
@@ -470,11 +462,7 @@ rind::GameInstance::GameInstance() {
             glm::mat4(1.0f),
             "lightObject3"
         );
-        light3Collider->setVertsFromModel(
-            lightVerts,
-            lightIndices,
-            glm::mat4(1.0f)
-        );
+        light3Collider->setHull(lightColliderModel);
         lightObject3->addChild(light3Collider);
 
         engine::Entity* lightObject4 = new engine::Entity(
@@ -510,11 +498,7 @@ rind::GameInstance::GameInstance() {
             glm::mat4(1.0f),
             "lightObject4"
         );
-        light4Collider->setVertsFromModel(
-            std::move(lightVerts),
-            std::move(lightIndices),
-            glm::mat4(1.0f)
-        );
+        light4Collider->setHull(lightColliderModel);
         lightObject4->addChild(light4Collider);
 
         std::vector<std::string> enemyMaterial = {
@@ -637,12 +621,31 @@ rind::GameInstance::GameInstance() {
     renderer->setOnFrameBegin([]{ rind::steam::runCallbacks(); });
 #endif
 
+    auto materialTextures = [](std::initializer_list<const char*> sets) {
+        std::vector<std::string> names;
+        for (const char* set : sets) {
+            for (const char* map : {"albedo", "metallic", "roughness", "normal"}) {
+                names.push_back(std::string("materials_") + set + "_" + map);
+            }
+        }
+        return names;
+    };
     std::vector<std::unique_ptr<engine::Scene>> scenes;
-    scenes.emplace_back(std::make_unique<engine::Scene>(titleScreenScene));
-    scenes.emplace_back(std::make_unique<engine::Scene>(mainGameScene));
+    scenes.emplace_back(std::make_unique<engine::Scene>(titleScreenScene,
+        materialTextures({"ground", "walls", "lasergun"}),
+        std::vector<std::string>{"groundplatform", "robot", "walls"}));
+    // enemies and projectiles spawn mid-game, preload them with the level
+    scenes.emplace_back(std::make_unique<engine::Scene>(mainGameScene,
+        materialTextures({"ground", "walls", "rock", "light", "damaged", "lasergun",
+            "enemy", "miniboss", "boss", "slowbullet"}),
+        std::vector<std::string>{"groundplatform", "groundplatform-collider", "groundblock", "groundblock-collider",
+            "groundcubes", "trueground", "walls", "light", "light-collider", "damaged",
+            "robot", "robot-visible", "robot-arm", "lasergun",
+            "enemy", "enemy-head", "flyingenemy", "bashingenemy", "slowbullet"}));
 
     entityManager = std::make_unique<engine::EntityManager>(renderer.get(), 2.0f, glm::vec3(55.0f, 25.0f, 55.0f));
     lightManager = std::make_unique<engine::LightManager>(renderer.get());
+    lightManager->setForceAllShadowFaces(options.shadowAllFaces);
     irradianceManager = std::make_unique<engine::IrradianceManager>(renderer.get());
     inputManager = std::make_unique<engine::InputManager>(renderer.get());
     sceneManager = std::make_unique<engine::SceneManager>(renderer.get(), std::move(scenes));
@@ -11,6 +11,7 @@
 #include <rind/GamepadBindings.h>
 #include <engine/TextureManager.h>
 #include <engine/InputManager.h>
+#include <engine/Platform.h>
 
 #include <array>
 #include <cmath>
@@ -20,42 +21,7 @@
 #include <unordered_set>
 #include <vector>
 
-#if defined(__APPLE__)
-#include <mach-o/dyld.h>
-#include <limits.h>
-#elif defined(_WIN32)
-#include <windows.h>
-#else
-#include <unistd.h>
-#include <limits.h>
-#endif
-
 namespace {
-    std::filesystem::path executableDir() {
-    #if defined(__APPLE__)
-        uint32_t size = PATH_MAX;
-        std::vector<char> buf(size + 1, '\0');
-        if (_NSGetExecutablePath(buf.data(), &size) != 0) {
-            buf.assign(size + 1, '\0');
-            if (_NSGetExecutablePath(buf.data(), &size) != 0) return {};
-        }
-        std::error_code ec;
-        auto p = std::filesystem::weakly_canonical(std::filesystem::path(buf.data()), ec);
-        return ec ? std::filesystem::path{} : p.parent_path();
-    #elif defined(_WIN32)
-        char buf[MAX_PATH];
-        DWORD n = GetModuleFileNameA(nullptr, buf, MAX_PATH);
-        if (n == 0 || n == MAX_PATH) return {};
-        std::error_code ec;
-        auto p = std::filesystem::weakly_canonical(std::filesystem::path(std::string(buf, n)), ec);
-        return ec ? std::filesystem::path{} : p.parent_path();
-    #else
-        std::error_code ec;
-        auto p = std::filesystem::read_symlink("/proc/self/exe", ec);
-        return ec ? std::filesystem::path{} : p.parent_path();
-    #endif
-    }
-
     using rind::GameAction;
 
     // canonical Steam Input action names
@@ -93,7 +59,7 @@ namespace {
             if (!SteamInput()) return;
             {
                 std::error_code ec;
-                std::filesystem::path manifest = executableDir() / "controller_config" /
+                std::filesystem::path manifest = engine::Platform::executableDir() / "controller_config" /
                     ("game_actions_" + std::to_string(rind::steam::kAppId) + ".vdf");
                 if (std::filesystem::exists(manifest, ec) && !ec) {
                     SteamInput()->SetInputActionManifestFilePath(manifest.string().c_str());
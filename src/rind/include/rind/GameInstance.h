@@ -26,9 +26,16 @@ namespace engine {
 }
 
 namespace rind {
+    // set from the command line in main.cpp
+    struct LaunchOptions {
+        bool gpuParticles = false; // --gpu-particles, simulate particles in compute whatever the setting says
+        bool particleTest = false; // --particle-test, the title screen keeps bursts going through the gpu pool
+        bool shadowAllFaces = false; // --shadow-all-faces, shadow casters skip the face test, baseline for the shadow counters
+    };
+
     class GameInstance {
     public:
-        GameInstance();
+        GameInstance(LaunchOptions options = {});
         ~GameInstance();
         void run();
 
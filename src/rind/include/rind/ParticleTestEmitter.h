@@ -0,0 +1,51 @@
+#pragma once
+
+#include <engine/EntityManager.h>
+#include <engine/ParticleManager.h>
+#include <engine/Renderer.h>
+#include <cmath>
+#include <numbers>
+
+namespace rind {
+    // keeps bursts of every size going through the particle pool, started with --particle-test
+    class ParticleTestEmitter : public engine::Entity {
+    public:
+        ParticleTestEmitter(
+            engine::EntityManager* entityManager,
+            const std::string& name,
+            const glm::mat4& transform,
+            float interval = 0.1f
+        ) : engine::Entity(entityManager, name, "", transform, {}, false), interval(interval) {}
+
+        void update(float deltaTime) override {
+            elapsed += deltaTime;
+            timer += deltaTime;
+            if (timer < interval) return;
+            timer = 0.0f;
+            engine::ParticleManager* particleManager = getEntityManager()->getRenderer()->getParticleManager();
+            const float phase = elapsed * 0.5f;
+            const glm::vec3 color(
+                0.5f + 0.5f * std::sin(phase),
+                0.5f + 0.5f * std::sin(phase + 2.0f * std::numbers::pi_v<float> / 3.0f),
+                0.5f + 0.5f * std::sin(phase + 4.0f * std::numbers::pi_v<float> / 3.0f)
+            );
+            // alternates small and large bursts so spawn budgets and compaction both get exercised
+            const int count = (burstIndex++ % 8 == 0) ? 2000 : 150;
+            particleManager->burstParticles(
+                getWorldPosition(),
+                color,
+                glm::vec3(std::cos(elapsed), 3.0f, std::sin(elapsed)),
+                count,
+                2.0f,
+                3.0f,
+                0.3f
+            );
+        }
+
+    private:
+        float interval;
+        float timer = 0.0f;
+        float elapsed = 0.0f;
+        uint32_t burstIndex = 0;
+    };
+};
@@ -0,0 +1,545 @@
+// Cooks a png/jpg/hdr into a KTX2 container with every mip level precomputed
+// usage: rind_texture_cooker INPUT OUTPUT ASSET_NAME
+#include <engine/CookedTexture.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb/stb_image_write.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using engine::cooked::TextureFormat;
+
+namespace {
+    struct Image {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<float> texels; // rgba, linear
+    };
+
+    float srgbToLinear(float c) {
+        return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+
+    float linearToSrgb(float c) {
+        return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+    }
+
+    uint8_t toUnorm8(float c) {
+        return static_cast<uint8_t>(std::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+
+    uint16_t floatToHalf(float value) {
+        uint32_t i;
+        std::memcpy(&i, &value, sizeof(i));
+        uint32_t sign = (i >> 16) & 0x8000;
+        int32_t exponent = ((i >> 23) & 0xff) - 127 + 15;
+        uint32_t mantissa = i & 0x7fffff;
+        if (exponent <= 0) {
+            if (exponent < -10) return static_cast<uint16_t>(sign);
+            mantissa = (mantissa | 0x800000) >> (1 - exponent);
+            return static_cast<uint16_t>(sign | (mantissa >> 13));
+        } else if (exponent >= 0x1f) {
+            return static_cast<uint16_t>(sign | 0x7c00);
+        }
+        return static_cast<uint16_t>(sign | (exponent << 10) | (mantissa >> 13));
+    }
+
+    bool contains(const std::string& text, const char* needle) {
+        return text.find(needle) != std::string::npos;
+    }
+
+    // same split as TextureManager's isNoncolorMap, block compression only for material sets.
+    // there is no ASTC encoder here: devices without textureCompressionBC (ASTC only mobile parts)
+    // get the BC levels expanded to rgba8 at load, a native ASTC cook is left out on purpose
+    TextureFormat chooseFormat(const std::string& assetName, bool isHDR) {
+        if (isHDR) return TextureFormat::RGBA16_SFLOAT;
+        const bool isMaterial = assetName.rfind("materials_", 0) == 0;
+        if (contains(assetName, "normal")) {
+            return isMaterial ? TextureFormat::BC5_UNORM : TextureFormat::RGBA8_UNORM;
+        }
+        if (contains(assetName, "metallic") || contains(assetName, "roughness")) {
+            return isMaterial ? TextureFormat::BC4_UNORM : TextureFormat::RGBA8_UNORM;
+        }
+        if (contains(assetName, "smaa_")) return TextureFormat::RGBA8_UNORM;
+        return isMaterial ? TextureFormat::BC7_SRGB : TextureFormat::RGBA8_SRGB;
+    }
+
+    bool isBlockCompressed(TextureFormat format) {
+        return format == TextureFormat::BC4_UNORM || format == TextureFormat::BC5_UNORM || format == TextureFormat::BC7_SRGB;
+    }
+
+    bool isSrgb(TextureFormat format) {
+        return format == TextureFormat::RGBA8_SRGB || format == TextureFormat::BC7_SRGB;
+    }
+
+    Image loadImage(const std::string& path, bool isHDR, bool srgb) {
+        Image image;
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        if (isHDR) {
+            float* pixels = stbi_loadf(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+            if (!pixels) throw std::runtime_error(std::string("failed to load: ") + stbi_failure_reason());
+            image.texels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+            stbi_image_free(pixels);
+        } else {
+            stbi_uc* pixels = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+            if (!pixels) throw std::runtime_error(std::string("failed to load: ") + stbi_failure_reason());
+            const size_t count = static_cast<size_t>(width) * height * 4;
+            image.texels.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                const float c = pixels[i] / 255.0f;
+                image.texels[i] = (srgb && (i & 3) != 3) ? srgbToLinear(c) : c;
+            }
+            stbi_image_free(pixels);
+        }
+        image.width = static_cast<uint32_t>(width);
+        image.height = static_cast<uint32_t>(height);
+        return image;
+    }
+
+    // 2x2 box filter with edge clamping, normal maps are renormalized
+    Image downsample(const Image& src, bool isNormalMap) {
+        Image dst;
+        dst.width = std::max(1u, src.width / 2);
+        dst.height = std::max(1u, src.height / 2);
+        dst.texels.resize(static_cast<size_t>(dst.width) * dst.height * 4);
+        for (uint32_t y = 0; y < dst.height; ++y) {
+            for (uint32_t x = 0; x < dst.width; ++x) {
+                std::array<float, 4> sum{};
+                for (uint32_t dy = 0; dy < 2; ++dy) {
+                    for (uint32_t dx = 0; dx < 2; ++dx) {
+                        const uint32_t sx = std::min(x * 2 + dx, src.width - 1);
+                        const uint32_t sy = std::min(y * 2 + dy, src.height - 1);
+                        const float* texel = &src.texels[(static_cast<size_t>(sy) * src.width + sx) * 4];
+                        for (int c = 0; c < 4; ++c) sum[c] += texel[c];
+                    }
+                }
+                float* out = &dst.texels[(static_cast<size_t>(y) * dst.width + x) * 4];
+                for (int c = 0; c < 4; ++c) out[c] = sum[c] * 0.25f;
+                if (isNormalMap) {
+                    float n[3] = {out[0] * 2.0f - 1.0f, out[1] * 2.0f - 1.0f, out[2] * 2.0f - 1.0f};
+                    const float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                    if (len > 1e-6f) {
+                        for (int c = 0; c < 3; ++c) out[c] = n[c] / len * 0.5f + 0.5f;
+                    }
+                }
+            }
+        }
+        return dst;
+    }
+
+    // gathers a 4x4 block as 8 bit values, clamping at the image edge
+    void fetchBlock(const Image& image, bool srgb, uint32_t bx, uint32_t by, uint8_t out[16][4]) {
+        for (uint32_t i = 0; i < 16; ++i) {
+            const uint32_t x = std::min(bx * 4 + (i & 3), image.width - 1);
+            const uint32_t y = std::min(by * 4 + (i >> 2), image.height - 1);
+            const float* texel = &image.texels[(static_cast<size_t>(y) * image.width + x) * 4];
+            for (int c = 0; c < 4; ++c) {
+                out[i][c] = toUnorm8((srgb && c != 3) ? linearToSrgb(texel[c]) : texel[c]);
+            }
+        }
+    }
+
+    class BitWriter {
+    public:
+        explicit BitWriter(uint8_t* out, size_t bytes) : out(out) { std::memset(out, 0, bytes); }
+        void write(uint32_t value, uint32_t bits) {
+            for (uint32_t i = 0; i < bits; ++i, ++pos) {
+                if ((value >> i) & 1u) out[pos >> 3] |= static_cast<uint8_t>(1u << (pos & 7));
+            }
+        }
+    private:
+        uint8_t* out;
+        uint32_t pos = 0;
+    };
+
+    void encodeBC4Block(const uint8_t values[16], uint8_t out[8]) {
+        uint8_t hi = values[0];
+        uint8_t lo = values[0];
+        for (int i = 1; i < 16; ++i) {
+            hi = std::max(hi, values[i]);
+            lo = std::min(lo, values[i]);
+        }
+        // hi > lo selects the 8 value palette
+        int palette[8] = {hi, lo};
+        for (int i = 2; i < 8; ++i) {
+            palette[i] = ((8 - i) * hi + (i - 1) * lo + 3) / 7;
+        }
+        BitWriter writer(out, 8);
+        writer.write(hi, 8);
+        writer.write(lo, 8);
+        for (int i = 0; i < 16; ++i) {
+            uint32_t best = 0;
+            int bestError = 256;
+            for (uint32_t p = 0; p < (hi == lo ? 1u : 8u); ++p) {
+                const int error = std::abs(palette[p] - values[i]);
+                if (error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            writer.write(best, 3);
+        }
+    }
+
+    constexpr int kBC7Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    struct BC7Mode6 {
+        int endpoints[2][4]; // 7 bit
+        int pbits[2];
+        uint8_t indices[16];
+        int error;
+    };
+
+    // picks the closest palette entry per texel for fixed quantized endpoints
+    void assignBC7Indices(const uint8_t texels[16][4], BC7Mode6& block) {
+        int palette[16][4];
+        for (int c = 0; c < 4; ++c) {
+            const int e0 = (block.endpoints[0][c] << 1) | block.pbits[0];
+            const int e1 = (block.endpoints[1][c] << 1) | block.pbits[1];
+            for (int w = 0; w < 16; ++w) {
+                palette[w][c] = ((64 - kBC7Weights[w]) * e0 + kBC7Weights[w] * e1 + 32) >> 6;
+            }
+        }
+        block.error = 0;
+        for (int i = 0; i < 16; ++i) {
+            int bestError = INT32_MAX;
+            for (int w = 0; w < 16; ++w) {
+                int error = 0;
+                for (int c = 0; c < 4; ++c) {
+                    const int d = palette[w][c] - texels[i][c];
+                    error += d * d;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    block.indices[i] = static_cast<uint8_t>(w);
+                }
+            }
+            block.error += bestError;
+        }
+    }
+
+    // tries every p-bit pair for a pair of unquantized endpoints
+    BC7Mode6 quantizeBC7(const uint8_t texels[16][4], const float lo[4], const float hi[4]) {
+        BC7Mode6 best{};
+        best.error = INT32_MAX;
+        for (int p = 0; p < 4; ++p) {
+            BC7Mode6 candidate{};
+            candidate.pbits[0] = p & 1;
+            candidate.pbits[1] = p >> 1;
+            for (int c = 0; c < 4; ++c) {
+                candidate.endpoints[0][c] = std::clamp(static_cast<int>(std::lround((lo[c] - candidate.pbits[0]) * 0.5f)), 0, 127);
+                candidate.endpoints[1][c] = std::clamp(static_cast<int>(std::lround((hi[c] - candidate.pbits[1]) * 0.5f)), 0, 127);
+            }
+            assignBC7Indices(texels, candidate);
+            if (candidate.error < best.error) best = candidate;
+        }
+        return best;
+    }
+
+    // single subset mode 6: endpoints from the principal axis, then one least squares refit
+    void encodeBC7Block(const uint8_t texels[16][4], uint8_t out[16]) {
+        float mean[4] = {};
+        for (int i = 0; i < 16; ++i) {
+            for (int c = 0; c < 4; ++c) mean[c] += texels[i][c] / 16.0f;
+        }
+        float cov[4][4] = {};
+        for (int i = 0; i < 16; ++i) {
+            float d[4];
+            for (int c = 0; c < 4; ++c) d[c] = texels[i][c] - mean[c];
+            for (int a = 0; a < 4; ++a) {
+                for (int b = 0; b < 4; ++b) cov[a][b] += d[a] * d[b];
+            }
+        }
+        float axis[4] = {1.0f, 1.0f, 1.0f, 0.25f};
+        for (int iter = 0; iter < 8; ++iter) {
+            float next[4] = {};
+            for (int a = 0; a < 4; ++a) {
+                for (int b = 0; b < 4; ++b) next[a] += cov[a][b] * axis[b];
+            }
+            const float len = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2] + next[3] * next[3]);
+            if (len < 1e-6f) break;
+            for (int c = 0; c < 4; ++c) axis[c] = next[c] / len;
+        }
+        float tMin = 0.0f;
+        float tMax = 0.0f;
+        for (int i = 0; i < 16; ++i) {
+            float t = 0.0f;
+            for (int c = 0; c < 4; ++c) t += (texels[i][c] - mean[c]) * axis[c];
+            tMin = std::min(tMin, t);
+            tMax = std::max(tMax, t);
+        }
+        float lo[4];
+        float hi[4];
+        for (int c = 0; c < 4; ++c) {
+            lo[c] = std::clamp(mean[c] + axis[c] * tMin, 0.0f, 255.0f);
+            hi[c] = std::clamp(mean[c] + axis[c] * tMax, 0.0f, 255.0f);
+        }
+        BC7Mode6 block = quantizeBC7(texels, lo, hi);
+
+        if (block.error > 0) {
+            float aa = 0.0f;
+            float ab = 0.0f;
+            float bb = 0.0f;
+            float ax[4] = {};
+            float bx[4] = {};
+            for (int i = 0; i < 16; ++i) {
+                const float w = kBC7Weights[block.indices[i]] / 64.0f;
+                aa += (1.0f - w) * (1.0f - w);
+                ab += (1.0f - w) * w;
+                bb += w * w;
+                for (int c = 0; c < 4; ++c) {
+                    ax[c] += (1.0f - w) * texels[i][c];
+                    bx[c] += w * texels[i][c];
+                }
+            }
+            const float det = aa * bb - ab * ab;
+            if (std::abs(det) > 1e-6f) {
+                for (int c = 0; c < 4; ++c) {
+                    lo[c] = std::clamp((ax[c] * bb - bx[c] * ab) / det, 0.0f, 255.0f);
+                    hi[c] = std::clamp((bx[c] * aa - ax[c] * ab) / det, 0.0f, 255.0f);
+                }
+                const BC7Mode6 refined = quantizeBC7(texels, lo, hi);
+                if (refined.error < block.error) block = refined;
+            }
+        }
+
+        // the anchor texel's index msb is implied zero
+        if (block.indices[0] & 8) {
+            std::swap(block.endpoints[0], block.endpoints[1]);
+            std::swap(block.pbits[0], block.pbits[1]);
+            for (uint8_t& index : block.indices) index = static_cast<uint8_t>(15 - index);
+        }
+        BitWriter writer(out, 16);
+        writer.write(1u << 6, 7);
+        for (int c = 0; c < 4; ++c) {
+            writer.write(static_cast<uint32_t>(block.endpoints[0][c]), 7);
+            writer.write(static_cast<uint32_t>(block.endpoints[1][c]), 7);
+        }
+        writer.write(static_cast<uint32_t>(block.pbits[0]), 1);
+        writer.write(static_cast<uint32_t>(block.pbits[1]), 1);
+        for (int i = 0; i < 16; ++i) {
+            writer.write(block.indices[i], i == 0 ? 3 : 4);
+        }
+    }
+
+    std::vector<uint8_t> encodeLevel(const Image& image, TextureFormat format) {
+        std::vector<uint8_t> out;
+        const uint32_t blocksX = (image.width + 3) / 4;
+        const uint32_t blocksY = (image.height + 3) / 4;
+        const size_t texelCount = static_cast<size_t>(image.width) * image.height;
+        switch (format) {
+            case TextureFormat::RGBA8_UNORM:
+            case TextureFormat::RGBA8_SRGB: {
+                const bool srgb = format == TextureFormat::RGBA8_SRGB;
+                out.resize(texelCount * 4);
+                for (size_t i = 0; i < out.size(); ++i) {
+                    const float c = image.texels[i];
+                    out[i] = toUnorm8((srgb && (i & 3) != 3) ? linearToSrgb(c) : c);
+                }
+                break;
+            }
+            case TextureFormat::RGBA16_SFLOAT: {
+                out.resize(texelCount * 8);
+                for (size_t i = 0; i < texelCount * 4; ++i) {
+                    const uint16_t half = floatToHalf(image.texels[i]);
+                    std::memcpy(&out[i * 2], &half, sizeof(half));
+                }
+                break;
+            }
+            case TextureFormat::BC4_UNORM:
+            case TextureFormat::BC5_UNORM: {
+                const uint32_t channels = format == TextureFormat::BC5_UNORM ? 2 : 1;
+                out.resize(static_cast<size_t>(blocksX) * blocksY * 8 * channels);
+                uint8_t* dst = out.data();
+                for (uint32_t by = 0; by < blocksY; ++by) {
+                    for (uint32_t bx = 0; bx < blocksX; ++bx) {
+                        uint8_t texels[16][4];
+                        fetchBlock(image, false, bx, by, texels);
+                        for (uint32_t c = 0; c < channels; ++c, dst += 8) {
+                            uint8_t values[16];
+                            for (int i = 0; i < 16; ++i) values[i] = texels[i][c];
+                            encodeBC4Block(values, dst);
+                        }
+                    }
+                }
+                break;
+            }
+            case TextureFormat::BC7_SRGB: {
+                out.resize(static_cast<size_t>(blocksX) * blocksY * 16);
+                uint8_t* dst = out.data();
+                for (uint32_t by = 0; by < blocksY; ++by) {
+                    for (uint32_t bx = 0; bx < blocksX; ++bx, dst += 16) {
+                        uint8_t texels[16][4];
+                        fetchBlock(image, true, bx, by, texels);
+                        encodeBC7Block(texels, dst);
+                    }
+                }
+                break;
+            }
+        }
+        return out;
+    }
+
+    void appendU32(std::vector<uint8_t>& out, uint32_t value) {
+        for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+
+    // basic data format descriptor, enough for ktx tools to identify the payload
+    std::vector<uint8_t> buildDfd(TextureFormat format) {
+        struct Sample { uint32_t bitOffset, bitLength, channel, lower, upper; };
+        constexpr uint32_t kModelRGBSDA = 1, kModelBC4 = 131, kModelBC5 = 132, kModelBC7 = 134;
+        constexpr uint32_t kLinear = 0x10, kSigned = 0x40, kFloat = 0x80, kAlpha = 15;
+        uint32_t model = kModelRGBSDA;
+        uint32_t blockDim = 0;
+        uint32_t bytesPlane0 = 4;
+        std::vector<Sample> samples;
+        switch (format) {
+            case TextureFormat::RGBA8_UNORM:
+            case TextureFormat::RGBA8_SRGB:
+                samples = {{0, 7, 0, 0, 255}, {8, 7, 1, 0, 255}, {16, 7, 2, 0, 255},
+                    {24, 7, kAlpha | (isSrgb(format) ? kLinear : 0u), 0, 255}};
+                break;
+            case TextureFormat::RGBA16_SFLOAT:
+                bytesPlane0 = 8;
+                for (uint32_t c = 0; c < 4; ++c) {
+                    samples.push_back({c * 16, 15, (c == 3 ? kAlpha : c) | kSigned | kFloat, 0xBF800000u, 0x3F800000u});
+                }
+                break;
+            case TextureFormat::BC4_UNORM:
+                model = kModelBC4;
+                blockDim = 3 | (3 << 8);
+                bytesPlane0 = 8;
+                samples = {{0, 63, 0, 0, 0xFFFFFFFFu}};
+                break;
+            case TextureFormat::BC5_UNORM:
+                model = kModelBC5;
+                blockDim = 3 | (3 << 8);
+                bytesPlane0 = 16;
+                samples = {{0, 63, 0, 0, 0xFFFFFFFFu}, {64, 63, 1, 0, 0xFFFFFFFFu}};
+                break;
+            case TextureFormat::BC7_SRGB:
+                model = kModelBC7;
+                blockDim = 3 | (3 << 8);
+                bytesPlane0 = 16;
+                samples = {{0, 127, 0, 0, 0xFFFFFFFFu}};
+                break;
+        }
+        const uint32_t transfer = isSrgb(format) ? 2u : 1u;
+        const uint32_t blockSize = 24 + 16 * static_cast<uint32_t>(samples.size());
+        std::vector<uint8_t> dfd;
+        appendU32(dfd, 4 + blockSize);
+        appendU32(dfd, 0);
+        appendU32(dfd, 2u | (blockSize << 16));
+        appendU32(dfd, model | (1u << 8) | (transfer << 16));
+        appendU32(dfd, blockDim);
+        appendU32(dfd, bytesPlane0);
+        appendU32(dfd, 0);
+        for (const Sample& sample : samples) {
+            appendU32(dfd, sample.bitOffset | (sample.bitLength << 16) | (sample.channel << 24));
+            appendU32(dfd, 0);
+            appendU32(dfd, sample.lower);
+            appendU32(dfd, sample.upper);
+        }
+        return dfd;
+    }
+
+    std::vector<uint8_t> cook(const std::string& input, const std::string& assetName) {
+        std::string extension = input.substr(input.find_last_of('.') + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+        const bool isHDR = extension == "hdr";
+        const TextureFormat format = chooseFormat(assetName, isHDR);
+        const bool isNormalMap = format == TextureFormat::BC5_UNORM || (format == TextureFormat::RGBA8_UNORM && contains(assetName, "normal"));
+
+        // same level count the runtime blit chain used
+        std::vector<Image> levels;
+        levels.push_back(loadImage(input, isHDR, isSrgb(format)));
+        const uint32_t levelCount = static_cast<uint32_t>(std::floor(std::log2(std::max(levels[0].width, levels[0].height)))) + 1;
+        while (levels.size() < levelCount) {
+            levels.push_back(downsample(levels.back(), isNormalMap));
+        }
+
+        // bc levels stay raw so the runtime stages them straight from the mapped pack,
+        // zlib on top of bc saves little and costs an inflate per level at load
+        const bool raw = isBlockCompressed(format);
+        std::vector<std::vector<uint8_t>> compressed(levelCount);
+        std::vector<uint64_t> uncompressedSizes(levelCount);
+        for (uint32_t level = 0; level < levelCount; ++level) {
+            std::vector<uint8_t> encoded = encodeLevel(levels[level], format);
+            uncompressedSizes[level] = encoded.size();
+            if (raw) {
+                compressed[level] = std::move(encoded);
+                continue;
+            }
+            int compressedSize = 0;
+            unsigned char* zlib = stbi_zlib_compress(encoded.data(), static_cast<int>(encoded.size()), &compressedSize, 8);
+            if (!zlib) throw std::runtime_error("zlib compression failed");
+            compressed[level].assign(zlib, zlib + compressedSize);
+            STBIW_FREE(zlib);
+        }
+
+        const std::vector<uint8_t> dfd = buildDfd(format);
+        engine::cooked::Ktx2Header header{};
+        std::memcpy(header.identifier, engine::cooked::kKtx2Identifier, sizeof(header.identifier));
+        header.vkFormat = static_cast<uint32_t>(format);
+        header.typeSize = format == TextureFormat::RGBA16_SFLOAT ? 2 : 1;
+        header.pixelWidth = levels[0].width;
+        header.pixelHeight = levels[0].height;
+        header.faceCount = 1;
+        header.levelCount = levelCount;
+        header.supercompressionScheme = raw ? engine::cooked::kKtx2SupercompressionNone : engine::cooked::kKtx2SupercompressionZlib;
+        header.dfdByteOffset = static_cast<uint32_t>(sizeof(header) + levelCount * sizeof(engine::cooked::Ktx2Level));
+        header.dfdByteLength = static_cast<uint32_t>(dfd.size());
+
+        // level data goes smallest first, as the spec recommends for streaming.
+        // raw levels get the spec's mip padding to 16 bytes, which also keeps every copy region block aligned
+        std::vector<engine::cooked::Ktx2Level> levelIndex(levelCount);
+        uint64_t offset = header.dfdByteOffset + header.dfdByteLength;
+        for (uint32_t level = levelCount; level-- > 0;) {
+            if (raw) offset = (offset + 15) & ~uint64_t(15);
+            levelIndex[level] = {offset, compressed[level].size(), uncompressedSizes[level]};
+            offset += compressed[level].size();
+        }
+
+        std::vector<uint8_t> out(offset);
+        std::memcpy(out.data(), &header, sizeof(header));
+        std::memcpy(out.data() + sizeof(header), levelIndex.data(), levelIndex.size() * sizeof(engine::cooked::Ktx2Level));
+        std::memcpy(out.data() + header.dfdByteOffset, dfd.data(), dfd.size());
+        for (uint32_t level = 0; level < levelCount; ++level) {
+            std::memcpy(out.data() + levelIndex[level].byteOffset, compressed[level].data(), compressed[level].size());
+        }
+        return out;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 4) {
+        std::cerr << "Usage: " << argv[0] << " INPUT OUTPUT ASSET_NAME\n";
+        return 1;
+    }
+    try {
+        const std::vector<uint8_t> data = cook(argv[1], argv[3]);
+        std::ofstream file(argv[2], std::ios::binary);
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!file) throw std::runtime_error(std::string("failed to write ") + argv[2]);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to cook " << argv[1] << ": " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}